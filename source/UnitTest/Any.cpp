@@ -2,10 +2,12 @@
 
 #include <rengine/util/Any.h>
 #include <rengine/util/OpaqueProperty.h>
+#include <rengine/util/HashMap.h>
 
 #include <list>
 #include <string>
 #include <algorithm>
+#include <sstream>
 
 using namespace rengine;
 
@@ -245,3 +247,68 @@ UNITT_TEST_BEGIN_CLASS(UnitTestOpaqueProperty)
 	}
 
 UNITT_TEST_END_CLASS(UnitTestOpaqueProperty)
+
+UNITT_TEST_BEGIN_CLASS(UnitTestHashMap)
+
+	virtual void run()
+	{
+		typedef HashMap<std::string, int> Names;
+		Names names;
+
+		UNITT_ASSERT(names.empty());
+		UNITT_ASSERT(names.find("missing") == names.end());
+		UNITT_FAIL_NOT_EQUAL(0, int(names.erase("missing")));
+
+		// enough names to grow the buckets a few times
+		for (int i = 0; i != 1000; ++i)
+		{
+			std::stringstream name;
+			name << "name_" << i;
+			UNITT_ASSERT(names.insert(Names::value_type(name.str(), i)).second);
+		}
+		UNITT_FAIL_NOT_EQUAL(1000, int(names.size()));
+		UNITT_ASSERT(!names.insert(Names::value_type("name_10", -1)).second);
+		UNITT_FAIL_NOT_EQUAL(10, names["name_10"]);
+
+		// iterators survive growth and other erases
+		Names::iterator kept = names.find("name_500");
+		UNITT_ASSERT(kept != names.end());
+
+		for (int i = 0; i != 1000; i += 2)
+		{
+			std::stringstream name;
+			name << "name_" << i;
+			UNITT_FAIL_NOT_EQUAL(1, int(names.erase(name.str())));
+		}
+		UNITT_FAIL_NOT_EQUAL(500, int(names.size()));
+
+		names["name_1001"] = 1001;
+		UNITT_FAIL_NOT_EQUAL(501, int(names.size()));
+		UNITT_ASSERT(names.find("name_2") == names.end());
+		UNITT_FAIL_NOT_EQUAL(3, names.find("name_3")->second);
+		UNITT_FAIL_NOT_EQUAL(1001, names.find("name_1001")->second);
+
+		// elements are listed in insertion order
+		UNITT_FAIL_NOT_EQUAL("name_1", names.begin()->first);
+
+		// copies have their own buckets
+		Names copy = names;
+		copy.erase("name_3");
+		UNITT_ASSERT(copy.find("name_3") == copy.end());
+		UNITT_ASSERT(names.find("name_3") != names.end());
+		UNITT_FAIL_NOT_EQUAL(5, copy.find("name_5")->second);
+
+		int values[2] = { 0, 0 };
+		HashMap<int const*, int> pointers;
+		pointers[&values[0]] = 1;
+		pointers[&values[1]] = 2;
+		UNITT_FAIL_NOT_EQUAL(2, pointers.find(&values[1])->second);
+		pointers.erase(pointers.find(&values[0]));
+		UNITT_ASSERT(pointers.find(&values[0]) == pointers.end());
+
+		names.clear();
+		UNITT_ASSERT(names.empty());
+		UNITT_ASSERT(names.begin() == names.end());
+	}
+
+UNITT_TEST_END_CLASS(UnitTestHashMap)
@@ -6,10 +6,14 @@
 #include <rengine/state/Streams.h>
 #include <rengine/state/Program.h>
 #include <rengine/state/ShaderResourceLoader.h>
+#include <rengine/state/ProgramBinaryCache.h>
+#include <rengine/file/File.h>
 #include <rengine/string/String.h>
 
 
 #include <iostream>
+#include <fstream>
+#include <cstdio>
 
 using namespace rengine;
 using namespace std;
@@ -209,3 +213,72 @@ UNITT_TEST_BEGIN_CLASS(UnitTestShaderLoader)
 	}
 
 UNITT_TEST_END_CLASS(UnitTestShaderLoader)
+
+
+//
+// UnitTestProgramBinaryCache
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestProgramBinaryCache)
+
+	virtual void run()
+	{
+		std::string const vertex = "void main() { gl_Position = vec4(0.0); }";
+		std::string const fragment = "void main() { gl_FragColor = vec4(1.0); }";
+
+		ProgramBinaryCache::Binary binary;
+		for (Uint i = 0; i != 100; ++i)
+		{
+			binary.push_back(Uchar(i));
+		}
+
+		ProgramBinaryCache cache;
+		cache.setDriver("vendor | renderer | 1.0");
+		UNITT_ASSERT(!cache.enabled());
+		UNITT_ASSERT(!cache.save(vertex, fragment, 7, binary));
+
+		cache.setDirectory("program_binary_cache_test");
+		UNITT_ASSERT(cache.enabled());
+		UNITT_ASSERT(cache.save(vertex, fragment, 7, binary));
+		UNITT_ASSERT(fileModificationTime(cache.filename(vertex, fragment)) > 0.0);
+
+		Uint format = 0;
+		ProgramBinaryCache::Binary loaded;
+		UNITT_ASSERT(cache.load(vertex, fragment, format, loaded));
+		UNITT_FAIL_NOT_EQUAL(7, format);
+		UNITT_ASSERT(loaded == binary);
+
+		// other sources and other drivers miss
+		UNITT_ASSERT(!cache.load(vertex + " ", fragment, format, loaded));
+		UNITT_ASSERT(!cache.load(vertex, "", format, loaded));
+
+		ProgramBinaryCache updated;
+		updated.setDirectory(cache.directory());
+		updated.setDriver("vendor | renderer | 1.1");
+		UNITT_ASSERT(!updated.load(vertex, fragment, format, loaded));
+
+		// sources of the same size whose checksums collide miss
+		std::string const colliding = "void main() { gl_Position = vec4(1.0); }";
+		UNITT_FAIL_NOT_EQUAL(vertex.size(), colliding.size());
+		std::remove(cache.filename(colliding, fragment).c_str());
+		UNITT_ASSERT(std::rename(cache.filename(vertex, fragment).c_str(), cache.filename(colliding, fragment).c_str()) == 0);
+		UNITT_ASSERT(!cache.load(colliding, fragment, format, loaded));
+		UNITT_ASSERT(std::rename(cache.filename(colliding, fragment).c_str(), cache.filename(vertex, fragment).c_str()) == 0);
+
+		// a binary size past the end of the file is rejected before allocating
+		{
+			std::fstream file(cache.filename(vertex, fragment).c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			Uint32 const huge = 0xFFFFFFFF;
+			file.seekp(std::streamoff(4 + 4 + 4 + cache.driver().size() + 4 + vertex.size() + 4 + fragment.size() + 4));
+			file.write((char const*) &huge, sizeof(huge));
+		}
+		UNITT_ASSERT(!cache.load(vertex, fragment, format, loaded));
+
+		cache.remove(vertex, fragment);
+		UNITT_ASSERT(!cache.load(vertex, fragment, format, loaded));
+		UNITT_ASSERT(fileModificationTime(cache.filename(vertex, fragment)) == 0.0);
+
+		std::remove(convertFileNameToNativeStyle(cache.directory()).c_str());
+	}
+
+UNITT_TEST_END_CLASS(UnitTestProgramBinaryCache)
@@ -1,8 +1,13 @@
 #include "UnitTest/UnitTest.h"
 
 #include <rengine/file/File.h>
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/image/Filter.h>
+#include <rengine/resource/AssetPack.h>
+#include <rengine/text/Fonts.h>
 
 #include <algorithm>
+#include <fstream>
 
 using namespace std;
 using namespace rengine;
@@ -91,3 +96,259 @@ virtual void run()
 }
 
 UNITT_TEST_END_CLASS(UnitTestFileDirectory)
+
+
+//
+// UnitTestFileVirtualFileSystem
+//
+
+static std::string readStream(SharedFileStream stream)
+{
+	std::string contents;
+	Char buffer[5];
+
+	for (Uint count = stream->read(buffer, sizeof(buffer)); count; count = stream->read(buffer, sizeof(buffer)))
+	{
+		contents.append(buffer, count);
+	}
+
+	return contents;
+}
+
+UNITT_TEST_BEGIN_CLASS(UnitTestFileVirtualFileSystem)
+
+virtual void run()
+{
+	UNITT_FAIL_NOT_EQUAL("a/c", VirtualFileSystem::normalize("a/./b/../c"));
+	UNITT_FAIL_NOT_EQUAL("a/c", VirtualFileSystem::normalize("a\\b\\..\\c\\"));
+	UNITT_FAIL_NOT_EQUAL("../x", VirtualFileSystem::normalize("./../x"));
+	UNITT_FAIL_NOT_EQUAL("/", VirtualFileSystem::normalize("/a/../.."));
+
+	VirtualFileSystem vfs;
+	UNITT_ASSERT(!vfs.fileExists("assets/File/one_text_file.txt"));
+
+	vfs.mountDirectory("unit_test_data", "assets");
+	UNITT_ASSERT(vfs.mountZip("unit_test_data/file_zipped.zip", "pack"));
+	UNITT_ASSERT(!vfs.mountZip("unit_test_data/missing.zip", "missing"));
+	UNITT_FAIL_NOT_EQUAL(2, vfs.numberOfMounts());
+
+	UNITT_ASSERT(vfs.fileType("") == FileDirectory);
+	UNITT_ASSERT(vfs.fileType("assets") == FileDirectory);
+	UNITT_ASSERT(vfs.fileType("pack/unit_test_data/Shader") == FileDirectory);
+	UNITT_ASSERT(vfs.fileType("assets/File/One") == FileDirectory);
+	UNITT_ASSERT(vfs.fileType("assets/File/../File/one_text_file.txt") == FileRegular);
+	UNITT_ASSERT(vfs.fileType("pack/unit_test_data/Shader/pin.fsh") == FileRegular);
+	UNITT_ASSERT(vfs.fileType("assets/unit_test_data/Shader/pin.fsh") == FileNotFound);
+
+	DirectoryContents contents = vfs.getDirectoryContents("");
+	UNITT_FAIL_NOT_EQUAL(2, contents.size());
+	UNITT_ASSERT(std::find(contents.begin(), contents.end(), "assets") != contents.end());
+	UNITT_ASSERT(std::find(contents.begin(), contents.end(), "pack") != contents.end());
+
+	contents = find("assets/File", EqualExtension("txt"), false, vfs);
+	UNITT_FAIL_NOT_EQUAL(2, contents.size());
+
+	// the same file from the disk and from the pack, the packed one has windows line endings
+	FileData disk;
+	FileData packed;
+	UNITT_ASSERT(vfs.read("assets/Shader/pin.fsh", disk));
+	UNITT_ASSERT(vfs.read("pack/unit_test_data/Shader/pin.fsh", packed));
+	UNITT_ASSERT(!vfs.read("assets/Shader/missing.fsh", disk));
+
+	std::string const disk_raw((Char const*) disk.bytes(), disk.size);
+	std::string const packed_raw((Char const*) packed.bytes(), packed.size);
+	UNITT_FAIL_NOT_EQUAL(disk_raw, readStream(vfs.openStream("assets/Shader/pin.fsh")));
+	UNITT_FAIL_NOT_EQUAL(packed_raw, readStream(vfs.openStream("pack/unit_test_data/Shader/pin.fsh")));
+	UNITT_ASSERT(!vfs.openStream("assets/Shader/missing.fsh"));
+
+	std::string text;
+	std::string packed_text;
+	UNITT_ASSERT(vfs.readText("assets/Shader/pin.fsh", text));
+	UNITT_ASSERT(vfs.readText("pack/unit_test_data/Shader/pin.fsh", packed_text));
+	UNITT_FAIL_NOT_EQUAL(disk_raw, text);
+	UNITT_FAIL_NOT_EQUAL(text, packed_text);
+
+	// an overlay with higher priority hides the directory file
+	VirtualFileSystem::SharedMemoryMount overlay = vfs.mountMemory("assets", 1);
+	overlay->add("File/one_text_file.txt", "overridden");
+	overlay->add("Generated/new.txt", "new file");
+
+	UNITT_ASSERT(vfs.readText("assets/File/one_text_file.txt", text));
+	UNITT_FAIL_NOT_EQUAL("overridden", text);
+	UNITT_ASSERT(vfs.readText("assets/File/another file.txt", text));
+	UNITT_FAIL_NOT_EQUAL("hello world\n", text);
+	UNITT_FAIL_NOT_EQUAL("new file", readStream(vfs.openStream("assets/Generated/new.txt")));
+	UNITT_ASSERT(vfs.fileType("assets/Generated") == FileDirectory);
+
+	contents = vfs.getDirectoryContents("assets");
+	UNITT_ASSERT(std::find(contents.begin(), contents.end(), "Generated") != contents.end());
+	UNITT_ASSERT(std::find(contents.begin(), contents.end(), "Shader") != contents.end());
+
+	// the same priority tries the last mounted first
+	VirtualFileSystem::SharedMemoryMount later = vfs.mountMemory("assets/File", 1);
+	later->add("one_text_file.txt", "later");
+	UNITT_ASSERT(vfs.readText("assets/File/one_text_file.txt", text));
+	UNITT_FAIL_NOT_EQUAL("later", text);
+
+	UNITT_ASSERT(vfs.unmount(later));
+	UNITT_ASSERT(vfs.unmount(overlay));
+	UNITT_ASSERT(!vfs.unmount(overlay));
+	UNITT_ASSERT(vfs.readText("assets/File/one_text_file.txt", text));
+	UNITT_FAIL_NOT_EQUAL("hello world\n", text);
+	UNITT_ASSERT(!vfs.fileExists("assets/Generated/new.txt"));
+
+	vfs.unmountAll();
+	UNITT_FAIL_NOT_EQUAL(0, vfs.numberOfMounts());
+	UNITT_ASSERT(!vfs.fileExists("assets/File/another file.txt"));
+}
+
+UNITT_TEST_END_CLASS(UnitTestFileVirtualFileSystem)
+
+
+//
+// UnitTestFileAssetPack
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestFileAssetPack)
+
+virtual void run()
+{
+	std::string const filename("unit_test_pack.rpak");
+	std::string const text("hello world\n");
+
+	// a 5x3 rgb gradient, flipped rows like the cooker stores them
+	SharedPointer<Image> image = new Image(5, 3, 3);
+	for (Uint i = 0; i != 5 * 3 * 3; ++i)
+	{
+		image->getData()[i] = Uint8(i * 5);
+	}
+
+	MipmapChain mipmaps;
+	mipmaps.build(image, BoxFilter());
+	UNITT_FAIL_NOT_EQUAL(3, mipmaps.numberOfLevels());
+
+	std::vector<Uint8> cooked_image;
+	AssetPack::encodeImage(*image, &mipmaps, AssetPack::ImageFlipped, cooked_image);
+
+	Winfont font;
+	FileData font_source;
+	UNITT_ASSERT(VirtualFileSystem::DirectoryMount().read("data/fonts/fon/5x7-iso8859-1.fon", font_source));
+	UNITT_ASSERT(font.load(font_source.bytes(), font_source.size));
+
+	std::vector<Uint8> cooked_font;
+	UNITT_ASSERT(CookedFont::cook(font, font_source.bytes(), font_source.size, cooked_font));
+
+	{
+		AssetPackWriter writer(filename);
+		UNITT_ASSERT(writer.isOpen());
+		UNITT_ASSERT(writer.add("text/hello.txt", AssetPack::RawEntry, text.data(), Uint(text.size())));
+		UNITT_ASSERT(writer.add("./images/gradient.png", AssetPack::ImageEntry, &cooked_image[0], Uint(cooked_image.size())));
+		UNITT_ASSERT(writer.add("fonts/5x7.fon", AssetPack::FontEntry, &cooked_font[0], Uint(cooked_font.size())));
+		UNITT_ASSERT(writer.add("empty.txt", AssetPack::RawEntry, 0, 0));
+		UNITT_ASSERT(!writer.add("text/../text/hello.txt", AssetPack::RawEntry, text.data(), Uint(text.size())));
+		UNITT_FAIL_NOT_EQUAL(4, writer.numberOfEntries());
+		UNITT_ASSERT(writer.close());
+	}
+
+	SharedAssetPack pack = new AssetPack();
+	UNITT_ASSERT(!pack->open("unit_test_data/xml_test.xml"));
+	UNITT_ASSERT(pack->open(filename));
+	UNITT_FAIL_NOT_EQUAL(4, pack->numberOfEntries());
+
+	AssetPack::EntryType type = AssetPack::RawEntry;
+	UNITT_ASSERT(pack->entryType("images/gradient.png", type));
+	UNITT_ASSERT(type == AssetPack::ImageEntry);
+	UNITT_ASSERT(!pack->entryType("images/missing.png", type));
+
+	UNITT_ASSERT(pack->fileType("images") == FileDirectory);
+	UNITT_ASSERT(pack->fileType("text/hello.txt") == FileRegular);
+	UNITT_ASSERT(pack->fileType("text/hello") == FileNotFound);
+	UNITT_FAIL_NOT_EQUAL(4 + 2, pack->getDirectoryContents("").size());
+
+	// entries are views of the mapping, aligned for direct uploads
+	FileData data;
+	UNITT_ASSERT(pack->read("text/hello.txt", data));
+	UNITT_ASSERT(data.isView());
+	UNITT_FAIL_NOT_EQUAL(text, std::string((Char const*) data.bytes(), data.size));
+	UNITT_FAIL_NOT_EQUAL(text, readStream(pack->openStream("text/hello.txt")));
+	UNITT_ASSERT(pack->read("empty.txt", data));
+	UNITT_FAIL_NOT_EQUAL(0, data.size);
+
+	UNITT_ASSERT(pack->read("images/gradient.png", data));
+	UNITT_FAIL_NOT_EQUAL(0, Uint(((Uint64) data.bytes()) % AssetPack::alignment));
+
+	AssetPack::CookedImage cooked;
+	UNITT_ASSERT(AssetPack::decodeImage(data, cooked));
+	UNITT_FAIL_NOT_EQUAL(AssetPack::ImageFlipped, cooked.flags);
+	UNITT_FAIL_NOT_EQUAL(5, cooked.image->getWidth());
+	UNITT_FAIL_NOT_EQUAL(3, cooked.image->getHeight());
+	UNITT_ASSERT(std::equal(image->getData(), image->getData() + 5 * 3 * 3, cooked.image->getData()));
+	UNITT_ASSERT(cooked.mipmaps);
+	UNITT_FAIL_NOT_EQUAL(3, cooked.mipmaps->numberOfLevels());
+	UNITT_FAIL_NOT_EQUAL(1, cooked.mipmaps->level(2)->getWidth());
+	UNITT_ASSERT(std::equal(mipmaps.level(1)->getData(), mipmaps.level(1)->getData() + 2 * 3, cooked.mipmaps->level(1)->getData()));
+
+	// referenced pixels point into the mapping and keep it alive
+	AssetPack::CookedImage referenced;
+	UNITT_ASSERT(AssetPack::decodeImage(data, referenced, true));
+	UNITT_ASSERT(referenced.image->getData() >= data.bytes());
+	UNITT_ASSERT(referenced.image->getData() < data.bytes() + data.size);
+	UNITT_ASSERT(std::equal(image->getData(), image->getData() + 5 * 3 * 3, referenced.image->getData()));
+	UNITT_ASSERT(std::equal(mipmaps.level(1)->getData(), mipmaps.level(1)->getData() + 2 * 3, referenced.mipmaps->level(1)->getData()));
+
+	// a truncated payload is rejected
+	FileData truncated = data;
+	truncated.size -= 1;
+	UNITT_ASSERT(!AssetPack::decodeImage(truncated, cooked));
+
+	// 65536 x 65536 x 1 wraps to 0 in 32 bits
+	std::vector<Uint8> wrapped(cooked_image);
+	wrapped[4] = 0; wrapped[5] = 0; wrapped[6] = 1; wrapped[7] = 0;
+	wrapped[8] = 0; wrapped[9] = 0; wrapped[10] = 1; wrapped[11] = 0;
+	wrapped[12] = 1;
+	wrapped[16] = 1;
+
+	FileData wrapped_data;
+	wrapped_data.view = &wrapped[0];
+	wrapped_data.size = Uint(wrapped.size());
+	UNITT_ASSERT(!AssetPack::decodeImage(wrapped_data, cooked));
+
+	UNITT_ASSERT(pack->read("fonts/5x7.fon", data));
+	UNITT_ASSERT(CookedFont::isCooked(data.bytes(), data.size));
+
+	Uint8 const* source = 0;
+	Uint source_size = 0;
+	UNITT_ASSERT(CookedFont::source(data.bytes(), data.size, source, source_size));
+	UNITT_ASSERT(source_size == font_source.size && std::equal(source, source + source_size, font_source.bytes()));
+
+	CookedFont cooked_font_loaded;
+	UNITT_ASSERT(cooked_font_loaded.load(data.bytes(), data.size));
+	UNITT_FAIL_NOT_EQUAL(font.name(), cooked_font_loaded.name());
+	UNITT_FAIL_NOT_EQUAL(font.glyphMap().size(), cooked_font_loaded.glyphMap().size());
+	UNITT_FAIL_NOT_EQUAL(font.referenceGlyph()->advance(), cooked_font_loaded.referenceGlyph()->advance());
+	UNITT_FAIL_NOT_EQUAL(font.texture()->getImage()->getWidth(), cooked_font_loaded.texture()->getImage()->getWidth());
+
+	// mounted over other sources
+	VirtualFileSystem vfs;
+	vfs.mount(pack, "cooked");
+	UNITT_ASSERT(vfs.fileType("cooked/images/gradient.png") == FileRegular);
+	std::string read_text;
+	UNITT_ASSERT(vfs.readText("cooked/text/hello.txt", read_text));
+	UNITT_FAIL_NOT_EQUAL(text, read_text);
+
+	vfs.unmountAll();
+	pack = 0;
+
+	// an entry count larger than the index is rejected before allocating
+	{
+		std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		Char const count[] = { Char(0xFF), Char(0xFF), Char(0xFF), Char(0x0F) };
+		file.seekp(8);
+		file.write(count, sizeof(count));
+	}
+	UNITT_ASSERT(!AssetPack().open(filename));
+
+	std::remove(filename.c_str());
+}
+
+UNITT_TEST_END_CLASS(UnitTestFileAssetPack)
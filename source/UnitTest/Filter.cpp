@@ -1,6 +1,8 @@
 #include "UnitTest/UnitTest.h"
 
 #include <rengine/image/Filter.h>
+#include <rengine/image/ImageResampler.h>
+#include <rengine/image/Mipmap.h>
 #include <rengine/string/String.h>
 #include <iostream>
 
@@ -62,3 +64,160 @@ UNITT_TEST_BEGIN_CLASS(UnitTestFilter)
 	}
 
 UNITT_TEST_END_CLASS(UnitTestFilter)
+
+//
+// UnitTestImageResampler
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestImageResampler)
+
+	virtual void run()
+	{
+		// constant images must stay constant for any filter and scale
+		Image constant(37, 21, 3);
+		for (Uint i = 0; i != constant.getWidth() * constant.getHeight(); ++i)
+		{
+			constant.rawPixel(i % constant.getWidth(), i / constant.getWidth())[0] = 200;
+			constant.rawPixel(i % constant.getWidth(), i / constant.getWidth())[1] = 100;
+			constant.rawPixel(i % constant.getWidth(), i / constant.getWidth())[2] = 7;
+		}
+
+		MitchellFilter mitchell;
+		LanczosFilter lanczos;
+		BoxFilter box;
+		Filter const* filters[] = { &mitchell, &lanczos, &box };
+
+		for (Uint f = 0; f != 3; ++f)
+		{
+			ImageResampler resampler(*filters[f]);
+
+			SharedPointer<Image> down = resampler.resample(constant, 16, 8);
+			UNITT_FAIL_NOT_EQUAL(16, Int(down->getWidth()));
+			UNITT_FAIL_NOT_EQUAL(8, Int(down->getHeight()));
+
+			SharedPointer<Image> up = resampler.resample(constant, 80, 50);
+			UNITT_FAIL_NOT_EQUAL(80, Int(up->getWidth()));
+			UNITT_FAIL_NOT_EQUAL(50, Int(up->getHeight()));
+
+			Bool down_constant = true;
+			for (Uint i = 0; i != down->getWidth() * down->getHeight(); ++i)
+			{
+				Uchar const* pixel = down->rawPixel(i % down->getWidth(), i / down->getWidth());
+				down_constant = down_constant && (pixel[0] == 200) && (pixel[1] == 100) && (pixel[2] == 7);
+			}
+			UNITT_ASSERT(down_constant);
+
+			Bool up_constant = true;
+			for (Uint i = 0; i != up->getWidth() * up->getHeight(); ++i)
+			{
+				Uchar const* pixel = up->rawPixel(i % up->getWidth(), i / up->getWidth());
+				up_constant = up_constant && (pixel[0] == 200) && (pixel[1] == 100) && (pixel[2] == 7);
+			}
+			UNITT_ASSERT(up_constant);
+		}
+
+		// box downscale by 2 averages 2x2 blocks
+		Image checker(4, 4, 1);
+		for (Uint y = 0; y != 4; ++y)
+		{
+			for (Uint x = 0; x != 4; ++x)
+			{
+				checker.rawPixel(x, y)[0] = ((x + y) % 2) ? 200 : 0;
+			}
+		}
+
+		checker.resize(2, 2, box);
+		UNITT_FAIL_NOT_EQUAL(2, Int(checker.getWidth()));
+		UNITT_FAIL_NOT_EQUAL(100, Int(checker.rawPixel(0, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(100, Int(checker.rawPixel(1, 1)[0]));
+
+		// contributions are normalized
+		ImageResampler::Contributions contributions;
+		contributions.build(lanczos, 100, 33, 8);
+		UNITT_FAIL_NOT_EQUAL(33, Int(contributions.size()));
+
+		Bool normalized = true;
+		for (Uint i = 0; i != contributions.size(); ++i)
+		{
+			Real sum = 0.0f;
+			for (Uint tap = 0; tap != contributions.count(i); ++tap)
+			{
+				sum += contributions.weights(i)[tap];
+			}
+			normalized = normalized && (absolute(sum - 1.0f) < 1e-4f);
+		}
+		UNITT_ASSERT(normalized);
+	}
+
+UNITT_TEST_END_CLASS(UnitTestImageResampler)
+
+//
+// UnitTestMipmapChain
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestMipmapChain)
+
+	virtual void run()
+	{
+		UNITT_FAIL_NOT_EQUAL(1, Int(MipmapChain::numberOfLevels(1, 1)));
+		UNITT_FAIL_NOT_EQUAL(3, Int(MipmapChain::numberOfLevels(5, 3)));
+		UNITT_FAIL_NOT_EQUAL(9, Int(MipmapChain::numberOfLevels(256, 16)));
+
+		BoxFilter box;
+
+		// sizes halve down to 1x1
+		SharedPointer<Image> base = new Image(5, 3, 4);
+		for (Uint i = 0; i != 5 * 3; ++i)
+		{
+			Uchar* pixel = base->rawPixel(i % 5, i / 5);
+			pixel[0] = 200;
+			pixel[1] = 100;
+			pixel[2] = 50;
+			pixel[3] = 77;
+		}
+
+		MipmapChain chain;
+		chain.build(base, box);
+		UNITT_FAIL_NOT_EQUAL(3, Int(chain.numberOfLevels()));
+		UNITT_ASSERT(chain.level(0).get() == base.get());
+		UNITT_FAIL_NOT_EQUAL(2, Int(chain.level(1)->getWidth()));
+		UNITT_FAIL_NOT_EQUAL(1, Int(chain.level(1)->getHeight()));
+		UNITT_FAIL_NOT_EQUAL(1, Int(chain.level(2)->getWidth()));
+		UNITT_FAIL_NOT_EQUAL(1, Int(chain.level(2)->getHeight()));
+
+		// constant colors survive the sRGB round trip
+		Uchar const* last = chain.level(2)->getData();
+		UNITT_FAIL_NOT_EQUAL(200, Int(last[0]));
+		UNITT_FAIL_NOT_EQUAL(100, Int(last[1]));
+		UNITT_FAIL_NOT_EQUAL(50, Int(last[2]));
+		UNITT_FAIL_NOT_EQUAL(77, Int(last[3]));
+
+		// black and white average to linear mid gray
+		SharedPointer<Image> checker = new Image(2, 2, 3);
+		for (Uint i = 0; i != 4; ++i)
+		{
+			Uchar const value = ((i % 2) == (i / 2)) ? 255 : 0;
+			checker->getData()[i * 3 + 0] = value;
+			checker->getData()[i * 3 + 1] = value;
+			checker->getData()[i * 3 + 2] = value;
+		}
+
+		chain.build(checker, box, true);
+		UNITT_FAIL_NOT_EQUAL(2, Int(chain.numberOfLevels()));
+		UNITT_ASSERT(absolute(Int(chain.level(1)->getData()[0]) - 188) <= 1);
+
+		chain.build(checker, box, false);
+		UNITT_ASSERT(absolute(Int(chain.level(1)->getData()[0]) - 128) <= 1);
+
+		// asynchronous build
+		MipmapBuilder builder(base);
+		builder.start();
+		while (!builder.finished())
+		{
+			Thread::microSleep(1000);
+		}
+		builder.stop();
+		UNITT_FAIL_NOT_EQUAL(3, Int(builder.chain()->numberOfLevels()));
+	}
+
+UNITT_TEST_END_CLASS(UnitTestMipmapChain)
@@ -0,0 +1,264 @@
+#include "UnitTest/UnitTest.h"
+
+#include <rengine/image/Image.h>
+#include <rengine/image/ImageView.h>
+#include <rengine/image/Colorspace.h>
+#include <rengine/image/processing/ImageProcessor.h>
+
+using namespace rengine;
+
+//
+// UnitTestImageView
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestImageView)
+
+	virtual void run()
+	{
+		// pixel value encodes its position
+		Image image(6, 4, 3);
+		for (Uint y = 0; y != image.getHeight(); ++y)
+		{
+			for (Uint x = 0; x != image.getWidth(); ++x)
+			{
+				image.rawPixel(x, y)[0] = Uchar(y * 10 + x);
+				image.rawPixel(x, y)[1] = 0;
+				image.rawPixel(x, y)[2] = 255;
+			}
+		}
+
+		// sub views share memory
+		ImageView region = image.view(2, 1, 3, 2);
+		UNITT_ASSERT(region.isValid());
+		UNITT_ASSERT(!region.isContiguous());
+		UNITT_FAIL_NOT_EQUAL(3, Int(region.getWidth()));
+		UNITT_FAIL_NOT_EQUAL(18, Int(region.getRowStride()));
+		UNITT_FAIL_NOT_EQUAL(12, Int(region.rawPixel(0, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(24, Int(region.rawPixel(2, 1)[0]));
+		UNITT_ASSERT(region.rawPixel(0, 0) == image.rawPixel(2, 1));
+
+		// clipped to the parent
+		ImageView clipped = image.view(4, 3, 10, 10);
+		UNITT_FAIL_NOT_EQUAL(2, Int(clipped.getWidth()));
+		UNITT_FAIL_NOT_EQUAL(1, Int(clipped.getHeight()));
+		UNITT_ASSERT(!image.view(6, 0, 1, 1).isValid());
+
+		// copy of a view
+		Image copy(region);
+		UNITT_FAIL_NOT_EQUAL(3, Int(copy.getWidth()));
+		UNITT_FAIL_NOT_EQUAL(2, Int(copy.getHeight()));
+		UNITT_FAIL_NOT_EQUAL(13, Int(copy.rawPixel(1, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(22, Int(copy.rawPixel(0, 1)[0]));
+
+		// in place flip of a region leaves the rest untouched
+		region.flip(ImageView::FlipHorizontal);
+		UNITT_FAIL_NOT_EQUAL(14, Int(image.rawPixel(2, 1)[0]));
+		UNITT_FAIL_NOT_EQUAL(12, Int(image.rawPixel(4, 1)[0]));
+		UNITT_FAIL_NOT_EQUAL(11, Int(image.rawPixel(1, 1)[0]));
+		UNITT_FAIL_NOT_EQUAL(15, Int(image.rawPixel(5, 1)[0]));
+		region.flip(ImageView::FlipHorizontal);
+
+		region.flip(ImageView::FlipVertical);
+		UNITT_FAIL_NOT_EQUAL(22, Int(image.rawPixel(2, 1)[0]));
+		UNITT_FAIL_NOT_EQUAL(12, Int(image.rawPixel(2, 2)[0]));
+		UNITT_FAIL_NOT_EQUAL(32, Int(image.rawPixel(2, 3)[0]));
+		region.flip(ImageView::FlipVertical);
+
+		// conversion on a region
+		convertBGR8_RGB8(region, region);
+		UNITT_FAIL_NOT_EQUAL(255, Int(image.rawPixel(2, 1)[0]));
+		UNITT_FAIL_NOT_EQUAL(12, Int(image.rawPixel(2, 1)[2]));
+		UNITT_FAIL_NOT_EQUAL(1, Int(image.rawPixel(1, 0)[0]));
+		convertBGR8_RGB8(region, region);
+
+		// crop honors the origin
+		image.crop(1, 2, 4, 2);
+		UNITT_FAIL_NOT_EQUAL(4, Int(image.getWidth()));
+		UNITT_FAIL_NOT_EQUAL(2, Int(image.getHeight()));
+		UNITT_FAIL_NOT_EQUAL(21, Int(image.rawPixel(0, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(34, Int(image.rawPixel(3, 1)[0]));
+
+		// channel expansion and color key
+		Image rgba(2, 1, 4);
+		image.view(0, 0, 2, 1).copyTo(rgba.view());
+		UNITT_FAIL_NOT_EQUAL(21, Int(rgba.rawPixel(0, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(255, Int(rgba.rawPixel(0, 0)[3]));
+
+		rgba.applyColorKey(Image::Color(22, 0, 255, 0));
+		UNITT_FAIL_NOT_EQUAL(255, Int(rgba.rawPixel(0, 0)[3]));
+		UNITT_FAIL_NOT_EQUAL(0, Int(rgba.rawPixel(1, 0)[3]));
+	}
+
+UNITT_TEST_END_CLASS(UnitTestImageView)
+
+//
+// UnitTestImageProcessorCpu
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestImageProcessorCpu)
+
+	virtual void run()
+	{
+		// larger than a tile so regions are spread over threads
+		Image image(300, 100, 4);
+		for (Uint y = 0; y != image.getHeight(); ++y)
+		{
+			for (Uint x = 0; x != image.getWidth(); ++x)
+			{
+				Uchar* pixel = image.rawPixel(x, y);
+				pixel[0] = (x < 150) ? 40 : 200;
+				pixel[1] = (x < 150) ? 40 : 200;
+				pixel[2] = (x < 150) ? 40 : 200;
+				pixel[3] = 128;
+			}
+		}
+
+		ProcessingChain chain;
+		chain.setNumberOfThreads(3);
+		chain.addProcessingStage(new GrayscaleImageProcessor());
+		chain.addProcessingStage(new BinarizationImageProcessor(0.5f));
+
+		SharedPointer<Image> binary = chain.process(image);
+		UNITT_ASSERT(binary);
+		UNITT_FAIL_NOT_EQUAL(0, Int(binary->rawPixel(10, 10)[0]));
+		UNITT_FAIL_NOT_EQUAL(255, Int(binary->rawPixel(299, 99)[1]));
+		UNITT_FAIL_NOT_EQUAL(255, Int(binary->rawPixel(149, 50)[3]));
+
+		// box kernel keeps a constant image
+		SharedPointer<Kernel> box = new Kernel2D(3);
+		for (Uint i = 0; i != box->dataSize(); ++i)
+		{
+			box->data()[i] = 1.0f;
+		}
+
+		Image constant(200, 70, 3);
+		constant.view().fill(90);
+
+		ProcessingChain blur;
+		blur.addProcessingStage(new KernelImageProcessor(box));
+		SharedPointer<Image> blurred = blur.process(constant);
+		UNITT_FAIL_NOT_EQUAL(90, Int(blurred->rawPixel(0, 0)[0]));
+		UNITT_FAIL_NOT_EQUAL(90, Int(blurred->rawPixel(128, 64)[2]));
+		UNITT_FAIL_NOT_EQUAL(90, Int(blurred->rawPixel(199, 69)[1]));
+
+		// sobel responds on the edge only
+		SharedPointer<Kernel> sobel = new Kernel1D(3);
+		sobel->data()[0] = -1.0f;
+		sobel->data()[1] = 0.0f;
+		sobel->data()[2] = 1.0f;
+
+		ProcessingChain edges;
+		edges.addProcessingStage(new SeparableKernelImageProcessor(sobel, sobel));
+		SharedPointer<Image> gradient = edges.process(image);
+		UNITT_FAIL_NOT_EQUAL(0, Int(gradient->rawPixel(10, 10)[0]));
+		UNITT_FAIL_NOT_EQUAL(0, Int(gradient->rawPixel(200, 90)[0]));
+		UNITT_FAIL_NOT_EQUAL(160, Int(gradient->rawPixel(149, 50)[0]));
+		UNITT_FAIL_NOT_EQUAL(255, Int(gradient->rawPixel(149, 50)[3]));
+
+		// channel conversion before the stages
+		Image gray(300, 100, 1);
+		chain.process(image.view(), gray.view());
+		UNITT_FAIL_NOT_EQUAL(255, Int(gray.rawPixel(160, 0)[0]));
+	}
+
+UNITT_TEST_END_CLASS(UnitTestImageProcessorCpu)
+
+//
+// UnitTestImageProcessorFusion
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestImageProcessorFusion)
+
+	virtual void run()
+	{
+		SharedPointer<ImageProcessor> grayscale = new GrayscaleImageProcessor();
+		SharedPointer<ThresholdImageProcessor> threshold = new ThresholdImageProcessor(0.25f);
+		SharedPointer<ImageProcessor> binarization = new BinarizationImageProcessor(0.5f);
+		SharedPointer<Kernel> box = new Kernel2D(3);
+
+		UNITT_ASSERT(grayscale->isPointOperation());
+		UNITT_ASSERT(binarization->isPointOperation());
+		UNITT_ASSERT(!KernelImageProcessor(box).isPointOperation());
+
+		ProcessingChain::ProcessingStages stages;
+		stages.push_back(grayscale);
+		stages.push_back(threshold);
+		stages.push_back(binarization);
+
+		FusedImageProcessor fused(stages);
+		std::string const operations = fused.pointOperation();
+		UNITT_ASSERT(operations.find("luminance") != std::string::npos);
+		UNITT_ASSERT(operations.find("stage1_threshold_value") != std::string::npos);
+		UNITT_ASSERT(operations.find("stage2_threshold") != std::string::npos);
+		UNITT_ASSERT(operations.find("0.25") == std::string::npos);
+
+		Program::Uniforms uniforms;
+		fused.pointOperationUniforms(uniforms);
+		UNITT_FAIL_NOT_EQUAL(3, Uint(uniforms.size()));
+		UNITT_FAIL_NOT_EQUAL("stage1_threshold", uniforms[0]->name());
+		UNITT_FAIL_NOT_EQUAL(0.25f, *((Real*) uniforms[0]->data()));
+		UNITT_FAIL_NOT_EQUAL("stage2_threshold", uniforms[2]->name());
+
+		// fused stages give the same result as the chain
+		Image image(130, 70, 3);
+		for (Uint y = 0; y != image.getHeight(); ++y)
+		{
+			for (Uint x = 0; x != image.getWidth(); ++x)
+			{
+				image.rawPixel(x, y)[0] = Uchar(x * 2);
+				image.rawPixel(x, y)[1] = Uchar(y * 3);
+				image.rawPixel(x, y)[2] = Uchar(x + y);
+			}
+		}
+
+		ProcessingChain chain;
+		chain.addProcessingStage(grayscale);
+		chain.addProcessingStage(threshold);
+		chain.addProcessingStage(binarization);
+		SharedPointer<Image> expected = chain.process(image);
+
+		Image result(image.getWidth(), image.getHeight(), image.getColorChannels());
+		fused.process(image.view(), result.view(), 2);
+
+		Bool same = true;
+		for (Uint y = 0; y != image.getHeight(); ++y)
+		{
+			for (Uint x = 0; x != image.getWidth(); ++x)
+			{
+				for (Uint channel = 0; channel != 3; ++channel)
+				{
+					same &= (expected->rawPixel(x, y)[channel] == result.rawPixel(x, y)[channel]);
+				}
+			}
+		}
+		UNITT_ASSERT(same);
+
+		// parameters changed after fusion reach the fused uniforms and output
+		threshold->setThreshold(0.75f);
+		threshold->setThresholdValue(Vector4D(1.0f, 0.0f, 0.0f, 1.0f));
+
+		uniforms.clear();
+		fused.pointOperationUniforms(uniforms);
+		UNITT_FAIL_NOT_EQUAL(0.75f, *((Real*) uniforms[0]->data()));
+		UNITT_FAIL_NOT_EQUAL(1.0f, ((Vector4D*) uniforms[1]->data())->x());
+
+		expected = chain.process(image);
+		fused.process(image.view(), result.view(), 2);
+
+		same = true;
+		for (Uint y = 0; y != image.getHeight(); ++y)
+		{
+			for (Uint x = 0; x != image.getWidth(); ++x)
+			{
+				for (Uint channel = 0; channel != 3; ++channel)
+				{
+					same &= (expected->rawPixel(x, y)[channel] == result.rawPixel(x, y)[channel]);
+				}
+			}
+		}
+		UNITT_ASSERT(same);
+		// dark pixels are now set to the red threshold value, binarized to white
+		UNITT_FAIL_NOT_EQUAL(255, Int(result.rawPixel(0, 0)[0]));
+	}
+
+UNITT_TEST_END_CLASS(UnitTestImageProcessorFusion)
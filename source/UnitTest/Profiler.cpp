@@ -0,0 +1,251 @@
+#include "UnitTest/UnitTest.h"
+
+#include <rengine/time/Profiler.h>
+#include <rengine/time/FrameProfiler.h>
+#include <rengine/thread/Thread.h>
+#include <rengine/string/String.h>
+
+#include <sstream>
+
+using namespace rengine;
+
+//
+// UnitTestProfiler
+//
+
+class ProfiledThread : public Thread
+{
+public:
+	ProfiledThread(std::string const& name, Uint const scopes)
+		:name_(name), scopes_(scopes)
+	{
+	}
+
+	virtual void run()
+	{
+		RENGINE_PROFILE_THREAD(name_);
+
+		for (Uint i = 0; i != scopes_; ++i)
+		{
+			RENGINE_PROFILE_SCOPE("profiled thread scope");
+			{
+				RENGINE_PROFILE_SCOPE("profiled thread \"inner\" scope");
+			}
+		}
+	}
+private:
+	std::string name_;
+	Uint scopes_;
+};
+
+static Profiler::ThreadTraces::const_iterator findTrace(Profiler::ThreadTraces const& traces, std::string const& name)
+{
+	for (Profiler::ThreadTraces::const_iterator i = traces.begin(); i != traces.end(); ++i)
+	{
+		if (i->second.name == name)
+		{
+			return i;
+		}
+	}
+	return traces.end();
+}
+
+UNITT_TEST_BEGIN_CLASS(UnitTestProfiler)
+
+	virtual void run()
+	{
+		Profiler& profiler = Profiler::instance();
+		Uint const buffer_size = profiler.bufferSize();
+
+		UNITT_FAIL_NOT_EQUAL(profiler.intern("unit test scope"), profiler.intern("unit test scope"));
+		UNITT_ASSERT(profiler.intern("unit test scope") != profiler.intern("another unit test scope"));
+		UNITT_FAIL_NOT_EQUAL("unit test scope", profiler.scopeName(profiler.intern("unit test scope")));
+
+		profiler.collect();
+		profiler.clear();
+
+		// disabled, nothing is recorded
+		profiler.setEnabled(false);
+		{
+			RENGINE_PROFILE_SCOPE("unit test disabled scope");
+		}
+		profiler.collect();
+
+		Profiler::ThreadTraces traces = profiler.traces();
+		for (Profiler::ThreadTraces::const_iterator i = traces.begin(); i != traces.end(); ++i)
+		{
+			UNITT_ASSERT(i->second.events.empty());
+		}
+
+		profiler.setEnabled(true);
+		profiler.setBufferSize(1024);
+
+		Profiler::Nanoseconds const begin_time = Profiler::now();
+		{
+			ProfiledThread first("profiled thread 0", 10);
+			ProfiledThread second("profiled thread 1", 10);
+			first.start();
+			second.start();
+			first.stop();
+			second.stop();
+		}
+		profiler.collect();
+
+		traces = profiler.traces();
+		for (Uint i = 0; i != 2; ++i)
+		{
+			Profiler::ThreadTraces::const_iterator trace = findTrace(traces, "profiled thread " + lexical_cast<std::string>(i));
+			UNITT_ASSERT(trace != traces.end());
+			if (trace == traces.end())
+			{
+				continue;
+			}
+
+			UNITT_FAIL_NOT_EQUAL(40, Uint(trace->second.events.size()));
+			UNITT_FAIL_NOT_EQUAL(0, Uint(trace->second.dropped));
+
+			for (Uint event = 0; event + 1 < trace->second.events.size(); ++event)
+			{
+				UNITT_ASSERT(trace->second.events[event].time >= begin_time);
+				UNITT_ASSERT(trace->second.events[event].time <= trace->second.events[event + 1].time);
+			}
+
+			UNITT_FAIL_NOT_EQUAL(Uint(Profiler::Begin), trace->second.events.front().type);
+			UNITT_FAIL_NOT_EQUAL(Uint(Profiler::End), trace->second.events.back().type);
+		}
+
+		std::stringstream json;
+		profiler.exportChromeTrace(json);
+		UNITT_ASSERT(json.str().find("\"traceEvents\"") != std::string::npos);
+		UNITT_ASSERT(json.str().find("\"profiled thread 1\"") != std::string::npos);
+		UNITT_ASSERT(json.str().find("\"profiled thread scope\"") != std::string::npos);
+		UNITT_ASSERT(json.str().find("\"profiled thread \\\"inner\\\" scope\"") != std::string::npos);
+
+		// a full ring keeps the newest events
+		profiler.clear();
+		profiler.setBufferSize(8);
+		{
+			ProfiledThread overflow("profiled overflow thread", 10);
+			overflow.start();
+			overflow.stop();
+		}
+		profiler.collect();
+
+		traces = profiler.traces();
+		Profiler::ThreadTraces::const_iterator trace = findTrace(traces, "profiled overflow thread");
+		UNITT_ASSERT(trace != traces.end());
+		if (trace != traces.end())
+		{
+			UNITT_FAIL_NOT_EQUAL(8, Uint(trace->second.events.size()));
+			UNITT_FAIL_NOT_EQUAL(32, Uint(trace->second.dropped));
+			UNITT_FAIL_NOT_EQUAL(Uint(Profiler::End), trace->second.events.back().type);
+		}
+
+		// a full trace keeps the newest events
+		Uint const trace_size = profiler.traceSize();
+		profiler.clear();
+		profiler.setBufferSize(1024);
+		profiler.setTraceSize(16);
+		{
+			ProfiledThread capped("profiled capped thread", 10);
+			capped.start();
+			capped.stop();
+		}
+		profiler.collect();
+
+		traces = profiler.traces();
+		trace = findTrace(traces, "profiled capped thread");
+		UNITT_ASSERT(trace != traces.end());
+		if (trace != traces.end())
+		{
+			UNITT_FAIL_NOT_EQUAL(16, Uint(trace->second.events.size()));
+			UNITT_FAIL_NOT_EQUAL(24, Uint(trace->second.dropped));
+			UNITT_FAIL_NOT_EQUAL(Uint(Profiler::End), trace->second.events.back().type);
+		}
+
+		profiler.setEnabled(false);
+		profiler.setBufferSize(buffer_size);
+		profiler.setTraceSize(trace_size);
+		profiler.clear();
+	}
+
+UNITT_TEST_END_CLASS(UnitTestProfiler)
+
+//
+// UnitTestFrameProfiler
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestFrameProfiler)
+
+	virtual void run()
+	{
+		FrameProfiler frame_profiler(100);
+
+		FrameProfiler::SectionId const outer = frame_profiler.section("outer");
+		FrameProfiler::SectionId const inner = frame_profiler.section("inner");
+		FrameProfiler::SectionId const recorded = frame_profiler.section("recorded");
+
+		UNITT_FAIL_NOT_EQUAL(outer, frame_profiler.section("outer"));
+		UNITT_FAIL_NOT_EQUAL(4, frame_profiler.numberOfSections());
+		UNITT_FAIL_NOT_EQUAL("frame", frame_profiler.sectionName(FrameProfiler::FrameSection));
+
+		frame_profiler.beginFrame();
+		{
+			FrameProfiler::ScopedSection outer_section(frame_profiler, outer);
+			FrameProfiler::ScopedSection inner_section(frame_profiler, inner);
+			frame_profiler.record(recorded, 1.0);
+		}
+		frame_profiler.endFrame();
+
+		// recorded time nests in the open sections
+		UNITT_FAIL_NOT_EQUAL(3, frame_profiler.sectionDepth(recorded));
+
+		UNITT_FAIL_NOT_EQUAL(0, frame_profiler.sectionDepth(FrameProfiler::FrameSection));
+		UNITT_FAIL_NOT_EQUAL(1, frame_profiler.sectionDepth(outer));
+		UNITT_FAIL_NOT_EQUAL(2, frame_profiler.sectionDepth(inner));
+		UNITT_FAIL_NOT_EQUAL(1, frame_profiler.statistics(inner).samples);
+		UNITT_ASSERT(frame_profiler.statistics(FrameProfiler::FrameSection).maximum >= frame_profiler.statistics(inner).maximum);
+
+		frame_profiler.clear();
+
+		// a frame without the section adds no sample
+		frame_profiler.beginFrame();
+		frame_profiler.endFrame();
+		UNITT_FAIL_NOT_EQUAL(0, frame_profiler.statistics(recorded).samples);
+
+		for (Uint i = 1; i <= 100; ++i)
+		{
+			frame_profiler.beginFrame();
+			frame_profiler.record(recorded, Real64(i) * 0.5);
+			frame_profiler.record(recorded, Real64(i) * 0.5);
+			frame_profiler.endFrame();
+		}
+
+		FrameProfiler::Statistics statistics = frame_profiler.statistics(recorded);
+		UNITT_FAIL_NOT_EQUAL(100, statistics.samples);
+		UNITT_FAIL_NOT_EQUAL(1.0, statistics.minimum);
+		UNITT_FAIL_NOT_EQUAL(50.5, statistics.average);
+		UNITT_FAIL_NOT_EQUAL(95.0, statistics.percentile_95);
+		UNITT_FAIL_NOT_EQUAL(99.0, statistics.percentile_99);
+		UNITT_FAIL_NOT_EQUAL(100.0, statistics.maximum);
+
+		// the window rolls over the oldest frames
+		for (Uint i = 0; i != 10; ++i)
+		{
+			frame_profiler.beginFrame();
+			frame_profiler.record(recorded, 200.0);
+			frame_profiler.endFrame();
+		}
+
+		FrameProfiler::Samples const samples = frame_profiler.samples(recorded);
+		UNITT_FAIL_NOT_EQUAL(100, Uint(samples.size()));
+		UNITT_FAIL_NOT_EQUAL(11.0, samples.front());
+		UNITT_FAIL_NOT_EQUAL(200.0, samples.back());
+
+		statistics = frame_profiler.statistics(recorded);
+		UNITT_FAIL_NOT_EQUAL(11.0, statistics.minimum);
+		UNITT_FAIL_NOT_EQUAL(200.0, statistics.percentile_95);
+		UNITT_FAIL_NOT_EQUAL(200.0, statistics.maximum);
+	}
+
+UNITT_TEST_END_CLASS(UnitTestFrameProfiler)
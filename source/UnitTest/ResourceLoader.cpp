@@ -1,8 +1,15 @@
 #include "UnitTest/UnitTest.h"
 
 #include <rengine/resource/ResourceLoader.h>
+#include <rengine/resource/ResourceManager.h>
+#include <rengine/resource/ResourceBatch.h>
 #include <rengine/string/String.h>
 #include <rengine/file/File.h>
+#include <rengine/file/FileWatcher.h>
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/thread/Thread.h>
+
+#include <cstdio>
 
 using namespace rengine;
 
@@ -139,3 +146,493 @@ UNITT_TEST_BEGIN_CLASS(UnitTestResourceLoader)
 	}
 
 UNITT_TEST_END_CLASS(UnitTestResourceLoader)
+
+
+//
+// UnitTestResourceLoaderAsync
+//
+
+class FinalizedIntResouceLoader : public IntResouceLoader
+{
+public:
+	FinalizedIntResouceLoader()
+		:finalized(0)
+	{
+	}
+
+	virtual void finalize(int& resource)
+	{
+		resource *= 10;
+		++finalized;
+	}
+
+	Uint finalized;
+};
+
+class IntLoadHandler : public ResourceLoadHandler<int>
+{
+public:
+	IntLoadHandler()
+		:calls(0), failures(0), sum(0)
+	{
+	}
+
+	virtual void operator()(std::string const& location, SharedPointer<int> const& resource)
+	{
+		++calls;
+
+		if (resource)
+		{
+			sum += *resource;
+		}
+		else
+		{
+			++failures;
+		}
+	}
+
+	Uint calls;
+	Uint failures;
+	Int sum;
+};
+
+UNITT_TEST_BEGIN_CLASS(UnitTestResourceLoaderAsync)
+
+	virtual void run()
+	{
+		FinalizedIntResouceLoader* loader = new FinalizedIntResouceLoader();
+
+		ResourceManager manager;
+		manager.addLoader(loader);
+		manager.loadQueue().setNumberOfWorkers(2);
+
+		IntLoadHandler handler;
+
+		SharedPointer< AsyncResource<int> > one = manager.loadAsync<int>("path/one.int", 0, &handler);
+		SharedPointer< AsyncResource<int> > two = manager.loadAsync<int>("path/two.int", 5, &handler);
+		SharedPointer< AsyncResource<int> > invalid = manager.loadAsync<int>("path/invalid.int", 0, &handler);
+		SharedPointer< AsyncResource<int> > unsupported = manager.loadAsync<int>("path/one.txt", 0, &handler);
+		UNITT_FAIL_NOT_EQUAL(2, manager.loadQueue().numberOfWorkers());
+
+		manager.loadQueue().flush();
+		UNITT_FAIL_NOT_EQUAL(0, manager.loadQueue().numberOfPendingRequests());
+
+		UNITT_ASSERT(one->state() == ResourceRequest::Loaded);
+		UNITT_ASSERT(two->state() == ResourceRequest::Loaded);
+		UNITT_ASSERT(invalid->state() == ResourceRequest::Failed);
+		UNITT_ASSERT(unsupported->state() == ResourceRequest::Failed);
+		UNITT_ASSERT(one->done() && invalid->done());
+
+		UNITT_FAIL_NOT_EQUAL(10, *one->resource());
+		UNITT_FAIL_NOT_EQUAL(20, *two->resource());
+		UNITT_ASSERT(!invalid->resource());
+
+		UNITT_FAIL_NOT_EQUAL(2, loader->finalized);
+		UNITT_FAIL_NOT_EQUAL(4, handler.calls);
+		UNITT_FAIL_NOT_EQUAL(2, handler.failures);
+		UNITT_FAIL_NOT_EQUAL(30, handler.sum);
+
+		// asynchronous loads share the cache
+		UNITT_ASSERT(manager.load<int>("path/one.int") == one->resource());
+		UNITT_FAIL_NOT_EQUAL(2, loader->getCacheItem("path/one.int").request_count);
+
+		// a cancelled request never notifies
+		SharedPointer< AsyncResource<int> > cancelled = manager.loadAsync<int>("path/three.int", 0, &handler);
+		cancelled->cancel();
+		manager.loadQueue().flush();
+		UNITT_ASSERT(cancelled->state() == ResourceRequest::Cancelled);
+		UNITT_ASSERT(!cancelled->resource());
+		UNITT_FAIL_NOT_EQUAL(4, handler.calls);
+
+		// the budget still finalizes one request per call
+		SharedPointer< AsyncResource<int> > four = manager.loadAsync<int>("path/four.int", 0, &handler);
+		while (four->state() != ResourceRequest::Finalizing)
+		{
+			Thread::microSleep(100);
+		}
+		UNITT_FAIL_NOT_EQUAL(1, manager.loadQueue().finalize(0.0));
+		UNITT_FAIL_NOT_EQUAL(40, *four->resource());
+		UNITT_FAIL_NOT_EQUAL(5, handler.calls);
+
+		manager.clearLoaders();
+		UNITT_FAIL_NOT_EQUAL(0, manager.loadQueue().numberOfPendingRequests());
+	}
+
+UNITT_TEST_END_CLASS(UnitTestResourceLoaderAsync)
+
+
+//
+// UnitTestResourceManagerDispatch
+//
+
+class IntegerResouceLoader : public IntResouceLoader
+{
+public:
+	virtual bool suportsFormat(std::string const& extension) const
+	{
+		return (extension == "integer");
+	}
+};
+
+UNITT_TEST_BEGIN_CLASS(UnitTestResourceManagerDispatch)
+
+	virtual void run()
+	{
+		IntResouceLoader* int_loader = new IntResouceLoader();
+		IntegerResouceLoader* integer_loader = new IntegerResouceLoader();
+
+		ResourceManager manager;
+		manager.addLoader(int_loader);
+		manager.addLoader(integer_loader);
+
+		UNITT_ASSERT(manager.suportsFormat<int>("int"));
+		UNITT_ASSERT(manager.suportsFormat<int>("integer"));
+		UNITT_ASSERT(!manager.suportsFormat<int>("txt"));
+		UNITT_ASSERT(!manager.suportsFormat<float>("int"));
+		UNITT_ASSERT(!manager.load<float>("path/one.int"));
+
+		SharedPointer<int> one = manager.load<int>("path/one.int");
+		SharedPointer<int> two = manager.load<int>("path/two.integer");
+		UNITT_ASSERT(one && two);
+		UNITT_FAIL_NOT_EQUAL(1, int_loader->numberOfCachedResources());
+		UNITT_FAIL_NOT_EQUAL(1, integer_loader->numberOfCachedResources());
+
+		// cached resources come from the loader that loaded them
+		UNITT_ASSERT(manager.load<int>("path/two.integer") == two);
+		UNITT_ASSERT(manager.load<int>("path/one.int") == one);
+		UNITT_FAIL_NOT_EQUAL(2, int_loader->getCacheItem("path/one.int").request_count);
+		UNITT_FAIL_NOT_EQUAL(2, integer_loader->getCacheItem("path/two.integer").request_count);
+
+		UNITT_ASSERT(!manager.load<int>("path/invalid.int"));
+		UNITT_ASSERT(!manager.load<int>("path/one.txt"));
+
+		UNITT_ASSERT(manager.resourceLocation<int>(one.get()) == "path/one.int");
+		UNITT_ASSERT(manager.resourceLocation<int>(two.get()) == "path/two.integer");
+		UNITT_ASSERT(integer_loader->getCacheItem(two.get()).location == "path/two.integer");
+
+		int unknown = 0;
+		UNITT_ASSERT(manager.resourceLocation<int>(&unknown).empty());
+		UNITT_ASSERT(!integer_loader->getCacheItem(&unknown).resource);
+		UNITT_ASSERT(!integer_loader->getCacheItem("path/unknown.integer").resource);
+
+		// the reverse index follows the cache
+		manager.clearCachedResources();
+		UNITT_ASSERT(!int_loader->isResourceCached(one.get()));
+		UNITT_ASSERT(manager.resourceLocation<int>(one.get()).empty());
+
+		SharedPointer<int> reloaded = manager.load<int>("path/one.int");
+		UNITT_ASSERT(reloaded && (reloaded != one));
+		UNITT_ASSERT(manager.resourceLocation<int>(reloaded.get()) == "path/one.int");
+	}
+
+UNITT_TEST_END_CLASS(UnitTestResourceManagerDispatch)
+
+
+//
+// UnitTestResourceManagerMemoryBudget
+//
+
+// every int takes one megabyte
+class SizedIntResouceLoader : public IntResouceLoader
+{
+public:
+	virtual Uint64 resourceSize(int const& resource) const
+	{
+		return 1024 * 1024;
+	}
+};
+
+UNITT_TEST_BEGIN_CLASS(UnitTestResourceManagerMemoryBudget)
+
+	virtual void run()
+	{
+		SizedIntResouceLoader* loader = new SizedIntResouceLoader();
+
+		ResourceManager manager;
+		manager.addLoader(loader);
+
+		manager.load<int>("path/one.int");
+		manager.load<int>("path/two.int");
+		SharedPointer<int> three = manager.load<int>("path/three.int");
+		manager.load<int>("path/four.int");
+		UNITT_FAIL_NOT_EQUAL(4 * 1024 * 1024, manager.cachedBytes());
+
+		// without a budget nothing is evicted
+		UNITT_FAIL_NOT_EQUAL(0, manager.enforceMemoryBudget());
+		UNITT_FAIL_NOT_EQUAL(4, loader->numberOfCachedResources());
+
+		// one is the least recently used after this
+		manager.load<int>("path/two.int");
+		manager.load<int>("path/four.int");
+
+		manager.setMemoryBudget(3.0f);
+		UNITT_FAIL_NOT_EQUAL(1024 * 1024, manager.enforceMemoryBudget());
+		UNITT_ASSERT(!loader->isResourceCached("path/one.int"));
+		UNITT_FAIL_NOT_EQUAL(3 * 1024 * 1024, loader->cachedBytes());
+
+		// three is referenced outside the cache, two goes instead
+		manager.setMemoryBudget(2.0f);
+		UNITT_FAIL_NOT_EQUAL(1024 * 1024, manager.enforceMemoryBudget());
+		UNITT_ASSERT(!loader->isResourceCached("path/two.int"));
+		UNITT_ASSERT(loader->isResourceCached("path/three.int"));
+		UNITT_ASSERT(loader->isResourceCached("path/four.int"));
+
+		// the type budget applies on its own
+		manager.setMemoryBudget(0.0f);
+		manager.setMemoryBudget<int>(0.5f);
+		UNITT_FAIL_NOT_EQUAL(1024 * 1024, manager.enforceMemoryBudget());
+		UNITT_FAIL_NOT_EQUAL(1, loader->numberOfCachedResources());
+		UNITT_ASSERT(manager.resourceLocation<int>(three.get()) == "path/three.int");
+
+		// nothing left that can be evicted
+		UNITT_FAIL_NOT_EQUAL(0, manager.enforceMemoryBudget());
+
+		three = 0;
+		UNITT_FAIL_NOT_EQUAL(1024 * 1024, manager.enforceMemoryBudget());
+		UNITT_FAIL_NOT_EQUAL(0, manager.cachedBytes());
+
+		// an evicted resource is loaded again
+		UNITT_FAIL_NOT_EQUAL(1, *manager.load<int>("path/one.int"));
+		UNITT_FAIL_NOT_EQUAL(1024 * 1024, manager.cachedBytes());
+	}
+
+UNITT_TEST_END_CLASS(UnitTestResourceManagerMemoryBudget)
+
+
+//
+// UnitTestResourceBatch
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestResourceBatch)
+
+	virtual void run()
+	{
+		std::string const filename = "resource_batch_manifest.xml";
+
+		ResourceManifest manifest;
+		manifest.add(ResourceManifest::Entry("int", "path/one.int"));
+		manifest.add(ResourceManifest::Entry("int", "path/two.int", 2));
+		manifest.add(ResourceManifest::Entry("int", "path/three.int"));
+		manifest.add(ResourceManifest::Entry("int", "path/invalid.int"));
+		manifest.add(ResourceManifest::Entry("int", "path/four.int"));
+
+		// three needs one and two, four needs the invalid one
+		ResourceManifest::Entry three("int", "path/three.int");
+		three.dependencies.push_back("path/one.int");
+		three.dependencies.push_back("path/two.int");
+		manifest.add(three);
+
+		ResourceManifest::Entry four("int", "path/four.int");
+		four.dependencies.push_back("path/invalid.int");
+		manifest.add(four);
+
+		UNITT_ASSERT(manifest.save(filename));
+
+		ResourceManifest loaded;
+		UNITT_ASSERT(loaded.load(filename));
+		std::remove(filename.c_str());
+		UNITT_FAIL_NOT_EQUAL(manifest.entries().size(), loaded.entries().size());
+		UNITT_ASSERT(loaded.entries()[1].location == "path/two.int");
+		UNITT_FAIL_NOT_EQUAL(2, loaded.entries()[1].priority);
+		UNITT_FAIL_NOT_EQUAL(2, loaded.entries()[5].dependencies.size());
+		UNITT_ASSERT(!loaded.load("missing_manifest.xml"));
+
+		FinalizedIntResouceLoader* loader = new FinalizedIntResouceLoader();
+		ResourceManager manager;
+		manager.addLoader(loader);
+		manager.loadQueue().setNumberOfWorkers(2);
+
+		{
+			ResourceBatch batch(manager);
+			UNITT_ASSERT(!batch.add(loaded));
+			batch.registerType<int>("int");
+			UNITT_ASSERT(batch.add(loaded));
+
+			// a second scene sharing one
+			UNITT_ASSERT(batch.add("int", "path/one.int"));
+			UNITT_FAIL_NOT_EQUAL(5, batch.numberOfResources());
+			UNITT_ASSERT(batch.progress() == 0.0f);
+
+			UNITT_ASSERT(batch.start());
+			UNITT_ASSERT(!batch.add("int", "path/late.int"));
+			batch.wait();
+
+			UNITT_ASSERT(batch.done());
+			UNITT_ASSERT(batch.progress() == 1.0f);
+			UNITT_FAIL_NOT_EQUAL(3, batch.numberOfLoaded());
+			UNITT_FAIL_NOT_EQUAL(2, batch.numberOfFailed());
+			UNITT_ASSERT(batch.state("int", "path/three.int") == ResourceBatch::Loaded);
+			UNITT_ASSERT(batch.state("int", "path/four.int") == ResourceBatch::Failed);
+			UNITT_FAIL_NOT_EQUAL(2, batch.failures().size());
+
+			// shared dependencies are loaded once
+			UNITT_FAIL_NOT_EQUAL(3, loader->finalized);
+			UNITT_FAIL_NOT_EQUAL(1, loader->getCacheItem("path/one.int").request_count);
+			UNITT_FAIL_NOT_EQUAL(10, *manager.load<int>("path/one.int"));
+		}
+
+		// circular and missing dependencies fail without blocking the others
+		{
+			ResourceBatch batch(manager);
+			batch.registerType<int>("int");
+
+			ResourceBatch::Dependencies needs_two(1, "path/two.int");
+			ResourceBatch::Dependencies needs_three(1, "path/three.int");
+			ResourceBatch::Dependencies needs_missing(1, "path/missing.int");
+
+			batch.add("int", "path/two.int", 0, needs_three);
+			batch.add("int", "path/three.int", 0, needs_two);
+			batch.add("int", "path/four.int", 0, needs_missing);
+			batch.add("int", "path/one.int");
+
+			UNITT_ASSERT(!batch.start());
+			batch.wait();
+
+			UNITT_FAIL_NOT_EQUAL(1, batch.numberOfLoaded());
+			UNITT_FAIL_NOT_EQUAL(3, batch.numberOfFailed());
+		}
+
+		// cancelled requests fail instead of blocking wait
+		{
+			ResourceBatch batch(manager);
+			batch.registerType<int>("int");
+
+			ResourceBatch::Dependencies needs_one(1, "path/one.int");
+			batch.add("int", "path/one.int");
+			batch.add("int", "path/two.int", 0, needs_one);
+			batch.add("int", "path/three.int");
+
+			UNITT_ASSERT(batch.start());
+			manager.loadQueue().shutdown();
+			batch.wait();
+
+			UNITT_ASSERT(batch.done());
+			UNITT_FAIL_NOT_EQUAL(0, batch.numberOfLoaded());
+			UNITT_FAIL_NOT_EQUAL(3, batch.numberOfFailed());
+			UNITT_ASSERT(batch.state("int", "path/two.int") == ResourceBatch::Failed);
+		}
+
+		manager.clearLoaders();
+	}
+
+UNITT_TEST_END_CLASS(UnitTestResourceBatch)
+
+
+//
+// UnitTestResourceHotReload
+//
+
+static void writeTextFile(std::string const& filename, std::string const& text)
+{
+	FILE* file = std::fopen(filename.c_str(), "wb");
+	if (file)
+	{
+		std::fwrite(text.c_str(), 1, text.size(), file);
+		std::fclose(file);
+	}
+}
+
+class TextResouceLoader : public ResourceLoader<std::string>
+{
+public:
+	virtual bool suportsFormat(std::string const& extension) const
+	{
+		return (extension == "hotreload");
+	}
+
+	virtual SharedPointer<std::string> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties())
+	{
+		FileData data;
+		if (!fileSystem().read(location, data))
+		{
+			return SharedPointer<std::string>();
+		}
+		return new std::string((Char const*) data.bytes(), data.size);
+	}
+
+	virtual Bool assign(std::string& resource, std::string& reloaded)
+	{
+		resource.swap(reloaded);
+		return true;
+	}
+};
+
+UNITT_TEST_BEGIN_CLASS(UnitTestResourceHotReload)
+
+	virtual void run()
+	{
+		std::string const watched = "file_watcher_test.txt";
+		writeTextFile(watched, "one");
+
+		{
+			FileWatcher watcher;
+			FileWatcher::Filenames files;
+			files.push_back(watched);
+			watcher.setFiles(files);
+			UNITT_FAIL_NOT_EQUAL(1, watcher.files().size());
+			UNITT_FAIL_NOT_EQUAL(0, watcher.changes().size());
+
+			// polling compares modification times, whole seconds outside Linux
+			if (!watcher.usesNotifications())
+			{
+				Thread::microSleep(1100000);
+			}
+			writeTextFile(watched, "two");
+
+			FileWatcher::Filenames changes;
+			for (Uint i = 0; (i != 300) && changes.empty(); ++i)
+			{
+				Thread::microSleep(10000);
+				changes = watcher.changes();
+			}
+			UNITT_FAIL_NOT_EQUAL(1, changes.size());
+			UNITT_ASSERT(changes[0] == watched);
+			UNITT_FAIL_NOT_EQUAL(0, watcher.changes().size());
+
+			watcher.stop();
+			UNITT_FAIL_NOT_EQUAL(0, watcher.files().size());
+		}
+		std::remove(watched.c_str());
+
+		std::string const filename = "resource_hot_reload.hotreload";
+		writeTextFile(filename, "first");
+
+		TextResouceLoader* loader = new TextResouceLoader();
+		ResourceManager manager;
+		manager.addLoader(loader);
+		manager.loadQueue().setNumberOfWorkers(1);
+
+		SharedPointer<std::string> text = manager.load<std::string>(filename);
+		UNITT_ASSERT(text);
+		UNITT_ASSERT(*text == "first");
+
+		// disabled by default
+		UNITT_FAIL_NOT_EQUAL(0, manager.updateHotReload());
+
+		manager.setHotReload(true);
+		UNITT_FAIL_NOT_EQUAL(0, manager.updateHotReload());
+
+		Thread::microSleep(1100000);
+		writeTextFile(filename, "second");
+
+		Uint queued = 0;
+		for (Uint i = 0; (i != 300) && (queued == 0); ++i)
+		{
+			Thread::microSleep(10000);
+			queued = manager.updateHotReload();
+		}
+		UNITT_FAIL_NOT_EQUAL(1, queued);
+
+		// the holders see the new content once finalized
+		UNITT_ASSERT(*text == "first");
+		manager.loadQueue().flush();
+		UNITT_ASSERT(*text == "second");
+		UNITT_ASSERT(manager.load<std::string>(filename) == text);
+		UNITT_FAIL_NOT_EQUAL(1, loader->numberOfCachedResources());
+
+		manager.setHotReload(false);
+		UNITT_FAIL_NOT_EQUAL(0, manager.updateHotReload());
+		std::remove(filename.c_str());
+	}
+
+UNITT_TEST_END_CLASS(UnitTestResourceHotReload)
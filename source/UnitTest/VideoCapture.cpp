@@ -0,0 +1,119 @@
+#include "UnitTest/UnitTest.h"
+
+#include <rengine/capture/VideoCaptureFile.h>
+
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+using namespace std;
+using namespace rengine;
+
+//
+// UnitTestVideoCaptureFile
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestVideoCaptureFile)
+
+virtual void run()
+{
+	std::string const filename("unit_test_capture_4x2.yuyv");
+	Uint const width = 4;
+	Uint const height = 2;
+	Uint const frames = 3;
+
+	// gray frames, frame i has luma 10 * (i + 1)
+	{
+		std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+		for (Uint frame = 0; frame != frames; ++frame)
+		{
+			for (Uint i = 0; i != width * height / 2; ++i)
+			{
+				Uchar const luma = Uchar(10 * (frame + 1));
+				Uchar const yuyv[] = { luma, 128, luma, 128 };
+				out.write((Char const*) yuyv, 4);
+			}
+		}
+	}
+
+	UNITT_ASSERT(VideoCaptureFile::supportsLocation(filename));
+
+	VideoCaptureFile capture(filename);
+	capture.setReplayMode(VideoCaptureFile::ReplayAsFastAsPossible);
+	capture.setLoop(false);
+
+	VideoCapture::Devices devices = capture.enumerateDevices();
+	UNITT_FAIL_NOT_EQUAL(1, Int(devices.size()));
+
+	VideoCapture::Formats formats = capture.enumerateFormats(devices.front());
+	UNITT_FAIL_NOT_EQUAL(1, Int(formats.size()));
+	UNITT_FAIL_NOT_EQUAL("YUYV", formats.front().mode);
+	UNITT_FAIL_NOT_EQUAL(Int(width), Int(formats.front().width));
+	UNITT_FAIL_NOT_EQUAL(Int(height), Int(formats.front().height));
+
+	capture.open(VideoCapture::CaptureOptions(filename));
+	UNITT_ASSERT(capture.ready());
+	UNITT_FAIL_NOT_EQUAL(Int(frames), Int(capture.numberOfFrames()));
+
+	SharedPointer<VideoCapture::Frame> frame;
+	for (Uint index = 0; index != frames; ++index)
+	{
+		frame = capture.grab(VideoCapture::FrameOptions(), frame);
+		UNITT_ASSERT(frame && frame->data);
+
+		if (frame && frame->data)
+		{
+			UNITT_FAIL_NOT_EQUAL(Int(width * height * 3), Int(frame->size));
+			UNITT_FAIL_NOT_EQUAL(Int(10 * (index + 1)), Int(frame->data[0]));
+			UNITT_FAIL_NOT_EQUAL(Int(10 * (index + 1)), Int(frame->data[frame->size - 1]));
+		}
+	}
+
+	SharedPointer<VideoCapture::Frame> last = capture.grab(VideoCapture::FrameOptions(), frame);
+	UNITT_ASSERT(!last);
+	UNITT_ASSERT(!capture.ready());
+
+	capture.close();
+	std::remove(filename.c_str());
+
+	// three copies of a jpeg
+	std::string const mjpeg_filename("unit_test_capture.mjpg");
+	{
+		std::ifstream in("data/images/wood/box.jpg", std::ios::in | std::ios::binary);
+		std::string const jpeg((std::istreambuf_iterator<Char>(in)), std::istreambuf_iterator<Char>());
+
+		std::ofstream out(mjpeg_filename.c_str(), std::ios::out | std::ios::binary);
+		for (Uint i = 0; i != 3; ++i)
+		{
+			out.write(jpeg.data(), std::streamsize(jpeg.size()));
+		}
+	}
+
+	VideoCaptureFile mjpeg(mjpeg_filename);
+	mjpeg.setReplayMode(VideoCaptureFile::ReplayAsFastAsPossible);
+	mjpeg.setLoop(false);
+
+	formats = mjpeg.enumerateFormats(mjpeg.enumerateDevices().front());
+	UNITT_FAIL_NOT_EQUAL(1, Int(formats.size()));
+	UNITT_FAIL_NOT_EQUAL("MJPG", formats.front().mode);
+
+	mjpeg.open(VideoCapture::CaptureOptions(mjpeg_filename));
+	UNITT_FAIL_NOT_EQUAL(3, Int(mjpeg.numberOfFrames()));
+
+	frame = 0;
+	for (Uint index = 0; index != 3; ++index)
+	{
+		frame = mjpeg.grab(VideoCapture::FrameOptions(), frame);
+		UNITT_ASSERT(frame && frame->data);
+		if (frame && frame->data)
+		{
+			UNITT_FAIL_NOT_EQUAL(Int(formats.front().width * formats.front().height * 3), Int(frame->size));
+		}
+	}
+
+	mjpeg.close();
+	UNITT_FAIL_NOT_EQUAL(0, Int(mjpeg.numberOfFrames()));
+	std::remove(mjpeg_filename.c_str());
+}
+
+UNITT_TEST_END_CLASS(UnitTestVideoCaptureFile)
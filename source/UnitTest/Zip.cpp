@@ -1,9 +1,17 @@
 #include "UnitTest/UnitTest.h"
 
 #include <rengine/file/Zip.h>
+#include <rengine/file/Inflate.h>
+#include <rengine/file/Deflate.h>
+#include <rengine/file/ZipWriter.h>
+#include <rengine/util/Crc32.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 using namespace std;
 using namespace rengine;
@@ -62,3 +70,694 @@ virtual void run()
 	//UNITT_FAIL_NOT_EQUAL(convertFileNameToUnixStyle(test_filename), test_filename_unix);
 }
 UNITT_TEST_END_CLASS(UnitTestUnzip)
+
+//
+// UnitTestZipMapped
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestZipMapped)
+
+virtual void run()
+{
+	std::string filename("unit_test_data/file_zipped.zip");
+
+	Zip stream_zip;
+	UNITT_ASSERT( stream_zip.load(filename) );
+	UNITT_ASSERT(stream_zip.accessMode() == Zip::StreamAccess);
+
+	Zip zip(filename, Zip::MappedAccess);
+	UNITT_ASSERT(zip.accessMode() == Zip::MappedAccess);
+
+	// stored entries are views of the mapping
+	Zip::FileData text = zip.read("unit_test_data/File/one_text_file.txt");
+	UNITT_ASSERT(text.isView());
+	UNITT_ASSERT(!text.data);
+	UNITT_FAIL_NOT_EQUAL(12, text.size);
+
+	// deflated entries are inflated from the mapping
+	Zip::FileData shader = zip.read("unit_test_data/Shader/Simple.eff");
+	Zip::FileData stream_shader = stream_zip.read("unit_test_data/Shader/Simple.eff");
+	UNITT_ASSERT(!shader.isView());
+	UNITT_ASSERT(shader.data);
+	UNITT_FAIL_NOT_EQUAL(stream_shader.size, shader.size);
+	if (shader.data && stream_shader.data && (shader.size == stream_shader.size))
+	{
+		UNITT_ASSERT(std::equal(shader.bytes(), shader.bytes() + shader.size, stream_shader.bytes()));
+	}
+
+	UNITT_ASSERT(zip.fileType("unit_test_data/File") == FileDirectory);
+	UNITT_ASSERT(!zip.read("unit_test_data/File/missing.txt").size);
+
+	// views keep the mapping alive
+	zip.close();
+	if (text.isView())
+	{
+		std::string data_as_string(text.bytes(), text.bytes() + text.size);
+		UNITT_FAIL_NOT_EQUAL("hello world\n", data_as_string);
+	}
+
+	UNITT_ASSERT(!zip.load("unit_test_data/missing.zip", Zip::MappedAccess));
+}
+UNITT_TEST_END_CLASS(UnitTestZipMapped)
+
+//
+// UnitTestZipReadMany
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestZipReadMany)
+
+virtual void run()
+{
+	std::string filename("unit_test_data/file_zipped.zip");
+
+	std::vector<std::string> filenames;
+	filenames.push_back("unit_test_data/File/one_text_file.txt");
+	filenames.push_back("unit_test_data/Shader/BasicEffect.eff");
+	filenames.push_back("unit_test_data/Shader/Simple.eff");
+	filenames.push_back("unit_test_data/File/missing.txt");
+	filenames.push_back("unit_test_data/xml_test.xml");
+	filenames.push_back("unit_test_data/Shader/test/math.shd");
+
+	// repeat the entries so several threads hit the same archive at once
+	std::vector<std::string> requests;
+	for (Uint i = 0; i != 16; ++i)
+	{
+		requests.insert(requests.end(), filenames.begin(), filenames.end());
+	}
+
+	Zip::AccessMode const modes[] = { Zip::StreamAccess, Zip::MappedAccess };
+	for (Uint mode = 0; mode != 2; ++mode)
+	{
+		Zip zip(filename, modes[mode]);
+
+		Zip::FileDataVector data = zip.readMany(requests, 4);
+		UNITT_FAIL_NOT_EQUAL(requests.size(), data.size());
+
+		Bool same = true;
+		for (Uint i = 0; i != data.size(); ++i)
+		{
+			Zip::FileData expected = zip.read(requests[i]);
+			same &= (expected.size == data[i].size);
+			same &= std::equal(expected.bytes(), expected.bytes() + expected.size, data[i].bytes());
+		}
+		UNITT_ASSERT(same);
+
+		UNITT_FAIL_NOT_EQUAL(12, data[0].size);
+		UNITT_FAIL_NOT_EQUAL(7797, data[4].size);
+		UNITT_FAIL_NOT_EQUAL(0, data[3].size);
+	}
+}
+UNITT_TEST_END_CLASS(UnitTestZipReadMany)
+
+//
+// UnitTestInflate
+//
+
+// reference decoder, see Puff.cpp
+int puff(unsigned char *dest, unsigned long *destlen, unsigned char *source, unsigned long *sourcelen);
+
+// raw deflate streams made by zlib
+static Uint8 const dynamic_stream[] =
+{
+	0x75, 0x56, 0x5b, 0x6e, 0x1b, 0x31, 0x0c, 0xfc, 0xe7, 0x29, 0x78, 0x35, 0x07, 0x59, 0x27, 0xfe,
+	0xb0, 0x6b, 0x28, 0x49, 0x51, 0xf4, 0xf4, 0x95, 0x77, 0x46, 0xd4, 0xcc, 0xae, 0x0a, 0x18, 0x92,
+	0x97, 0xe2, 0x9b, 0x43, 0x4a, 0x6d, 0x7b, 0xbc, 0x6f, 0xed, 0xeb, 0xf3, 0xd2, 0xd7, 0x6b, 0xbb,
+	0xdc, 0xb7, 0xdf, 0x5b, 0xfb, 0xde, 0xfe, 0xb4, 0xed, 0xf1, 0x71, 0x7b, 0x6c, 0xfd, 0xdf, 0xf7,
+	0x4f, 0xdb, 0x82, 0x7b, 0xdb, 0x99, 0x93, 0x87, 0x71, 0xbf, 0x3d, 0xef, 0x97, 0xa7, 0xb3, 0xee,
+	0x3a, 0xf6, 0x85, 0x04, 0x30, 0x0d, 0x45, 0xfb, 0x09, 0x25, 0xd2, 0x38, 0x60, 0x17, 0xeb, 0xb0,
+	0x90, 0xa9, 0xfc, 0x66, 0x2e, 0xe0, 0xf2, 0xdf, 0xdb, 0x73, 0x67, 0xc1, 0xd7, 0xf0, 0x33, 0x3b,
+	0x39, 0xa0, 0x0a, 0x07, 0x83, 0x9e, 0x20, 0x96, 0xa6, 0x79, 0x14, 0xcf, 0xf6, 0xeb, 0xa3, 0x6b,
+	0x1a, 0x9c, 0xc3, 0x03, 0xb0, 0xbe, 0xfd, 0x5c, 0xaf, 0x5b, 0x83, 0x70, 0xc5, 0xd0, 0x85, 0x41,
+	0x4f, 0x6c, 0x20, 0x75, 0xd3, 0x90, 0x81, 0x65, 0xaa, 0xb5, 0x2c, 0xec, 0xee, 0xa9, 0x0c, 0x99,
+	0x40, 0xea, 0x87, 0x23, 0x33, 0x96, 0x35, 0xe8, 0x6b, 0x52, 0x2f, 0xf0, 0x6b, 0x8a, 0xe0, 0xe1,
+	0x10, 0x4b, 0x30, 0x9b, 0x0d, 0x96, 0xd0, 0x1c, 0x77, 0x6b, 0xdd, 0x3e, 0xc8, 0x94, 0x30, 0x9d,
+	0xb4, 0xc3, 0x23, 0x6e, 0x5d, 0x82, 0x75, 0xc3, 0x56, 0x71, 0xf0, 0xdc, 0x71, 0x05, 0x8f, 0x5e,
+	0x5a, 0x34, 0x05, 0x88, 0x68, 0x04, 0x5e, 0x27, 0xb3, 0xee, 0x5d, 0xdd, 0x22, 0xa3, 0x13, 0x6e,
+	0x16, 0xca, 0x29, 0x3f, 0x51, 0xe2, 0xf5, 0xa9, 0xce, 0xc1, 0x07, 0xb8, 0xb8, 0x13, 0xb4, 0x84,
+	0xa6, 0x13, 0xab, 0x42, 0xd6, 0x60, 0xc9, 0xbc, 0x16, 0x38, 0xfb, 0x8f, 0x27, 0x6a, 0x9d, 0x45,
+	0x48, 0x0d, 0x9d, 0xee, 0x44, 0x6a, 0x23, 0xcc, 0xa2, 0x4d, 0xe5, 0x8a, 0xc2, 0xc3, 0x62, 0xd9,
+	0x93, 0x68, 0x2c, 0x91, 0xd6, 0x75, 0x60, 0xb5, 0x38, 0xbd, 0xc9, 0xbd, 0xee, 0xe9, 0x7d, 0xb6,
+	0x64, 0x85, 0xe2, 0x14, 0xcc, 0xc2, 0x13, 0xa4, 0x82, 0xfc, 0x55, 0x1d, 0xc7, 0x1e, 0x68, 0xe7,
+	0xb5, 0xcb, 0x5a, 0x15, 0xf8, 0x61, 0x98, 0x9e, 0x60, 0x34, 0xf8, 0xd2, 0x63, 0x4b, 0x41, 0xac,
+	0x12, 0x3f, 0x06, 0x4b, 0xa1, 0xd9, 0x8d, 0xbc, 0x7a, 0x56, 0xc5, 0xf0, 0x9f, 0xfa, 0x22, 0x14,
+	0x41, 0xcc, 0x00, 0x36, 0xc1, 0xa9, 0x21, 0x97, 0x92, 0x8b, 0x31, 0x40, 0x47, 0xb8, 0x55, 0x3c,
+	0x35, 0x58, 0xc8, 0x66, 0x69, 0xb4, 0x4c, 0xd8, 0x60, 0xfb, 0x6f, 0xd1, 0x75, 0x08, 0x2a, 0x3d,
+	0x73, 0x01, 0x37, 0x0d, 0x8f, 0xba, 0xec, 0xe3, 0x1c, 0x9f, 0x22, 0xeb, 0x34, 0x00, 0x3c, 0xb5,
+	0xd2, 0xbf, 0xaa, 0xc7, 0x99, 0xb4, 0xfd, 0xaa, 0x02, 0xb3, 0xb1, 0x52, 0xbd, 0x25, 0x29, 0xcf,
+	0x11, 0x10, 0x0d, 0x61, 0x1a, 0x7c, 0xa8, 0xf9, 0x0c, 0x35, 0xeb, 0x32, 0x1a, 0xac, 0xeb, 0xab,
+	0x34, 0x2f, 0x90, 0xb0, 0xfa, 0x75, 0x1b, 0x1c, 0xa6, 0xb7, 0x58, 0xd2, 0x02, 0x72, 0x80, 0x82,
+	0x99, 0xee, 0x8d, 0x2d, 0xac, 0x20, 0x0c, 0xce, 0xa2, 0xd7, 0x95, 0x55, 0xf4, 0x24, 0xc6, 0x0c,
+	0xb5, 0xea, 0xd8, 0x51, 0x6b, 0x3d, 0xe8, 0x3d, 0x52, 0x01, 0x1d, 0x9e, 0x02, 0x10, 0x09, 0xa7,
+	0x2a, 0x8a, 0x33, 0x32, 0x0c, 0xa8, 0x85, 0xe0, 0x61, 0xcf, 0x8f, 0x63, 0x26, 0xed, 0x84, 0x19,
+	0x45, 0x97, 0xda, 0x30, 0x08, 0x4a, 0x87, 0x2d, 0x5e, 0x14, 0xc7, 0xd1, 0x61, 0x55, 0x3e, 0x43,
+	0xa3, 0xee, 0x09, 0x6d, 0x12, 0xcf, 0xa5, 0x78, 0xa3, 0xf3, 0x6d, 0x71, 0xeb, 0xa3, 0x98, 0x72,
+	0xc3, 0x08, 0x80, 0x16, 0xad, 0x7a, 0x6c, 0xe2, 0x59, 0xb0, 0xd0, 0x61, 0xe8, 0x63, 0x42, 0xb4,
+	0xc7, 0xfe, 0xb0, 0xf0, 0x89, 0x6a, 0xed, 0x3f, 0x6f, 0xf8, 0xe3, 0xbd, 0xe4, 0xd7, 0x63, 0x65,
+	0x4e, 0xdf, 0x56, 0x91, 0x8b, 0x51, 0x33, 0x35, 0x3a, 0xb4, 0xcf, 0x35, 0x9c, 0x2c, 0xd6, 0x60,
+	0xb3, 0x3c, 0x69, 0xae, 0x4e, 0xba, 0xbd, 0x05, 0x18, 0xe8, 0xae, 0xf8, 0xf5, 0x50, 0xb2, 0xb6,
+	0x8a, 0xd5, 0x63, 0xab, 0xe2, 0xb3, 0x78, 0x0b, 0xdd, 0x15, 0x6a, 0x14, 0x89, 0x20, 0xd5, 0x51,
+	0x52, 0x77, 0xd7, 0x6c, 0x78, 0x9f, 0x1d, 0x1e, 0x7d, 0x84, 0x4d, 0x77, 0x05, 0xb7, 0x21, 0x57,
+	0xae, 0x68, 0x7d, 0x39, 0xc5, 0xf1, 0x8d, 0x72, 0x18, 0x39, 0xef, 0x07, 0x5c, 0x1a, 0xa4, 0xff,
+	0x01
+};
+
+static Uint8 const fixed_stream[] =
+{
+	0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0x40, 0x22, 0x8b, 0x52, 0xf3, 0xd2, 0x33, 0xf3, 0x52,
+	0x61, 0x34, 0x00
+};
+
+static Uint8 const stored_stream[] =
+{
+	0x01, 0x11, 0x00, 0xee, 0xff, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x64, 0x20, 0x62, 0x6c, 0x6f, 0x63,
+	0x6b, 0x20, 0x64, 0x61, 0x74, 0x61
+};
+
+static Bool inflateMatchesPuff(std::vector<Uint8> const& stream, Uint const capacity)
+{
+	std::vector<Uint8> expected(capacity + 1);
+	std::vector<Uint8> result(capacity + 1);
+	std::vector<Uint8> input(stream);
+	input.push_back(0);
+
+	unsigned long puff_size = capacity;
+	unsigned long puff_source_size = stream.size();
+	int puff_result = puff(&expected[0], &puff_size, &input[0], &puff_source_size);
+
+	Uint size = capacity;
+	Uint source_size = Uint(stream.size());
+	Inflater::Status status = inflate(&result[0], size, &input[0], source_size);
+
+	if ((puff_result == 0) != (status == Inflater::Success))
+	{
+		return false;
+	}
+
+	if (status == Inflater::Success)
+	{
+		return (size == puff_size) && (source_size == puff_source_size) &&
+			std::equal(result.begin(), result.begin() + size, expected.begin());
+	}
+
+	return true;
+}
+
+UNITT_TEST_BEGIN_CLASS(UnitTestInflate)
+
+virtual void run()
+{
+	std::vector<Uint8> dynamic(dynamic_stream, dynamic_stream + sizeof(dynamic_stream));
+	std::vector<Uint8> fixed(fixed_stream, fixed_stream + sizeof(fixed_stream));
+	std::vector<Uint8> stored(stored_stream, stored_stream + sizeof(stored_stream));
+
+	UNITT_ASSERT(inflateMatchesPuff(dynamic, 4096));
+	UNITT_ASSERT(inflateMatchesPuff(fixed, 64));
+	UNITT_ASSERT(inflateMatchesPuff(stored, 64));
+
+	std::vector<Uint8> data(3025);
+	Uint size = Uint(data.size());
+	Uint source_size = Uint(dynamic.size());
+	UNITT_ASSERT(inflate(&data[0], size, &dynamic[0], source_size) == Inflater::Success);
+	UNITT_FAIL_NOT_EQUAL(3025, Int(size));
+	UNITT_FAIL_NOT_EQUAL(Int(dynamic.size()), Int(source_size));
+
+	std::string fixed_text(64, ' ');
+	size = 64;
+	source_size = Uint(fixed.size());
+	UNITT_ASSERT(inflate((Uint8*) &fixed_text[0], size, &fixed[0], source_size) == Inflater::Success);
+	UNITT_FAIL_NOT_EQUAL("hello hello hello rengine rengine", fixed_text.substr(0, size));
+
+	// small destinations and truncated sources fail
+	size = 3024;
+	source_size = Uint(dynamic.size());
+	UNITT_ASSERT(inflate(&data[0], size, &dynamic[0], source_size) == Inflater::OutputOverflow);
+
+	size = Uint(data.size());
+	source_size = Uint(dynamic.size()) / 2;
+	UNITT_ASSERT(inflate(&data[0], size, &dynamic[0], source_size) == Inflater::InputUnderflow);
+
+	// corrupted streams agree with puff
+	Uint seed = 12345;
+	Bool agree = true;
+	for (Uint iteration = 0; iteration != 2000; ++iteration)
+	{
+		std::vector<Uint8> const& original = (iteration % 3 == 0) ? dynamic : ((iteration % 3 == 1) ? fixed : stored);
+		std::vector<Uint8> corrupted(original);
+
+		for (Uint flips = 0; flips != 1 + (iteration % 4); ++flips)
+		{
+			seed = seed * 1103515245 + 12345;
+			Uint const bit = (seed >> 8) % (Uint(corrupted.size()) * 8);
+			corrupted[bit / 8] ^= Uint8(1 << (bit % 8));
+		}
+
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 4 == 0)
+		{
+			corrupted.resize((seed >> 4) % corrupted.size());
+		}
+
+		agree &= inflateMatchesPuff(corrupted, 4096);
+	}
+	UNITT_ASSERT(agree);
+
+	// reading a zip goes through inflate
+	Zip zip;
+	UNITT_ASSERT(zip.load("unit_test_data/file_zipped.zip"));
+	Zip::FileData file = zip.read("unit_test_data/Shader/Simple.eff");
+	UNITT_ASSERT(file.data && (file.size > 0));
+}
+UNITT_TEST_END_CLASS(UnitTestInflate)
+
+//
+// UnitTestDeflate
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestDeflate)
+
+Bool roundTrip(std::vector<Uint8> const& data, Deflater& deflater)
+{
+	std::vector<Uint8> compressed(Deflater::bound(Uint(data.size())));
+	Uint compressed_size = Uint(compressed.size());
+	Uint8 const* source = data.empty() ? 0 : &data[0];
+
+	if (deflater.deflate(&compressed[0], compressed_size, source, Uint(data.size())) != Deflater::Success)
+	{
+		return false;
+	}
+
+	std::vector<Uint8> decompressed(data.size() + 1);
+	Uint decompressed_size = Uint(decompressed.size());
+	Uint consumed = compressed_size;
+
+	if ((inflate(&decompressed[0], decompressed_size, &compressed[0], consumed) != Inflater::Success) ||
+		(decompressed_size != data.size()) || (consumed != compressed_size) ||
+		!std::equal(data.begin(), data.end(), decompressed.begin()))
+	{
+		return false;
+	}
+
+	// the reference decoder must accept the stream too
+	unsigned long puff_size = (unsigned long) decompressed.size();
+	unsigned long puff_consumed = compressed_size;
+	return (puff(&decompressed[0], &puff_size, &compressed[0], &puff_consumed) == 0) && (puff_size == data.size()) &&
+		   std::equal(data.begin(), data.end(), decompressed.begin());
+}
+
+virtual void run()
+{
+	Uint seed = 11;
+	std::vector<std::vector<Uint8> > inputs;
+
+	inputs.push_back(std::vector<Uint8>());
+	inputs.push_back(std::vector<Uint8>(1, 'a'));
+	inputs.push_back(std::vector<Uint8>(200000, 0));
+
+	// noise does not compress, it must fall back to stored blocks
+	std::vector<Uint8> noise(70000);
+	for (Uint i = 0; i != noise.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		noise[i] = Uint8(seed >> 16);
+	}
+	inputs.push_back(noise);
+
+	// text like data with a small alphabet and repeated words
+	std::vector<Uint8> text;
+	char const* words[] = { "render ", "engine ", "texture ", "shader ", "zip ", "\n", "frame buffer " };
+	while (text.size() < 150000)
+	{
+		seed = seed * 1103515245 + 12345;
+		std::string const word(words[(seed >> 16) % 7]);
+		text.insert(text.end(), word.begin(), word.end());
+	}
+	inputs.push_back(text);
+
+	Zip zip("unit_test_data/file_zipped.zip");
+	Zip::FileData xml = zip.read("unit_test_data/xml_test.xml");
+	inputs.push_back(std::vector<Uint8>(xml.bytes(), xml.bytes() + xml.size));
+
+	Deflater::Level const levels[] = { Deflater::StoreLevel, Deflater::FastLevel, Deflater::BestLevel };
+	for (Uint level = 0; level != 3; ++level)
+	{
+		Deflater deflater(levels[level]);
+
+		Bool same = true;
+		for (Uint i = 0; i != inputs.size(); ++i)
+		{
+			same &= roundTrip(inputs[i], deflater);
+		}
+		UNITT_ASSERT(same);
+	}
+
+	// compression actually happens
+	std::vector<Uint8> compressed(Deflater::bound(Uint(text.size())));
+	Uint fast_size = Uint(compressed.size());
+	Uint best_size = Uint(compressed.size());
+	UNITT_ASSERT(deflate(&compressed[0], fast_size, &text[0], Uint(text.size()), Deflater::FastLevel) == Deflater::Success);
+	UNITT_ASSERT(deflate(&compressed[0], best_size, &text[0], Uint(text.size()), Deflater::BestLevel) == Deflater::Success);
+	UNITT_ASSERT(fast_size < text.size() / 3);
+	UNITT_ASSERT(best_size <= fast_size);
+
+	// small destinations are reported
+	Uint small_size = 100;
+	UNITT_ASSERT(deflate(&compressed[0], small_size, &noise[0], Uint(noise.size())) == Deflater::OutputOverflow);
+}
+UNITT_TEST_END_CLASS(UnitTestDeflate)
+
+//
+// UnitTestZipWriter
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestZipWriter)
+
+virtual void run()
+{
+	std::string const filename("unit_test_writer.zip");
+	std::string const text("hello world\n");
+	std::string repeated;
+	for (Uint i = 0; i != 1000; ++i)
+	{
+		repeated += "rengine zip writer ";
+	}
+
+	{
+		ZipWriter writer(filename);
+		UNITT_ASSERT(writer.isOpen());
+		UNITT_ASSERT(writer.add("data/text.txt", text.data(), Uint(text.size())));
+		UNITT_ASSERT(writer.add("data/deep/repeated.txt", repeated.data(), Uint(repeated.size()), Deflater::FastLevel));
+		UNITT_ASSERT(writer.add("stored.txt", repeated.data(), Uint(repeated.size()), Deflater::StoreLevel));
+		UNITT_ASSERT(writer.add("empty.txt", 0, 0));
+		UNITT_ASSERT(writer.addDirectory("other"));
+		UNITT_ASSERT(!writer.add("data/text.txt", text.data(), Uint(text.size())));
+
+		// data/ data/deep/ and other/ are directories
+		UNITT_FAIL_NOT_EQUAL(7, writer.numberOfEntries());
+		UNITT_ASSERT(writer.close());
+	}
+
+	Zip zip;
+	UNITT_ASSERT(zip.load(filename));
+
+	Zip::FileData data = zip.read("data/text.txt");
+	UNITT_ASSERT(data.size == text.size() && std::equal(text.begin(), text.end(), data.bytes()));
+
+	data = zip.read("data/deep/repeated.txt");
+	UNITT_ASSERT(data.size == repeated.size() && std::equal(repeated.begin(), repeated.end(), data.bytes()));
+
+	data = zip.read("stored.txt");
+	UNITT_ASSERT(data.size == repeated.size() && std::equal(repeated.begin(), repeated.end(), data.bytes()));
+
+	UNITT_ASSERT(zip.fileType("empty.txt") == FileRegular);
+	UNITT_ASSERT(zip.fileType("data/deep") == FileDirectory);
+	UNITT_ASSERT(zip.fileType("other") == FileDirectory);
+	UNITT_FAIL_NOT_EQUAL(2 + 2, zip.getDirectoryContents("data").size());
+
+	zip.close();
+	std::remove(filename.c_str());
+}
+UNITT_TEST_END_CLASS(UnitTestZipWriter)
+
+//
+// UnitTestZipIndex
+//
+
+UNITT_TEST_BEGIN_CLASS(UnitTestZipIndex)
+
+virtual void run()
+{
+	std::string const filename("unit_test_index.zip");
+	Uint const directories = 20;
+	Uint const files = 500;
+
+	{
+		ZipWriter writer(filename);
+		for (Uint directory = 0; directory != directories; ++directory)
+		{
+			for (Uint file = 0; file != files; ++file)
+			{
+				std::string const name = "pack/" + lexical_cast<std::string>(directories - directory) + "/" + lexical_cast<std::string>(file) + ".txt";
+				UNITT_ASSERT(writer.add(name, name.data(), Uint(name.size()), Deflater::StoreLevel));
+			}
+		}
+		UNITT_ASSERT(writer.close());
+	}
+
+	Zip zip;
+	UNITT_ASSERT(zip.load(filename));
+	zip.resetStatistics();
+
+	// the names are normalized before the lookup
+	UNITT_ASSERT(zip.fileType("pack/7/123.txt") == FileRegular);
+	UNITT_ASSERT(zip.fileType("./pack\\7\\123.txt") == FileRegular);
+	UNITT_ASSERT(zip.fileType("pack/7/123.txt/") == FileNotFound);
+	UNITT_ASSERT(zip.fileType("pack/7") == FileDirectory);
+	UNITT_ASSERT(zip.fileType("pack/7/") == FileDirectory);
+	UNITT_ASSERT(zip.fileType("") == FileDirectory);
+	UNITT_ASSERT(zip.fileType("pack/7/500.txt") == FileNotFound);
+	UNITT_ASSERT(zip.fileType("pack/21") == FileNotFound);
+
+	Zip::Statistics statistics = zip.statistics();
+	UNITT_FAIL_NOT_EQUAL(8, Uint(statistics.lookups));
+	UNITT_FAIL_NOT_EQUAL(2, Uint(statistics.misses));
+	UNITT_FAIL_NOT_EQUAL(0, Uint(statistics.opens));
+
+	for (Uint directory = 1; directory <= directories; ++directory)
+	{
+		std::string const name = "pack/" + lexical_cast<std::string>(directory) + "/" + lexical_cast<std::string>(directory * 7) + ".txt";
+		Zip::FileData data = zip.read(name);
+		UNITT_ASSERT(data.size == name.size() && std::equal(name.begin(), name.end(), data.bytes()));
+	}
+	UNITT_ASSERT(zip.openStream("pack/1/1.txt"));
+	UNITT_ASSERT(!zip.openStream("pack/1"));
+
+	statistics = zip.statistics();
+	UNITT_FAIL_NOT_EQUAL(8 + directories + 2, Uint(statistics.lookups));
+	UNITT_FAIL_NOT_EQUAL(directories + 1, Uint(statistics.opens));
+
+	// listings are sorted by name
+	DirectoryContents contents = zip.getDirectoryContents("pack");
+	UNITT_FAIL_NOT_EQUAL(directories + 2, Uint(contents.size()));
+	UNITT_FAIL_NOT_EQUAL("1", contents[0]);
+	UNITT_FAIL_NOT_EQUAL("10", contents[1]);
+	for (Uint i = 1; i != directories; ++i)
+	{
+		UNITT_ASSERT(contents[i - 1] < contents[i]);
+	}
+
+	contents = zip.getDirectoryContents("pack/3/");
+	UNITT_FAIL_NOT_EQUAL(files + 2, Uint(contents.size()));
+	UNITT_ASSERT(std::find(contents.begin(), contents.end(), "499.txt") != contents.end());
+
+	contents = zip.getDirectoryContents(".");
+	UNITT_FAIL_NOT_EQUAL(2, Uint(contents.size()));
+	UNITT_FAIL_NOT_EQUAL("pack", contents[0]);
+
+	UNITT_ASSERT(zip.getDirectoryContents("pack/3/1.txt").empty());
+	UNITT_ASSERT(zip.getDirectoryContents("missing").empty());
+
+	zip.close();
+	UNITT_ASSERT(zip.fileType("pack") == FileNotFound);
+	std::remove(filename.c_str());
+}
+UNITT_TEST_END_CLASS(UnitTestZipIndex)
+
+//
+// UnitTestZipStream
+//
+
+// hands out the input a few bytes at a time to cross every chunk boundary
+class TrickleSource : public InflateStream::Source
+{
+public:
+	TrickleSource(std::vector<Uint8> const& data, Uint const step)
+		:data_(data), position_(0), step_(step)
+	{
+	}
+
+	virtual Uint read(Uint8* buffer, Uint const size)
+	{
+		Uint const count = std::min(std::min(size, step_), Uint(data_.size()) - position_);
+		std::copy(data_.begin() + position_, data_.begin() + position_ + count, buffer);
+		position_ += count;
+		return count;
+	}
+private:
+	std::vector<Uint8> const& data_;
+	Uint position_;
+	Uint step_;
+};
+
+UNITT_TEST_BEGIN_CLASS(UnitTestZipStream)
+
+std::vector<Uint8> readStream(Zip::SharedStream const& stream, Uint const chunk)
+{
+	std::vector<Uint8> data;
+	std::vector<Uint8> buffer(chunk);
+
+	for (Uint count = stream->read(&buffer[0], chunk); count; count = stream->read(&buffer[0], chunk))
+	{
+		data.insert(data.end(), buffer.begin(), buffer.begin() + count);
+	}
+
+	return data;
+}
+
+virtual void run()
+{
+	// 3MB with long matches, literals and a stored block
+	std::vector<Uint8> large;
+	Uint seed = 5;
+	while (large.size() < 3 * 1024 * 1024)
+	{
+		seed = seed * 1103515245 + 12345;
+		Uint const kind = (seed >> 16) % 4;
+
+		for (Uint i = 0; i != 1000; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			large.push_back(Uint8((kind == 0) ? (seed >> 16) : ((kind == 1) ? (i & 7) : ('a' + (i % 26)))));
+		}
+	}
+
+	// incremental decoding through chunk boundaries
+	Deflater::Level const levels[] = { Deflater::StoreLevel, Deflater::FastLevel, Deflater::BestLevel };
+	for (Uint level = 0; level != 3; ++level)
+	{
+		std::vector<Uint8> compressed(Deflater::bound(Uint(large.size())));
+		Uint compressed_size = Uint(compressed.size());
+		UNITT_ASSERT(deflate(&compressed[0], compressed_size, &large[0], Uint(large.size()), levels[level]) == Deflater::Success);
+		compressed.resize(compressed_size);
+
+		TrickleSource source(compressed, 3 + level * 1000);
+		InflateStream inflate(source);
+
+		std::vector<Uint8> decoded(large.size() + 10);
+		Uint decoded_size = 0;
+		for (Uint count = 1; count; decoded_size += count)
+		{
+			count = inflate.read(&decoded[decoded_size], std::min(Uint(12345), Uint(decoded.size()) - decoded_size));
+		}
+
+		UNITT_ASSERT(inflate.status() == Inflater::Success);
+		UNITT_ASSERT(inflate.finished());
+		UNITT_FAIL_NOT_EQUAL(Uint(large.size()), decoded_size);
+		UNITT_ASSERT(std::equal(large.begin(), large.end(), decoded.begin()));
+	}
+
+	// zip entries
+	std::string const filename("unit_test_stream.zip");
+	std::string const marker("stored entry marker");
+	{
+		ZipWriter writer(filename);
+		UNITT_ASSERT(writer.add("large.bin", &large[0], Uint(large.size())));
+		UNITT_ASSERT(writer.add("stored.txt", marker.data(), Uint(marker.size()), Deflater::StoreLevel));
+		UNITT_ASSERT(writer.close());
+	}
+
+	Zip::AccessMode const modes[] = { Zip::StreamAccess, Zip::MappedAccess };
+	for (Uint mode = 0; mode != 2; ++mode)
+	{
+		Zip zip(filename, modes[mode]);
+		Zip::SharedStream stream = zip.openStream("large.bin");
+		UNITT_ASSERT(stream);
+		UNITT_ASSERT(!zip.openStream("missing.bin"));
+
+		if (stream)
+		{
+			UNITT_FAIL_NOT_EQUAL(Uint(large.size()), stream->size());
+
+			// the stream outlives the archive
+			zip.close();
+
+			std::vector<Uint8> data = readStream(stream, 77777);
+			UNITT_ASSERT(stream->eof());
+			UNITT_ASSERT(stream->good());
+			UNITT_ASSERT(data == large);
+		}
+	}
+
+	// corrupted stored entry, the crc fails at the end
+	{
+		std::vector<Uint8> archive;
+		{
+			std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+			archive.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		}
+
+		std::vector<Uint8>::iterator found = std::search(archive.begin(), archive.end(), marker.begin(), marker.end());
+		UNITT_ASSERT(found != archive.end());
+		if (found != archive.end())
+		{
+			*found ^= 1;
+			std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+			out.write((Char const*) &archive[0], archive.size());
+		}
+
+		Zip zip(filename);
+		Zip::SharedStream stream = zip.openStream("stored.txt");
+		UNITT_ASSERT(stream);
+		if (stream)
+		{
+			std::vector<Uint8> data = readStream(stream, 4);
+			UNITT_FAIL_NOT_EQUAL(marker.size(), data.size());
+			UNITT_ASSERT(!stream->good());
+		}
+	}
+
+	std::remove(filename.c_str());
+}
+UNITT_TEST_END_CLASS(UnitTestZipStream)
+
+//
+// UnitTestCrc32
+//
+
+static Uint32 bitwiseCrc32(Uint8 const* data, Uint size)
+{
+	Uint32 crc = 0xFFFFFFFF;
+	for (Uint i = 0; i != size; ++i)
+	{
+		crc ^= data[i];
+		for (Uint bit = 0; bit != 8; ++bit)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+		}
+	}
+	return ~crc;
+}
+
+UNITT_TEST_BEGIN_CLASS(UnitTestCrc32)
+
+virtual void run()
+{
+	std::string const check("123456789");
+	UNITT_ASSERT(crc32(0, check.data(), Uint(check.size())) == 0xCBF43926);
+	UNITT_ASSERT(crc32(0, check.data(), 0) == 0);
+
+	std::vector<Uint8> data(4099);
+	Uint seed = 7;
+	for (Uint i = 0; i != data.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = Uint8(seed >> 16);
+	}
+
+	// every path, sizes around the folding block sizes and unaligned starts
+	Bool same = true;
+	Uint const sizes[] = { 1, 7, 8, 15, 16, 63, 64, 65, 127, 128, 200, 1000, 4096 };
+	for (Uint size = 0; size != sizeof(sizes) / sizeof(Uint); ++size)
+	{
+		for (Uint offset = 0; offset != 3; ++offset)
+		{
+			same &= (crc32(0, &data[offset], sizes[size]) == bitwiseCrc32(&data[offset], sizes[size]));
+		}
+	}
+	UNITT_ASSERT(same);
+
+	// chaining
+	Uint32 const whole = crc32(0, &data[0], Uint(data.size()));
+	Uint32 const chained = crc32(crc32(0, &data[0], 1500), &data[1500], Uint(data.size()) - 1500);
+	UNITT_ASSERT(whole == chained);
+}
+UNITT_TEST_END_CLASS(UnitTestCrc32)
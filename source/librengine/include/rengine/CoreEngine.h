@@ -21,6 +21,9 @@ namespace rengine
 	class HudWriter;
 	class ResourceManager;
 	class StringTable;
+	class RenderTargetPool;
+	class VirtualFileSystem;
+	class FrameProfiler;
 
 	class CoreEngine
 	{
@@ -62,6 +65,18 @@ namespace rengine
 		StringTable& locationTable();
 		StringTable const& locationTable() const;
 
+		// files of every resource, the working directory is mounted at the root
+		VirtualFileSystem& fileSystem();
+		VirtualFileSystem const& fileSystem() const;
+
+		// frame buffers shared by transient passes
+		RenderTargetPool& renderTargetPool();
+		RenderTargetPool const& renderTargetPool() const;
+
+		// times of the frame sections, shown by the profiler_hud variable
+		FrameProfiler& frameProfiler();
+		FrameProfiler const& frameProfiler() const;
+
 		void setScene(SharedPointer<Scene> const& scene);
 		Scene *const scene() const;
 
@@ -104,6 +119,8 @@ namespace rengine
 		Bool makeCurrentContext(GraphicsWindow* context);
 
 	private:
+		void writeFrameProfiler();
+
 		struct Implementation;
 		Implementation* implementation;
 
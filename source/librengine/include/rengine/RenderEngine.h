@@ -10,6 +10,8 @@
 
 #include <rengine/state/DrawStates.h>
 
+#include <map>
+
 namespace rengine
 {
 	class Drawable;
@@ -55,6 +57,32 @@ namespace rengine
 
 		typedef Uint BufferType;
 
+		// per frame counters, the state changes are counted per state type
+		enum Counter
+		{
+			DrawCalls,
+			CapabilityChanges,
+			BlendFunctionChanges,
+			BlendEquationChanges,
+			BlendColorChanges,
+			CullFaceChanges,
+			DepthChanges,
+			ColorChannelMaskChanges,
+			PolygonModeChanges,
+			StencilChanges,
+			OperationBufferChanges,
+			TextureUnitChanges,
+			ProgramChanges,
+			TextureBinds,
+			BufferUploads,
+			BufferUploadBytes,
+			UniformUploads,
+			NumberOfCounters
+		};
+
+		// pass name to milliseconds
+		typedef std::map<std::string, Real64> GpuPassTimes;
+
 
 		RenderEngine();
 		~RenderEngine();
@@ -65,6 +93,30 @@ namespace rengine
 		void preFrame();
 		void postFrame();
 
+		//
+		// Frame statistics
+		//
+
+		// Description
+		//	Counters of the last finished frame, a frame ends in postFrame.
+		//	They are also the render_* console variables.
+		Uint64 frameCounter(Counter const counter) const;
+		// sum of the state type and capability changes
+		Uint64 frameStateChanges() const;
+		static Char const* counterName(Counter const counter);
+
+		// Description
+		//	Times the gpu work of a pass with a GL_TIME_ELAPSED query, read back a few frames later so the cpu never waits.
+		//	Queries can not nest, a pass begun inside another is part of the outer one.
+		//	Passes with the same name in a frame add up.
+		void beginGpuPass(std::string const& name);
+		void endGpuPass();
+		// Description
+		//	Times of the passes of the frame read back by the last preFrame, empty while no result is available.
+		GpuPassTimes const& gpuPassTimes() const;
+		// true with GL 3.3, ARB_timer_query or EXT_timer_query
+		Bool supportsTimerQuery() const;
+
 		void setModelView(Matrix const& matrix);
 		Matrix const& modelView() const;
 		Matrix& modelView();
@@ -140,6 +192,8 @@ namespace rengine
 		// Texture handling
 		//
 		void apply(Texture2D& texture);
+		// uploads pending texture data, the texture bound to the active unit is kept
+		void prepare(Texture2D& texture);
 		Int getTextureFormatFromChannels(Int color_channels);
 		Bool supportsNonPowerOfTwoTextures() const;
 		Bool supportsTextureRectangle() const;
@@ -152,10 +206,45 @@ namespace rengine
 		// Shader Handling
 		//
 		void apply(Program& program);
+		// compiles and links a changed program, the program in use is kept
+		void prepare(Program& program);
+
+		// Description
+		//	Starts compiling and linking a changed program without waiting for the driver,
+		//	submitting many programs before using them overlaps their compilation.
+		//	The status is queried by completeProgram, called when the program is applied.
+		void submit(Program& program);
+		// Description
+		//	false while a submitted program is compiling in the driver threads.
+		//	Always true without parallel shader compile, the status query waits instead.
+		Bool programReady(Program const& program) const;
+		// queries the compile and link status of a submitted program, waiting for the driver
+		void completeProgram(Program& program);
+		// uniform, input and output locations of a linked program
+		void programLocations(Program& program, std::stringstream& shader_log);
+
+		// Description
+		//	Program drawn instead of programs still compiling, 0 (the default) waits for them.
+		//	It is applied with its own uniforms, a placeholder should only need the engine inputs.
+		void setPlaceholderProgram(SharedPointer<Program> const& program);
+		SharedPointer<Program> const& placeholderProgram() const;
+
 		void loadShader(Shader& shader, std::string& log);
+		// compileShader starts the compilation, shaderStatus waits for it and returns the log
+		void compileShader(Shader& shader);
+		Bool shaderStatus(Shader& shader, std::string& log);
 		void unloadShader(Shader& shader);
 		void unloadProgram(Program& program);
 		void linkProgram(Program& program, std::string& log);
+		// linkProgram in two steps, startLink does not wait for the driver
+		void startLink(Program& program);
+		Bool linkStatus(Program& program, std::string& log);
+		// Description
+		//	Links the program from the shader_cache_directory binaries.
+		//	Returns false when there is no binary for its sources and driver, or the driver rejects it.
+		Bool loadProgramBinary(Program& program);
+		// stores the binary of a linked program
+		void saveProgramBinary(Program& program);
 		void updateUniforms(Program& program);
 		void displayShaderLog(Shader& shader, std::stringstream& shader_log, std::string& info);
 		void displayProgramLog(Program& program, std::string const& log);
@@ -207,6 +296,10 @@ namespace rengine
 		std::string shadingLanguageVersion() const;
 
 		Bool limitedToOpenGL21() const;
+		// true when linked programs can be read back and cached, GL 4.1 or ARB_get_program_binary
+		Bool supportsProgramBinary() const;
+		// true with KHR_parallel_shader_compile or ARB_parallel_shader_compile
+		Bool supportsParallelShaderCompile() const;
 	private:
 		RenderEngine(RenderEngine const& copy);
 
@@ -82,6 +82,12 @@ namespace rengine
 		//
 		static SharedPointer<VideoCapture> create();
 
+		//
+		// Creates a VideoCapture for location,
+		// recorded files and image directories are replayed by VideoCaptureFile
+		//
+		static SharedPointer<VideoCapture> create(std::string const& location);
+
 		CaptureOptions const& captureOptions() const;
 
 		virtual Devices enumerateDevices() const;
@@ -0,0 +1,112 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_CAPTURE_FILE_H__
+#define __RENGINE_CAPTURE_FILE_H__
+
+#include <rengine/capture/VideoCapture.h>
+#include <rengine/time/Timer.h>
+
+namespace rengine
+{
+	//
+	// Fake capture device that replays recorded data.
+	//
+	// The device location is one of :
+	//	- a directory of images (bmp, png, tga, jpg, psd), replayed in name order as "RGB3"
+	//	- a raw YUYV/YUY2 dump (.yuyv, .yuy2), replayed as "YUYV"
+	//	  frame size is parsed from the file name (capture_640x480.yuyv) or taken from the capture options
+	//	- a MJPEG dump (.mjpg, .mjpeg), a sequence of concatenated jpeg images, replayed as "MJPG"
+	//
+	// Frames are decoded to RGB8 exactly like a physical device would do.
+	//
+	class VideoCaptureFile : public VideoCapture
+	{
+	public:
+		enum ReplayMode
+		{
+			ReplayRealTime,			// frames are delivered at the format frame interval
+			ReplayAsFastAsPossible	// every grab delivers a frame
+		};
+
+		VideoCaptureFile();
+		VideoCaptureFile(std::string const& location);
+		virtual ~VideoCaptureFile();
+
+		// checks if the location can be replayed by this device
+		static Bool supportsLocation(std::string const& location);
+
+		virtual Devices enumerateDevices() const;
+		virtual Formats enumerateFormats(Device const& device) const;
+
+		virtual void open(CaptureOptions const& capture_options);
+		virtual void close();
+		virtual Bool ready() const;
+
+		virtual SharedPointer<Frame> grab(FrameOptions const& options, SharedPointer<Frame> const& frame = 0);
+
+		// frame interval used when the capture options do not request one, defaults to 1/30
+		void setDefaultInterval(Uint const numerator, Uint const denominator);
+
+		void setReplayMode(ReplayMode const mode);
+		ReplayMode replayMode() const;
+
+		// when looping is disabled the device stops being ready after the last frame
+		void setLoop(Bool const loop);
+		Bool loop() const;
+
+		Uint numberOfFrames() const;
+		Uint64 framesDelivered() const;
+
+	private:
+		struct PrivateImplementation;
+
+		void readFrame(Uint const index, Frame& frame);
+
+		PrivateImplementation* implementation_;
+		std::string location_;
+		ReplayMode replay_mode_;
+		Bool loop_;
+		Bool streaming_;
+		Uint default_interval_numerator_;
+		Uint default_interval_denominator_;
+		Uint64 frames_delivered_;
+		Timer timer_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE void VideoCaptureFile::setDefaultInterval(Uint const numerator, Uint const denominator)
+	{
+		default_interval_numerator_ = numerator;
+		default_interval_denominator_ = denominator;
+	}
+
+	RENGINE_INLINE void VideoCaptureFile::setReplayMode(ReplayMode const mode)
+	{
+		replay_mode_ = mode;
+	}
+
+	RENGINE_INLINE VideoCaptureFile::ReplayMode VideoCaptureFile::replayMode() const
+	{
+		return replay_mode_;
+	}
+
+	RENGINE_INLINE void VideoCaptureFile::setLoop(Bool const loop)
+	{
+		loop_ = loop;
+	}
+
+	RENGINE_INLINE Bool VideoCaptureFile::loop() const
+	{
+		return loop_;
+	}
+
+	RENGINE_INLINE Uint64 VideoCaptureFile::framesDelivered() const
+	{
+		return frames_delivered_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_CAPTURE_FILE_H__
@@ -0,0 +1,89 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_DEFLATE_H__
+#define __RENGINE_DEFLATE_H__
+
+#include <rengine/lang/Lang.h>
+#include <rengine/file/Inflate.h>
+
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Raw deflate (RFC 1951) encoder.
+	//
+	// Matches are searched on hash chains over a 32k window, FastLevel takes the first good match (greedy)
+	// and BestLevel searches longer chains and defers a match by one byte when the next one is longer (lazy).
+	// Each block is written with dynamic, fixed or stored codes, whichever is smaller,
+	// so the output is never much larger than the input, see bound.
+	//
+	// A Deflater keeps its hash chains between calls, reuse it to avoid reallocating them.
+	//
+	class Deflater
+	{
+	public:
+		enum Level
+		{
+			StoreLevel	= 0,	// stored blocks, no compression
+			FastLevel	= 1,	// greedy matching on short chains
+			BestLevel	= 2		// lazy matching on long chains
+		};
+
+		enum Status
+		{
+			Success			= 0,
+			OutputOverflow	= 1		// destination too small
+		};
+
+		struct Symbol
+		{
+			Uint16 length;		// literal when distance is 0, otherwise match length
+			Uint16 distance;
+		};
+		typedef std::vector<Symbol> Symbols;
+
+		Deflater(Level const level = BestLevel);
+		~Deflater();
+
+		void setLevel(Level const level);
+		Level level() const;
+
+		//
+		// Encodes a complete stream.
+		// destination_size holds the capacity of destination and returns the number of bytes written.
+		//
+		Status deflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint const source_size);
+
+		// destination capacity that always holds the encoding of source_size bytes
+		static Uint bound(Uint const source_size);
+
+		// maps a zlib level [0, 9]
+		static Level levelFromZlib(Int const level);
+	private:
+		Level level_;
+		std::vector<Int32> head_;
+		std::vector<Int32> previous_;
+		Symbols symbols_;
+	};
+
+	// encodes with a temporary Deflater
+	Deflater::Status deflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint const source_size,
+							 Deflater::Level const level = Deflater::BestLevel);
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE void Deflater::setLevel(Level const level)
+	{
+		level_ = level;
+	}
+
+	RENGINE_INLINE Deflater::Level Deflater::level() const
+	{
+		return level_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_DEFLATE_H__
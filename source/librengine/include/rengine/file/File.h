@@ -21,6 +21,8 @@ namespace rengine
 	std::string getCurrentDirectory();
 
 	Uint64 fileSize(std::string const& filename);
+	// seconds since the epoch, with sub second precision where the platform has it, 0 when the file does not exist
+	Real64 fileModificationTime(std::string const& filename);
 	Bool fileExists(std::string const& filename);
 	FileType fileType(std::string const& filename);
 
@@ -0,0 +1,138 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_FILE_DATA_H__
+#define __RENGINE_FILE_DATA_H__
+
+#include <rengine/lang/Lang.h>
+#include <rengine/file/MappedFile.h>
+
+#include <cstring>
+
+namespace rengine
+{
+	// Description
+	//	Contents of a whole file, either owned bytes or a view of a memory mapping
+	struct FileData
+	{
+		typedef SharedArray<Uint8> SharedData;
+		typedef SharedPointer<MappedFile> SharedMapping;
+
+		FileData();
+
+		// Description
+		//	file bytes, the owned data or the view
+		Uint8 const* bytes() const;
+
+		// Description
+		//	true when the bytes are a view of a mapping
+		Bool isView() const;
+
+		SharedData data;
+		SharedMapping mapping;		// keeps the view valid after the file is closed
+		Uint8 const* view;
+		Uint size;
+	};
+
+	// Description
+	//	Sequential reader of a single file
+	class FileStream
+	{
+	public:
+		virtual ~FileStream();
+
+		// Description
+		//	copies up to size bytes, returns the number copied, 0 at the end of the file
+		virtual Uint read(void* buffer, Uint const size) = 0;
+
+		// Description
+		//	size of the file
+		virtual Uint size() const = 0;
+		virtual Uint position() const = 0;
+		virtual Bool eof() const = 0;
+
+		// Description
+		//	false when the file could not be read or is corrupted
+		virtual Bool good() const = 0;
+	};
+	typedef SharedPointer<FileStream> SharedFileStream;
+
+	// Description
+	//	Stream over the bytes of a FileData, the data is shared not copied
+	class MemoryFileStream : public FileStream
+	{
+	public:
+		MemoryFileStream(FileData const& data);
+
+		virtual Uint read(void* buffer, Uint const size);
+		virtual Uint size() const;
+		virtual Uint position() const;
+		virtual Bool eof() const;
+		virtual Bool good() const;
+	private:
+		FileData data_;
+		Uint position_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE FileData::FileData()
+		:view(0), size(0)
+	{
+	}
+
+	RENGINE_INLINE Uint8 const* FileData::bytes() const
+	{
+		return view ? view : data.get();
+	}
+
+	RENGINE_INLINE Bool FileData::isView() const
+	{
+		return (view != 0);
+	}
+
+	RENGINE_INLINE FileStream::~FileStream()
+	{
+	}
+
+	RENGINE_INLINE MemoryFileStream::MemoryFileStream(FileData const& data)
+		:data_(data), position_(0)
+	{
+	}
+
+	RENGINE_INLINE Uint MemoryFileStream::read(void* buffer, Uint const size)
+	{
+		Uint const count = (size < data_.size - position_) ? size : (data_.size - position_);
+
+		if (count)
+		{
+			memcpy(buffer, data_.bytes() + position_, count);
+			position_ += count;
+		}
+
+		return count;
+	}
+
+	RENGINE_INLINE Uint MemoryFileStream::size() const
+	{
+		return data_.size;
+	}
+
+	RENGINE_INLINE Uint MemoryFileStream::position() const
+	{
+		return position_;
+	}
+
+	RENGINE_INLINE Bool MemoryFileStream::eof() const
+	{
+		return (position_ == data_.size);
+	}
+
+	RENGINE_INLINE Bool MemoryFileStream::good() const
+	{
+		return true;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_FILE_DATA_H__
@@ -0,0 +1,56 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_FILE_WATCHER_H__
+#define __RENGINE_FILE_WATCHER_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Reports changes of disk files from a background thread.
+	//
+	// Linux uses inotify on the directories of the files, so files replaced by editors are seen.
+	// The other platforms, or a failed inotify, compare the modification time and size of the files periodically.
+	//
+	class FileWatcher
+	{
+	public:
+		typedef std::vector<std::string> Filenames;
+
+		FileWatcher();
+
+		// stops the thread
+		~FileWatcher();
+
+		// Description
+		//	Replaces the watched files, native filenames.
+		//	The thread starts with the first files.
+		void setFiles(Filenames const& filenames);
+		Filenames files() const;
+
+		// Description
+		//	files changed since the last call, each file once
+		Filenames changes();
+
+		// Description
+		//	true when the changes come from system notifications
+		Bool usesNotifications() const;
+
+		// Description
+		//	stops the thread, forgetting the files
+		void stop();
+	private:
+		FileWatcher(FileWatcher const& copy);
+		FileWatcher& operator=(FileWatcher const& copy);
+
+		class Implementation;
+		Implementation* implementation_;
+	};
+
+} // namespace rengine
+
+#endif //__RENGINE_FILE_WATCHER_H__
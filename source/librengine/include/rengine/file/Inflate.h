@@ -0,0 +1,98 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_INFLATE_H__
+#define __RENGINE_INFLATE_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Raw deflate (RFC 1951) decoder.
+	//
+	// Huffman codes are decoded with two level lookup tables, 10 root bits for literal/length codes
+	// and 8 for distance codes, longer codes continue in a sub table.
+	// Input is read through a 64 bit buffer refilled a word at a time, so a full length/distance pair
+	// is decoded with a single refill, and back references that do not overlap are copied 8 bytes at a time.
+	//
+	// An Inflater keeps its tables between calls, reuse it to avoid reallocating them.
+	//
+	class Inflater
+	{
+	public:
+		enum Status
+		{
+			Success			= 0,
+			OutputOverflow	= 1,	// destination too small
+			InputUnderflow	= 2,	// stream ended before the last block
+			InvalidData		= 3		// malformed stream
+		};
+
+		Inflater();
+		~Inflater();
+
+		//
+		// Decodes a complete stream.
+		// destination_size holds the capacity of destination and returns the number of bytes written,
+		// source_size holds the size of source and returns the number of bytes consumed.
+		//
+		Status inflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint& source_size);
+
+		struct HuffmanEntry
+		{
+			Uint16 value;	// literal, base value or sub table offset
+			Uint8 bits;		// code length
+			Uint8 op;		// kind in the high nibble, extra bits or sub table bits in the low nibble
+		};
+		typedef std::vector<HuffmanEntry> HuffmanTable;
+
+	private:
+		HuffmanTable literal_table_;
+		HuffmanTable distance_table_;
+		HuffmanTable code_length_table_;
+	};
+
+	// decodes with a temporary Inflater
+	Inflater::Status inflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint& source_size);
+
+	//
+	// Incremental raw deflate decoder.
+	//
+	// Compressed bytes are pulled from a Source in chunks and decoded into a 64k window that keeps the
+	// 32k history back references need, so memory use does not depend on the size of the stream.
+	//
+	class InflateStream
+	{
+	public:
+		class Source
+		{
+		public:
+			virtual ~Source() {}
+
+			// copies up to size compressed bytes to buffer, returns the number copied, 0 at the end of the input
+			virtual Uint read(Uint8* buffer, Uint const size) = 0;
+		};
+
+		// the source must outlive the stream
+		InflateStream(Source& source);
+		~InflateStream();
+
+		// decodes up to size bytes, returns the number copied, less than size at the end of the stream or on errors
+		Uint read(Uint8* destination, Uint const size);
+
+		// Success while decoding and at the end of the stream
+		Inflater::Status status() const;
+		Bool finished() const;
+	private:
+		InflateStream(InflateStream const& copy);
+		InflateStream& operator=(InflateStream const& copy);
+
+		struct Implementation;
+		Implementation* implementation_;
+	};
+
+} // namespace rengine
+
+#endif //__RENGINE_INFLATE_H__
@@ -0,0 +1,67 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_MAPPED_FILE_H__
+#define __RENGINE_MAPPED_FILE_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <string>
+
+namespace rengine
+{
+	//
+	// Read only memory mapping of a whole file.
+	// The bytes stay valid until the file is closed or the object destroyed.
+	//
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		MappedFile(std::string const& filename);
+		~MappedFile();
+
+		Bool open(std::string const& filename);
+		void close();
+
+		Bool isOpen() const;
+		Uint8 const* data() const;
+		Uint64 size() const;
+		std::string const& filename() const;
+	private:
+		MappedFile(MappedFile const& copy);
+		MappedFile& operator=(MappedFile const& copy);
+
+		std::string filename_;
+		Uint8 const* data_;
+		Uint64 size_;
+
+		struct Implementation;
+		Implementation* implementation_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Bool MappedFile::isOpen() const
+	{
+		return (data_ != 0);
+	}
+
+	RENGINE_INLINE Uint8 const* MappedFile::data() const
+	{
+		return data_;
+	}
+
+	RENGINE_INLINE Uint64 MappedFile::size() const
+	{
+		return size_;
+	}
+
+	RENGINE_INLINE std::string const& MappedFile::filename() const
+	{
+		return filename_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_MAPPED_FILE_H__
@@ -0,0 +1,64 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_RANDOM_ACCESS_FILE_H__
+#define __RENGINE_RANDOM_ACCESS_FILE_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <string>
+
+namespace rengine
+{
+	//
+	// Read only file with positional reads.
+	// read does not move a shared file position, it may be called concurrently from several threads.
+	//
+	class RandomAccessFile
+	{
+	public:
+		RandomAccessFile();
+		RandomAccessFile(std::string const& filename);
+		~RandomAccessFile();
+
+		Bool open(std::string const& filename);
+		void close();
+
+		Bool isOpen() const;
+		Uint64 size() const;
+		std::string const& filename() const;
+
+		// reads size bytes at offset, false if the file is shorter
+		Bool read(Uint64 const offset, void* destination, Uint const size) const;
+	private:
+		RandomAccessFile(RandomAccessFile const& copy);
+		RandomAccessFile& operator=(RandomAccessFile const& copy);
+
+		std::string filename_;
+		Uint64 size_;
+		Bool open_;
+
+		struct Implementation;
+		Implementation* implementation_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Bool RandomAccessFile::isOpen() const
+	{
+		return open_;
+	}
+
+	RENGINE_INLINE Uint64 RandomAccessFile::size() const
+	{
+		return size_;
+	}
+
+	RENGINE_INLINE std::string const& RandomAccessFile::filename() const
+	{
+		return filename_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_RANDOM_ACCESS_FILE_H__
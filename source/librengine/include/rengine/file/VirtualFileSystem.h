@@ -0,0 +1,224 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_VIRTUAL_FILE_SYSTEM_H__
+#define __RENGINE_VIRTUAL_FILE_SYSTEM_H__
+
+#include <rengine/file/File.h>
+#include <rengine/file/FileData.h>
+#include <rengine/file/Zip.h>
+#include <rengine/thread/Synchronization.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Filesystem made of mounted sources: disk directories, zip packs and in memory overlays.
+	//
+	// Every mount has a mount point, a unix style prefix of the virtual names it serves ("" serves every name),
+	// and a priority. A lookup tries the mounts that serve the name by descending priority, mounts with
+	// the same priority are tried from the last mounted, so a pack mounted over a directory overrides its files.
+	// Names are unix style, "." and ".." segments are resolved before the lookup.
+	//
+	// Lookups may run concurrently from several threads, mounting takes a write lock.
+	//
+	class VirtualFileSystem : public FileSystem
+	{
+	public:
+		// Description
+		//	Source of files, names are relative to the mount point
+		class Mount
+		{
+		public:
+			virtual ~Mount();
+
+			virtual FileType fileType(std::string const& filename) const = 0;
+			virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const = 0;
+
+			// Description
+			//	reads the whole file, returns false when it does not exist or can not be read
+			virtual Bool read(std::string const& filename, FileData& data) const = 0;
+
+			// Description
+			//	returns 0 when the file does not exist
+			virtual SharedFileStream openStream(std::string const& filename) const = 0;
+
+			// Description
+			//	disk file of a name, empty when the mount is not backed by disk files
+			virtual std::string nativeFilename(std::string const& filename) const;
+		};
+		typedef SharedPointer<Mount> SharedMount;
+
+		// Description
+		//	Files of a disk directory, an empty root uses the names as given, absolute or relative to the working directory
+		class DirectoryMount : public Mount
+		{
+		public:
+			DirectoryMount(std::string const& root = "");
+
+			std::string const& root() const;
+
+			virtual FileType fileType(std::string const& filename) const;
+			virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const;
+			virtual Bool read(std::string const& filename, FileData& data) const;
+			virtual SharedFileStream openStream(std::string const& filename) const;
+			virtual std::string nativeFilename(std::string const& filename) const;
+		private:
+			std::string path(std::string const& filename) const;
+			std::string root_;
+		};
+
+		// Description
+		//	Files of a zip archive
+		class ZipMount : public Mount
+		{
+		public:
+			typedef SharedPointer<Zip> SharedZip;
+
+			ZipMount(SharedZip const& zip);
+
+			Zip const& zip() const;
+
+			virtual FileType fileType(std::string const& filename) const;
+			virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const;
+			virtual Bool read(std::string const& filename, FileData& data) const;
+			virtual SharedFileStream openStream(std::string const& filename) const;
+		private:
+			SharedZip zip_;
+		};
+
+		// Description
+		//	Files kept in memory, used to override files without touching the disk
+		class MemoryMount : public Mount
+		{
+		public:
+			MemoryMount();
+
+			// Description
+			//	adds or replaces a file, the bytes are copied
+			void add(std::string const& filename, void const* data, Uint const size);
+			void add(std::string const& filename, std::string const& text);
+			Bool remove(std::string const& filename);
+			void clear();
+			Uint numberOfFiles() const;
+
+			virtual FileType fileType(std::string const& filename) const;
+			virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const;
+			virtual Bool read(std::string const& filename, FileData& data) const;
+			virtual SharedFileStream openStream(std::string const& filename) const;
+		private:
+			typedef std::map<std::string, FileData> Files;
+			Files files_;
+			mutable Mutex mutex_;
+		};
+		typedef SharedPointer<MemoryMount> SharedMemoryMount;
+
+		VirtualFileSystem();
+		virtual ~VirtualFileSystem();
+
+		// Description
+		//	mounts a source
+		// Arguments
+		//	mount_point - virtual directory served by the mount, "" for the root
+		//	priority - higher priorities are tried first
+		void mount(SharedMount const& mount, std::string const& mount_point = "", Int const priority = 0);
+
+		// Description
+		//	mounts a disk directory
+		SharedMount mountDirectory(std::string const& directory, std::string const& mount_point = "", Int const priority = 0);
+
+		// Description
+		//	mounts a zip archive, returns 0 when the archive can not be loaded
+		SharedMount mountZip(std::string const& filename, std::string const& mount_point = "", Int const priority = 0,
+							 Zip::AccessMode const mode = Zip::MappedAccess);
+
+		// Description
+		//	mounts an empty memory overlay
+		SharedMemoryMount mountMemory(std::string const& mount_point = "", Int const priority = 0);
+
+		Bool unmount(SharedMount const& mount);
+		void unmountAll();
+		Uint numberOfMounts() const;
+
+		// Description
+		//	Filesystem methods, the directory contents are merged from every mount
+		virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const;
+		virtual Bool fileExists(std::string const& filename) const;
+		virtual FileType fileType(std::string const& filename) const;
+
+		// Description
+		//	reads a whole file from the first mount that has it
+		Bool read(std::string const& filename, FileData& data) const;
+
+		// Description
+		//	reads a text file and converts it to the native line style, like readRawText
+		Bool readText(std::string const& filename, std::string& text) const;
+
+		// Description
+		//	opens a file for sequential reading, returns 0 when it does not exist
+		SharedFileStream openStream(std::string const& filename) const;
+
+		// Description
+		//	disk file that serves a name, empty when the name does not exist or is served from a pack or memory
+		std::string nativeFilename(std::string const& filename) const;
+
+		// Description
+		//	unix style name with "." and ".." segments resolved
+		static std::string normalize(std::string const& filename);
+	private:
+		VirtualFileSystem(VirtualFileSystem const& copy);
+		VirtualFileSystem& operator=(VirtualFileSystem const& copy);
+
+		struct MountPoint
+		{
+			SharedMount mount;
+			std::string prefix;		// normalized mount point, without the trailing slash
+			Int priority;
+		};
+		typedef std::vector<MountPoint> MountPoints;
+
+		// mounts serving the name, in lookup order, with the name relative to each mount
+		struct Match
+		{
+			SharedMount mount;
+			std::string filename;
+		};
+		typedef std::vector<Match> Matches;
+		Matches match(std::string const& filename) const;
+
+		MountPoints mount_points_;
+		mutable ReadWriteMutex mutex_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE VirtualFileSystem::Mount::~Mount()
+	{
+	}
+
+	RENGINE_INLINE std::string VirtualFileSystem::Mount::nativeFilename(std::string const& filename) const
+	{
+		return std::string();
+	}
+
+	RENGINE_INLINE std::string const& VirtualFileSystem::DirectoryMount::root() const
+	{
+		return root_;
+	}
+
+	RENGINE_INLINE Zip const& VirtualFileSystem::ZipMount::zip() const
+	{
+		return *zip_;
+	}
+
+	RENGINE_INLINE Bool VirtualFileSystem::fileExists(std::string const& filename) const
+	{
+		return (fileType(filename) != FileNotFound);
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_VIRTUAL_FILE_SYSTEM_H__
@@ -36,6 +36,12 @@ namespace rengine
 		Bool open(std::string const& filename, Mode mode = Read);
 		Bool save();
 
+		//
+		// Opens a document held in memory for reading,
+		// used with files read through the VirtualFileSystem.
+		//
+		Bool parse(std::string const& text);
+
 		Mode mode() const { return mode_; }
 
 		//
@@ -56,6 +62,8 @@ namespace rengine
 		void writeText(std::string const& text);
 		Uint nodeElementCount() const;
 	private:
+		Bool openRoot();
+
 		XmlArchiveData *data_;
 		Mode mode_;
 		std::string filename_;
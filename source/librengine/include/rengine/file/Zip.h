@@ -4,27 +4,68 @@
 #define __RENGINE_ZIP__
 
 #include <rengine/file/File.h>
+#include <rengine/file/FileData.h>
+#include <rengine/file/RandomAccessFile.h>
+#include <rengine/thread/Synchronization.h>
 #include <fstream>
-#include <map>
+#include <vector>
 
 namespace rengine
 {
 	// Description
 	//	Zip Filesystem with deflate/inflate compression support
+	//	The directory is immutable after load and entries are read with positional reads,
+	//	so the const methods may be called concurrently from several threads.
 	class Zip : public FileSystem
 	{
 	public:
+		enum AccessMode
+		{
+			StreamAccess,	// entries are read through a file stream into new buffers
+			MappedAccess	// the archive is memory mapped, stored entries are returned as views of the mapping
+		};
+
 		Zip();
-		Zip(std::string const filename);
+		Zip(std::string const filename, AccessMode const mode = StreamAccess);
 		virtual ~Zip();
 
 		typedef SharedArray<Uint8> SharedData;
+		typedef SharedPointer<MappedFile> SharedMapping;
+		typedef SharedPointer<RandomAccessFile> SharedFile;
+
+		typedef rengine::FileData FileData;
+		typedef std::vector<FileData> FileDataVector;
 
-		struct FileData
+		// Description
+		//	Sequential reader of a single entry, deflated entries are inflated incrementally
+		//	so memory use does not depend on the entry size.
+		//	A stream keeps the archive file open, it stays valid after the Zip is closed.
+		class Stream : public FileStream
 		{
-			SharedData data;
-			Uint size;
+		public:
+			virtual ~Stream();
+
+			virtual Uint read(void* buffer, Uint const size);
+
+			// Description
+			//	uncompressed size of the entry
+			virtual Uint size() const;
+			virtual Uint position() const;
+			virtual Bool eof() const;
+
+			// Description
+			//	false when the entry is corrupted, the crc is checked after the last byte is read
+			virtual Bool good() const;
+		private:
+			friend class Zip;
+			Stream();
+			Stream(Stream const& copy);
+			Stream& operator=(Stream const& copy);
+
+			struct Implementation;
+			Implementation* implementation_;
 		};
+		typedef SharedPointer<Stream> SharedStream;
 
 		// Description
 		//	Filesystem methods
@@ -34,7 +75,11 @@ namespace rengine
 
 		// Description
 		//	Load a Zip File from disk;
-		bool load(std::string const& filename);
+		bool load(std::string const& filename, AccessMode const mode = StreamAccess);
+
+		// Description
+		//	access mode of the loaded archive
+		AccessMode accessMode() const;
 
 		// Description
 		//	Closes the zip file
@@ -44,12 +89,37 @@ namespace rengine
 		//	reads a file from zip archive
 		// Arguments
 		//	filename - filename to read from archive
-		FileData read(std::string const& filename);
+		FileData read(std::string const& filename) const;
+
+		// Description
+		//	reads several files from the zip archive, entries are decompressed in parallel
+		// Arguments
+		//	filenames - filenames to read from archive, missing files return empty data
+		//	threads - worker threads, 0 uses the number of processors
+		FileDataVector readMany(std::vector<std::string> const& filenames, Uint const threads = 0) const;
+
+		// Description
+		//	opens a file of the zip archive for sequential reading
+		//	returns 0 when the file does not exist or its compression is not supported
+		SharedStream openStream(std::string const& filename) const;
 
 		// Description
 		//	zip filename getter
 		std::string const& GetFilename() const;
+
+		// Description
+		//	Counters of name lookups, every fileType, fileExists, read and openStream does one
+		struct Statistics
+		{
+			Uint64 lookups;
+			Uint64 misses;		// lookups of names that are not in the archive
+			Uint64 opens;		// entries read or opened as streams
+		};
+		Statistics statistics() const;
+		void resetStatistics();
 	private:
+		Zip(Zip const& copy);
+		Zip& operator=(Zip const& copy);
 		
 		static Int const max_filename_size = 2048;
 		static Int const max_extra_field_size = 100;
@@ -121,16 +191,52 @@ namespace rengine
 
 		std::string m_filename;
 		std::string m_current_directory;
-		std::ifstream file;
+		SharedFile m_file;
 
-		SharedData loadFile(Uint index, LocalFileHeader& local_header);
-		bool loadCentralDirectory();
-		bool loadEndOfCentralDirectory();
+		// offset of the entry data, after the local header
+		Bool locateEntry(Uint index, Uint64& start, Uint16& compression_method) const;
+		FileData readEntry(Uint index) const;
+		bool loadCentralDirectory(std::ifstream& file);
+		bool loadEndOfCentralDirectory(std::ifstream& file);
 		EndOfCentralDirectory m_end_of_central_directory;
 		CentralDirectoryVector m_central_directory;
 		
-		typedef std::map<std::string, Int> RecordMap; // name -> index
-		RecordMap m_records;
+		//
+		// Name index, built once in load.
+		// Every file and directory has a node, parent directories missing from the archive are added.
+		// Lookups probe an open addressing hash of the normalized names (unix style, no trailing slash, "" is the root)
+		// and the children of a directory are a range of m_children sorted by name.
+		//
+		struct Node
+		{
+			std::string name;
+			Uint32 hash;
+			Int entry;			// central directory index, -1 for directories without a record
+			Bool directory;
+			Uint first_child;
+			Uint children;
+		};
+		typedef std::vector<Node> Nodes;
+
+		static std::string normalizeName(std::string const& filename);
+		static Uint32 hashName(std::string const& name);
+		void buildIndex();
+		Int addNode(std::string const& name, Bool const directory);
+		void insertSlot(Uint const node);
+		Int findNormalizedNode(std::string const& name, Uint32 const hash) const;
+		// -1 when not found
+		Int findNode(std::string const& filename) const;
+
+		Nodes m_nodes;
+		std::vector<Uint> m_children;
+		std::vector<Int> m_slots;		// node index, -1 for empty slots
+
+		mutable Atomic m_lookups;
+		mutable Atomic m_misses;
+		mutable Atomic m_opens;
+
+		AccessMode m_access_mode;
+		SharedMapping m_mapping;
 	};
 
 	//
@@ -141,6 +247,11 @@ namespace rengine
 		return m_filename;
 	}
 
+	RENGINE_INLINE Zip::AccessMode Zip::accessMode() const
+	{
+		return m_access_mode;
+	}
+
 } // namespace rengine
 
 #endif //__RENGINE_ZIP__
@@ -0,0 +1,91 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_ZIP_WRITER__
+#define __RENGINE_ZIP_WRITER__
+
+#include <rengine/file/Deflate.h>
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	// Description
+	//	Creates zip archives readable by Zip
+	//	Entries are deflated, or stored when deflate does not make them smaller.
+	//	Parent directories of an entry are added automatically.
+	class ZipWriter
+	{
+	public:
+		ZipWriter();
+		ZipWriter(std::string const& filename);
+		~ZipWriter();
+
+		// Description
+		//	Creates the archive, an existing file is replaced
+		Bool open(std::string const& filename);
+
+		// Description
+		//	Writes the central directory and closes the archive
+		Bool close();
+
+		Bool isOpen() const;
+
+		// Description
+		//	adds a file to the archive
+		// Arguments
+		//	filename - name in the archive, unix style
+		//	level - StoreLevel writes the entry without compression
+		Bool add(std::string const& filename, void const* data, Uint const size, Deflater::Level const level = Deflater::BestLevel);
+
+		// Description
+		//	adds an empty directory to the archive
+		Bool addDirectory(std::string const& directory_name);
+
+		// Description
+		//	number of entries, directories included
+		Uint numberOfEntries() const;
+	private:
+		ZipWriter(ZipWriter const& copy);
+		ZipWriter& operator=(ZipWriter const& copy);
+
+		struct Entry
+		{
+			std::string filename;
+			Uint16 compression_method;
+			Uint32 crc;
+			Uint32 compressed_size;
+			Uint32 uncompressed_size;
+			Uint32 offset;
+		};
+		typedef std::vector<Entry> Entries;
+
+		Bool addEntry(std::string const& filename, Uint8 const* data, Uint const size, Deflater::Level const level);
+		void addParentDirectories(std::string const& filename);
+
+		std::ofstream m_file;
+		Entries m_entries;
+		std::set<std::string> m_names;
+		std::vector<Uint8> m_buffer;
+		Deflater m_deflater;
+		Bool m_good;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Bool ZipWriter::isOpen() const
+	{
+		return m_file.is_open();
+	}
+
+	RENGINE_INLINE Uint ZipWriter::numberOfEntries() const
+	{
+		return Uint(m_entries.size());
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_ZIP_WRITER__
@@ -4,6 +4,7 @@
 #define __RENGINE_COLORSPACE_H__
 
 #include <rengine/lang/Lang.h>
+#include <rengine/image/ImageView.h>
 
 namespace rengine
 {
@@ -17,9 +18,13 @@ namespace rengine
 	// Sane but slow
 	void convertYUYV_RGB8_Sane(Uchar* in, Uchar* out, Uint const& width, Uint const& height);
 	void convertYUYV_RGB8(Uchar* in, Uchar* out, Uint const& width, Uint const& height);
+	// in is a 2 channel view, out a 3 channel view of the same size
+	void convertYUYV_RGB8(ImageView const& in, ImageView const& out);
 
 	void convertBGR8_RGB8(Uchar* in, Uchar* out, Uint const& width, Uint const& height);
 	void convertBGR8_RGB8(Uchar* in_out, Uint const& width, Uint const& height);
+	// 3 channel views, in and out may be the same view
+	void convertBGR8_RGB8(ImageView const& in, ImageView const& out);
 
 } //namespace rengine
 
@@ -4,24 +4,42 @@
 #define __RENGINE_IMAGE_GFX____
 
 #include <string>
+#include <rengine/lang/Lang.h>
 #include <rengine/math/Vector.h>
+#include <rengine/image/ImageView.h>
 
 namespace rengine
 {
+	class Filter;
+
+	//
+	// Keeps alive pixels an image references without owning them
+	//
+	class ImageStorage
+	{
+	public:
+		virtual ~ImageStorage() {}
+	};
+	typedef SharedPointer<ImageStorage> SharedImageStorage;
+
 	class Image
 	{
 	public:
-		typedef Vector4<Uchar> Color;
+		typedef ImageView::Color Color;
 
 		enum FlipMode
 		{
-			FlipVertical,
-			FlipHorizontal
+			FlipVertical = ImageView::FlipVertical,
+			FlipHorizontal = ImageView::FlipHorizontal
 		};
 
 		Image();
 		Image(Uint const width, Uint const height, Uint const color_channels);
 		Image(Uint const width, Uint const height, Uint const color_channels, Uchar* data);
+		// references the data kept valid by the storage, the image never frees it
+		Image(Uint const width, Uint const height, Uint const color_channels, Uchar* data, SharedImageStorage const& storage);
+		// copies the view pixels
+		explicit Image(ImageView const& view);
 
 		~Image();
 
@@ -32,9 +50,17 @@ namespace rengine
 
 		Bool isLoaded() const;
 
+		// non owning views, valid while the image data is not reallocated
+		ImageView view() const;
+		ImageView view(Uint const x, Uint const y, Uint const view_width, Uint const view_height) const;
+
 		void applyColorKey(Color const&color);
 		void crop(Uint const x, Uint const y, Uint const crop_width, Uint const crop_height);
 		void downscale(Uint new_width, Uint new_height);
+
+		// filtered resize, up or down, uses a Mitchell filter when none is given
+		void resize(Uint const new_width, Uint const new_height);
+		void resize(Uint const new_width, Uint const new_height, Filter const& filter);
 		void flip(FlipMode mode);
 
 
@@ -97,6 +123,7 @@ namespace rengine
 		Uint color_channels;
 
 		Bool delete_on_destructor;
+		SharedImageStorage storage;
 	};
 
 } //namespace rengine
@@ -0,0 +1,124 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_IMAGE_RESAMPLER_H__
+#define __RENGINE_IMAGE_RESAMPLER_H__
+
+#include <rengine/image/Filter.h>
+#include <rengine/image/Image.h>
+#include <rengine/lang/Lang.h>
+
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Separable polyphase image resampler.
+	//
+	// For every output column and row a table of source taps and weights is built from the filter.
+	// When downscaling the filter support is stretched by the scale factor so every source pixel contributes,
+	// when upscaling the filter is used at its natural width.
+	// Images with 1 to 4 color channels are supported, pixels are processed as 4 float lanes (SSE2 when available).
+	// Rows are processed in parallel blocks.
+	//
+	// The filter must outlive the resampler.
+	//
+	class ImageResampler
+	{
+	public:
+		ImageResampler(Filter const& filter, Uint const samples = 8);
+		~ImageResampler();
+
+		// number of worker threads, 0 uses the number of processors
+		void setNumberOfThreads(Uint const threads);
+		Uint numberOfThreads() const;
+
+		// resamples the source pixels into the destination buffer, both with the same number of color channels
+		void resample(Uchar const* source, Uint const source_width, Uint const source_height,
+					  Uchar* destination, Uint const destination_width, Uint const destination_height,
+					  Uint const color_channels) const;
+
+		// resamples between views, both with the same number of color channels
+		void resample(ImageView const& source, ImageView const& destination) const;
+
+		// resamples float pixels, source and destination hold 4 floats per pixel
+		void resample(Real const* source, Uint const source_width, Uint const source_height,
+					  Real* destination, Uint const destination_width, Uint const destination_height) const;
+
+		// returns a new image with the requested size
+		SharedPointer<Image> resample(Image const& image, Uint const width, Uint const height) const;
+
+		//
+		// Weights for one axis, output sample i reads count(i) taps starting at first(i)
+		//
+		class Contributions
+		{
+		public:
+			Contributions();
+
+			void build(Filter const& filter, Uint const source_size, Uint const destination_size, Uint const samples);
+
+			Uint size() const;
+			Uint taps() const;
+
+			Uint first(Uint const index) const;
+			Uint count(Uint const index) const;
+			Real const* weights(Uint const index) const;
+
+		private:
+			Uint taps_;
+			std::vector<Uint> first_;
+			std::vector<Uint> count_;
+			std::vector<Real> weights_;
+		};
+
+	private:
+		void run(Uchar const* source, Uint const source_stride, Real const* source_lanes, Uint const source_width, Uint const source_height,
+				 Uchar* destination, Uint const destination_stride, Real* destination_lanes, Uint const destination_width, Uint const destination_height,
+				 Uint const color_channels) const;
+
+		Filter const& filter_;
+		Uint samples_;
+		Uint threads_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE void ImageResampler::setNumberOfThreads(Uint const threads)
+	{
+		threads_ = threads;
+	}
+
+	RENGINE_INLINE Uint ImageResampler::numberOfThreads() const
+	{
+		return threads_;
+	}
+
+	RENGINE_INLINE Uint ImageResampler::Contributions::size() const
+	{
+		return Uint(first_.size());
+	}
+
+	RENGINE_INLINE Uint ImageResampler::Contributions::taps() const
+	{
+		return taps_;
+	}
+
+	RENGINE_INLINE Uint ImageResampler::Contributions::first(Uint const index) const
+	{
+		return first_[index];
+	}
+
+	RENGINE_INLINE Uint ImageResampler::Contributions::count(Uint const index) const
+	{
+		return count_[index];
+	}
+
+	RENGINE_INLINE Real const* ImageResampler::Contributions::weights(Uint const index) const
+	{
+		return &weights_[index * taps_];
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_IMAGE_RESAMPLER_H__
@@ -5,6 +5,7 @@
 
 #include <rengine/image/Image.h>
 #include <rengine/state/Texture.h>
+#include <rengine/file/FileData.h>
 
 #include <rengine/resource/ResourceLoader.h>
 
@@ -14,14 +15,27 @@ namespace rengine
 	{
 	public:
 		virtual bool suportsFormat(std::string const& extension) const;
+		virtual Bool supportsConcurrentLoads() const;
+		virtual Uint64 resourceSize(Image const& image) const;
+		virtual Bool assign(Image& image, Image& reloaded);
 		virtual SharedPointer<Image> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
+
+		// Description
+		//	decodes an image file or a cooked image, the rows are top to bottom in both cases
+		static SharedPointer<Image> decode(FileData const& data);
 	};
 
 	class Texture2DResourceLoader : public ResourceLoader<Texture2D>
 	{
 	public:
 		virtual bool suportsFormat(std::string const& extension) const;
+		virtual Bool supportsConcurrentLoads() const;
+		virtual Uint64 resourceSize(Texture2D const& texture) const;
+		virtual Bool assign(Texture2D& texture, Texture2D& reloaded);
 		virtual SharedPointer<Texture2D> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
+
+		// uploads the texture
+		virtual void finalize(Texture2D& texture);
 	};
 
 } //namespace
@@ -0,0 +1,129 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_IMAGE_VIEW_H__
+#define __RENGINE_IMAGE_VIEW_H__
+
+#include <rengine/math/Vector.h>
+
+namespace rengine
+{
+	//
+	// Non owning window over 8 bit pixels.
+	//
+	// Rows are row_stride bytes apart, so a view can address a region of a larger image
+	// without copying. A stride of 0 means tightly packed rows.
+	// The viewed memory must outlive the view.
+	//
+	class ImageView
+	{
+	public:
+		typedef Vector4<Uchar> Color;
+
+		enum FlipMode
+		{
+			FlipVertical,
+			FlipHorizontal
+		};
+
+		ImageView();
+		ImageView(Uchar* data, Uint const width, Uint const height, Uint const color_channels, Uint const row_stride = 0);
+
+		Bool isValid() const;
+		// rows are tightly packed
+		Bool isContiguous() const;
+
+		Uchar* getData() const;
+		Uint getWidth() const;
+		Uint getHeight() const;
+		Uint getColorChannels() const;
+		Uint getRowStride() const;
+
+		Uchar* row(Uint const y) const;
+		Uchar* rawPixel(Uint const x, Uint const y) const;
+
+		// zero copy region, clipped to the view
+		ImageView subView(Uint const x, Uint const y, Uint const width, Uint const height) const;
+
+		//
+		// In place operations
+		//
+		void flip(FlipMode const mode) const;
+		// sets the alpha of pixels with the color rgb, only for 4 channel views
+		void applyColorKey(Color const& color) const;
+		void fill(Uchar const value) const;
+
+		//
+		// Copies into a destination of the same size.
+		// When the number of channels differ, gray is replicated to rgb, a missing alpha is set to 255
+		// and gray destinations take the first channel.
+		//
+		void copyTo(ImageView const& destination) const;
+
+	private:
+		Uchar* data_;
+		Uint width_;
+		Uint height_;
+		Uint color_channels_;
+		Uint row_stride_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE ImageView::ImageView()
+		:data_(0), width_(0), height_(0), color_channels_(0), row_stride_(0)
+	{}
+
+	RENGINE_INLINE ImageView::ImageView(Uchar* data, Uint const width, Uint const height, Uint const color_channels, Uint const row_stride)
+		:data_(data), width_(width), height_(height), color_channels_(color_channels),
+		 row_stride_((row_stride == 0) ? (width * color_channels) : row_stride)
+	{}
+
+	RENGINE_INLINE Bool ImageView::isValid() const
+	{
+		return (data_ != 0) && (width_ != 0) && (height_ != 0) && (color_channels_ != 0);
+	}
+
+	RENGINE_INLINE Bool ImageView::isContiguous() const
+	{
+		return (row_stride_ == width_ * color_channels_);
+	}
+
+	RENGINE_INLINE Uchar* ImageView::getData() const
+	{
+		return data_;
+	}
+
+	RENGINE_INLINE Uint ImageView::getWidth() const
+	{
+		return width_;
+	}
+
+	RENGINE_INLINE Uint ImageView::getHeight() const
+	{
+		return height_;
+	}
+
+	RENGINE_INLINE Uint ImageView::getColorChannels() const
+	{
+		return color_channels_;
+	}
+
+	RENGINE_INLINE Uint ImageView::getRowStride() const
+	{
+		return row_stride_;
+	}
+
+	RENGINE_INLINE Uchar* ImageView::row(Uint const y) const
+	{
+		return data_ + y * row_stride_;
+	}
+
+	RENGINE_INLINE Uchar* ImageView::rawPixel(Uint const x, Uint const y) const
+	{
+		return data_ + y * row_stride_ + x * color_channels_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_IMAGE_VIEW_H__
@@ -0,0 +1,105 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_MIPMAP_H__
+#define __RENGINE_MIPMAP_H__
+
+#include <rengine/image/Image.h>
+#include <rengine/image/Filter.h>
+#include <rengine/thread/Thread.h>
+#include <rengine/lang/Lang.h>
+
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Complete mipmap chain of an image, level 0 is the base image.
+	//
+	// Each level halves the previous one (rounded down, never below 1) and is resampled with a Filter
+	// from the previous level kept in floating point, so precision is not lost along the chain.
+	// With gamma correction the color channels of 3 and 4 channel images are treated as sRGB
+	// and filtered in linear space, alpha is always filtered linearly.
+	//
+	class MipmapChain
+	{
+	public:
+		typedef std::vector< SharedPointer<Image> > Levels;
+
+		MipmapChain();
+		~MipmapChain();
+
+		void build(SharedPointer<Image> const& base, Filter const& filter, Bool const gamma_correct = true);
+		// uses levels built elsewhere, a cooked chain for instance
+		void setLevels(Levels const& levels);
+		void clear();
+
+		Uint numberOfLevels() const;
+		SharedPointer<Image> const& level(Uint const index) const;
+		Levels const& levels() const;
+
+		// number of levels of a complete chain for the given size
+		static Uint numberOfLevels(Uint const width, Uint const height);
+	private:
+		Levels levels_;
+	};
+
+	//
+	// Builds a mipmap chain on a worker thread
+	//
+	class MipmapBuilder : public Thread
+	{
+	public:
+		// uses a box filter when no filter is given
+		MipmapBuilder(SharedPointer<Image> const& base, SharedPointer<Filter> const& filter = 0, Bool const gamma_correct = true);
+		virtual ~MipmapBuilder();
+
+		virtual void run();
+
+		// true once the chain is complete
+		Bool finished() const;
+		SharedPointer<MipmapChain> const& chain() const;
+
+	private:
+		SharedPointer<Image> base_;
+		SharedPointer<Filter> filter_;
+		Bool gamma_correct_;
+		SharedPointer<MipmapChain> chain_;
+		Atomic finished_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Uint MipmapChain::numberOfLevels() const
+	{
+		return Uint(levels_.size());
+	}
+
+	RENGINE_INLINE SharedPointer<Image> const& MipmapChain::level(Uint const index) const
+	{
+		return levels_[index];
+	}
+
+	RENGINE_INLINE MipmapChain::Levels const& MipmapChain::levels() const
+	{
+		return levels_;
+	}
+
+	RENGINE_INLINE void MipmapChain::setLevels(Levels const& levels)
+	{
+		levels_ = levels;
+	}
+
+	RENGINE_INLINE void MipmapChain::clear()
+	{
+		levels_.clear();
+	}
+
+	RENGINE_INLINE SharedPointer<MipmapChain> const& MipmapBuilder::chain() const
+	{
+		return chain_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_MIPMAP_H__
@@ -6,8 +6,10 @@
 #include <rengine/state/Texture.h>
 #include <rengine/geometry/BaseShapes.h>
 #include <rengine/state/FrameBuffer.h>
+#include <rengine/state/Program.h>
 #include <rengine/util/StringTable.h>
 #include <rengine/image/Filter.h>
+#include <rengine/image/ImageView.h>
 
 namespace rengine
 {
@@ -17,6 +19,12 @@ namespace rengine
 		typedef SharedPointer<Texture2D> Connection;
 		typedef std::vector<Connection> Connections;
 
+		enum Backend
+		{
+			GpuBackend,	// glsl passes on frame buffers
+			CpuBackend	// tiled, multi threaded passes on images
+		};
+
 		ImageProcessor();
 		virtual ~ImageProcessor();
 
@@ -35,9 +43,32 @@ namespace rengine
 		SharedPointer<Quadrilateral>const& quadrilateral() const;
 
 		virtual std::string effectFile() const;
+
+		//
+		// Point operations only read the pixel they write, consecutive ones are fused in a single pass.
+		// pointOperation returns glsl statements that transform the vec4 "color" in place,
+		// the uniforms they read are named prefix + name so fused stages do not clash.
+		// pointOperationUniforms adds those uniforms with their current values, they are set before each draw.
+		//
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
+		virtual void pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix = "") const;
+
+		//
+		// Cpu backend, does not need a render engine.
+		// Source and destination must have the same size and number of channels and must not overlap.
+		// The destination is processed in tiles spread over threads, threads = 0 uses the number of processors.
+		//
+		virtual void process(ImageView const& source, ImageView const& destination, Uint const threads = 0) const;
 	private:
 		ImageProcessor(ImageProcessor const& copy);
+		friend class ImageProcessorTiles;
+		friend class FusedImageProcessor;
 	protected:
+		// processes the destination region [x, x + width[ [y, y + height[, called concurrently for disjoint regions
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
+
 		Connections inputs_;
 		Connections outputs_;
 		SharedPointer<Quadrilateral> quadrilateral_;
@@ -56,26 +87,83 @@ namespace rengine
 
 		void addProcessingStage(ProcessingStage const& stage);
 
+		// consecutive point operations are drawn in one pass, on by default
+		void setStageFusion(Bool const fusion);
+		Bool stageFusion() const;
+
+		// passes drawn by the gpu backend, available after initialize
+		Uint numberOfPasses() const;
+
+		// with the cpu backend the input texture is read back, processed on the cpu and uploaded to the output
+		void setBackend(Backend const backend);
+		Backend backend() const;
+
+		// cpu backend worker threads, 0 uses the number of processors
+		void setNumberOfThreads(Uint const threads);
+		Uint numberOfThreads() const;
+
 		virtual void operator()(RenderEngine& render_engine);
 		virtual bool initialize();
+
+		// runs every stage on the cpu, source and destination channels may differ
+		virtual void process(ImageView const& source, ImageView const& destination, Uint const threads = 0) const;
+		SharedPointer<Image> process(Image const& image) const;
 	private:
+		void processOnCpu(RenderEngine& render_engine);
+		void buildPasses();
+
+		Backend backend_;
+		Uint threads_;
+		Bool fusion_;
 		DrawStates states;
 		ProcessingStages stages_;
-		ProcessingBuffer ping_;
-		ProcessingBuffer pong_;
-		SharedPointer<Texture2D> ping_texture_;
+		ProcessingStages passes_;
+		// intermediate passes draw on targets of the core engine render target pool
+		ProcessingBuffer output_buffer_;
+	};
+
+	//
+	// Runs a sequence of point operations in a single generated shader
+	//
+	class FusedImageProcessor : public ImageProcessor
+	{
+	public:
+		FusedImageProcessor(ProcessingChain::ProcessingStages const& stages);
+
+		virtual bool initialize();
+		virtual std::string effectFile() const;
+
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
+		virtual void pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix = "") const;
+
+		ProcessingChain::ProcessingStages const& stages() const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
+	private:
+		ProcessingChain::ProcessingStages stages_;
 	};
 
 	class CopyImageProcessor : public ImageProcessor
 	{
 	public:
 		virtual std::string effectFile() const;
+
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
 	};
 
 	class GrayscaleImageProcessor : public ImageProcessor
 	{
 	public:
 		virtual std::string effectFile() const;
+
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
 	};
 
 	class ThresholdImageProcessor : public ImageProcessor
@@ -84,7 +172,6 @@ namespace rengine
 		ThresholdImageProcessor();
 		ThresholdImageProcessor(Real const& threshold);
 
-		virtual bool initialize();
 		Real threshold() const;
 		void setThreshold(Real const& threshold);
 
@@ -92,6 +179,13 @@ namespace rengine
 		void setThresholdValue(Vector4D const& value);
 
 		virtual std::string effectFile() const;
+
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
+		virtual void pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix = "") const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
 	private:
 		Real threshold_;
 		Vector4D value_;
@@ -103,11 +197,17 @@ namespace rengine
 		BinarizationImageProcessor();
 		BinarizationImageProcessor(Real const& threshold);
 
-		virtual bool initialize();
 		Real threshold() const;
 		void setThreshold(Real const& threshold);
 
 		virtual std::string effectFile() const;
+
+		virtual Bool isPointOperation() const;
+		virtual std::string pointOperation(std::string const& prefix = "") const;
+		virtual void pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix = "") const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
 	private:
 		Real threshold_;
 		Vector4D value_;
@@ -121,6 +221,9 @@ namespace rengine
 		virtual bool initialize();
 
 		virtual std::string effectFile() const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
 	private:
 		SharedPointer<Kernel> kernel_;
 	};
@@ -133,6 +236,9 @@ namespace rengine
 		virtual bool initialize();
 
 		virtual std::string effectFile() const;
+	protected:
+		virtual void processRegion(ImageView const& source, ImageView const& destination,
+								   Uint const x, Uint const y, Uint const width, Uint const height) const;
 	private:
 		SharedPointer<Kernel> kernel0_;
 		SharedPointer<Kernel> kernel1_;
@@ -187,6 +293,52 @@ namespace rengine
 	}
 
 
+	//
+	// ProcessingChain
+	//
+	RENGINE_INLINE void ProcessingChain::setBackend(Backend const backend)
+	{
+		backend_ = backend;
+	}
+
+	RENGINE_INLINE ImageProcessor::Backend ProcessingChain::backend() const
+	{
+		return backend_;
+	}
+
+	RENGINE_INLINE void ProcessingChain::setNumberOfThreads(Uint const threads)
+	{
+		threads_ = threads;
+	}
+
+	RENGINE_INLINE Uint ProcessingChain::numberOfThreads() const
+	{
+		return threads_;
+	}
+
+	RENGINE_INLINE void ProcessingChain::setStageFusion(Bool const fusion)
+	{
+		fusion_ = fusion;
+	}
+
+	RENGINE_INLINE Bool ProcessingChain::stageFusion() const
+	{
+		return fusion_;
+	}
+
+	RENGINE_INLINE Uint ProcessingChain::numberOfPasses() const
+	{
+		return Uint(passes_.size());
+	}
+
+	//
+	// FusedImageProcessor
+	//
+	RENGINE_INLINE ProcessingChain::ProcessingStages const& FusedImageProcessor::stages() const
+	{
+		return stages_;
+	}
+
 	//
 	// ThresholdImageProcessor
 	//
@@ -41,6 +41,12 @@
 	#define RENGINE_ARCH_TYPE RENGINE_ARCHITECTURE_32
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define RENGINE_SIMD_SSE2 RENGINE_ON
+#else
+	#define RENGINE_SIMD_SSE2 RENGINE_OFF
+#endif
+
 
 #if RENGINE_COMPILER == RENGINE_COMPILER_MSVC
 	#if defined(_DEBUG) || !defined(NDEBUG)
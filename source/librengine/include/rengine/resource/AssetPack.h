@@ -0,0 +1,205 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_ASSET_PACK_H__
+#define __RENGINE_ASSET_PACK_H__
+
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/image/Image.h>
+#include <rengine/image/Mipmap.h>
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Pack of cooked assets written by rengineAssetCooker.
+	//
+	// Layout, little endian:
+	//	header	- "RPAK", version, number of entries, reserved, index offset (64 bit), index size (64 bit)
+	//	data	- entry payloads, each one aligned to 16 bytes
+	//	index	- per entry: type, name length, offset (64 bit), size (64 bit), name. Sorted by name.
+	//
+	// The pack is memory mapped and mounted in a VirtualFileSystem, entries are read as views of the mapping.
+	// Raw entries are plain files, shader programs are stored with their includes expanded.
+	// Image entries hold decoded pixels already flipped for OpenGL and their mipmap chain,
+	// font entries hold the baked atlas, see CookedFont. Loaders recognize both by their magic.
+	//
+	class AssetPack : public VirtualFileSystem::Mount
+	{
+	public:
+		enum EntryType
+		{
+			RawEntry	= 0,
+			ImageEntry	= 1,
+			FontEntry	= 2
+		};
+
+		enum ImageFlags
+		{
+			ImageFlipped		= 1,	// rows are bottom to top
+			ImagePowerOfTwo		= 2		// rescaled to power of two sizes
+		};
+
+		struct CookedImage
+		{
+			CookedImage();
+
+			SharedPointer<Image> image;
+			SharedPointer<MipmapChain> mipmaps;	// 0 when the image was cooked without mipmaps
+			Uint flags;
+		};
+
+		AssetPack();
+		AssetPack(std::string const& filename);
+		virtual ~AssetPack();
+
+		Bool open(std::string const& filename);
+		void close();
+
+		Bool isOpen() const;
+		Uint numberOfEntries() const;
+		std::string const& filename() const;
+
+		// Description
+		//	type of an entry, false when the pack does not have it
+		Bool entryType(std::string const& filename, EntryType& type) const;
+
+		virtual FileType fileType(std::string const& filename) const;
+		virtual DirectoryContents getDirectoryContents(std::string const& directory_name) const;
+		virtual Bool read(std::string const& filename, FileData& data) const;
+		virtual SharedFileStream openStream(std::string const& filename) const;
+
+		// Description
+		//	Cooked image payloads.
+		//	With reference_pixels the images point into the payload instead of copying it, the data is kept alive
+		//	by the images and their pixels must not be written, a mapped pack is read only.
+		static void encodeImage(Image const& image, MipmapChain const* mipmaps, Uint const flags, std::vector<Uint8>& out);
+		static Bool isCookedImage(FileData const& data);
+		static Bool decodeImage(FileData const& data, CookedImage& cooked, Bool const reference_pixels = false);
+
+		static Uint32 const magic = 0x4B415052;			// "RPAK"
+		static Uint32 const image_magic = 0x474D4952;	// "RIMG"
+		static Uint32 const version = 1;
+		static Uint const header_size = 32;
+		static Uint const alignment = 16;
+	private:
+		AssetPack(AssetPack const& copy);
+		AssetPack& operator=(AssetPack const& copy);
+
+		struct Entry
+		{
+			std::string name;
+			EntryType type;
+			Uint64 offset;
+			Uint64 size;
+
+			Bool operator<(Entry const& entry) const;
+		};
+		typedef std::vector<Entry> Entries;
+
+		// first entry not less than the name
+		Entries::const_iterator lowerBound(std::string const& name) const;
+		Entry const* find(std::string const& filename) const;
+
+		std::string filename_;
+		FileData::SharedMapping mapping_;
+		Entries entries_;
+	};
+	typedef SharedPointer<AssetPack> SharedAssetPack;
+
+	//
+	// Writes AssetPack files
+	//
+	class AssetPackWriter
+	{
+	public:
+		AssetPackWriter();
+		AssetPackWriter(std::string const& filename);
+		~AssetPackWriter();
+
+		// Description
+		//	Creates the pack, an existing file is replaced
+		Bool open(std::string const& filename);
+
+		// Description
+		//	Writes the index and closes the pack
+		Bool close();
+
+		Bool isOpen() const;
+
+		// Description
+		//	adds an entry, names are unix style with "." and ".." resolved
+		Bool add(std::string const& filename, AssetPack::EntryType const type, void const* data, Uint const size);
+
+		Uint numberOfEntries() const;
+	private:
+		AssetPackWriter(AssetPackWriter const& copy);
+		AssetPackWriter& operator=(AssetPackWriter const& copy);
+
+		struct Entry
+		{
+			std::string name;
+			Uint32 type;
+			Uint64 offset;
+			Uint64 size;
+
+			Bool operator<(Entry const& entry) const;
+		};
+		typedef std::vector<Entry> Entries;
+
+		std::ofstream file_;
+		Entries entries_;
+		std::set<std::string> names_;
+		Uint64 offset_;
+		Bool good_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE AssetPack::CookedImage::CookedImage()
+		:flags(0)
+	{
+	}
+
+	RENGINE_INLINE Bool AssetPack::isOpen() const
+	{
+		return (mapping_.get() != 0);
+	}
+
+	RENGINE_INLINE Uint AssetPack::numberOfEntries() const
+	{
+		return Uint(entries_.size());
+	}
+
+	RENGINE_INLINE std::string const& AssetPack::filename() const
+	{
+		return filename_;
+	}
+
+	RENGINE_INLINE Bool AssetPack::Entry::operator<(Entry const& entry) const
+	{
+		return (name < entry.name);
+	}
+
+	RENGINE_INLINE Bool AssetPackWriter::isOpen() const
+	{
+		return file_.is_open();
+	}
+
+	RENGINE_INLINE Uint AssetPackWriter::numberOfEntries() const
+	{
+		return Uint(entries_.size());
+	}
+
+	RENGINE_INLINE Bool AssetPackWriter::Entry::operator<(Entry const& entry) const
+	{
+		return (name < entry.name);
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_ASSET_PACK_H__
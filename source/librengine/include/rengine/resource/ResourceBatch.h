@@ -0,0 +1,205 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_RESOURCE_BATCH_H__
+#define __RENGINE_RESOURCE_BATCH_H__
+
+#include <rengine/resource/ResourceManager.h>
+#include <rengine/resource/ResourceManifest.h>
+
+#include <map>
+
+namespace rengine
+{
+	//
+	// Loads a set of resources ahead of their use, for load screens.
+	//
+	// The resources form a graph, a resource shared by several manifests is loaded once
+	// and a resource is only requested after its dependencies are loaded.
+	// Resources with no pending dependency are loaded in parallel by the ResourceManager workers,
+	// a failed resource fails the resources that depend on it.
+	// Dependencies only order the loads, a loaded dependency is not handed to the loaders of its dependents,
+	// a texture depending on an image of the same file still decodes the file itself.
+	//
+	// The batch is used from the render thread, progress is made while the engine finalizes asynchronous loads
+	// or by calling wait. It keeps the loaded resources referenced, so they are not evicted while it lives.
+	//
+	class ResourceBatch
+	{
+	public:
+		typedef ResourceManifest::Dependencies Dependencies;
+
+		enum State
+		{
+			Pending,	// waiting for start or for its dependencies
+			Loading,
+			Loaded,
+			Failed
+		};
+
+		ResourceBatch(ResourceManager& manager);
+
+		// cancels the requests still running
+		~ResourceBatch();
+
+		// Description
+		//	Maps a manifest type to a resource type.
+		//	image, texture, font and program are registered by default.
+		template<typename T>
+		void registerType(std::string const& type);
+
+		// Description
+		//	Adds a resource, adding it again merges the dependencies and keeps the highest priority.
+		//	Returns false when the type is not registered or the batch already started.
+		Bool add(std::string const& type, std::string const& location, Int const priority = 0, Dependencies const& dependencies = Dependencies());
+		Bool add(ResourceManifest const& manifest);
+
+		// Description
+		//	Requests every resource with no dependencies.
+		//	Returns false when dependencies are missing or circular, the resources involved fail and the others load.
+		Bool start();
+
+		// Description
+		//	Loads and finalizes the remaining resources on the calling thread.
+		//	Resources whose requests were cancelled, by a queue shutdown for instance, fail.
+		void wait();
+
+		Uint numberOfResources() const;
+		Uint numberOfLoaded() const;
+		Uint numberOfFailed() const;
+
+		// Description
+		//	done resources over the total, from 0 to 1
+		Real progress() const;
+		Bool done() const;
+
+		// Description
+		//	Pending when the resource is not in the batch
+		State state(std::string const& type, std::string const& location) const;
+
+		// Description
+		//	"type location" of every failed resource
+		std::vector<std::string> failures() const;
+	private:
+		ResourceBatch(ResourceBatch const& copy);
+		ResourceBatch& operator=(ResourceBatch const& copy);
+
+		typedef std::vector<Uint> Nodes;
+
+		struct Node
+		{
+			std::string type;
+			std::string location;
+			Int priority;
+			Dependencies dependencies;
+
+			State state;
+			Nodes dependents;
+			Uint pending_dependencies;
+			SharedResourceRequest request;
+		};
+
+		// a node request calls back the batch through this
+		class NodeHandler
+		{
+		public:
+			NodeHandler(ResourceBatch& batch, Uint const node) :batch_(batch), node_(node) {}
+			virtual ~NodeHandler() {}
+		protected:
+			void finished(Bool const loaded) { batch_.finished(node_, loaded); }
+		private:
+			ResourceBatch& batch_;
+			Uint node_;
+		};
+
+		template<typename T>
+		class TypedNodeHandler : public NodeHandler, public ResourceLoadHandler<T>
+		{
+		public:
+			TypedNodeHandler(ResourceBatch& batch, Uint const node) :NodeHandler(batch, node) {}
+			virtual void operator()(std::string const& location, SharedPointer<T> const& resource) { finished(resource.get() != 0); }
+		};
+
+		// requests the resources of a manifest type
+		class Type
+		{
+		public:
+			virtual ~Type() {}
+			virtual SharedResourceRequest request(ResourceBatch& batch, Uint const node) = 0;
+		};
+
+		template<typename T>
+		class TypedType : public Type
+		{
+		public:
+			virtual SharedResourceRequest request(ResourceBatch& batch, Uint const node);
+		};
+
+		typedef std::vector<Node> NodeList;
+		typedef std::vector< SharedPointer<NodeHandler> > Handlers;
+		typedef std::map<std::string, SharedPointer<Type> > Types;
+		typedef std::map<std::string, Uint> NodeIndex;	// "type location" to node
+
+		static std::string key(std::string const& type, std::string const& location);
+
+		void schedule(Uint const node);
+		void finished(Uint const node, Bool const loaded);
+		void fail(Uint const node);
+
+		ResourceManager& manager_;
+		NodeList nodes_;
+		NodeIndex node_index_;
+		Handlers handlers_;
+		Types types_;
+		Bool started_;
+		Uint loaded_;
+		Uint failed_;
+	};
+
+	//
+	// Implementation
+	//
+	template<typename T>
+	void ResourceBatch::registerType(std::string const& type)
+	{
+		types_[type] = new TypedType<T>();
+	}
+
+	template<typename T>
+	SharedResourceRequest ResourceBatch::TypedType<T>::request(ResourceBatch& batch, Uint const node)
+	{
+		TypedNodeHandler<T>* handler = new TypedNodeHandler<T>(batch, node);
+		batch.handlers_.push_back(SharedPointer<NodeHandler>(handler));
+
+		Node const& current = batch.nodes_[node];
+		SharedPointer< AsyncResource<T> > request = batch.manager_.loadAsync<T>(current.location, current.priority, handler);
+		return request;
+	}
+
+	RENGINE_INLINE Uint ResourceBatch::numberOfResources() const
+	{
+		return Uint(nodes_.size());
+	}
+
+	RENGINE_INLINE Uint ResourceBatch::numberOfLoaded() const
+	{
+		return loaded_;
+	}
+
+	RENGINE_INLINE Uint ResourceBatch::numberOfFailed() const
+	{
+		return failed_;
+	}
+
+	RENGINE_INLINE Bool ResourceBatch::done() const
+	{
+		return (loaded_ + failed_ == nodes_.size());
+	}
+
+	RENGINE_INLINE Real ResourceBatch::progress() const
+	{
+		return nodes_.empty() ? 1.0f : Real(loaded_ + failed_) / Real(nodes_.size());
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_RESOURCE_BATCH_H__
@@ -0,0 +1,176 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_RESOURCE_LOAD_QUEUE_H__
+#define __RENGINE_RESOURCE_LOAD_QUEUE_H__
+
+#include <rengine/lang/Lang.h>
+#include <rengine/thread/Synchronization.h>
+
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Asynchronous resource request, see ResourceManager::loadAsync
+	//
+	// load runs on a worker thread, finalize and notify run on the render thread.
+	//
+	class ResourceRequest
+	{
+	public:
+		enum State
+		{
+			Queued		= 0,
+			Loading		= 1,
+			Finalizing	= 2,	// loaded, waiting for the render thread
+			Loaded		= 3,
+			Failed		= 4,
+			Cancelled	= 5
+		};
+
+		ResourceRequest(std::string const& location, Int const priority);
+		virtual ~ResourceRequest();
+
+		std::string const& location() const;
+		Int priority() const;
+
+		State state() const;
+
+		// Description
+		//	Loaded, Failed or Cancelled
+		Bool done() const;
+
+		// Description
+		//	A queued request is dropped, a request already loading completes without notifying.
+		//	Has no effect on a finished request.
+		void cancel();
+	protected:
+		// Description
+		//	worker thread, returns false when the resource can not be loaded
+		virtual Bool load() = 0;
+
+		// Description
+		//	render thread, gpu work of a loaded resource
+		virtual void finalize() = 0;
+
+		// Description
+		//	render thread, called once the request is done, unless it was cancelled
+		virtual void notify() = 0;
+	private:
+		ResourceRequest(ResourceRequest const& copy);
+		ResourceRequest& operator=(ResourceRequest const& copy);
+
+		friend class ResourceLoadQueue;
+		friend struct ResourceRequestOrder;
+
+		std::string location_;
+		Int priority_;
+		Uint64 sequence_;
+		mutable Atomic state_;
+		mutable Atomic cancelled_;
+	};
+	typedef SharedPointer<ResourceRequest> SharedResourceRequest;
+
+	//
+	// Runs resource requests on worker threads.
+	//
+	// Requests are loaded by descending priority, requests with the same priority in the order they were pushed.
+	// Loaded requests wait for finalize, called once per frame by the engine with a time budget,
+	// so texture uploads and shader compiles are spread over several frames instead of stalling one.
+	//
+	class ResourceLoadQueue
+	{
+	public:
+		ResourceLoadQueue();
+		~ResourceLoadQueue();
+
+		// Description
+		//	Number of worker threads, applied when the workers start.
+		//	0 uses the number of processors minus one, with at least one worker.
+		void setNumberOfWorkers(Uint const workers);
+		Uint numberOfWorkers() const;
+
+		// Description
+		//	queues a request, the workers start on the first one
+		void push(SharedResourceRequest const& request);
+
+		// Description
+		//	Finalizes loaded requests on the calling thread until the budget is spent.
+		//	At least one request is finalized per call, so loads always progress.
+		//	Returns the number of requests finalized.
+		Uint finalize(Real64 const budget_seconds);
+
+		// Description
+		//	Waits for every request and finalizes them on the calling thread
+		void flush();
+
+		// Description
+		//	requests queued, loading or waiting to be finalized
+		Uint numberOfPendingRequests() const;
+
+		// Description
+		//	cancels the pending requests and stops the workers
+		void shutdown();
+	private:
+		ResourceLoadQueue(ResourceLoadQueue const& copy);
+		ResourceLoadQueue& operator=(ResourceLoadQueue const& copy);
+
+		class Worker;
+		friend class Worker;
+		typedef std::vector<SharedResourceRequest> Requests;
+		typedef std::vector<Worker*> Workers;
+
+		void startWorkers();
+		void stopWorkers();
+
+		// worker loop, returns 0 when the queue is stopping
+		SharedResourceRequest take();
+		void loaded(SharedResourceRequest const& request, Bool const succeeded);
+
+		Requests queued_;		// heap ordered by ResourceRequestOrder
+		Requests finalizing_;	// heap ordered by ResourceRequestOrder
+		Uint loading_;
+		Uint64 sequence_;
+		Bool stopping_;
+
+		Uint number_of_workers_;
+		Workers workers_;
+
+		mutable Mutex mutex_;
+		Condition work_condition_;
+		Condition loaded_condition_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE std::string const& ResourceRequest::location() const
+	{
+		return location_;
+	}
+
+	RENGINE_INLINE Int ResourceRequest::priority() const
+	{
+		return priority_;
+	}
+
+	RENGINE_INLINE ResourceRequest::State ResourceRequest::state() const
+	{
+		State const state = State(Int64(state_));
+		return ((state < Loaded) && (Int64(cancelled_) != 0)) ? Cancelled : state;
+	}
+
+	RENGINE_INLINE Bool ResourceRequest::done() const
+	{
+		return (state() >= Loaded);
+	}
+
+	RENGINE_INLINE Uint ResourceLoadQueue::numberOfWorkers() const
+	{
+		return number_of_workers_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_RESOURCE_LOAD_QUEUE_H__
@@ -5,10 +5,14 @@
 
 #include <rengine/lang/Lang.h>
 #include <rengine/util/OpaqueProperty.h>
-#include <map>
+#include <rengine/util/HashMap.h>
+#include <rengine/thread/Synchronization.h>
+#include <rengine/resource/ResourceLoadQueue.h>
 
 namespace rengine
 {
+	class VirtualFileSystem;
+
 	class BaseResourceLoader
 	{
 	public:
@@ -24,10 +28,24 @@ namespace rengine
 		{
 			std::string name;
 			SizeType request_count;
+			Uint64 size;
 		};
 
 		typedef std::vector<CacheItemInfo> ResourceLoaderInfo;
 
+		// a cached resource referenced only by the cache
+		struct EvictionCandidate
+		{
+			BaseResourceLoader* loader;
+			std::string location;
+			Uint64 size;
+			Uint64 last_use;
+		};
+
+		typedef std::vector<EvictionCandidate> EvictionCandidates;
+
+		typedef std::vector<std::string> Locations;
+
 		BaseResourceLoader();
 		virtual ~BaseResourceLoader();
 
@@ -48,10 +66,52 @@ namespace rengine
 		virtual std::type_info const& resourceTypeinfo() const = 0;
 
 		virtual ResourceLoaderInfo loaderInfo() const = 0;
+
+		// Description
+		//	bytes of the cached resources, as reported by resourceSize
+		virtual Uint64 cachedBytes() const = 0;
+
+		// Description
+		//	appends the cached resources nothing else references
+		virtual void evictionCandidates(EvictionCandidates& candidates) const = 0;
+
+		// Description
+		//	Removes a resource from the cache if nothing else references it.
+		//	Returns the bytes released, 0 when the resource is not evicted.
+		virtual Uint64 evict(std::string const& location) = 0;
+
+		// Description
+		//	changes every time a resource enters or leaves the cache
+		virtual Uint64 cacheGeneration() const = 0;
+
+		// Description
+		//	Files a resource is made of, the resource is reloaded when one of them changes.
+		//	The default is the location itself.
+		virtual void sourceFiles(std::string const& location, Locations& files) const;
+
+		// Description
+		//	Request that loads a cached resource again on a worker thread and swaps it in once finalized.
+		//	Returns 0 when the resource is not cached.
+		virtual SharedResourceRequest reload(std::string const& location) = 0;
+
+		// Description
+		//	loaders with no state of their own may run loadImplementation from several threads at once,
+		//	the others are serialized. The cache is always safe to use from any thread.
+		virtual Bool supportsConcurrentLoads() const;
+
+		// Description
+		//	filesystem the resources are read from, the engine one or the disk when there is no engine
+		static VirtualFileSystem const& fileSystem();
+	protected:
+		// Description
+		//	increasing use stamp, shared by every loader so the least recently used resources can be compared
+		static Uint64 nextUse();
 	private:
 		CacheOption cache_option;
 	};
 
+	template<typename T> class ResourceReload;
+
 	//
 	// ResourceLoader
 	//
@@ -69,9 +129,15 @@ namespace rengine
 			SharedPointer<ResourceType> resource;
 			SizeType request_count;
 			std::string location;
+			Uint64 size;
+			Uint64 last_use;
+			OpaqueProperties options;
 		};
 
-		typedef std::map<std::string, CacheItem> ResourceCache;
+		typedef HashMap<std::string, CacheItem> ResourceCache;
+
+		// reverse index of the cache, finds the location of a resource without scanning the cache
+		typedef HashMap<ResourceType const*, typename ResourceCache::iterator> ResourceIndex;
 
 		ResourceLoader();
 		virtual ~ResourceLoader();
@@ -87,15 +153,51 @@ namespace rengine
 
 		virtual ResourceLoaderInfo loaderInfo() const;
 
+		virtual Uint64 cachedBytes() const;
+		virtual void evictionCandidates(EvictionCandidates& candidates) const;
+		virtual Uint64 evict(std::string const& location);
+		virtual Uint64 cacheGeneration() const;
+		virtual SharedResourceRequest reload(std::string const& location);
+
+		// Description
+		//	Moves a reloaded resource into the cached one, so the existing holders see the new data.
+		//	Returns false when the type can not be updated in place, the cache then serves the reloaded
+		//	resource to new requests and the existing holders keep the old one. The default returns false.
+		virtual Bool assign(ResourceType& resource, ResourceType& reloaded);
+
+		// Description
+		//	bytes held by a resource, used by the memory budget of the ResourceManager.
+		//	The default is the size of the type, loaders of large resources report their data.
+		virtual Uint64 resourceSize(ResourceType const& resource) const;
+
 		virtual SharedPointer<ResourceType> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties()) = 0;
 
 		SharedPointer<ResourceType> load(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
 
+		// Description
+		//	Work that needs the render thread, called by asynchronous loads once the resource is loaded.
+		//	Texture uploads and shader compiles for instance, the default does nothing.
+		virtual void finalize(ResourceType& resource);
 
-		CacheItem const& getCacheItem(ResourceType const * const resource) const;
-		CacheItem const& getCacheItem(std::string const& location) const;
+		// Description
+		//	Copy of the cache entry, taken under the lock since other threads may evict or reload it.
+		//	Returns an empty item, with no resource, when it is not cached.
+		CacheItem getCacheItem(ResourceType const * const resource) const;
+		CacheItem getCacheItem(std::string const& location) const;
 	private:
+		friend class ResourceReload<T>;
+
+		// worker side of a reload, 0 when the resource is no longer cached or fails to load
+		SharedPointer<ResourceType> loadAgain(std::string const& location);
+		// render thread side of a reload
+		void swapReloaded(std::string const& location, SharedPointer<ResourceType> const& reloaded);
+
 		ResourceCache cache;
+		ResourceIndex cache_index;
+		Uint64 cache_bytes;
+		Uint64 cache_generation;
+		mutable Mutex cache_mutex;
+		Mutex load_mutex;
 	};
 
 	//
@@ -121,12 +223,50 @@ namespace rengine
 		cache_option = option;
 	}
 
+	RENGINE_INLINE Bool BaseResourceLoader::supportsConcurrentLoads() const
+	{
+		return false;
+	}
+
 	//
 	// Resource Loader
 	//
 
+	//
+	// Reload of a cached resource, see BaseResourceLoader::reload
+	//
+	template<typename T>
+	class ResourceReload : public ResourceRequest
+	{
+	public:
+		ResourceReload(ResourceLoader<T>& loader, std::string const& location)
+			:ResourceRequest(location, 0), loader_(loader)
+		{
+		}
+	protected:
+		virtual Bool load()
+		{
+			reloaded_ = loader_.loadAgain(location());
+			return (reloaded_.get() != 0);
+		}
+
+		virtual void finalize()
+		{
+			loader_.swapReloaded(location(), reloaded_);
+			reloaded_ = 0;
+		}
+
+		virtual void notify()
+		{
+		}
+	private:
+		ResourceLoader<T>& loader_;
+		SharedPointer<T> reloaded_;
+	};
+
 	template<typename T>
 	ResourceLoader<T>::ResourceLoader()
+		:cache_bytes(0), cache_generation(0)
 	{
 	}
 
@@ -137,7 +277,7 @@ namespace rengine
 
 	template<typename T>
 	ResourceLoader<T>::CacheItem::CacheItem() :
-		resource(0), request_count(0)
+		resource(0), request_count(0), size(0), last_use(0)
 	{
 	}
 
@@ -150,6 +290,7 @@ namespace rengine
 	template<typename T>
 	BaseResourceLoader::ResourceLoaderInfo ResourceLoader<T>::loaderInfo() const
 	{
+		ScopedLock lock(cache_mutex);
 		ResourceLoaderInfo info;
 
 		for (typename ResourceCache::const_iterator i = cache.begin(); i != cache.end(); ++i)
@@ -157,6 +298,7 @@ namespace rengine
 			CacheItemInfo item;
 			item.name = i->first;
 			item.request_count = i->second.request_count;
+			item.size = i->second.size;
 
 			info.push_back(item);
 		}
@@ -169,16 +311,30 @@ namespace rengine
 	{
 		SharedPointer<T> resource;
 
-		if ((getCacheOption() == CacheResources) && isResourceCached(location))
+		if (getCacheOption() == CacheResources)
 		{
-			CacheItem& cache_item = cache[location];
-			cache_item.request_count++;
-			resource = cache_item.resource;
+			ScopedLock lock(cache_mutex);
 
+			typename ResourceCache::iterator found = cache.find(location);
+			if (found != cache.end())
+			{
+				found->second.request_count++;
+				found->second.last_use = nextUse();
+				return found->second.resource;
+			}
 		}
-		else if (canLoadResourceFromLocation(location))
+
+		if (canLoadResourceFromLocation(location))
 		{
-			resource = loadImplementation(location, options);
+			if (supportsConcurrentLoads())
+			{
+				resource = loadImplementation(location, options);
+			}
+			else
+			{
+				ScopedLock lock(load_mutex);
+				resource = loadImplementation(location, options);
+			}
 
 			Bool do_cache = (getCacheOption() == CacheResources);
 			if (options.hasProperty("cache_option"))
@@ -189,79 +345,259 @@ namespace rengine
 
 			if (resource.get() && do_cache)
 			{
+				ScopedLock lock(cache_mutex);
+
+				// another thread may have loaded the same location meanwhile, the first one is kept
+				typename ResourceCache::iterator found = cache.find(location);
+				if (found != cache.end())
+				{
+					found->second.request_count++;
+					found->second.last_use = nextUse();
+					return found->second.resource;
+				}
+
 				CacheItem cache_item;
 				cache_item.request_count = 1;
 				cache_item.resource = resource;
 				cache_item.location = location;
-
-				cache[location] = cache_item;
+				cache_item.size = resourceSize(*resource);
+				cache_item.last_use = nextUse();
+				cache_item.options = options;
+				cache_bytes += cache_item.size;
+				cache_generation++;
+
+				typename ResourceCache::iterator inserted = cache.insert(typename ResourceCache::value_type(location, cache_item)).first;
+				cache_index[resource.get()] = inserted;
 			}
 		}
 
 		return resource;
 	}
 
+	template<typename T>
+	void ResourceLoader<T>::finalize(ResourceType& resource)
+	{
+	}
+
 	template<typename T>
 	typename ResourceLoader<T>::SizeType ResourceLoader<T>::numberOfCachedResources() const
 	{
+		ScopedLock lock(cache_mutex);
 		return cache.size();
 	}
 
 	template<typename T>
 	void ResourceLoader<T>::clearCachedResources()
 	{
+		ScopedLock lock(cache_mutex);
+		cache_index.clear();
 		cache.clear();
+		cache_bytes = 0;
+		cache_generation++;
 	}
 
 	template<typename T>
-	Bool ResourceLoader<T>::isResourceCached(std::string const& resource_location) const
+	Uint64 ResourceLoader<T>::cachedBytes() const
 	{
-		return (cache.find(resource_location) != cache.end());
+		ScopedLock lock(cache_mutex);
+		return cache_bytes;
 	}
 
 	template<typename T>
-	Bool ResourceLoader<T>::isResourceCached(ResourceType const * const resource) const
+	void ResourceLoader<T>::evictionCandidates(EvictionCandidates& candidates) const
 	{
-		Bool found = false;
+		ScopedLock lock(cache_mutex);
 
-		for (typename ResourceCache::const_iterator i = cache.begin();
-			 (i != cache.end()) && !found;
-			 ++i)
+		for (typename ResourceCache::const_iterator i = cache.begin(); i != cache.end(); ++i)
 		{
-			if (i->second.resource.get() == resource)
+			if (i->second.resource.referenceCount() == 1)
 			{
-				found = true;
+				EvictionCandidate candidate;
+				candidate.loader = const_cast<ResourceLoader<T>*>(this);
+				candidate.location = i->first;
+				candidate.size = i->second.size;
+				candidate.last_use = i->second.last_use;
+
+				candidates.push_back(candidate);
 			}
 		}
+	}
+
+	template<typename T>
+	Uint64 ResourceLoader<T>::evict(std::string const& location)
+	{
+		SharedPointer<ResourceType> evicted;
+		Uint64 size = 0;
+
+		{
+			ScopedLock lock(cache_mutex);
 
-		return found;
+			// the resource may have been requested again since it was a candidate
+			typename ResourceCache::iterator found = cache.find(location);
+			if ((found == cache.end()) || (found->second.resource.referenceCount() != 1))
+			{
+				return 0;
+			}
+
+			evicted = found->second.resource;
+			size = found->second.size;
+
+			cache_index.erase(evicted.get());
+			cache.erase(found);
+			cache_bytes -= size;
+			cache_generation++;
+		}
+
+		// the resource is destroyed here, outside the lock
+		return size;
 	}
 
 	template<typename T>
-	typename ResourceLoader<T>::CacheItem const& ResourceLoader<T>::getCacheItem(ResourceType const * const resource) const
+	Uint64 ResourceLoader<T>::cacheGeneration() const
 	{
-		Bool found = false;
-		CacheItem const * item = 0;
+		ScopedLock lock(cache_mutex);
+		return cache_generation;
+	}
 
-		for (typename ResourceCache::const_iterator i = cache.begin();
-			 (i != cache.end()) && !found;
-			 ++i)
+	template<typename T>
+	SharedResourceRequest ResourceLoader<T>::reload(std::string const& location)
+	{
+		SharedResourceRequest request;
+
+		if (isResourceCached(location))
+		{
+			request = new ResourceReload<T>(*this, location);
+		}
+
+		return request;
+	}
+
+	template<typename T>
+	Bool ResourceLoader<T>::assign(ResourceType& resource, ResourceType& reloaded)
+	{
+		return false;
+	}
+
+	template<typename T>
+	SharedPointer<T> ResourceLoader<T>::loadAgain(std::string const& location)
+	{
+		OpaqueProperties options;
+		{
+			ScopedLock lock(cache_mutex);
+
+			typename ResourceCache::const_iterator found = cache.find(location);
+			if (found == cache.end())
+			{
+				return SharedPointer<T>();
+			}
+
+			options = found->second.options;
+		}
+
+		if (supportsConcurrentLoads())
 		{
-			if (i->second.resource.get() == resource)
+			return loadImplementation(location, options);
+		}
+
+		ScopedLock lock(load_mutex);
+		return loadImplementation(location, options);
+	}
+
+	template<typename T>
+	void ResourceLoader<T>::swapReloaded(std::string const& location, SharedPointer<T> const& reloaded)
+	{
+		SharedPointer<T> resource;
+		{
+			ScopedLock lock(cache_mutex);
+
+			typename ResourceCache::iterator found = cache.find(location);
+			if (found == cache.end())
 			{
-				found = true;
-				item = &(i->second);
+				return;
 			}
+
+			resource = found->second.resource;
+		}
+
+		// holders of the cached resource see the change
+		if (assign(*resource, *reloaded))
+		{
+			finalize(*resource);
+		}
+		else
+		{
+			finalize(*reloaded);
+			resource = reloaded;
+		}
+
+		ScopedLock lock(cache_mutex);
+
+		// the resource may have been evicted meanwhile
+		typename ResourceCache::iterator found = cache.find(location);
+		if (found == cache.end())
+		{
+			return;
+		}
+
+		CacheItem& item = found->second;
+		cache_index.erase(item.resource.get());
+		cache_bytes -= item.size;
+
+		item.resource = resource;
+		item.size = resourceSize(*resource);
+		item.last_use = nextUse();
+
+		cache_index[resource.get()] = found;
+		cache_bytes += item.size;
+		cache_generation++;
+	}
+
+	template<typename T>
+	Uint64 ResourceLoader<T>::resourceSize(ResourceType const& resource) const
+	{
+		return sizeof(ResourceType);
+	}
+
+	template<typename T>
+	Bool ResourceLoader<T>::isResourceCached(std::string const& resource_location) const
+	{
+		ScopedLock lock(cache_mutex);
+		return (cache.find(resource_location) != cache.end());
+	}
+
+	template<typename T>
+	Bool ResourceLoader<T>::isResourceCached(ResourceType const * const resource) const
+	{
+		ScopedLock lock(cache_mutex);
+		return (cache_index.find(resource) != cache_index.end());
+	}
+
+	template<typename T>
+	typename ResourceLoader<T>::CacheItem ResourceLoader<T>::getCacheItem(ResourceType const * const resource) const
+	{
+		ScopedLock lock(cache_mutex);
+
+		typename ResourceIndex::const_iterator found = cache_index.find(resource);
+		if (found == cache_index.end())
+		{
+			return CacheItem();
 		}
 
-		return *item;
+		return found->second->second;
 	}
 
 	template<typename T>
-	typename ResourceLoader<T>::CacheItem const& ResourceLoader<T>::getCacheItem(std::string const& location) const
+	typename ResourceLoader<T>::CacheItem ResourceLoader<T>::getCacheItem(std::string const& location) const
 	{
-		RENGINE_ASSERT( isResourceCached(location) );
-		return cache.find(location)->second;
+		ScopedLock lock(cache_mutex);
+
+		typename ResourceCache::const_iterator found = cache.find(location);
+		if (found == cache.end())
+		{
+			return CacheItem();
+		}
+
+		return found->second;
 	}
 
 }// end of namespace
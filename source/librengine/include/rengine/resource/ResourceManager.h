@@ -4,11 +4,54 @@
 #define __RENGINE_RESOURCE_MANAGER_H__
 
 #include <rengine/resource/ResourceLoader.h>
+#include <rengine/resource/ResourceLoadQueue.h>
 #include <rengine/system/System.h>
+#include <rengine/file/FileWatcher.h>
 #include <vector>
+#include <map>
+#include <cstring>
 
 namespace rengine
 {
+	//
+	// Called when an asynchronous load finishes
+	//
+	template<typename T>
+	class ResourceLoadHandler
+	{
+	public:
+		virtual ~ResourceLoadHandler() {}
+
+		// render thread, the resource is 0 when the load failed
+		virtual void operator()(std::string const& location, SharedPointer<T> const& resource) = 0;
+	};
+
+	//
+	// Handle of an asynchronous load, the loader runs on a worker and finalize on the render thread
+	//
+	template<typename T>
+	class AsyncResource : public ResourceRequest
+	{
+	public:
+		typedef ResourceLoadHandler<T> Handler;
+
+		AsyncResource(ResourceLoader<T>* loader, std::string const& location, OpaqueProperties const& options,
+					  Int const priority, Handler* handler);
+
+		// Description
+		//	the resource once the request is Loaded, 0 before
+		SharedPointer<T> resource() const;
+	protected:
+		virtual Bool load();
+		virtual void finalize();
+		virtual void notify();
+	private:
+		ResourceLoader<T>* loader_;
+		OpaqueProperties options_;
+		Handler* handler_;
+		SharedPointer<T> resource_;
+	};
+
 	class ResourceManager: public SystemCommand::Handler, public SystemVariable::Handler
 	{
 	public:
@@ -39,6 +82,51 @@ namespace rengine
 		template<typename T>
 		SharedPointer<T> load(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
 
+		// Description
+		//	Loads a resource on a worker thread, the cache is shared with load.
+		//	The render thread finalizes loaded resources every frame, within the resource_finalize_budget,
+		//	and then calls the handler. The handler must outlive the request or the request must be cancelled.
+		// Arguments
+		//	priority - higher priorities are loaded first
+		template<typename T>
+		SharedPointer< AsyncResource<T> > loadAsync(std::string const& location, Int const priority = 0,
+													ResourceLoadHandler<T>* handler = 0, OpaqueProperties const& options = OpaqueProperties());
+
+		// Description
+		//	finalizes asynchronous loads within the frame budget, called by the engine every frame
+		Uint finalizeAsyncLoads();
+
+		ResourceLoadQueue& loadQueue();
+
+		// Description
+		//	Memory budget of the cached resources in megabytes, 0 disables it.
+		//	The global budget is the resource_memory_budget variable, each resource type has its own
+		//	resource_budget_<type> variable, resource_budget_texture2d for instance.
+		void setMemoryBudget(Real const megabytes);
+		template<typename T>
+		void setMemoryBudget(Real const megabytes);
+
+		// Description
+		//	Evicts the least recently used resources that nothing outside the cache references,
+		//	until every budget is met or nothing else can be evicted. Called by the engine every frame.
+		//	Returns the bytes released.
+		Uint64 enforceMemoryBudget();
+
+		Uint64 cachedBytes() const;
+
+		// Description
+		//	Hot reload, the resource_hot_reload variable.
+		//	The disk files of the cached resources are watched, a changed file is loaded again on a worker
+		//	and swapped in when the engine finalizes asynchronous loads. Loaders that implement assign update
+		//	the cached object, so the existing holders see the change, the others serve the new resource to new requests.
+		//	Files served from packs or memory are not watched.
+		void setHotReload(Bool const enabled);
+
+		// Description
+		//	follows the cache and queues the reloads of changed files, called by the engine every frame.
+		//	Returns the number of reloads queued.
+		Uint updateHotReload();
+
 		//
 		// Gets the resource location from the object
 		template<typename T>
@@ -48,7 +136,47 @@ namespace rengine
 		void operator()(SystemCommand::CommandId const command, SystemCommand::Arguments const& arguments);
 		Bool operator()(SystemVariable& variable, SystemVariable::Arguments const& arguments);
 	private:
+		//
+		// Loaders of one resource type.
+		// Locations remembers the loader that loaded each location, so cached resources are found in one lookup,
+		// formats remembers the answers of suportsFormat by extension. Both are hashed.
+		//
+		struct LoaderIndex
+		{
+			typedef std::vector<BaseResourceLoader*> Loaders;
+			typedef HashMap<std::string, BaseResourceLoader*> Locations;
+			typedef HashMap<std::string, Bool> Formats;
+
+			Loaders loaders;
+			Locations locations;
+			Formats formats;
+			SharedPointer<SystemVariable> budget;
+		};
+
+		// type_info objects of the same type may differ across modules, they are hashed and compared by value
+		struct TypeInfoHash
+		{
+			Uint32 operator()(std::type_info const* type) const;
+		};
+		struct TypeInfoEqual
+		{
+			Bool operator()(std::type_info const* lhs, std::type_info const* rhs) const;
+		};
+		typedef HashMap<std::type_info const*, LoaderIndex, TypeInfoHash, TypeInfoEqual> LoaderIndices;
+
+		// returns 0 when there are no loaders of the type
+		LoaderIndex* loaderIndex(std::type_info const& type) const;
+
+		// evicts from the loaders until their cached bytes fit the budget
+		static Uint64 evictLeastRecentlyUsed(LoaderIndex::Loaders const& loaders, Uint64 const budget);
+
+		template<typename T>
+		ResourceLoader<T>* findLoader(std::string const& location) const;
+
 		ResourceLoaders loaders;
+		mutable LoaderIndices loader_indices;
+		mutable Mutex index_mutex;
+		ResourceLoadQueue load_queue;
 
 		enum Commands
 		{
@@ -57,6 +185,21 @@ namespace rengine
 		};
 
 		SharedPointer<SystemVariable> caching_option;
+		SharedPointer<SystemVariable> finalize_budget;
+		SharedPointer<SystemVariable> memory_budget;
+		Bool configured;
+
+		// native filename to the cached resources made of it
+		typedef std::pair<BaseResourceLoader*, std::string> WatchedResource;
+		typedef std::multimap<std::string, WatchedResource> WatchedFiles;
+
+		void stopHotReload();
+
+		SharedPointer<SystemVariable> hot_reload;
+		FileWatcher file_watcher;
+		WatchedFiles watched_files;
+		Uint64 watched_generation;
+		Bool watching;
 	};
 
 	//
@@ -70,24 +213,72 @@ namespace rengine
 
 	RENGINE_INLINE void ResourceManager::clearLoaders()
 	{
+		// workers may be using the loaders
+		load_queue.shutdown();
+		stopHotReload();
+
+		ScopedLock lock(index_mutex);
+
+		// the budgets stay registered in the system
+		for (LoaderIndices::iterator i = loader_indices.begin(); i != loader_indices.end(); ++i)
+		{
+			i->second.loaders.clear();
+			i->second.locations.clear();
+			i->second.formats.clear();
+		}
 		loaders.clear();
 	}
 
+	RENGINE_INLINE ResourceLoadQueue& ResourceManager::loadQueue()
+	{
+		return load_queue;
+	}
+
+	RENGINE_INLINE Uint32 ResourceManager::TypeInfoHash::operator()(std::type_info const* type) const
+	{
+		Char const* name = type->name();
+		return fnv1a(name, Uint(strlen(name)));
+	}
+
+	RENGINE_INLINE Bool ResourceManager::TypeInfoEqual::operator()(std::type_info const* lhs, std::type_info const* rhs) const
+	{
+		return (*lhs == *rhs);
+	}
+
+	RENGINE_INLINE ResourceManager::LoaderIndex* ResourceManager::loaderIndex(std::type_info const& type) const
+	{
+		LoaderIndices::iterator found = loader_indices.find(&type);
+		return (found != loader_indices.end()) ? &found->second : 0;
+	}
+
+	template<typename T>
+	void ResourceManager::setMemoryBudget(Real const megabytes)
+	{
+		ScopedLock lock(index_mutex);
+
+		LoaderIndex* index = loaderIndex(typeid(T));
+		if (index)
+		{
+			index->budget->set(megabytes);
+		}
+	}
+
+	//
+	// Every loader in the index of T has T as resource type, so the downcasts are static
+	//
+
 	template<typename T>
 	std::string ResourceManager::resourceLocation(T const * const resource) const
 	{
+		ScopedLock lock(index_mutex);
 		std::string location;
-		for (ResourceLoaders::size_type i = 0; ((i != loaders.size()) && location.empty()); ++i)
+
+		LoaderIndex* index = loaderIndex(typeid(T));
+		for (LoaderIndex::Loaders::size_type i = 0; index && (i != index->loaders.size()) && location.empty(); ++i)
 		{
-			if (loaders[i]->resourceTypeinfo() == typeid(T))
-			{
-				ResourceLoader<T> *loader = dynamic_cast< ResourceLoader<T>* > ( loaders[i].get() );
-				if (loader->isResourceCached(resource))
-				{
-					typename ResourceLoader<T>::CacheItem item = loader->getCacheItem(resource);
-					location = item.location;
-				}
-			}
+			ResourceLoader<T> *loader = static_cast< ResourceLoader<T>* > ( index->loaders[i] );
+			// a single locked lookup, the resource may be evicted meanwhile
+			location = loader->getCacheItem(resource).location;
 		}
 
 		return location;
@@ -96,18 +287,27 @@ namespace rengine
 	template<typename T>
 	Bool ResourceManager::suportsFormat(std::string const& extension) const
 	{
+		ScopedLock lock(index_mutex);
+
+		LoaderIndex* index = loaderIndex(typeid(T));
+		if (!index)
+		{
+			return false;
+		}
+
+		LoaderIndex::Formats::iterator found = index->formats.find(extension);
+		if (found != index->formats.end())
+		{
+			return found->second;
+		}
+
 		Bool supported = false;
-		for (ResourceLoaders::size_type i = 0; ((i != loaders.size()) && !supported); ++i)
+		for (LoaderIndex::Loaders::size_type i = 0; (i != index->loaders.size()) && !supported; ++i)
 		{
-			if (loaders[i]->resourceTypeinfo() == typeid(T))
-			{
-				if (loaders[i]->suportsFormat(extension))
-				{
-					supported = true;
-				}
-			}
+			supported = index->loaders[i]->suportsFormat(extension);
 		}
 
+		index->formats[extension] = supported;
 		return supported;
 	}
 
@@ -115,18 +315,149 @@ namespace rengine
 	SharedPointer<T> ResourceManager::load(std::string const& location, OpaqueProperties const& options)
 	{
 		SharedPointer<T> resource;
+		ResourceLoader<T>* last_loader = 0;
+		LoaderIndex::Loaders candidates;
+
+		{
+			ScopedLock lock(index_mutex);
+
+			LoaderIndex* index = loaderIndex(typeid(T));
+			if (!index)
+			{
+				return resource;
+			}
+
+			LoaderIndex::Locations::const_iterator found = index->locations.find(location);
+			if (found != index->locations.end())
+			{
+				last_loader = static_cast< ResourceLoader<T>* > ( found->second );
+			}
+			else
+			{
+				candidates = index->loaders;
+			}
+		}
 
-		for (ResourceLoaders::size_type i = 0; ((i != loaders.size()) && !resource.get()); ++i)
+		// the common case, a resource already loaded is served by its cache
+		if (last_loader)
 		{
-			if (loaders[i]->resourceTypeinfo() == typeid(T))
+			resource = last_loader->load(location, options);
+			if (resource.get())
 			{
-				ResourceLoader<T> *loader = dynamic_cast< ResourceLoader<T>* > ( loaders[i].get() );
-				resource = loader->load(location, options);
+				return resource;
 			}
+
+			ScopedLock lock(index_mutex);
+			candidates = loaderIndex(typeid(T))->loaders;
 		}
+
+		// loaders may call load themselves, the index is not locked while they run
+		BaseResourceLoader* loaded_by = 0;
+		for (LoaderIndex::Loaders::size_type i = 0; (i != candidates.size()) && !resource.get(); ++i)
+		{
+			ResourceLoader<T> *loader = static_cast< ResourceLoader<T>* > ( candidates[i] );
+			resource = loader->load(location, options);
+			loaded_by = loader;
+		}
+
+		ScopedLock lock(index_mutex);
+		LoaderIndex* index = loaderIndex(typeid(T));
+		if (index)
+		{
+			if (resource.get())
+			{
+				index->locations[location] = loaded_by;
+			}
+			else
+			{
+				index->locations.erase(location);
+			}
+		}
+
 		return resource;
 	}
 
+	template<typename T>
+	ResourceLoader<T>* ResourceManager::findLoader(std::string const& location) const
+	{
+		ScopedLock lock(index_mutex);
+
+		LoaderIndex* index = loaderIndex(typeid(T));
+		if (!index)
+		{
+			return 0;
+		}
+
+		LoaderIndex::Locations::const_iterator found = index->locations.find(location);
+		if (found != index->locations.end())
+		{
+			return static_cast< ResourceLoader<T>* > ( found->second );
+		}
+
+		for (LoaderIndex::Loaders::size_type i = 0; i != index->loaders.size(); ++i)
+		{
+			if (index->loaders[i]->canLoadResourceFromLocation(location))
+			{
+				return static_cast< ResourceLoader<T>* > ( index->loaders[i] );
+			}
+		}
+
+		return 0;
+	}
+
+	template<typename T>
+	SharedPointer< AsyncResource<T> > ResourceManager::loadAsync(std::string const& location, Int const priority,
+																 ResourceLoadHandler<T>* handler, OpaqueProperties const& options)
+	{
+		// a missing loader fails on the worker, the handler is still called from the render thread
+		SharedPointer< AsyncResource<T> > request = new AsyncResource<T>(findLoader<T>(location), location, options, priority, handler);
+		load_queue.push(request);
+
+		return request;
+	}
+
+	//
+	// AsyncResource
+	//
+	template<typename T>
+	AsyncResource<T>::AsyncResource(ResourceLoader<T>* loader, std::string const& location, OpaqueProperties const& options,
+									 Int const priority, Handler* handler)
+		:ResourceRequest(location, priority), loader_(loader), options_(options), handler_(handler)
+	{
+	}
+
+	template<typename T>
+	SharedPointer<T> AsyncResource<T>::resource() const
+	{
+		return (state() == Loaded) ? resource_ : SharedPointer<T>();
+	}
+
+	template<typename T>
+	Bool AsyncResource<T>::load()
+	{
+		if (loader_)
+		{
+			resource_ = loader_->load(location(), options_);
+		}
+
+		return (resource_.get() != 0);
+	}
+
+	template<typename T>
+	void AsyncResource<T>::finalize()
+	{
+		loader_->finalize(*resource_);
+	}
+
+	template<typename T>
+	void AsyncResource<T>::notify()
+	{
+		if (handler_)
+		{
+			(*handler_)(location(), resource());
+		}
+	}
+
 }// end of namespace
 
 #endif // __RENGINE_RESOURCE_MANAGER_H__
@@ -0,0 +1,83 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_RESOURCE_MANIFEST_H__
+#define __RENGINE_RESOURCE_MANIFEST_H__
+
+#include <rengine/lang/Lang.h>
+#include <rengine/file/XmlSerialization.h>
+
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// List of the resources a scene needs, loaded ahead with a ResourceBatch.
+	//
+	// <root>
+	//	<resources>
+	//		<element>
+	//			<type>texture</type>
+	//			<location>data/images/floor.png</location>
+	//			<priority>0</priority>
+	//			<dependencies>
+	//				<element>data/images/floor_detail.png</element>
+	//			</dependencies>
+	//		</element>
+	//	</resources>
+	// </root>
+	//
+	// Dependencies are locations of other resources of the batch, they are loaded first.
+	// They only set the load order, the dependent resource is loaded on its own and shares nothing with them.
+	// Every field of an entry must be present, dependencies may be empty.
+	//
+	class ResourceManifest
+	{
+	public:
+		typedef std::vector<std::string> Dependencies;
+
+		struct Entry
+		{
+			Entry();
+			Entry(std::string const& type, std::string const& location, Int const priority = 0);
+
+			void serialize(XmlArchive& archive);
+
+			std::string type;
+			std::string location;
+			Int priority;
+			Dependencies dependencies;
+		};
+
+		typedef std::vector<Entry> Entries;
+
+		ResourceManifest();
+		~ResourceManifest();
+
+		// Description
+		//	reads a manifest through the resource file system, returns false when it is missing or malformed
+		Bool load(std::string const& location);
+
+		// Description
+		//	writes the manifest to disk
+		Bool save(std::string const& filename) const;
+
+		void add(Entry const& entry);
+		void clear();
+
+		Entries const& entries() const;
+	private:
+		Entries entries_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE ResourceManifest::Entries const& ResourceManifest::entries() const
+	{
+		return entries_;
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_RESOURCE_MANIFEST_H__
@@ -23,6 +23,11 @@ namespace rengine
 			Vertex 		= 0x8B31
 		};
 
+		enum Flag
+		{
+			CompilePending				= 1	// compiled by RenderEngine::submit, status not queried yet
+		};
+
 		Shader(Type const type);
 		Shader(Type const type, std::string const source);
 		~Shader();
@@ -148,7 +153,8 @@ namespace rengine
 			None						= 0,
 			UniformsChanged				= 1,
 			VertexShaderChanged			= 2,
-			FragmentShaderChanged		= 4
+			FragmentShaderChanged		= 4,
+			LinkPending					= 8		// submitted to the driver, status not queried yet
 		};
 
 		Program();
@@ -0,0 +1,72 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_PROGRAM_BINARY_CACHE_H__
+#define __RENGINE_PROGRAM_BINARY_CACHE_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <string>
+#include <vector>
+
+namespace rengine
+{
+	//
+	// Disk cache of linked program binaries, so programs are not compiled again on every start.
+	//
+	// A binary is stored per pair of shader sources, the filename is made of the checksums of the sources and of the driver.
+	// The file repeats the driver and the whole sources, any mismatch is a miss and the program is compiled.
+	// A driver may still reject a binary it made (an update keeping the same strings), the caller removes it and compiles.
+	//
+	class ProgramBinaryCache
+	{
+	public:
+		typedef std::vector<Uchar> Binary;
+
+		ProgramBinaryCache();
+
+		// Description
+		//	directory of the binaries, "" disables the cache
+		void setDirectory(std::string const& directory);
+		std::string const& directory() const;
+
+		// Description
+		//	vendor, renderer and version of the driver, a binary is only valid for the driver that made it
+		void setDriver(std::string const& driver);
+		std::string const& driver() const;
+
+		Bool enabled() const;
+
+		// Description
+		//	Reads the binary of a pair of sources.
+		//	Returns false when there is no valid binary.
+		Bool load(std::string const& vertex_source, std::string const& fragment_source, Uint& format, Binary& binary) const;
+		Bool save(std::string const& vertex_source, std::string const& fragment_source, Uint const format, Binary const& binary) const;
+		void remove(std::string const& vertex_source, std::string const& fragment_source) const;
+
+		std::string filename(std::string const& vertex_source, std::string const& fragment_source) const;
+	private:
+		std::string directory_;
+		std::string driver_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE std::string const& ProgramBinaryCache::directory() const
+	{
+		return directory_;
+	}
+
+	RENGINE_INLINE std::string const& ProgramBinaryCache::driver() const
+	{
+		return driver_;
+	}
+
+	RENGINE_INLINE Bool ProgramBinaryCache::enabled() const
+	{
+		return !directory_.empty();
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_PROGRAM_BINARY_CACHE_H__
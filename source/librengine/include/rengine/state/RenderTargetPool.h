@@ -0,0 +1,87 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_RENDER_TARGET_POOL_H__
+#define __RENGINE_RENDER_TARGET_POOL_H__
+
+#include <rengine/state/FrameBuffer.h>
+
+#include <map>
+
+namespace rengine
+{
+	//
+	// Frame buffers with a color texture, shared by users that only need them for the duration of a draw.
+	// Targets are keyed by size and internal format, a released target is handed to the next acquire
+	// with the same key, its content is undefined.
+	//
+	class RenderTargetPool
+	{
+	public:
+		struct RenderTarget
+		{
+			SharedPointer<FrameBuffer> frame_buffer;
+			SharedPointer<Texture2D> texture;
+		};
+
+		RenderTargetPool();
+		~RenderTargetPool();
+
+		// returns an idle target or creates a new one
+		RenderTarget acquire(Uint const width, Uint const height, DrawResource::DataFormat const internal_format);
+		void release(RenderTarget const& target);
+
+		// drops the idle targets
+		void clear();
+
+		Uint numberOfIdleTargets() const;
+		// idle and acquired targets
+		Uint numberOfTargets() const;
+	private:
+		RenderTargetPool(RenderTargetPool const& copy);
+
+		struct Key
+		{
+			Uint width;
+			Uint height;
+			DrawResource::DataFormat internal_format;
+
+			Bool operator<(Key const& other) const;
+		};
+
+		typedef std::multimap<Key, RenderTarget> Targets;
+
+		Targets idle_;
+		Uint targets_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Uint RenderTargetPool::numberOfIdleTargets() const
+	{
+		return Uint(idle_.size());
+	}
+
+	RENGINE_INLINE Uint RenderTargetPool::numberOfTargets() const
+	{
+		return targets_;
+	}
+
+	RENGINE_INLINE Bool RenderTargetPool::Key::operator<(Key const& other) const
+	{
+		if (width != other.width)
+		{
+			return (width < other.width);
+		}
+
+		if (height != other.height)
+		{
+			return (height < other.height);
+		}
+
+		return (internal_format < other.internal_format);
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_RENDER_TARGET_POOL_H__
@@ -27,6 +27,26 @@ namespace rengine
 		virtual Bool suportsFormat(std::string const& extension) const;
 
 		virtual SharedPointer<Program> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
+
+		// starts compiling and linking the program
+		virtual void finalize(Program& program);
+
+		// the effect and the files it includes
+		virtual void sourceFiles(std::string const& location, Locations& files) const;
+
+		// the program is linked again with the reloaded shaders
+		virtual Bool assign(Program& program, Program& reloaded);
+
+		// Description
+		//	Reads an effect and inlines its include pragmas, the other pragmas and the symbols are kept.
+		//	Used to cook effects into a single file.
+		Bool expandIncludes(std::string const& location, std::string& source);
+
+		// Description
+		//	Forgets the preprocessed effects.
+		//	Effects are preprocessed once per set of symbols, until the effect or one of its includes changes on disk.
+		void clearPreprocessed();
+		Uint numberOfPreprocessed() const;
 	private:
 		typedef std::pair<std::string, std::string> DefaultValue;
 		typedef std::pair<std::string, std::string> Semantic;
@@ -44,6 +64,8 @@ namespace rengine
 
 		std::string getSection(std::string const& src, std::string const& name);
 		std::string preprocess(SharedPointer<Program> program, std::string src, std::string const& base_location);
+		// replaces the include pragmas by the included files, false when they nest too deep
+		Bool expandIncludePragmas(std::string& src, std::string const& base_location);
 		std::string expandSymbols(std::string const& src);
 
 		std::string pragmaInclude(std::string const& line, std::string const& base_location);
@@ -78,6 +100,51 @@ namespace rengine
 
 		bool m_limitedToOpenGL21;
 
+		// files included by the last load, and by every cached program
+		typedef std::map<std::string, Locations> ProgramIncludes;
+		Locations includes;
+		ProgramIncludes program_includes;
+		mutable Mutex includes_mutex;
+
+		// the preprocessor output, replayed while the files keep their stamps
+		struct UniformDeclaration
+		{
+			std::string name;
+			Uniform::Type type;
+			Uniform::SizeType size;
+		};
+		typedef std::vector<UniformDeclaration> UniformDeclarations;
+
+		// disk files are stamped by modification time, files of packs and memory mounts by a checksum of their contents
+		struct FileStamp
+		{
+			FileStamp() :time(0.0), checksum(0) {}
+			Bool operator!=(FileStamp const& rhs) const { return (time != rhs.time) || (checksum != rhs.checksum); }
+
+			Real64 time;
+			Uint32 checksum;
+		};
+		typedef std::map<std::string, FileStamp> FileStamps;
+
+		struct PreprocessedEffect
+		{
+			std::string source;
+			UniformDeclarations uniforms;
+			DefaultValues default_values;
+			Semantics semantics;
+			Locations includes;
+			FileStamps file_stamps;
+		};
+		typedef std::map<std::string, PreprocessedEffect> PreprocessedEffects;
+
+		static FileStamp fileStamp(std::string const& location);
+		std::string preprocessedKey(std::string const& location) const;
+		Bool replayPreprocessed(std::string const& key, SharedPointer<Program> program, std::string& source);
+		void storePreprocessed(std::string const& key, std::string const& location, SharedPointer<Program> program, std::string const& source);
+
+		PreprocessedEffects preprocessed;
+		mutable Mutex preprocessed_mutex;
+
 		typedef std::map<std::string, std::string> InOutLines;
 		InOutLines in_out_lines;
 		std::string replaceInOutLines(std::string const src, Bool isIn);
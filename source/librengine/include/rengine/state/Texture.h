@@ -12,6 +12,9 @@
 
 namespace rengine
 {
+	class MipmapChain;
+	class MipmapBuilder;
+
 	//
 	// Texture2D
 	//
@@ -43,10 +46,12 @@ namespace rengine
 			GenerateMipmap		= 2,
 			AutoFilter			= 4,
 			ReleaseImage		= 8,
+			GenerateMipmapAsync	= 16, // with GenerateMipmap, the chain is built on a worker thread while the base level is used
 
 			WrapChanged			= 1024,
 			FilterChanged 		= 2048,
-			ImageDataChanged	= 4096
+			ImageDataChanged	= 4096,
+			MipmapDataChanged	= 8192
 		};
 
 		Texture2D();
@@ -75,6 +80,22 @@ namespace rengine
 
 		SharedPointer<Image> const& getImage() const;
 
+		//
+		// Mipmaps are built on the cpu from the current image and uploaded level by level.
+		// The render engine builds them on first upload when GenerateMipmap is set,
+		// call buildMipmaps at load time to avoid the work on the render thread.
+		//
+		void buildMipmaps(Bool const asynchronous = false);
+		// uses a chain built elsewhere, level 0 must match the image
+		void setMipmaps(SharedPointer<MipmapChain> const& mipmaps);
+		SharedPointer<MipmapChain> const& getMipmaps() const;
+		void releaseMipmaps();
+
+		// an asynchronous build is running
+		Bool mipmapsPending() const;
+		// takes the chain of a finished asynchronous build, returns true if the chain was collected
+		Bool collectMipmaps();
+
 		void setSize(Int const& width, Int const& height);
 		void setColorChannels(Int const& channels);
 		void setInternalFormat(DataFormat const& internal_format);
@@ -85,6 +106,10 @@ namespace rengine
 
 		DataFormat getInternalFormat() const;
 		DataFormat getFormat() const;
+
+		// Description
+		//	estimate of the bytes held, the uploaded levels plus the image and mipmaps kept on the cpu
+		Uint64 memorySize() const;
 	private:
 		void initialize();
 		Uint flags;
@@ -102,6 +127,8 @@ namespace rengine
 		Wrap wrap_t;
 
 		SharedPointer<Image> image;
+		SharedPointer<MipmapChain> mipmaps_;
+		SharedPointer<MipmapBuilder> mipmap_builder_;
 	};
 
 	//
@@ -161,6 +188,16 @@ namespace rengine
 		return image;
 	}
 
+	RENGINE_INLINE SharedPointer<MipmapChain> const& Texture2D::getMipmaps() const
+	{
+		return mipmaps_;
+	}
+
+	RENGINE_INLINE Bool Texture2D::mipmapsPending() const
+	{
+		return (mipmap_builder_.get() != 0);
+	}
+
 	RENGINE_INLINE Int Texture2D::getWidth() const
 	{
 		return width;
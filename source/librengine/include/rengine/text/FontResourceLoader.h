@@ -14,6 +14,7 @@ namespace rengine
 	public:
 		virtual Bool suportsFormat(std::string const& extension) const;
 		virtual Bool canLoadResourceFromLocation(std::string const& resource_location) const;
+		virtual Uint64 resourceSize(Font const& font) const;
 
 		virtual SharedPointer<Font> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
 	};
@@ -22,6 +23,9 @@ namespace rengine
 	{
 	public:
 		virtual Bool suportsFormat(std::string const& extension) const;
+		virtual Bool supportsConcurrentLoads() const;
+		virtual void finalize(Font& font);
+		virtual Uint64 resourceSize(Font const& font) const;
 		virtual SharedPointer<Font> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
 	};
 
@@ -29,6 +33,9 @@ namespace rengine
 	{
 	public:
 		virtual Bool suportsFormat(std::string const& extension) const;
+		virtual Bool supportsConcurrentLoads() const;
+		virtual void finalize(Font& font);
+		virtual Uint64 resourceSize(Font const& font) const;
 		virtual SharedPointer<Font> loadImplementation(std::string const& location, OpaqueProperties const& options = OpaqueProperties());
 	};
 
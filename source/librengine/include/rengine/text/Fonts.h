@@ -36,6 +36,10 @@ namespace rengine
 		//
 		Bool load(std::string const& filename);
 		//
+		// Load the first winfont from the bytes of a .fon file
+		//
+		Bool load(Uint8 const* data, Uint const size);
+		//
 		// Load a winfont from a stream
 		//
 		Bool load(std::istream& in);
@@ -58,6 +62,10 @@ namespace rengine
 		virtual ~Truetypefont();
 	
 		Bool load(std::string const& filename);
+		//
+		// Load from the bytes of a .ttf file, the bytes are only used during the call
+		//
+		Bool load(Uint8 const* data, Uint const size);
 
 		// Only load glyphs from 'first' to 'last'
 		void setFirstGlyphCode(Font::GlyphCode const& code);
@@ -69,6 +77,31 @@ namespace rengine
 		Real pixel_height;
 	};
 
+	//
+	// Font baked by rengineAssetCooker, the glyphs and the atlas are stored ready to use.
+	// The source font file is kept in the payload so loads with non default options can rasterize it again.
+	//
+	class CookedFont : public Font
+	{
+	public:
+		CookedFont();
+		virtual ~CookedFont();
+
+		Bool load(Uint8 const* data, Uint const size);
+
+		static Bool isCooked(Uint8 const* data, Uint const size);
+
+		// Description
+		//	bakes a loaded font, the font texture must still have its image
+		static Bool cook(Font const& font, Uint8 const* source, Uint const source_size, std::vector<Uint8>& out);
+
+		// Description
+		//	the source font file of a cooked payload
+		static Bool source(Uint8 const* data, Uint const size, Uint8 const*& source, Uint& source_size);
+
+		static Uint32 const magic = 0x544E4652;	// "RFNT"
+	};
+
 	//
 	// This class builds a texture with glyph bitmapdata
 	//
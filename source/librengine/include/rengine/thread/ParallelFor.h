@@ -0,0 +1,32 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_PARALLEL_FOR_H__
+#define __RENGINE_PARALLEL_FOR_H__
+
+#include <rengine/lang/Types.h>
+
+namespace rengine
+{
+	//
+	// Work split by parallelFor, operator() is called concurrently with disjoint ranges
+	//
+	class ParallelRange
+	{
+	public:
+		virtual ~ParallelRange() {}
+
+		// process items [begin, end)
+		virtual void operator()(Uint const begin, Uint const end) = 0;
+	};
+
+	//
+	// Splits [0, count) in contiguous blocks and processes them on worker threads.
+	// The calling thread processes the first block and returns when all blocks are done.
+	// threads = 0 uses the number of processors.
+	// Blocks will have at least minimum_block items, small ranges run on the calling thread only.
+	//
+	void parallelFor(ParallelRange& range, Uint const count, Uint const threads = 0, Uint const minimum_block = 1);
+
+} // namespace rengine
+
+#endif //__RENGINE_PARALLEL_FOR_H__
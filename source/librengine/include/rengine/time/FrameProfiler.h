@@ -0,0 +1,165 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_FRAME_PROFILER_H__
+#define __RENGINE_FRAME_PROFILER_H__
+
+#include <rengine/time/Profiler.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace rengine
+{
+	//
+	// Times named sections of each frame, keeping a rolling window of the last frames.
+	//
+	// Sections nest, the depth of a section is its nesting level when it last ran, the frame is depth 0.
+	// A section running more than once in a frame adds up, a frame without the section adds no sample.
+	// Sections are also recorded by the Profiler while it is enabled.
+	// Meant for the render thread, it does no locking.
+	//
+	class FrameProfiler
+	{
+	public:
+		typedef Uint SectionId;
+		// milliseconds
+		typedef std::vector<Real64> Samples;
+
+		struct Statistics
+		{
+			Statistics();
+
+			Uint samples;
+			Real64 minimum;
+			Real64 average;
+			Real64 percentile_95;
+			Real64 percentile_99;
+			Real64 maximum;
+		};
+
+		// the whole frame, between beginFrame and endFrame
+		static SectionId const FrameSection = 0;
+
+		FrameProfiler(Uint const window = 120);
+
+		// Description
+		//	frames kept, the samples are cleared
+		void setWindow(Uint const frames);
+		Uint window() const;
+
+		// Description
+		//	Returns the id of a section name, registering it on the first call.
+		//	Sections are listed in registration order.
+		SectionId section(std::string const& name);
+		Uint numberOfSections() const;
+		std::string const& sectionName(SectionId const section) const;
+		Uint sectionDepth(SectionId const section) const;
+
+		void beginFrame();
+		// closes the sections left open
+		void endFrame();
+
+		void begin(SectionId const section);
+		void end(SectionId const section);
+
+		// Description
+		//	adds time measured elsewhere to a section of the current frame, at the depth of the sections open
+		void record(SectionId const section, Real64 const milliseconds);
+
+		// Description
+		//	nearest rank percentiles over the window
+		Statistics statistics(SectionId const section) const;
+
+		// Description
+		//	samples of the window, oldest first
+		Samples samples(SectionId const section) const;
+
+		void clear();
+
+		//
+		// Times a section while it lives
+		//
+		class ScopedSection
+		{
+		public:
+			ScopedSection(FrameProfiler& profiler, SectionId const section);
+			~ScopedSection();
+		private:
+			ScopedSection(ScopedSection const& copy);
+			ScopedSection& operator=(ScopedSection const& copy);
+
+			FrameProfiler& profiler_;
+			SectionId const section_;
+		};
+	private:
+		struct Section
+		{
+			std::string name;
+			Profiler::ScopeId scope;
+			Uint depth;
+
+			// time of the current frame
+			Real64 frame_time;
+			Bool ran;
+
+			// ring of the window
+			Samples samples;
+			Uint next;
+		};
+		typedef std::vector<Section> Sections;
+		typedef std::map<std::string, SectionId> SectionIds;
+
+		struct OpenSection
+		{
+			SectionId section;
+			Profiler::Nanoseconds start;
+			Bool traced;
+		};
+		typedef std::vector<OpenSection> OpenSections;
+
+		void addSample(Section& section, Real64 const milliseconds);
+
+		Uint window_;
+		Sections sections_;
+		SectionIds section_ids_;
+		OpenSections open_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Uint FrameProfiler::window() const
+	{
+		return window_;
+	}
+
+	RENGINE_INLINE Uint FrameProfiler::numberOfSections() const
+	{
+		return Uint(sections_.size());
+	}
+
+	RENGINE_INLINE std::string const& FrameProfiler::sectionName(SectionId const section) const
+	{
+		return sections_[section].name;
+	}
+
+	RENGINE_INLINE Uint FrameProfiler::sectionDepth(SectionId const section) const
+	{
+		return sections_[section].depth;
+	}
+
+	RENGINE_INLINE FrameProfiler::ScopedSection::ScopedSection(FrameProfiler& profiler, SectionId const section)
+		:profiler_(profiler), section_(section)
+	{
+		profiler_.begin(section_);
+	}
+
+	RENGINE_INLINE FrameProfiler::ScopedSection::~ScopedSection()
+	{
+		profiler_.end(section_);
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_FRAME_PROFILER_H__
@@ -0,0 +1,225 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_PROFILER_H__
+#define __RENGINE_PROFILER_H__
+
+#include <rengine/lang/Lang.h>
+#include <rengine/thread/Synchronization.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <iostream>
+
+namespace rengine
+{
+	//
+	// Scoped profiler, records begin and end events of named scopes of every thread on a single timeline.
+	//
+	// Each thread writes to its own ring buffer without locking, collect() moves the events to the traces.
+	// The engine collects every frame while the profiler is enabled, a thread writing more than a ring
+	// between two collections overwrites its oldest events, they are counted as dropped.
+	// The collected trace of a thread keeps its newest events up to the trace size, older ones are dropped too.
+	// Scope names are interned once per call site, events only carry the scope id and a nanosecond timestamp.
+	// Defining RENGINE_PROFILER_DISABLED removes the RENGINE_PROFILE_* macros, a disabled profiler costs a branch.
+	//
+	class Profiler
+	{
+	public:
+		typedef Uint32 ScopeId;
+		typedef Uint64 Nanoseconds;
+
+		enum EventType
+		{
+			Begin,
+			End
+		};
+
+		struct Event
+		{
+			Nanoseconds time;
+			ScopeId scope;
+			Uint32 type;
+		};
+		typedef std::vector<Event> Events;
+		// dropped from the front once the trace is full
+		typedef std::deque<Event> TraceEvents;
+
+		struct ThreadTrace
+		{
+			ThreadTrace() :dropped(0) {}
+
+			std::string name;
+			TraceEvents events;
+			Uint64 dropped;
+		};
+		// thread registration order to its trace
+		typedef std::map<Uint, ThreadTrace> ThreadTraces;
+
+		static Profiler& instance();
+
+		// Description
+		//	nanoseconds of a monotonic clock
+		static Nanoseconds now();
+
+		void setEnabled(Bool const enabled);
+		Bool enabled() const;
+
+		// Description
+		//	Events per thread buffer, rounded to a power of two.
+		//	Applies to threads that record their first event after the call.
+		void setBufferSize(Uint const events);
+		Uint bufferSize() const;
+
+		// Description
+		//	Collected events kept per thread, the oldest are dropped past it.
+		void setTraceSize(Uint const events);
+		Uint traceSize() const;
+
+		// Description
+		//	Returns the id of a scope name, the same name always has the same id.
+		ScopeId intern(Char const* name);
+		std::string scopeName(ScopeId const scope) const;
+
+		// Description
+		//	Records an event on the calling thread, without locking.
+		void begin(ScopeId const scope);
+		void end(ScopeId const scope);
+
+		// Description
+		//	names the calling thread on the timeline
+		void setThreadName(std::string const& name);
+
+		// Description
+		//	Moves the recorded events of all threads to the traces.
+		//	Buffers of finished threads are released.
+		void collect();
+
+		// Description
+		//	copy of the collected traces
+		ThreadTraces traces() const;
+
+		// Description
+		//	forgets the collected traces, the scope names are kept
+		void clear();
+
+		// Description
+		//	Writes the collected traces in the Chrome trace event format, loadable by chrome://tracing and Perfetto.
+		void exportChromeTrace(std::ostream& out) const;
+		Bool exportChromeTrace(std::string const& filename) const;
+	private:
+		Profiler();
+		~Profiler();
+		Profiler(Profiler const& copy);
+		Profiler& operator=(Profiler const& copy);
+
+		struct ThreadBuffer;
+		typedef std::vector<ThreadBuffer*> ThreadBuffers;
+		typedef std::map<std::string, ScopeId> ScopeIds;
+		typedef std::vector<std::string> ScopeNames;
+
+		ThreadBuffer* threadBuffer();
+		void record(ScopeId const scope, EventType const type);
+		void drain(ThreadBuffer& buffer);
+
+		volatile Bool enabled_;
+		Uint buffer_size_;
+		Uint trace_size_;
+		Nanoseconds start_time_;
+
+		ScopeIds scope_ids_;
+		ScopeNames scope_names_;
+		mutable Mutex scopes_mutex_;
+
+		ThreadBuffers buffers_;
+		ThreadTraces traces_;
+		Uint registered_threads_;
+		mutable Mutex buffers_mutex_;
+
+		friend struct ProfilerThreadKey;
+	};
+
+	//
+	// Interns a scope name once, meant as a function static
+	//
+	struct ProfilerScope
+	{
+		explicit ProfilerScope(Char const* name);
+		Profiler::ScopeId const id;
+	};
+
+	//
+	// Records a scope while it lives, when the profiler is enabled at construction
+	//
+	class ScopedProfile
+	{
+	public:
+		explicit ScopedProfile(ProfilerScope const& scope);
+		~ScopedProfile();
+	private:
+		ScopedProfile(ScopedProfile const& copy);
+		ScopedProfile& operator=(ScopedProfile const& copy);
+
+		Profiler::ScopeId const scope_;
+		Bool const active_;
+	};
+
+#ifdef RENGINE_PROFILER_DISABLED
+#define RENGINE_PROFILE_SCOPE(name)
+#define RENGINE_PROFILE_THREAD(name)
+#else //RENGINE_PROFILER_DISABLED
+#define RENGINE_PROFILE_SCOPE(name) \
+	static rengine::ProfilerScope const RENGINE_UNIQUE_LINE(profiler_scope_)(name); \
+	rengine::ScopedProfile const RENGINE_UNIQUE_LINE(scoped_profile_)(RENGINE_UNIQUE_LINE(profiler_scope_))
+#define RENGINE_PROFILE_THREAD(name) rengine::Profiler::instance().setThreadName(name)
+#endif //RENGINE_PROFILER_DISABLED
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE void Profiler::setEnabled(Bool const enabled)
+	{
+		enabled_ = enabled;
+	}
+
+	RENGINE_INLINE Bool Profiler::enabled() const
+	{
+		return enabled_;
+	}
+
+	RENGINE_INLINE void Profiler::begin(ScopeId const scope)
+	{
+		record(scope, Begin);
+	}
+
+	RENGINE_INLINE void Profiler::end(ScopeId const scope)
+	{
+		record(scope, End);
+	}
+
+	RENGINE_INLINE ProfilerScope::ProfilerScope(Char const* name)
+		:id(Profiler::instance().intern(name))
+	{
+	}
+
+	RENGINE_INLINE ScopedProfile::ScopedProfile(ProfilerScope const& scope)
+		:scope_(scope.id), active_(Profiler::instance().enabled())
+	{
+		if (active_)
+		{
+			Profiler::instance().begin(scope_);
+		}
+	}
+
+	RENGINE_INLINE ScopedProfile::~ScopedProfile()
+	{
+		if (active_)
+		{
+			Profiler::instance().end(scope_);
+		}
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_PROFILER_H__
@@ -0,0 +1,26 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_CRC32_H__
+#define __RENGINE_CRC32_H__
+
+#include <rengine/lang/Lang.h>
+
+namespace rengine
+{
+	//
+	// CRC-32 (ISO 3309 / zlib polynomial 0xEDB88320).
+	//
+	// Returns the checksum of data continuing from a previous checksum, start with 0.
+	// The result is the same as zlib crc32, so crc32(crc32(0, a, n), b, m) is the checksum of a followed by b.
+	//
+	// Large buffers are folded with carry-less multiplications when the processor supports PCLMULQDQ,
+	// otherwise and for the tails the data is processed 8 bytes at a time (slicing by 8).
+	//
+	Uint32 crc32(Uint32 crc, void const* data, Uint const size);
+
+	// true when crc32 uses the carry-less multiplication path
+	Bool crc32Accelerated();
+
+} // namespace rengine
+
+#endif //__RENGINE_CRC32_H__
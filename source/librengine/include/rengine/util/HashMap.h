@@ -0,0 +1,322 @@
+// __!!rengine_copyright!!__ //
+
+#ifndef __RENGINE_HASH_MAP_H__
+#define __RENGINE_HASH_MAP_H__
+
+#include <rengine/lang/Lang.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+#include <functional>
+
+namespace rengine
+{
+	// Description
+	//	FNV-1a of a byte range, continuing from a previous hash
+	Uint32 fnv1a(void const* data, Uint const size, Uint32 const hash = 2166136261u);
+
+	//
+	// Hash functors of the keys HashMap knows, strings hash their characters and pointers their address
+	//
+	template<typename T>
+	struct Hash;
+
+	template<>
+	struct Hash<std::string>
+	{
+		Uint32 operator()(std::string const& key) const;
+	};
+
+	template<typename T>
+	struct Hash<T*>
+	{
+		Uint32 operator()(T const* key) const;
+	};
+
+	//
+	// Hash map with chained buckets, a power of two of them, kept at most one element per bucket.
+	//
+	// Elements live in a list in insertion order, iterators and references stay valid until the element is erased,
+	// growing only rebuilds the buckets. Finds, inserts and erases are O(1) on average.
+	//
+	template<typename Key, typename Value, typename KeyHash = Hash<Key>, typename KeyEqual = std::equal_to<Key> >
+	class HashMap
+	{
+	public:
+		typedef Key key_type;
+		typedef Value mapped_type;
+		typedef std::pair<Key const, Value> value_type;
+		typedef std::list<value_type> Elements;
+		typedef typename Elements::iterator iterator;
+		typedef typename Elements::const_iterator const_iterator;
+		typedef typename Elements::size_type size_type;
+
+		HashMap();
+		HashMap(HashMap const& copy);
+		HashMap& operator=(HashMap const& copy);
+
+		iterator begin();
+		iterator end();
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		size_type size() const;
+		Bool empty() const;
+
+		iterator find(Key const& key);
+		const_iterator find(Key const& key) const;
+
+		// Description
+		//	the element of the key, the existing one when the key was already there
+		std::pair<iterator, Bool> insert(value_type const& value);
+		Value& operator[](Key const& key);
+
+		void erase(iterator position);
+		size_type erase(Key const& key);
+		void clear();
+	private:
+		typedef std::vector<iterator> Bucket;
+		typedef std::vector<Bucket> Buckets;
+
+		Bucket& bucket(Key const& key);
+		Bucket const& bucket(Key const& key) const;
+		void rebuild(size_type const buckets);
+
+		Elements elements_;
+		size_type size_;
+		Buckets buckets_;
+		KeyHash hash_;
+		KeyEqual equal_;
+	};
+
+	//
+	// Implementation
+	//
+	RENGINE_INLINE Uint32 fnv1a(void const* data, Uint const size, Uint32 const hash)
+	{
+		Uint8 const* bytes = (Uint8 const*) data;
+
+		Uint32 value = hash;
+		for (Uint i = 0; i != size; ++i)
+		{
+			value = (value ^ bytes[i]) * 16777619u;
+		}
+		return value;
+	}
+
+	RENGINE_INLINE Uint32 Hash<std::string>::operator()(std::string const& key) const
+	{
+		return fnv1a(key.data(), Uint(key.size()));
+	}
+
+	template<typename T>
+	Uint32 Hash<T*>::operator()(T const* key) const
+	{
+		return fnv1a(&key, sizeof(key));
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	HashMap<Key, Value, KeyHash, KeyEqual>::HashMap()
+		:size_(0)
+	{
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	HashMap<Key, Value, KeyHash, KeyEqual>::HashMap(HashMap const& copy)
+		:elements_(copy.elements_), size_(copy.size_), hash_(copy.hash_), equal_(copy.equal_)
+	{
+		// the buckets of the copy point to its own elements
+		rebuild(copy.buckets_.size());
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	HashMap<Key, Value, KeyHash, KeyEqual>& HashMap<Key, Value, KeyHash, KeyEqual>::operator=(HashMap const& copy)
+	{
+		if (this != &copy)
+		{
+			elements_ = copy.elements_;
+			size_ = copy.size_;
+			hash_ = copy.hash_;
+			equal_ = copy.equal_;
+			rebuild(copy.buckets_.size());
+		}
+		return *this;
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::iterator HashMap<Key, Value, KeyHash, KeyEqual>::begin()
+	{
+		return elements_.begin();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::iterator HashMap<Key, Value, KeyHash, KeyEqual>::end()
+	{
+		return elements_.end();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::const_iterator HashMap<Key, Value, KeyHash, KeyEqual>::begin() const
+	{
+		return elements_.begin();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::const_iterator HashMap<Key, Value, KeyHash, KeyEqual>::end() const
+	{
+		return elements_.end();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::size_type HashMap<Key, Value, KeyHash, KeyEqual>::size() const
+	{
+		return size_;
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	Bool HashMap<Key, Value, KeyHash, KeyEqual>::empty() const
+	{
+		return (size_ == 0);
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::Bucket& HashMap<Key, Value, KeyHash, KeyEqual>::bucket(Key const& key)
+	{
+		return buckets_[hash_(key) & (buckets_.size() - 1)];
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::Bucket const& HashMap<Key, Value, KeyHash, KeyEqual>::bucket(Key const& key) const
+	{
+		return buckets_[hash_(key) & (buckets_.size() - 1)];
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::iterator HashMap<Key, Value, KeyHash, KeyEqual>::find(Key const& key)
+	{
+		if (buckets_.empty())
+		{
+			return elements_.end();
+		}
+
+		Bucket const& candidates = bucket(key);
+		for (typename Bucket::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
+		{
+			if (equal_((*i)->first, key))
+			{
+				return *i;
+			}
+		}
+
+		return elements_.end();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::const_iterator HashMap<Key, Value, KeyHash, KeyEqual>::find(Key const& key) const
+	{
+		if (buckets_.empty())
+		{
+			return elements_.end();
+		}
+
+		Bucket const& candidates = bucket(key);
+		for (typename Bucket::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
+		{
+			if (equal_((*i)->first, key))
+			{
+				return *i;
+			}
+		}
+
+		return elements_.end();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	std::pair<typename HashMap<Key, Value, KeyHash, KeyEqual>::iterator, Bool> HashMap<Key, Value, KeyHash, KeyEqual>::insert(value_type const& value)
+	{
+		iterator found = find(value.first);
+		if (found != elements_.end())
+		{
+			return std::make_pair(found, false);
+		}
+
+		// keep the load factor under one
+		if (size_ + 1 > buckets_.size())
+		{
+			rebuild((buckets_.size() < 16) ? 16 : buckets_.size() * 2);
+		}
+
+		iterator inserted = elements_.insert(elements_.end(), value);
+		bucket(value.first).push_back(inserted);
+		++size_;
+
+		return std::make_pair(inserted, true);
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	Value& HashMap<Key, Value, KeyHash, KeyEqual>::operator[](Key const& key)
+	{
+		return insert(value_type(key, Value())).first->second;
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	void HashMap<Key, Value, KeyHash, KeyEqual>::erase(iterator position)
+	{
+		Bucket& candidates = bucket(position->first);
+		for (typename Bucket::iterator i = candidates.begin(); i != candidates.end(); ++i)
+		{
+			if (*i == position)
+			{
+				*i = candidates.back();
+				candidates.pop_back();
+				break;
+			}
+		}
+
+		elements_.erase(position);
+		--size_;
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	typename HashMap<Key, Value, KeyHash, KeyEqual>::size_type HashMap<Key, Value, KeyHash, KeyEqual>::erase(Key const& key)
+	{
+		iterator found = find(key);
+		if (found == elements_.end())
+		{
+			return 0;
+		}
+
+		erase(found);
+		return 1;
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	void HashMap<Key, Value, KeyHash, KeyEqual>::clear()
+	{
+		elements_.clear();
+		size_ = 0;
+		buckets_.clear();
+	}
+
+	template<typename Key, typename Value, typename KeyHash, typename KeyEqual>
+	void HashMap<Key, Value, KeyHash, KeyEqual>::rebuild(size_type const buckets)
+	{
+		buckets_.clear();
+		buckets_.resize(buckets);
+
+		if (buckets == 0)
+		{
+			return;
+		}
+
+		for (iterator i = elements_.begin(); i != elements_.end(); ++i)
+		{
+			bucket(i->first).push_back(i);
+		}
+	}
+
+} // namespace rengine
+
+#endif //__RENGINE_HASH_MAP_H__
@@ -11,6 +11,8 @@
 #include <rengine/lang/exception/BaseExceptions.h>
 #include <rengine/RenderEngine.h>
 #include <rengine/time/Timer.h>
+#include <rengine/time/Profiler.h>
+#include <rengine/time/FrameProfiler.h>
 #include <rengine/Scene.h>
 #include <rengine/camera/Camera.h>
 #include <rengine/event/EventManager.h>
@@ -21,6 +23,12 @@
 #include <rengine/thread/Thread.h>
 
 #include <rengine/state/BaseStates.h>
+#include <rengine/state/RenderTargetPool.h>
+#include <rengine/file/VirtualFileSystem.h>
+
+#include <sstream>
+#include <iomanip>
+#include <cmath>
 
 //soft openal
 extern "C" 
@@ -46,6 +54,37 @@ namespace rengine
 		}
 	};
 
+	class CoreEngineProfilerCommands : public SystemCommand::Handler
+	{
+	public:
+		enum Commands
+		{
+			ProfilerExport
+		};
+
+		virtual ~CoreEngineProfilerCommands()
+		{
+		}
+
+		virtual void operator()(SystemCommand::CommandId const command, SystemCommand::Arguments const& arguments)
+		{
+			if (command == ProfilerExport)
+			{
+				std::string const filename = (arguments.size() > 1) ? arguments[1]->toString() : "profile.json";
+
+				Profiler::instance().collect();
+				if (Profiler::instance().exportChromeTrace(filename))
+				{
+					CoreEngine::instance()->log() << "Profile written to " << filename << std::endl;
+				}
+				else
+				{
+					CoreEngine::instance()->log() << "Unable to write the profile to " << filename << std::endl;
+				}
+			}
+		}
+	};
+
 	struct CoreEngine::Implementation
 	{
 		Implementation()
@@ -71,11 +110,42 @@ namespace rengine
 		GraphicsWindow* current_context_;
 		EngineConfiguration engine_configuration_;
 		SharedPointer<HudWriter> writer_;
+		VirtualFileSystem file_system_;
 		ResourceManager resource_manager_;
+		RenderTargetPool render_target_pool_;
 
 		DrawStates output_draw_states;
+
+		SharedPointer<SystemVariable> profiler_enabled;
+		SharedPointer<SystemVariable> profiler_trace_size;
+		CoreEngineProfilerCommands profiler_commands;
+
+		FrameProfiler frame_profiler_;
+		SharedPointer<SystemVariable> profiler_hud;
+
+		FrameProfiler::SectionId events_section;
+		FrameProfiler::SectionId update_section;
+		FrameProfiler::SectionId render_section;
+		FrameProfiler::SectionId resources_section;
+		FrameProfiler::SectionId scene_section;
+		FrameProfiler::SectionId console_section;
+		FrameProfiler::SectionId hud_section;
+		FrameProfiler::SectionId swap_section;
 	};
 
+	// width of a hud table column, in reference glyphs
+	static Real const hud_column_glyphs = 7.0f;
+	static Real const hud_name_column_glyphs = 14.0f;
+	// height of the frame time graph, in lines
+	static Uint const hud_graph_lines = 5;
+
+	static std::string hudMilliseconds(Real64 const milliseconds)
+	{
+		std::stringstream text;
+		text << std::fixed << std::setprecision(2) << milliseconds;
+		return text.str();
+	}
+
 	CoreEngine::CoreEngine() :
 		implementation(new Implementation()),
 		engine_started_(false),
@@ -83,6 +153,18 @@ namespace rengine
 	{
 		implementation->current_context_ = 0;
 		implementation->camera_ = new Camera();
+		implementation->file_system_.mountDirectory("");
+
+		// registration order is the hud order
+		FrameProfiler& frame_profiler = implementation->frame_profiler_;
+		implementation->events_section = frame_profiler.section("events");
+		implementation->update_section = frame_profiler.section("update");
+		implementation->render_section = frame_profiler.section("render");
+		implementation->resources_section = frame_profiler.section("resources");
+		implementation->scene_section = frame_profiler.section("scene render");
+		implementation->console_section = frame_profiler.section("console");
+		implementation->hud_section = frame_profiler.section("hud");
+		implementation->swap_section = frame_profiler.section("swap");
 
 		log().registerPrinter(new CoutStringPrinter());
 	}
@@ -96,6 +178,7 @@ namespace rengine
 		implementation->console_.shutdown();
 		implementation->event_manager_.shutdown();
 		implementation->writer_ = 0;
+		renderTargetPool().clear();
 
 		renderEngine().shutdown();
 		windows().clear();
@@ -151,6 +234,25 @@ namespace rengine
 
 		eventManager().configure();
 
+		implementation->profiler_enabled = new SystemVariable("profiler_enabled", false);
+		implementation->profiler_enabled->setDescription("records the scopes of every thread, profilerExport writes them");
+		system().registerVariable(implementation->profiler_enabled);
+
+		implementation->profiler_trace_size = new SystemVariable("profiler_trace_size", Int(1024 * 1024));
+		implementation->profiler_trace_size->setDescription("recorded events kept per thread, the oldest are dropped");
+		system().registerVariable(implementation->profiler_trace_size);
+
+		system().registerCommand(
+				new SystemCommand("profilerExport", CoreEngineProfilerCommands::ProfilerExport, &implementation->profiler_commands,
+								  "writes the recorded scopes as a chrome trace, profilerExport <filename>")
+				);
+
+		implementation->profiler_hud = new SystemVariable("profiler_hud", false);
+		implementation->profiler_hud->setDescription("shows the frame sections times and a frame time graph");
+		system().registerVariable(implementation->profiler_hud);
+
+		RENGINE_PROFILE_THREAD("render");
+
 		console().registerSystemFeed(&system());
 
 		log().clearPrinters();
@@ -289,6 +391,9 @@ namespace rengine
 
 	void CoreEngine::frame()
 	{
+		Profiler::instance().setEnabled(implementation->profiler_enabled && implementation->profiler_enabled->asBool());
+		frameProfiler().beginFrame();
+
 		handleEvents();
 		update();
 
@@ -304,6 +409,15 @@ namespace rengine
 		//}
 
 
+		frameProfiler().endFrame();
+
+		// drained every frame, before the thread rings wrap, the trace keeps the newest events of the capture
+		if (Profiler::instance().enabled())
+		{
+			Profiler::instance().setTraceSize(Uint(maximum(implementation->profiler_trace_size->asInt(), Int(1))));
+			Profiler::instance().collect();
+		}
+
 		last_frame_time_seconds_ = timer().advanceOperation();
 		frame_delta_seconds_ = timer().operationTime();
 	}
@@ -338,6 +452,8 @@ namespace rengine
 
 	void CoreEngine::handleEvents()
 	{
+		FrameProfiler::ScopedSection section(frameProfiler(), implementation->events_section);
+
 		// loop each window
 
 		for (Uint current_window = 0; current_window != windows().size(); ++current_window)
@@ -358,6 +474,8 @@ namespace rengine
 
 	void CoreEngine::update()
 	{
+		FrameProfiler::ScopedSection section(frameProfiler(), implementation->update_section);
+
 		if (implementation->camera_)
 		{
 			camera()->update();
@@ -371,38 +489,159 @@ namespace rengine
 
 	void CoreEngine::render()
 	{
+		FrameProfiler::ScopedSection section(frameProfiler(), implementation->render_section);
+
 		renderEngine().preFrame();
 
+		// gpu times arrive a few frames late, they are recorded with the frame that reads them
+		RenderEngine::GpuPassTimes const& gpu_times = renderEngine().gpuPassTimes();
+		for (RenderEngine::GpuPassTimes::const_iterator i = gpu_times.begin(); i != gpu_times.end(); ++i)
+		{
+			frameProfiler().record(frameProfiler().section("gpu " + i->first), i->second);
+		}
+
+		// uploads of asynchronous loads, before the scene uses them
+		{
+			FrameProfiler::ScopedSection resources(frameProfiler(), implementation->resources_section);
+			resourceManager().finalizeAsyncLoads();
+			resourceManager().enforceMemoryBudget();
+			resourceManager().updateHotReload();
+		}
+
 		// render scene
 		if (implementation->scene_)
 		{
+			FrameProfiler::ScopedSection scene_render(frameProfiler(), implementation->scene_section);
+
+			renderEngine().beginGpuPass("scene");
 			scene()->render();
+			renderEngine().endGpuPass();
 		}
 
+		renderEngine().beginGpuPass("overlay");
+
 		renderEngine().pushDrawStates();
 		renderEngine().apply(implementation->output_draw_states);
 
 		// render console
 		if ( console().state() > Console::closed )
 		{
+			FrameProfiler::ScopedSection console_render(frameProfiler(), implementation->console_section);
 			renderEngine().draw( console() );
 		}
 
 
-		writer().clear();
-		writer().write(Vector2D(0.0f, 0.0f), " frame : " + lexical_cast<std::string>( frameNumber() ) + " "
-											 " fps : " + lexical_cast<std::string>( timer().getFps() ) +
-				                         //    " frame time: " + lexical_cast<std::string>( frameDeltaTime()) +
-				                             " global time: " + lexical_cast<std::string>( frameGlobalTime() ) );
+		{
+			FrameProfiler::ScopedSection hud(frameProfiler(), implementation->hud_section);
+
+			writer().clear();
+			writer().write(Vector2D(0.0f, 0.0f), " frame : " + lexical_cast<std::string>( frameNumber() ) + " "
+												 " fps : " + lexical_cast<std::string>( timer().getFps() ) +
+					                         //    " frame time: " + lexical_cast<std::string>( frameDeltaTime()) +
+					                             " global time: " + lexical_cast<std::string>( frameGlobalTime() ) );
+
+			if (implementation->profiler_hud && implementation->profiler_hud->asBool())
+			{
+				writeFrameProfiler();
+			}
 
-		renderEngine().draw( writer() );
+			renderEngine().draw( writer() );
+		}
 
 		renderEngine().popDrawStates();
 
-		renderEngine().postFrame();
+		renderEngine().endGpuPass();
+
+		{
+			FrameProfiler::ScopedSection swap(frameProfiler(), implementation->swap_section);
+			renderEngine().postFrame();
+		}
 		renderEngine().checkErrors("End Of Frame : ");
 	}
 
+	void CoreEngine::writeFrameProfiler()
+	{
+		Font::Glyph* glyph = writer().getFont() ? writer().getFont()->referenceGlyph() : 0;
+		if (!glyph)
+		{
+			return;
+		}
+
+		FrameProfiler const& frame_profiler = frameProfiler();
+		Uint const sections = frame_profiler.numberOfSections();
+
+		Real const glyph_width = Real(glyph->dimension().x());
+		Real const glyph_height = Real(glyph->dimension().y());
+		Real const line_height = glyph_height * 1.25f;
+		Real const name_width = glyph_width * hud_name_column_glyphs;
+		Real const column_width = glyph_width * hud_column_glyphs;
+
+		// the table grows up from above the status line, the first section at the top
+		Real y = line_height * Real(sections + 1);
+
+		Char const* headers[] = { "min", "avg", "p95", "p99", "max" };
+		writer().write(Vector2D(0.0f, y), " section (ms)");
+		for (Uint column = 0; column != 5; ++column)
+		{
+			writer().write(Vector2D(name_width + column_width * Real(column), y), headers[column]);
+		}
+
+		for (FrameProfiler::SectionId section = 0; section != sections; ++section)
+		{
+			y -= line_height;
+
+			FrameProfiler::Statistics const statistics = frame_profiler.statistics(section);
+			if (statistics.samples == 0)
+			{
+				continue;
+			}
+
+			std::string const indent(1 + 2 * frame_profiler.sectionDepth(section), ' ');
+			writer().write(Vector2D(0.0f, y), indent + frame_profiler.sectionName(section));
+
+			Real64 const values[] = { statistics.minimum, statistics.average, statistics.percentile_95, statistics.percentile_99, statistics.maximum };
+			for (Uint column = 0; column != 5; ++column)
+			{
+				writer().write(Vector2D(name_width + column_width * Real(column), y), hudMilliseconds(values[column]));
+			}
+		}
+
+		// counters of the last frame, between the table and the graph
+		RenderEngine const& render_engine = renderEngine();
+		writer().write(Vector2D(0.0f, line_height * Real(sections + 2)),
+					   " draws " + lexical_cast<std::string>(render_engine.frameCounter(RenderEngine::DrawCalls)) +
+					   "  states " + lexical_cast<std::string>(render_engine.frameStateChanges()) +
+					   "  textures " + lexical_cast<std::string>(render_engine.frameCounter(RenderEngine::TextureBinds)) +
+					   "  uploads " + lexical_cast<std::string>(render_engine.frameCounter(RenderEngine::BufferUploadBytes) / 1024) + " KB" +
+					   "  uniforms " + lexical_cast<std::string>(render_engine.frameCounter(RenderEngine::UniformUploads)));
+
+		// frame time graph above the table, one column per frame of the window scaled to the slowest one
+		FrameProfiler::Samples const frame_times = frame_profiler.samples(FrameProfiler::FrameSection);
+		FrameProfiler::Statistics const frame_statistics = frame_profiler.statistics(FrameProfiler::FrameSection);
+		if (frame_times.empty() || (frame_statistics.maximum <= 0.0))
+		{
+			return;
+		}
+
+		Real const graph_y = line_height * Real(sections + 3);
+		Real const graph_column_width = glyph_width * 0.5f;
+
+		for (Uint frame = 0; frame != frame_times.size(); ++frame)
+		{
+			Uint const lines = Uint(std::ceil(Real64(hud_graph_lines) * frame_times[frame] / frame_statistics.maximum));
+
+			for (Uint line = 0; line != lines; ++line)
+			{
+				writer().write(Vector2D(glyph_width + graph_column_width * Real(frame), graph_y + glyph_height * Real(line)), "|");
+			}
+		}
+
+		writer().write(Vector2D(glyph_width * 2.0f + graph_column_width * Real(frame_profiler.window()), graph_y + glyph_height * Real(hud_graph_lines - 1)),
+					   hudMilliseconds(frame_statistics.maximum) + " ms");
+		writer().write(Vector2D(glyph_width * 2.0f + graph_column_width * Real(frame_profiler.window()), graph_y),
+					   "p99 " + hudMilliseconds(frame_statistics.percentile_99) + " ms");
+	}
+
 	CoreEngine* CoreEngine::instance()
 	{
 		return engine_instance_;
@@ -553,6 +792,36 @@ namespace rengine
 		return shutdown_requested_;
 	}
 
+	VirtualFileSystem& CoreEngine::fileSystem()
+	{
+		return implementation->file_system_;
+	}
+
+	VirtualFileSystem const& CoreEngine::fileSystem() const
+	{
+		return implementation->file_system_;
+	}
+
+	FrameProfiler& CoreEngine::frameProfiler()
+	{
+		return implementation->frame_profiler_;
+	}
+
+	FrameProfiler const& CoreEngine::frameProfiler() const
+	{
+		return implementation->frame_profiler_;
+	}
+
+	RenderTargetPool& CoreEngine::renderTargetPool()
+	{
+		return implementation->render_target_pool_;
+	}
+
+	RenderTargetPool const& CoreEngine::renderTargetPool() const
+	{
+		return implementation->render_target_pool_;
+	}
+
 	StringTable& CoreEngine::locationTable()
 	{
 		return implementation->engine_configuration_.location_table;
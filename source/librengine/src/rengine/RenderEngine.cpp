@@ -7,12 +7,15 @@
 #include <rengine/RenderEngine.h>
 #include <rengine/resource/ResourceManager.h>
 #include <rengine/string/String.h>
+#include <rengine/system/SystemVariable.h>
 
 #include <rengine/state/BaseStates.h>
 #include <rengine/state/Texture.h>
+#include <rengine/image/Mipmap.h>
 #include <rengine/state/Streams.h>
 #include <rengine/state/DrawResource.h>
 #include <rengine/state/FrameBuffer.h>
+#include <rengine/state/ProgramBinaryCache.h>
 
 #include <rengine/outputstream/Log.h>
 
@@ -29,6 +32,13 @@
 #include <cstdlib>
 #include <GL/glew.h>
 
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+#include <GL/wglew.h>
+#elif RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+// glxew.h brings the X11 Bool macro
+extern "C" void (*glXGetProcAddressARB(GLubyte const* name))(void);
+#endif //RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+
 #include <iostream>
 using namespace std;
 
@@ -57,6 +67,20 @@ using namespace std;
 
 static const std::string log_name = "render_engine";
 
+// ARB_get_program_binary, newer than the bundled glew
+#define RENGINE_GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#define RENGINE_GL_PROGRAM_BINARY_LENGTH			0x8741
+#define RENGINE_GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+
+// KHR_parallel_shader_compile, same values as the ARB extension
+#define RENGINE_GL_COMPLETION_STATUS				0x91B1
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+#define RENGINE_GL_CALL __stdcall
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+#define RENGINE_GL_CALL
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
 namespace rengine
 {
 	typedef std::stack< SharedPointer<Matrix> > MatrixStack;
@@ -69,14 +93,83 @@ namespace rengine
 		Bool input_available;
 	};
 
+	typedef void (RENGINE_GL_CALL *GetProgramBinaryFunction) (GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* format, GLvoid* binary);
+	typedef void (RENGINE_GL_CALL *ProgramBinaryFunction) (GLuint program, GLenum format, GLvoid const* binary, GLsizei length);
+	typedef void (RENGINE_GL_CALL *ProgramParameteriFunction) (GLuint program, GLenum name, GLint value);
+	typedef void (RENGINE_GL_CALL *MaxShaderCompilerThreadsFunction) (GLuint count);
+	typedef void (RENGINE_GL_CALL *GetQueryObjectui64Function) (GLuint id, GLenum name, GLuint64EXT* value);
+
+	// frames between a gpu pass and the read back of its time
+	static Uint const gpu_query_latency = 4;
+
+	static Char const* counter_names[RenderEngine::NumberOfCounters] =
+	{
+		"draw_calls",
+		"capability_changes",
+		"blend_function_changes",
+		"blend_equation_changes",
+		"blend_color_changes",
+		"cull_face_changes",
+		"depth_changes",
+		"color_channel_mask_changes",
+		"polygon_mode_changes",
+		"stencil_changes",
+		"operation_buffer_changes",
+		"texture_unit_changes",
+		"program_changes",
+		"texture_binds",
+		"buffer_uploads",
+		"buffer_upload_bytes",
+		"uniform_uploads"
+	};
+
+	struct GpuPass
+	{
+		std::string name;
+		GLuint query;
+	};
+	typedef std::vector<GpuPass> GpuPasses;
+
+	static void* glFunction(Char const* name)
+	{
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+		return (void*) wglGetProcAddress((LPCSTR) name);
+#elif RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+		return (void*) glXGetProcAddressARB((GLubyte const*) name);
+#else
+		return 0;
+#endif
+	}
+
 	struct RenderEngine::PrivateImplementation
 	{
 		PrivateImplementation() :
 			model_view_matrix(new Matrix()),
 			projection_matrix(new Matrix()),
 			draw_states(new DrawStates()),
-			clear_depth(1.0)
+			clear_depth(1.0),
+			non_power_of_two_textures(-1),
+			texture_rectangle(-1),
+			shader_cache_directory(new SystemVariable("shader_cache_directory", "cache/shaders")),
+			get_program_binary(0),
+			program_binary(0),
+			program_parameteri(0),
+			parallel_shader_compile(false),
+			get_query_object_ui64(0),
+			gpu_frame(0),
+			gpu_pass_depth(0),
+			gpu_pass_timed(false)
 		{
+			for (Uint i = 0; i != NumberOfCounters; ++i)
+			{
+				counters[i] = 0;
+				frame_counters[i] = 0;
+			}
+		}
+
+		void count(Counter const counter, Uint64 const value = 1)
+		{
+			counters[counter] += value;
 		}
 
 		SharedPointer<Matrix> model_view_matrix;
@@ -102,6 +195,36 @@ namespace rengine
 
 		std::vector<ChannelInputBinding> channel_input_cache;
 		DrawStates::StateVector empty_state_vector;
+
+		// queried once with the context current, loaders ask from worker threads, -1 until queried
+		Int non_power_of_two_textures;
+		Int texture_rectangle;
+
+		// linked programs kept on disk, the entry points are null when the driver can not return binaries
+		SharedPointer<SystemVariable> shader_cache_directory;
+		ProgramBinaryCache program_binary_cache;
+		GetProgramBinaryFunction get_program_binary;
+		ProgramBinaryFunction program_binary;
+		ProgramParameteriFunction program_parameteri;
+
+		// programs compile in driver threads, completion can be queried without waiting
+		Bool parallel_shader_compile;
+		SharedPointer<Program> placeholder_program;
+
+		// counters of the current frame and of the last finished one
+		Uint64 counters[NumberOfCounters];
+		Uint64 frame_counters[NumberOfCounters];
+		std::vector< SharedPointer<SystemVariable> > counter_variables;
+		SharedPointer<SystemVariable> gpu_time_variable;
+
+		// null without timer queries
+		GetQueryObjectui64Function get_query_object_ui64;
+		GpuPasses gpu_frames[gpu_query_latency];
+		Uint gpu_frame;
+		Uint gpu_pass_depth;
+		Bool gpu_pass_timed;
+		std::vector<GLuint> free_queries;
+		GpuPassTimes gpu_pass_times;
 	};
 
 	RenderEngine::RenderEngine()
@@ -134,15 +257,139 @@ namespace rengine
 		clearDrawStates();
 
 		clearBuffers();
+
+		implementation->non_power_of_two_textures = (glewIsExtensionSupported("GL_ARB_texture_non_power_of_two") == GL_TRUE) ? 1 : 0;
+		implementation->texture_rectangle = (glewIsExtensionSupported("GL_ARB_texture_rectangle") == GL_TRUE) ? 1 : 0;
+
+		implementation->shader_cache_directory->setDescription("directory of the linked shader programs cache, empty disables it");
+		CoreEngine::instance()->system().registerVariable(implementation->shader_cache_directory);
+
+		// core since 4.1
+		Int major = 0;
+		Int minor = 0;
+		Char separator = 0;
+		std::stringstream version_stream(version());
+		version_stream >> major >> separator >> minor;
+
+		if ((major > 4) || ((major == 4) && (minor >= 1)) || (glewIsExtensionSupported("GL_ARB_get_program_binary") == GL_TRUE))
+		{
+			implementation->get_program_binary = (GetProgramBinaryFunction) glFunction("glGetProgramBinary");
+			implementation->program_binary = (ProgramBinaryFunction) glFunction("glProgramBinary");
+			implementation->program_parameteri = (ProgramParameteriFunction) glFunction("glProgramParameteri");
+		}
+
+		GLint binary_formats = 0;
+		if (supportsProgramBinary())
+		{
+			glGetIntegerv(RENGINE_GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats);
+		}
+
+		// the driver may not be able to return any binary
+		if (binary_formats <= 0)
+		{
+			implementation->get_program_binary = 0;
+			implementation->program_binary = 0;
+			implementation->program_parameteri = 0;
+		}
+
+		implementation->program_binary_cache.setDriver(vendor() + " | " + renderer() + " | " + version());
+
+		MaxShaderCompilerThreadsFunction max_shader_compiler_threads = 0;
+		if (glewIsExtensionSupported("GL_KHR_parallel_shader_compile") == GL_TRUE)
+		{
+			max_shader_compiler_threads = (MaxShaderCompilerThreadsFunction) glFunction("glMaxShaderCompilerThreadsKHR");
+		}
+		else if (glewIsExtensionSupported("GL_ARB_parallel_shader_compile") == GL_TRUE)
+		{
+			max_shader_compiler_threads = (MaxShaderCompilerThreadsFunction) glFunction("glMaxShaderCompilerThreadsARB");
+		}
+
+		// as many compiler threads as the driver wants, some drivers compile on the calling thread until asked
+		if (max_shader_compiler_threads)
+		{
+			max_shader_compiler_threads(0xFFFFFFFF);
+			implementation->parallel_shader_compile = true;
+		}
+
+		// core since 3.3, the extension entry point has the same signature
+		if ((major > 3) || ((major == 3) && (minor >= 3)) || (glewIsExtensionSupported("GL_ARB_timer_query") == GL_TRUE))
+		{
+			implementation->get_query_object_ui64 = (GetQueryObjectui64Function) glFunction("glGetQueryObjectui64v");
+		}
+		else if (glewIsExtensionSupported("GL_EXT_timer_query") == GL_TRUE)
+		{
+			implementation->get_query_object_ui64 = (GetQueryObjectui64Function) glFunction("glGetQueryObjectui64vEXT");
+		}
+
+		// read only for the console, updated at the end of each frame, strings hold the whole 64 bit counts
+		implementation->counter_variables.clear();
+		for (Uint i = 0; i != NumberOfCounters; ++i)
+		{
+			SharedPointer<SystemVariable> variable = new SystemVariable(std::string("render_") + counter_names[i], "0", SystemVariable::ConstFlag);
+			variable->setDescription("last frame counter");
+			CoreEngine::instance()->system().registerVariable(variable);
+			implementation->counter_variables.push_back(variable);
+		}
+
+		implementation->gpu_time_variable = new SystemVariable("render_gpu_time", 0.0f, SystemVariable::ConstFlag);
+		implementation->gpu_time_variable->setDescription("milliseconds of the timed gpu passes of a recent frame");
+		CoreEngine::instance()->system().registerVariable(implementation->gpu_time_variable);
     }
 
     void RenderEngine::shutdown()
     {
     	implementation->draw_states = 0;
+
+    	for (Uint i = 0; i != gpu_query_latency; ++i)
+    	{
+    		for (GpuPasses::const_iterator pass = implementation->gpu_frames[i].begin(); pass != implementation->gpu_frames[i].end(); ++pass)
+    		{
+    			implementation->free_queries.push_back(pass->query);
+    		}
+    		implementation->gpu_frames[i].clear();
+    	}
+
+    	if (!implementation->free_queries.empty())
+    	{
+    		glDeleteQueries(GLsizei(implementation->free_queries.size()), &implementation->free_queries[0]);
+    		implementation->free_queries.clear();
+    	}
     }
 
 	void RenderEngine::preFrame()
 	{
+		// the slot of the frame gpu_query_latency frames ago, its results are ready unless the gpu is that far behind
+		implementation->gpu_frame = (implementation->gpu_frame + 1) % gpu_query_latency;
+		GpuPasses& passes = implementation->gpu_frames[implementation->gpu_frame];
+
+		implementation->gpu_pass_times.clear();
+		Real64 gpu_time = 0.0;
+
+		for (GpuPasses::const_iterator pass = passes.begin(); pass != passes.end(); ++pass)
+		{
+			GLint available = 0;
+			glGetQueryObjectiv(pass->query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+			// never waits, a late result is dropped
+			if (available)
+			{
+				GLuint64EXT nanoseconds = 0;
+				implementation->get_query_object_ui64(pass->query, GL_QUERY_RESULT, &nanoseconds);
+
+				Real64 const milliseconds = Real64(nanoseconds) / 1000000.0;
+				implementation->gpu_pass_times[pass->name] += milliseconds;
+				gpu_time += milliseconds;
+			}
+
+			implementation->free_queries.push_back(pass->query);
+		}
+		passes.clear();
+
+		if (implementation->gpu_time_variable && !implementation->gpu_pass_times.empty())
+		{
+			implementation->gpu_time_variable->Variable::set(Real(gpu_time));
+		}
+
 		/*
 		for (Uint current_window = 0; current_window != CoreEngine::instance()->windows().size(); ++current_window)
 		{
@@ -159,6 +406,92 @@ namespace rengine
 			//glFinish();
 			CoreEngine::instance()->windows()[current_window]->swapBuffers();
 		}
+
+		for (Uint i = 0; i != NumberOfCounters; ++i)
+		{
+			implementation->frame_counters[i] = implementation->counters[i];
+			implementation->counters[i] = 0;
+		}
+
+		// past the read only flag
+		for (Uint i = 0; i != implementation->counter_variables.size(); ++i)
+		{
+			implementation->counter_variables[i]->Variable::set(lexical_cast<std::string>(implementation->frame_counters[i]));
+		}
+	}
+
+	Uint64 RenderEngine::frameCounter(Counter const counter) const
+	{
+		return implementation->frame_counters[counter];
+	}
+
+	Uint64 RenderEngine::frameStateChanges() const
+	{
+		Uint64 changes = 0;
+		for (Uint i = CapabilityChanges; i <= ProgramChanges; ++i)
+		{
+			changes += implementation->frame_counters[i];
+		}
+		return changes;
+	}
+
+	Char const* RenderEngine::counterName(Counter const counter)
+	{
+		return counter_names[counter];
+	}
+
+	void RenderEngine::beginGpuPass(std::string const& name)
+	{
+		if (implementation->gpu_pass_depth++ != 0)
+		{
+			return;
+		}
+
+		implementation->gpu_pass_timed = supportsTimerQuery();
+		if (!implementation->gpu_pass_timed)
+		{
+			return;
+		}
+
+		GpuPass pass;
+		pass.name = name;
+
+		if (implementation->free_queries.empty())
+		{
+			glGenQueries(1, &pass.query);
+		}
+		else
+		{
+			pass.query = implementation->free_queries.back();
+			implementation->free_queries.pop_back();
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED_EXT, pass.query);
+		implementation->gpu_frames[implementation->gpu_frame].push_back(pass);
+	}
+
+	void RenderEngine::endGpuPass()
+	{
+		if ((implementation->gpu_pass_depth == 0) || (--implementation->gpu_pass_depth != 0))
+		{
+			return;
+		}
+
+		if (implementation->gpu_pass_timed)
+		{
+			glEndQuery(GL_TIME_ELAPSED_EXT);
+			implementation->gpu_pass_timed = false;
+		}
+	}
+
+	RenderEngine::GpuPassTimes const& RenderEngine::gpuPassTimes() const
+	{
+		return implementation->gpu_pass_times;
+	}
+
+	Bool RenderEngine::supportsTimerQuery() const
+	{
+		return (implementation->get_query_object_ui64 != 0);
 	}
 
 
@@ -207,6 +540,11 @@ namespace rengine
 		return (GLEW_VERSION_2_1 && !GLEW_VERSION_3_0);
 	}
 
+	Bool RenderEngine::supportsProgramBinary() const
+	{
+		return implementation->get_program_binary && implementation->program_binary && implementation->program_parameteri;
+	}
+
 	Bool RenderEngine::checkErrors(std::string const &message)
 	{
 
@@ -507,6 +845,7 @@ namespace rengine
 		{
 			implementation->draw_states->setCapability(capability, value);
 			RENGINE_LOG_CAPABILITY_APPLY
+			implementation->count(CapabilityChanges);
 
 			if (value)
 			{
@@ -522,6 +861,7 @@ namespace rengine
 		{
 			implementation->draw_states->setCapability(capability, value);
 			RENGINE_LOG_CAPABILITY_APPLY
+			implementation->count(CapabilityChanges);
 
 			if (value)
 			{
@@ -538,18 +878,21 @@ namespace rengine
 	void RenderEngine::apply(BlendFunction const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(BlendFunctionChanges);
 		glBlendFunc(state.getSource(), state.getDestination());
 	}
 
 	void RenderEngine::apply(BlendEquation const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(BlendEquationChanges);
 		glBlendEquation(state.get());
 	}
 
 	void RenderEngine::apply(BlendColor const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(BlendColorChanges);
 		Vector4D const& v = state.get();
 		glBlendColor(v.r(), v.g(), v.b(), v.a());
 	}
@@ -557,12 +900,14 @@ namespace rengine
 	void RenderEngine::apply(CullFace const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(CullFaceChanges);
 		glCullFace(state.get());
 	}
 
 	void RenderEngine::apply(Depth const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(DepthChanges);
 	    glDepthFunc(state.getFunction());
 	    glDepthRange(state.getNear(), state.getFar());
 	    glDepthMask(state.getWriteFlag());
@@ -571,12 +916,14 @@ namespace rengine
 	void RenderEngine::apply(ColorChannelMask const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(ColorChannelMaskChanges);
 		glColorMask(GLboolean(state.getRed()), GLboolean(state.getGreen()), GLboolean(state.getBlue()), GLboolean(state.getAlpha()));
 	}
 
 	void RenderEngine::apply(PolygonMode const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(PolygonModeChanges);
 
 		PolygonMode::Mode const& front = state.getFront();
 		PolygonMode::Mode const& back = state.getBack();
@@ -595,6 +942,7 @@ namespace rengine
 	void RenderEngine::apply(Stencil const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(StencilChanges);
 
 	    glStencilFunc(state.getFunction(), state.getReference(), state.getMask());
 	    glStencilOp(state.getStencilFail(), state.getStencilPassDepthFail(), state.getStencilPassDepthPass());
@@ -604,6 +952,7 @@ namespace rengine
 	void RenderEngine::apply(OperationBuffer const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(OperationBufferChanges);
 
 		glDrawBuffer(state.getDrawBuffer());
 		glReadBuffer(state.getReadBuffer());
@@ -612,6 +961,7 @@ namespace rengine
 	void RenderEngine::apply(Texture2DUnit const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(TextureUnitChanges);
 
 		glActiveTexture(GL_TEXTURE0 + state.getUnit());
 		apply(*state.getTexture().get());
@@ -620,9 +970,21 @@ namespace rengine
 	void RenderEngine::apply(ProgramUnit const& state)
 	{
 		RENGINE_LOG_STATE_APPLY
+		implementation->count(ProgramChanges);
 
 		implementation->program = state.get();
 
+		// a program still compiling is drawn with the placeholder
+		if (implementation->program && implementation->placeholder_program && (implementation->program != implementation->placeholder_program))
+		{
+			submit(*implementation->program);
+
+			if (!programReady(*implementation->program))
+			{
+				implementation->program = implementation->placeholder_program;
+			}
+		}
+
 		if (implementation->program)
 		{
 			apply(*implementation->program.get());
@@ -717,13 +1079,42 @@ namespace rengine
 	//
 	// Texture
 	//
+
+	// uploads levels 1 to n of the texture mipmap chain, the texture must be bound
+	static void uploadMipmaps(Texture2D& texture)
+	{
+		SharedPointer<MipmapChain> const& mipmaps = texture.getMipmaps();
+		Uint const levels = mipmaps->numberOfLevels();
+
+		for (Uint level = 1; level < levels; ++level)
+		{
+			Image const& image = *mipmaps->level(level);
+			glTexImage2D(GL_TEXTURE_2D, level, texture.getInternalFormat(), image.getWidth(), image.getHeight(), 0,
+						 texture.getFormat(), GL_UNSIGNED_BYTE, image.getData());
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (levels > 0) ? Int(levels - 1) : 0);
+
+		if (texture.isFlagSet(Texture2D::ReleaseImage))
+		{
+			texture.releaseMipmaps();
+		}
+	}
+
 	void RenderEngine::apply(Texture2D& texture)
 	{
 		Bool const trilinear_filtering = false;
 		Real const maximum_anisotropy = 1.0f;
 
+		implementation->count(TextureBinds);
+
 		ResourceId id = texture.getId(this);
 
+		if (texture.mipmapsPending())
+		{
+			texture.collectMipmaps();
+		}
+
 		Uint change_flags = Uint( texture.changeFlags() );
 		Uint texture_flags = texture.getFlags();
 
@@ -783,11 +1174,16 @@ namespace rengine
 			//
 			if (change_flags & Texture2D::ImageDataChanged)
 			{
-				if (texture.isFlagSet(Texture2D::GenerateMipmap))
+				Bool const generate_mipmap = texture.isFlagSet(Texture2D::GenerateMipmap);
+
+				if (generate_mipmap)
 				{
-					CoreEngine::instance()->log() << "GL_GENERATE_MIPMAP is deprecated!" << std::endl;
+					if (!texture.getMipmaps() && !texture.mipmapsPending())
+					{
+						texture.buildMipmaps(texture.isFlagSet(Texture2D::GenerateMipmapAsync));
+					}
+
 					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maximum_anisotropy);
-					glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
 				}
 
 
@@ -801,6 +1197,16 @@ namespace rengine
 
 				checkErrors("before:");
 				glTexImage2D(GL_TEXTURE_2D, 0, texture.getInternalFormat(), texture.getWidth(), texture.getHeight(), 0, texture.getFormat(), type, data);
+
+				if (generate_mipmap && texture.getMipmaps())
+				{
+					uploadMipmaps(texture);
+				}
+				else if (generate_mipmap)
+				{
+					// only the base level is usable until the chain is built
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+				}
 				checkErrors("after:");
 
 				if (texture.isFlagSet(Texture2D::ReleaseImage))
@@ -808,6 +1214,11 @@ namespace rengine
 					texture.setImage(0);
 				}
 			}
+			else if ((change_flags & Texture2D::MipmapDataChanged) && texture.getMipmaps())
+			{
+				uploadMipmaps(texture);
+				checkErrors("mipmaps:");
+			}
 
 			texture.clearChangeFlags();
 		}
@@ -819,12 +1230,37 @@ namespace rengine
 
 	Bool RenderEngine::supportsNonPowerOfTwoTextures() const
 	{
-		return (glewIsExtensionSupported("GL_ARB_texture_non_power_of_two") == GL_TRUE);
+		if (implementation->non_power_of_two_textures < 0)
+		{
+			return (glewIsExtensionSupported("GL_ARB_texture_non_power_of_two") == GL_TRUE);
+		}
+
+		return (implementation->non_power_of_two_textures != 0);
 	}
 
 	Bool RenderEngine::supportsTextureRectangle() const
 	{
-		return (glewIsExtensionSupported("GL_ARB_texture_rectangle") == GL_TRUE);
+		if (implementation->texture_rectangle < 0)
+		{
+			return (glewIsExtensionSupported("GL_ARB_texture_rectangle") == GL_TRUE);
+		}
+
+		return (implementation->texture_rectangle != 0);
+	}
+
+	void RenderEngine::prepare(Texture2D& texture)
+	{
+		if (!texture.changeFlags() && texture.getId(this))
+		{
+			return;
+		}
+
+		GLint bound = 0;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+
+		apply(texture);
+
+		glBindTexture(GL_TEXTURE_2D, GLuint(bound));
 	}
 
 	Uint RenderEngine::maximumTextureSizeSupported() const
@@ -904,159 +1340,275 @@ namespace rengine
 			if (program.isChangeFlagSet(Program::VertexShaderChanged) ||
 				program.isChangeFlagSet(Program::FragmentShaderChanged))
 			{
-				std::stringstream shader_log;
+				submit(program);
+			}
 
-				// load shaders if needed
-				Uint number_of_shaders_loaded = 0;
+			// waits for the driver if it is still compiling
+			if (program.isChangeFlagSet(Program::LinkPending))
+			{
+				completeProgram(program);
+			}
 
-				Uint current_shader = Uint (Shader::Fragment);
-				Uint end_shader = Uint (Shader::Vertex) + 1;
+			glUseProgram( program.getId(this) );
 
-				while (current_shader != end_shader)
-				{
-					if (program.getShader(Shader::Type(current_shader)))
-					{
-						if (!program.getShader(Shader::Type(current_shader))->drawResourceLoaded(this))
-						{
-							std::string log;
-							loadShader(*program.getShader(Shader::Type(current_shader)), log);
-							log = trim(TrimBoth, log);
-
-							if (!log.empty() && 
-								!endsWith(log, "No errors.") //Mobile Intel(R) 4 Series Express Chipset Family
-								)
-							{
-								displayShaderLog(*program.getShader(Shader::Type(current_shader)), shader_log, log);
-							}
-
-							if (!program.getShader(Shader::Type(current_shader))->drawResourceLoaded(this))
-							{
-								program.removeShader(Shader::Type(current_shader));
-							}
-						}
-					}
+			//
+			// Apply Uniform Values
+			//
+			if (program.isChangeFlagSet(Program::UniformsChanged))
+			{
+				updateUniforms(program);
+			}
 
-					if (program.getShader(Shader::Type(current_shader)))
-					{
-						number_of_shaders_loaded += program.getShader(Shader::Type(current_shader))->drawResourceLoaded(this) ? 1 : 0;
-					}
+			program.clearChangeFlags();
+		}
+		else
+		{
+			glUseProgram( program.getId(this) );
+		}
+	}
 
-					current_shader++;
-				}
+	void RenderEngine::submit(Program& program)
+	{
+		if (!program.isChangeFlagSet(Program::VertexShaderChanged) &&
+			!program.isChangeFlagSet(Program::FragmentShaderChanged))
+		{
+			return;
+		}
+
+		program.changeFlags() &= ~(Program::VertexShaderChanged | Program::FragmentShaderChanged);
+
+		// a cached binary is neither compiled nor linked
+		if (loadProgramBinary(program))
+		{
+			std::stringstream shader_log;
+			programLocations(program, shader_log);
+
+			if (!shader_log.str().empty())
+			{
+				displayProgramLog(program, shader_log.str());
+			}
+			return;
+		}
 
-				//
-				// Check if needs link
-				//
-				if (number_of_shaders_loaded)
+		//
+		// Compile the shaders, the status is only queried by completeProgram
+		// so the driver compiles while the other programs are submitted
+		//
+		Uint number_of_shaders = 0;
+
+		Uint current_shader = Uint (Shader::Fragment);
+		Uint end_shader = Uint (Shader::Vertex) + 1;
+
+		while (current_shader != end_shader)
+		{
+			SharedPointer<Shader> const& shader = program.getShader(Shader::Type(current_shader));
+			if (shader)
+			{
+				if (!shader->drawResourceLoaded(this))
 				{
-					//
-					// Rebuild program
-					//
-					ResourceId resource_id = program.getId(this);
-					if (resource_id)
-					{
-						unloadProgram(program);
-					}
+					compileShader(*shader);
+				}
+				++number_of_shaders;
+			}
 
-					resource_id = glCreateProgram();
-					program.setId(resource_id, this);
+			current_shader++;
+		}
 
-					if (program.getShader(Shader::Vertex))
-					{
-						glAttachShader(resource_id, program.getShader(Shader::Vertex)->getId(this));
-					}
+		ResourceId resource_id = program.getId(this);
+		if (resource_id)
+		{
+			unloadProgram(program);
+		}
 
-					if (program.getShader(Shader::Fragment))
-					{
-						glAttachShader(resource_id, program.getShader(Shader::Fragment)->getId(this));
-					}
+		if (!number_of_shaders)
+		{
+			return;
+		}
 
-					//
-					// Link Program and Check for ok
-					//
-					std::string log;
-					linkProgram(program, log);
-					log = trim(TrimBoth, log);
+		//
+		// Rebuild program
+		//
+		resource_id = glCreateProgram();
+		program.setId(resource_id, this);
 
-					if (!log.empty() && 
-						!endsWith(log, "No errors.") //Mobile Intel(R) 4 Series Express Chipset Family
-						)
-					{
-						shader_log << log << std::endl;
-					}
+		if (program.getShader(Shader::Vertex))
+		{
+			glAttachShader(resource_id, program.getShader(Shader::Vertex)->getId(this));
+		}
 
-					//
-					// Get Uniforms location
-					//
-					for (Program::Uniforms::size_type i = 0; i != program.uniforms().size(); ++i)
-					{
-						GLint uniform_id = glGetUniformLocation(resource_id, program.uniforms()[i]->name().c_str() );
-						if (uniform_id == -1)
-						{
-							program.uniforms()[i]->changeFlags() |= Uniform::NotFound;
-							shader_log << "Uniform " << program.uniforms()[i]->name().c_str() << " not found." << std::endl;
-						}
-						else
-						{
-							program.uniforms()[i]->setId(ResourceId(uniform_id), this);
-						}
-					}
+		if (program.getShader(Shader::Fragment))
+		{
+			glAttachShader(resource_id, program.getShader(Shader::Fragment)->getId(this));
+		}
 
-					//
-					// Get Input Locations
-					//
-					for (Program::Connections::size_type i = 0; i != program.inputs().size(); ++i)
-					{
-						//std::cout << "Testing : |" << program.inputs()[i].name.c_str() << "|" << std::endl;
-						program.inputs()[i].id = glGetAttribLocation(resource_id, program.inputs()[i].name.c_str() );
+		startLink(program);
+		program.changeFlags() |= Program::LinkPending;
+	}
 
-						if (program.inputs()[i].id == -1)
-						{
-							shader_log << "Program input " << program.inputs()[i].name << " not found." << std::endl;
-						}
-					}
+	Bool RenderEngine::programReady(Program const& program) const
+	{
+		if (!program.isChangeFlagSet(Program::LinkPending) || !program.getId())
+		{
+			return true;
+		}
 
-					//
-					// Get Frag Data Location
-					//
-					for (Program::Connections::size_type i = 0; i != program.outputs().size(); ++i)
-					{
-						program.outputs()[i].id  = glGetFragDataLocation(resource_id, program.outputs()[i].name.c_str() );
-						if (program.outputs()[i].id == -1)
-						{
-							shader_log << "Program output " << program.outputs()[i].name << " not found." << std::endl;
-						}
-					}
+		// without parallel compile the status query waits for the compiler
+		if (!supportsParallelShaderCompile())
+		{
+			return true;
+		}
+
+		GLint completed = GL_FALSE;
+		glGetProgramiv(program.getId(), RENGINE_GL_COMPLETION_STATUS, &completed);
+
+		return (completed == GL_TRUE);
+	}
 
-					program.prepareConnections();
+	void RenderEngine::completeProgram(Program& program)
+	{
+		if (!program.isChangeFlagSet(Program::LinkPending))
+		{
+			return;
+		}
+		program.changeFlags() &= ~Program::LinkPending;
+
+		std::stringstream shader_log;
+
+		//
+		// Compile status of the shaders compiled by submit
+		//
+		Uint current_shader = Uint (Shader::Fragment);
+		Uint end_shader = Uint (Shader::Vertex) + 1;
+
+		Bool compiled = true;
+		while (current_shader != end_shader)
+		{
+			SharedPointer<Shader> shader = program.getShader(Shader::Type(current_shader));
+			if (shader && shader->isChangeFlagSet(Shader::CompilePending))
+			{
+				std::string log;
+				compiled = shaderStatus(*shader, log) && compiled;
+				log = trim(TrimBoth, log);
+
+				if (!log.empty() &&
+					!endsWith(log, "No errors.") //Mobile Intel(R) 4 Series Express Chipset Family
+					)
+				{
+					displayShaderLog(*shader, shader_log, log);
 				}
 
-				if (!shader_log.str().empty())
+				if (!shader->drawResourceLoaded(this))
 				{
-					displayProgramLog(program, shader_log.str());
+					program.removeShader(Shader::Type(current_shader));
 				}
 			}
 
-			glUseProgram( program.getId(this) );
+			current_shader++;
+		}
 
-			//
-			// Apply Uniform Values
-			//
+		//
+		// Link status
+		//
+		if (program.getId(this))
+		{
+			std::string log;
+			Bool const linked = linkStatus(program, log);
+			log = trim(TrimBoth, log);
 
-			if (program.isChangeFlagSet(Program::VertexShaderChanged) ||
-				program.isChangeFlagSet(Program::FragmentShaderChanged) ||
-				program.isChangeFlagSet(Program::UniformsChanged))
+			if (!log.empty() &&
+				!endsWith(log, "No errors.") //Mobile Intel(R) 4 Series Express Chipset Family
+				)
 			{
-				updateUniforms(program);
+				shader_log << log << std::endl;
+			}
+
+			if (linked && compiled)
+			{
+				saveProgramBinary(program);
+				programLocations(program, shader_log);
+			}
+			else
+			{
+				unloadProgram(program);
 			}
+		}
 
+		// removing a failed shader is not a new change
+		program.changeFlags() &= ~(Program::VertexShaderChanged | Program::FragmentShaderChanged);
 
-			program.clearChangeFlags();
+		if (!shader_log.str().empty())
+		{
+			displayProgramLog(program, shader_log.str());
 		}
-		else
+	}
+
+	void RenderEngine::programLocations(Program& program, std::stringstream& shader_log)
+	{
+		ResourceId resource_id = program.getId(this);
+
+		//
+		// Get Uniforms location
+		//
+		for (Program::Uniforms::size_type i = 0; i != program.uniforms().size(); ++i)
 		{
-			glUseProgram( program.getId(this) );
+			GLint uniform_id = glGetUniformLocation(resource_id, program.uniforms()[i]->name().c_str() );
+			if (uniform_id == -1)
+			{
+				program.uniforms()[i]->changeFlags() |= Uniform::NotFound;
+				shader_log << "Uniform " << program.uniforms()[i]->name().c_str() << " not found." << std::endl;
+			}
+			else
+			{
+				program.uniforms()[i]->setId(ResourceId(uniform_id), this);
+
+				// a new program holds none of the values
+				program.uniforms()[i]->changeFlags() |= Uniform::ValueChanged;
+			}
 		}
+		program.changeFlags() |= Program::UniformsChanged;
+
+		//
+		// Get Input Locations
+		//
+		for (Program::Connections::size_type i = 0; i != program.inputs().size(); ++i)
+		{
+			//std::cout << "Testing : |" << program.inputs()[i].name.c_str() << "|" << std::endl;
+			program.inputs()[i].id = glGetAttribLocation(resource_id, program.inputs()[i].name.c_str() );
+
+			if (program.inputs()[i].id == -1)
+			{
+				shader_log << "Program input " << program.inputs()[i].name << " not found." << std::endl;
+			}
+		}
+
+		//
+		// Get Frag Data Location
+		//
+		for (Program::Connections::size_type i = 0; i != program.outputs().size(); ++i)
+		{
+			program.outputs()[i].id  = glGetFragDataLocation(resource_id, program.outputs()[i].name.c_str() );
+			if (program.outputs()[i].id == -1)
+			{
+				shader_log << "Program output " << program.outputs()[i].name << " not found." << std::endl;
+			}
+		}
+
+		program.prepareConnections();
+	}
+
+	void RenderEngine::setPlaceholderProgram(SharedPointer<Program> const& program)
+	{
+		implementation->placeholder_program = program;
+	}
+
+	SharedPointer<Program> const& RenderEngine::placeholderProgram() const
+	{
+		return implementation->placeholder_program;
+	}
+
+	Bool RenderEngine::supportsParallelShaderCompile() const
+	{
+		return implementation->parallel_shader_compile;
 	}
 
 	void RenderEngine::updateUniforms(Program& program)
@@ -1068,6 +1620,8 @@ namespace rengine
 			if (!uniform->isChangeFlagSet(Uniform::NotFound) &&
 				 uniform->isChangeFlagSet(Uniform::ValueChanged))
 			{
+				implementation->count(UniformUploads);
+
 				switch (uniform->type())
 				{
 					case Uniform::FloatUniform:
@@ -1120,11 +1674,109 @@ namespace rengine
 		}
 	}
 
+	static std::string shaderSource(Program const& program, Shader::Type const type)
+	{
+		return program.getShader(type) ? program.getShader(type)->source() : std::string();
+	}
+
+	Bool RenderEngine::loadProgramBinary(Program& program)
+	{
+		ProgramBinaryCache& cache = implementation->program_binary_cache;
+		cache.setDirectory(implementation->shader_cache_directory->asString());
+
+		if (!supportsProgramBinary() || !cache.enabled())
+		{
+			return false;
+		}
+
+		std::string const vertex_source = shaderSource(program, Shader::Vertex);
+		std::string const fragment_source = shaderSource(program, Shader::Fragment);
+
+		Uint format = 0;
+		ProgramBinaryCache::Binary binary;
+		if ((vertex_source.empty() && fragment_source.empty()) || !cache.load(vertex_source, fragment_source, format, binary))
+		{
+			return false;
+		}
+
+		ResourceId resource_id = glCreateProgram();
+		implementation->program_binary(resource_id, GLenum(format), &binary[0], GLsizei(binary.size()));
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(resource_id, GL_LINK_STATUS, &linked);
+
+		if (!linked)
+		{
+			// the driver changed, compiled and stored again
+			glDeleteProgram(resource_id);
+			cache.remove(vertex_source, fragment_source);
+			return false;
+		}
+
+		if (program.getId(this))
+		{
+			unloadProgram(program);
+		}
+		program.setId(resource_id, this);
+
+		return true;
+	}
+
+	void RenderEngine::saveProgramBinary(Program& program)
+	{
+		ProgramBinaryCache const& cache = implementation->program_binary_cache;
+		ResourceId resource_id = program.getId(this);
+
+		if (!supportsProgramBinary() || !cache.enabled() || !resource_id)
+		{
+			return;
+		}
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(resource_id, GL_LINK_STATUS, &linked);
+
+		GLint length = 0;
+		glGetProgramiv(resource_id, RENGINE_GL_PROGRAM_BINARY_LENGTH, &length);
+
+		if (!linked || (length <= 0))
+		{
+			return;
+		}
+
+		ProgramBinaryCache::Binary binary(length);
+		GLsizei written = 0;
+		GLenum format = 0;
+		implementation->get_program_binary(resource_id, length, &written, &format, &binary[0]);
+
+		if (written > 0)
+		{
+			binary.resize(written);
+			cache.save(shaderSource(program, Shader::Vertex), shaderSource(program, Shader::Fragment), Uint(format), binary);
+		}
+	}
+
 	void RenderEngine::linkProgram(Program& program, std::string& log)
+	{
+		startLink(program);
+		linkStatus(program, log);
+	}
+
+	void RenderEngine::startLink(Program& program)
 	{
 		ResourceId resource_id = program.getId(this);
 
+		// some drivers only return binaries of programs linked with the hint
+		if (supportsProgramBinary() && implementation->program_binary_cache.enabled())
+		{
+			implementation->program_parameteri(resource_id, RENGINE_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
 		glLinkProgram(resource_id);
+	}
+
+	Bool RenderEngine::linkStatus(Program& program, std::string& log)
+	{
+		ResourceId resource_id = program.getId(this);
 
 		GLint linked = GL_FALSE;
 		glGetProgramiv(resource_id, GL_LINK_STATUS, &linked);
@@ -1154,9 +1806,31 @@ namespace rengine
 		}
 
 		log = shader_log.str();
+		return (linked == GL_TRUE);
+	}
+
+	void RenderEngine::prepare(Program& program)
+	{
+		if (!program.changeFlags())
+		{
+			return;
+		}
+
+		GLint current = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+
+		apply(program);
+
+		glUseProgram(GLuint(current));
 	}
 
 	void RenderEngine::loadShader(Shader& shader, std::string& log)
+	{
+		compileShader(shader);
+		shaderStatus(shader, log);
+	}
+
+	void RenderEngine::compileShader(Shader& shader)
 	{
 		Char const* source_as_char= shader.source().c_str();
 
@@ -1165,6 +1839,15 @@ namespace rengine
 		glShaderSource(resource_id, 1, &source_as_char, 0);
 		glCompileShader(resource_id);
 
+		shader.setId(resource_id, this);
+		shader.changeFlags() |= Shader::CompilePending;
+	}
+
+	Bool RenderEngine::shaderStatus(Shader& shader, std::string& log)
+	{
+		ResourceId resource_id = shader.getId(this);
+		shader.changeFlags() &= ~Shader::CompilePending;
+
 		GLint compiled = GL_FALSE;
 		glGetShaderiv(resource_id, GL_COMPILE_STATUS, &compiled);
 
@@ -1205,14 +1888,13 @@ namespace rengine
 	        }
 	    }
 
-	    shader.setId(resource_id, this);
-
 		log = shader_log.str();
 		if (!compiled)
 		{
-
 			unloadShader(shader);
 		}
+
+		return (compiled == GL_TRUE);
 	}
 
 	void RenderEngine::unloadShader(Shader& shader)
@@ -1245,6 +1927,8 @@ namespace rengine
 			glUseProgram(0);
 			program.setId(0, this);
 		}
+
+		program.changeFlags() &= ~Program::LinkPending;
 	}
 
 	void RenderEngine::displayShaderLog(Shader& shader, std::stringstream& shader_log, std::string& info)
@@ -1345,6 +2029,8 @@ namespace rengine
 
 	void RenderEngine::drawVertexArrayObject(VertexArrayObject& vertex_array_object, VertexBuffer& vertex_buffer)
 	{
+		implementation->count(DrawCalls);
+
 		bindVertexArrayObject(vertex_array_object);
 		glDrawArrays(GL_TRIANGLES, 0, vertex_buffer.size());
 		unbindVertexArrayObject(vertex_array_object);
@@ -1352,6 +2038,8 @@ namespace rengine
 
 	void RenderEngine::drawVertexArrayObject(VertexArrayObject& vertex_array_object, Drawable::IndexVector& index_buffer)
 	{
+		implementation->count(DrawCalls);
+
 		bindVertexArrayObject(vertex_array_object);
 		glDrawElements(GL_TRIANGLES, index_buffer.size(), GL_UNSIGNED_INT, VertexBuffer::DataPointer(0));
 		unbindVertexArrayObject(vertex_array_object);
@@ -1375,6 +2063,9 @@ namespace rengine
 
 		//glBufferData(GL_ARRAY_BUFFER, vertex_buffer.vertexSize() * vertex_buffer.size(), NULL, GL_STATIC_DRAW);
 		glBufferData(GL_ARRAY_BUFFER, vertex_buffer.vertexSize() * vertex_buffer.size(), vertex_buffer.data(), mode);
+
+		implementation->count(BufferUploads);
+		implementation->count(BufferUploadBytes, Uint64(vertex_buffer.vertexSize()) * Uint64(vertex_buffer.size()));
 	}
 
 	void RenderEngine::bindVertexBufferObject(VertexBufferObject const& vertex_buffer_object, VertexBuffer const& vertex_buffer)
@@ -1490,6 +2181,9 @@ namespace rengine
 		//glBufferData(GL_ARRAY_BUFFER, vertex_buffer.vertexSize() * vertex_buffer.size(), NULL, GL_STATIC_DRAW);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Drawable::IndexType) * index_buffer.size(), &index_buffer[0], mode);
 
+		implementation->count(BufferUploads);
+		implementation->count(BufferUploadBytes, Uint64(sizeof(Drawable::IndexType)) * Uint64(index_buffer.size()));
+
 	}
 
 	void RenderEngine::unloadVertexBufferObject(VertexBufferObject& vertex_buffer_object)
@@ -1,6 +1,7 @@
 // __!!rengine_copyright!!__ //
 
 #include <rengine/capture/ThreadedVideoCapture.h>
+#include <rengine/time/Profiler.h>
 
 namespace rengine
 {
@@ -73,13 +74,18 @@ namespace rengine
 
 	void ThreadedVideoCapture::run()
 	{
+		RENGINE_PROFILE_THREAD("capture");
+
 		FrameOptions options;
 		SharedPointer<Frame> frame = 0;
 
 		while(keepRunning())
 		{
+			{
+				RENGINE_PROFILE_SCOPE("capture grab");
+				frame = m_video_capture->grab(options, frame);
+			}
 
-			frame = m_video_capture->grab(options, frame);
 			if (frame)
 			{
 				SharedFrame auto_frame = new FrameAutoReleaser();
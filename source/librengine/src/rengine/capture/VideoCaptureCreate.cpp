@@ -1,6 +1,7 @@
 // __!!rengine_copyright!!__ //
 
 #include <rengine/capture/VideoCapture.h>
+#include <rengine/capture/VideoCaptureFile.h>
 
 #ifdef RENGINE_WITH_V4L
 #include <rengine/capture/VideoCaptureV4L.h>
@@ -27,4 +28,14 @@ namespace rengine
 		return capture;
 	}
 
+	SharedPointer<VideoCapture> VideoCapture::create(std::string const& location)
+	{
+		if (VideoCaptureFile::supportsLocation(location))
+		{
+			return new VideoCaptureFile(location);
+		}
+
+		return create();
+	}
+
 } // namespace rengine
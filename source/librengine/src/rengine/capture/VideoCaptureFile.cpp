@@ -0,0 +1,626 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/capture/VideoCaptureFile.h>
+#include <rengine/image/Colorspace.h>
+#include <rengine/image/stb_image.h>
+#include <rengine/file/File.h>
+#include <rengine/string/String.h>
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace rengine
+{
+	enum SourceType
+	{
+		SourceNone,
+		SourceImages,
+		SourceYUYV,
+		SourceMJPEG
+	};
+
+	struct VideoCaptureFile::PrivateImplementation
+	{
+		typedef std::vector<std::string> Files;
+		typedef std::vector<Uint64> Offsets;
+
+		PrivateImplementation()
+			:type(SourceNone), width(0), height(0), frame_size(0), frame(0), stream_size(0), indexed_size(0)
+		{
+		}
+
+		// indexes a MJPEG file, the index of the last file is kept for open after enumerateFormats
+		Bool indexJpegFile(std::string const& location);
+
+		SourceType type;
+		Uint width;
+		Uint height;
+		std::string mode;
+		Uint frame_size; // source bytes per frame, YUYV only
+
+		Uint frame;		// next frame to deliver
+
+		Files files;	// SourceImages
+
+		std::ifstream stream; // SourceYUYV, SourceMJPEG
+		Uint64 stream_size;
+
+		SharedArray<Uchar> buffer; // SourceYUYV one frame
+		std::vector<Uchar> jpeg; // SourceMJPEG one frame
+
+		// SourceMJPEG frame starts, last element is the stream end
+		Offsets offsets;
+		std::string indexed_location;
+		Uint64 indexed_size;
+	};
+
+	//
+	// Source inspection helpers
+	//
+	static SourceType sourceType(std::string const& location)
+	{
+		FileType file_type = fileType(location);
+
+		if (file_type == FileDirectory)
+		{
+			return SourceImages;
+		}
+
+		if (file_type == FileRegular)
+		{
+			std::string const extension = getLowerCaseFileExtension(location);
+
+			if ((extension == "yuyv") || (extension == "yuy2"))
+			{
+				return SourceYUYV;
+			}
+
+			if ((extension == "mjpg") || (extension == "mjpeg"))
+			{
+				return SourceMJPEG;
+			}
+		}
+
+		return SourceNone;
+	}
+
+	static Bool isImageFile(std::string const& filename)
+	{
+		std::string const extension = getLowerCaseFileExtension(filename);
+		return (extension == "bmp") || (extension == "png") || (extension == "tga") ||
+			   (extension == "jpg") || (extension == "jpeg") || (extension == "psd");
+	}
+
+	static DirectoryContents imageFiles(std::string const& directory)
+	{
+		DirectoryContents images;
+		DirectoryContents contents = getDirectoryContents(directory);
+
+		for (DirectoryContents::const_iterator file = contents.begin(); file != contents.end(); ++file)
+		{
+			if (isImageFile(*file))
+			{
+				images.push_back(directory + "/" + *file);
+			}
+		}
+
+		std::sort(images.begin(), images.end());
+		return images;
+	}
+
+	// parses "name_640x480.yuyv" like file names
+	static Bool frameSizeFromName(std::string const& location, Uint& width, Uint& height)
+	{
+		std::string name = getStrippedName(location);
+		std::string::size_type separator = name.find_last_of("_-.");
+		if (separator != std::string::npos)
+		{
+			name = name.substr(separator + 1);
+		}
+
+		StringElements elements = split(name, "x");
+		if ((elements.size() == 2) && isInteger(elements[0]) && isInteger(elements[1]))
+		{
+			width = lexical_cast<Uint>(elements[0]);
+			height = lexical_cast<Uint>(elements[1]);
+			return (width > 0) && (height > 0);
+		}
+
+		return false;
+	}
+
+	// splits a concatenated jpeg file on the start of image markers, read in blocks
+	static Bool indexJpegStream(std::istream& in, Uint64 const size, std::vector<Uint64>& offsets)
+	{
+		offsets.clear();
+
+		std::vector<Uchar> block(1024 * 1024);
+		Bool in_image = false;
+		Uint previous = 0x100;			// last byte, 0x100 when there is none
+		Uint before_previous = 0x100;	// the byte before it
+		Uint64 position = 0;
+
+		while (position < size)
+		{
+			in.read((Char*) &block[0], std::streamsize(block.size()));
+			Uint const count = Uint(in.gcount());
+			if (count == 0)
+			{
+				return false;
+			}
+
+			for (Uint i = 0; i != count; ++i, ++position)
+			{
+				Uint const current = block[i];
+
+				if (!in_image && (before_previous == 0xFF) && (previous == 0xD8) && (current == 0xFF))
+				{
+					offsets.push_back(position - 2);
+					in_image = true;
+					before_previous = 0x100;
+				}
+				else if (in_image && (previous == 0xFF) && (current == 0xD9))
+				{
+					// the end of image marker, the next start is searched after it
+					in_image = false;
+					before_previous = 0x100;
+					previous = 0x100;
+					continue;
+				}
+				else
+				{
+					before_previous = previous;
+				}
+				previous = current;
+			}
+		}
+
+		offsets.push_back(size);
+		return true;
+	}
+
+	Bool VideoCaptureFile::PrivateImplementation::indexJpegFile(std::string const& location)
+	{
+		Uint64 const size = fileSize(location);
+		if (!offsets.empty() && (indexed_location == location) && (indexed_size == size))
+		{
+			return true;
+		}
+
+		offsets.clear();
+		indexed_location.clear();
+
+		std::ifstream in(location.c_str(), std::ios::in | std::ios::binary);
+		if (!in || !indexJpegStream(in, size, offsets))
+		{
+			offsets.clear();
+			return false;
+		}
+
+		indexed_location = location;
+		indexed_size = size;
+		return true;
+	}
+
+	// reads the bytes [begin, end[ of a stream
+	static Bool readRange(std::ifstream& in, Uint64 const begin, Uint64 const end, std::vector<Uchar>& bytes)
+	{
+		if ((end <= begin) || ((end - begin) > Uint64(Uint(-1))))
+		{
+			return false;
+		}
+
+		bytes.resize(std::vector<Uchar>::size_type(end - begin));
+
+		in.clear();
+		in.seekg(std::streamoff(begin), std::ios::beg);
+		in.read((Char*) &bytes[0], std::streamsize(bytes.size()));
+
+		return (Uint64(in.gcount()) == (end - begin));
+	}
+
+	//
+	// VideoCaptureFile
+	//
+	VideoCaptureFile::VideoCaptureFile()
+		:implementation_(new PrivateImplementation()),
+		 replay_mode_(ReplayRealTime), loop_(true), streaming_(false),
+		 default_interval_numerator_(1), default_interval_denominator_(30),
+		 frames_delivered_(0)
+	{
+	}
+
+	VideoCaptureFile::VideoCaptureFile(std::string const& location)
+		:implementation_(new PrivateImplementation()), location_(location),
+		 replay_mode_(ReplayRealTime), loop_(true), streaming_(false),
+		 default_interval_numerator_(1), default_interval_denominator_(30),
+		 frames_delivered_(0)
+	{
+	}
+
+	VideoCaptureFile::~VideoCaptureFile()
+	{
+		close();
+		delete(implementation_);
+	}
+
+	Bool VideoCaptureFile::supportsLocation(std::string const& location)
+	{
+		return (sourceType(location) != SourceNone);
+	}
+
+	VideoCapture::Devices VideoCaptureFile::enumerateDevices() const
+	{
+		Devices devices;
+
+		if (supportsLocation(location_))
+		{
+			Device device;
+			device.index = 0;
+			device.location = location_;
+			device.name = getSimpleFileName(location_);
+			device.driver = "file";
+			device.bus = "file:" + location_;
+
+			devices.push_back(device);
+		}
+
+		return devices;
+	}
+
+	VideoCapture::Formats VideoCaptureFile::enumerateFormats(Device const& device) const
+	{
+		Formats formats;
+
+		Format format;
+		format.interval_numerator = default_interval_numerator_;
+		format.interval_denominator = default_interval_denominator_;
+
+		Int width = 0;
+		Int height = 0;
+		Int components = 0;
+
+		switch (sourceType(device.location))
+		{
+			case SourceImages:
+			{
+				DirectoryContents images = imageFiles(device.location);
+				Uchar* data = images.empty() ? 0 : stbi_load(images.front().c_str(), &width, &height, &components, 3);
+
+				if (data)
+				{
+					format.width = Uint(width);
+					format.height = Uint(height);
+					format.mode = "RGB3";
+					format.sample_size = format.width * format.height * 3;
+					formats.push_back(format);
+
+					rg_free(data);
+				}
+			}
+			break;
+
+			case SourceYUYV:
+			{
+				if (frameSizeFromName(device.location, format.width, format.height))
+				{
+					format.mode = "YUYV";
+					format.sample_size = format.width * format.height * 2;
+					formats.push_back(format);
+				}
+			}
+			break;
+
+			case SourceMJPEG:
+			{
+				// the first frame sets the format, the index is kept for open
+				std::vector<Uchar> jpeg;
+				std::ifstream in(device.location.c_str(), std::ios::in | std::ios::binary);
+
+				Uchar* data = (implementation_->indexJpegFile(device.location) && (implementation_->offsets.size() > 1) &&
+							   readRange(in, implementation_->offsets[0], implementation_->offsets[1], jpeg)) ?
+					stbi_jpeg_load_from_memory(&jpeg[0], Int(jpeg.size()), &width, &height, &components, 3) : 0;
+
+				if (data)
+				{
+					format.width = Uint(width);
+					format.height = Uint(height);
+					format.mode = "MJPG";
+					// variable size frames
+					format.sample_size = 0;
+					formats.push_back(format);
+
+					rg_free(data);
+				}
+			}
+			break;
+
+			default:
+			break;
+		}
+
+		return formats;
+	}
+
+	void VideoCaptureFile::open(CaptureOptions const& capture_options)
+	{
+		close();
+
+		options_ = capture_options;
+		if (options_.location.empty())
+		{
+			options_.location = location_;
+		}
+
+		implementation_->type = sourceType(options_.location);
+		if (implementation_->type == SourceNone)
+		{
+			throw VideoCaptureException(101, "Unsupported capture file: " + options_.location);
+		}
+
+		Device device;
+		device.location = options_.location;
+		Formats formats = enumerateFormats(device);
+
+		// raw dumps with no size on the name use the requested size
+		if (formats.empty() && (implementation_->type == SourceYUYV) && options_.width && options_.height)
+		{
+			Format format;
+			format.width = options_.width;
+			format.height = options_.height;
+			format.mode = "YUYV";
+			format.interval_numerator = default_interval_numerator_;
+			format.interval_denominator = default_interval_denominator_;
+			format.sample_size = format.width * format.height * 2;
+			formats.push_back(format);
+		}
+
+		// a file replays at any rate, match everything but the interval
+		Format filter = options_;
+		filter.interval_numerator = 0;
+		filter.interval_denominator = 0;
+		if ((filter.mode == "YUY2") && (implementation_->type == SourceYUYV))
+		{
+			filter.mode = "YUYV";
+		}
+
+		Format format = matchBestFormat(formats, filter);
+		if (format.width == 0 || format.height == 0)
+		{
+			throw VideoCaptureException(102, "No matching format on capture file: " + options_.location);
+		}
+
+		if (options_.interval_numerator && options_.interval_denominator)
+		{
+			format.interval_numerator = options_.interval_numerator;
+			format.interval_denominator = options_.interval_denominator;
+		}
+
+		options_.set(format);
+		options_.name = getSimpleFileName(options_.location);
+		options_.driver = "file";
+
+		implementation_->width = format.width;
+		implementation_->height = format.height;
+		implementation_->mode = format.mode;
+		implementation_->frame = 0;
+
+		if (implementation_->type == SourceImages)
+		{
+			implementation_->files = imageFiles(options_.location);
+		}
+		else if (implementation_->type == SourceYUYV)
+		{
+			implementation_->frame_size = format.width * format.height * 2;
+			implementation_->stream_size = fileSize(options_.location);
+			implementation_->stream.open(options_.location.c_str(), std::ios::in | std::ios::binary);
+			implementation_->buffer = new Uchar[implementation_->frame_size];
+
+			if (!implementation_->stream)
+			{
+				throw VideoCaptureException(103, "Unable to open capture file: " + options_.location);
+			}
+		}
+		else if (implementation_->type == SourceMJPEG)
+		{
+			// indexed by enumerateFormats
+			implementation_->stream.open(options_.location.c_str(), std::ios::in | std::ios::binary);
+
+			if (!implementation_->stream || !implementation_->indexJpegFile(options_.location))
+			{
+				throw VideoCaptureException(103, "Unable to open capture file: " + options_.location);
+			}
+		}
+
+		if (numberOfFrames() == 0)
+		{
+			close();
+			throw VideoCaptureException(104, "Capture file has no frames: " + options_.location);
+		}
+
+		frames_delivered_ = 0;
+		streaming_ = true;
+		timer_.start();
+	}
+
+	void VideoCaptureFile::close()
+	{
+		streaming_ = false;
+
+		if (implementation_->stream.is_open())
+		{
+			implementation_->stream.close();
+		}
+		implementation_->stream.clear();
+
+		implementation_->files.clear();
+		implementation_->buffer = 0;
+		implementation_->jpeg.clear();
+		implementation_->stream_size = 0;
+		implementation_->frame_size = 0;
+		implementation_->frame = 0;
+	}
+
+	Bool VideoCaptureFile::ready() const
+	{
+		return streaming_;
+	}
+
+	Uint VideoCaptureFile::numberOfFrames() const
+	{
+		switch (implementation_->type)
+		{
+			case SourceImages:
+				return Uint(implementation_->files.size());
+
+			case SourceYUYV:
+				return implementation_->frame_size ? Uint(implementation_->stream_size / implementation_->frame_size) : 0;
+
+			case SourceMJPEG:
+				// the index outlives close for the next open
+				return (!implementation_->stream.is_open() || implementation_->offsets.empty()) ? 0 : Uint(implementation_->offsets.size() - 1);
+
+			default:
+				return 0;
+		}
+	}
+
+	void VideoCaptureFile::readFrame(Uint const index, Frame& frame)
+	{
+		Uint const frame_size = implementation_->width * implementation_->height * 3;
+
+		if (implementation_->type == SourceImages)
+		{
+			Int width = 0;
+			Int height = 0;
+			Int components = 0;
+			Uchar* data = stbi_load(implementation_->files[index].c_str(), &width, &height, &components, 3);
+
+			if (data && (Uint(width) == implementation_->width) && (Uint(height) == implementation_->height))
+			{
+				if (!frame.data)
+				{
+					frame.data = new Uchar[frame_size];
+					frame.size = frame_size;
+				}
+
+				memcpy(frame.data, data, frame_size);
+			}
+			else
+			{
+				frame.release();
+			}
+
+			if (data)
+			{
+				rg_free(data);
+			}
+		}
+		else if (implementation_->type == SourceYUYV)
+		{
+			Uint64 const position = Uint64(index) * Uint64(implementation_->frame_size);
+			if (Uint64(implementation_->stream.tellg()) != position)
+			{
+				implementation_->stream.clear();
+				implementation_->stream.seekg(std::streamoff(position), std::ios::beg);
+			}
+
+			implementation_->stream.read((Char*) implementation_->buffer.get(), implementation_->frame_size);
+
+			if (Uint(implementation_->stream.gcount()) == implementation_->frame_size)
+			{
+				if (!frame.data)
+				{
+					frame.data = new Uchar[frame_size];
+					frame.size = frame_size;
+				}
+
+				convertYUYV_RGB8(implementation_->buffer.get(), frame.data, implementation_->width, implementation_->height);
+			}
+			else
+			{
+				frame.release();
+			}
+		}
+		else if (implementation_->type == SourceMJPEG)
+		{
+			frame.release();
+			if (readRange(implementation_->stream, implementation_->offsets[index], implementation_->offsets[index + 1], implementation_->jpeg))
+			{
+				frame.data = convertJPEG_RGB8(&implementation_->jpeg[0], Uint(implementation_->jpeg.size()), frame.size);
+			}
+
+			if (frame.data && (frame.size != frame_size))
+			{
+				frame.release();
+			}
+		}
+	}
+
+	SharedPointer<VideoCapture::Frame> VideoCaptureFile::grab(FrameOptions const& options, SharedPointer<Frame> const& frame)
+	{
+		if (!ready())
+		{
+			if (frame.get())
+			{
+				frame->release();
+			}
+
+			return 0;
+		}
+
+		Real64 const interval = Real64(options_.interval_numerator) / Real64(options_.interval_denominator);
+		Real64 const presentation_time = Real64(frames_delivered_) * interval;
+
+		if ((replay_mode_ == ReplayRealTime) && (timer_.elapsedTime() < presentation_time))
+		{
+			// no frame available yet, same as a device select timeout
+			return 0;
+		}
+
+		Uint const frames = numberOfFrames();
+		if (implementation_->frame >= frames)
+		{
+			if (!loop_)
+			{
+				streaming_ = false;
+
+				if (frame.get())
+				{
+					frame->release();
+				}
+
+				return 0;
+			}
+
+			implementation_->frame = 0;
+		}
+
+		SharedPointer<Frame> output_frame = new Frame();
+		Uint const frame_size = options_.width * options_.height * 3;
+
+		if (frame.get() && (frame->size == frame_size))
+		{
+			output_frame = frame;
+		}
+		else if (frame.get() && frame->data && frame->size)
+		{
+			frame->release();
+		}
+
+		readFrame(implementation_->frame, *output_frame);
+		output_frame->time_stamp = Real(presentation_time);
+
+		++implementation_->frame;
+		++frames_delivered_;
+
+		if (!output_frame->data)
+		{
+			return 0;
+		}
+
+		return output_frame;
+	}
+
+} // namespace rengine
@@ -0,0 +1,920 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/Deflate.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rengine
+{
+	typedef Deflater::Symbol Symbol;
+	typedef Deflater::Symbols Symbols;
+
+	static Uint const window_size = 32768;
+	static Uint const window_mask = window_size - 1;
+	static Uint const hash_bits = 15;
+	static Uint const minimum_match = 3;
+	static Uint const maximum_match = 258;
+	static Uint const maximum_stored = 65535;
+	static Uint const maximum_symbols = 16383;
+	static Uint const maximum_code_bits = 15;
+	static Uint const maximum_code_length_bits = 7;
+
+	static Uint const literal_count = 286;
+	static Uint const distance_count = 30;
+	static Uint const code_length_count = 19;
+	static Uint const end_of_block = 256;
+
+	static Uint16 const length_base[29] =
+	{
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+	};
+
+	static Uint8 const length_extra[29] =
+	{
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+	};
+
+	static Uint16 const distance_base[30] =
+	{
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+	};
+
+	static Uint8 const distance_extra[30] =
+	{
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+	};
+
+	static Uint8 const code_length_order[19] =
+	{
+		16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+	};
+
+	static RENGINE_INLINE Uint reverseBits(Uint code, Uint const length)
+	{
+		Uint reversed = 0;
+		for (Uint i = 0; i != length; ++i)
+		{
+			reversed = (reversed << 1) | (code & 1);
+			code >>= 1;
+		}
+		return reversed;
+	}
+
+	// canonical codes, bit reversed to be written lsb first
+	static void buildCodes(Uint8 const* lengths, Uint const count, Uint16* codes)
+	{
+		Uint length_count[maximum_code_bits + 1];
+		Uint next_code[maximum_code_bits + 1];
+		std::memset(length_count, 0, sizeof(length_count));
+
+		for (Uint i = 0; i != count; ++i)
+		{
+			++length_count[lengths[i]];
+		}
+		length_count[0] = 0;
+
+		Uint code = 0;
+		for (Uint bits = 1; bits <= maximum_code_bits; ++bits)
+		{
+			code = (code + length_count[bits - 1]) << 1;
+			next_code[bits] = code;
+		}
+
+		for (Uint i = 0; i != count; ++i)
+		{
+			codes[i] = lengths[i] ? Uint16(reverseBits(next_code[lengths[i]]++, lengths[i])) : 0;
+		}
+	}
+
+	//
+	// Code lengths limited to maximum_bits.
+	// A Huffman tree is built on the sorted leaves with two queues, lengths over the limit are then
+	// moved down and the shortest codes lengthened until the code is complete again.
+	// At least two codes are always produced so every table is complete.
+	//
+	static void buildLengths(Uint const* frequencies, Uint const count, Uint const maximum_bits, Uint8* lengths)
+	{
+		std::vector<std::pair<Uint, Uint> > leaves;
+		leaves.reserve(count);
+
+		for (Uint i = 0; i != count; ++i)
+		{
+			if (frequencies[i])
+			{
+				leaves.push_back(std::make_pair(frequencies[i], i));
+			}
+		}
+
+		for (Uint i = 0; (leaves.size() < 2) && (i != count); ++i)
+		{
+			if (!frequencies[i])
+			{
+				leaves.push_back(std::make_pair(Uint(1), i));
+			}
+		}
+
+		std::sort(leaves.begin(), leaves.end());
+		std::memset(lengths, 0, count);
+
+		Uint const leaf_count = Uint(leaves.size());
+		Uint const node_count = leaf_count * 2 - 1;
+
+		std::vector<Uint> weight(node_count);
+		std::vector<Uint> parent(node_count);
+
+		for (Uint i = 0; i != leaf_count; ++i)
+		{
+			weight[i] = leaves[i].first;
+		}
+
+		Uint leaf = 0;
+		Uint node = leaf_count;
+		for (Uint next = leaf_count; next != node_count; ++next)
+		{
+			Uint children[2];
+			for (Uint child = 0; child != 2; ++child)
+			{
+				if ((leaf < leaf_count) && ((node == next) || (weight[leaf] <= weight[node])))
+				{
+					children[child] = leaf++;
+				}
+				else
+				{
+					children[child] = node++;
+				}
+			}
+
+			weight[next] = weight[children[0]] + weight[children[1]];
+			parent[children[0]] = next;
+			parent[children[1]] = next;
+		}
+
+		// depths, the root is the last node
+		std::vector<Uint> depth(node_count);
+		depth[node_count - 1] = 0;
+
+		Uint length_count[maximum_code_bits + 1];
+		std::memset(length_count, 0, sizeof(length_count));
+
+		for (Int i = Int(node_count) - 2; i >= 0; --i)
+		{
+			depth[i] = depth[parent[i]] + 1;
+			if (Uint(i) < leaf_count)
+			{
+				++length_count[std::min(depth[i], maximum_bits)];
+			}
+		}
+
+		// kraft sum in units of 2^-maximum_bits, longer codes were clamped so it may exceed one
+		Uint total = 0;
+		for (Uint bits = 1; bits <= maximum_bits; ++bits)
+		{
+			total += length_count[bits] << (maximum_bits - bits);
+		}
+
+		while (total != (1u << maximum_bits))
+		{
+			--length_count[maximum_bits];
+			for (Uint bits = maximum_bits - 1; bits != 0; --bits)
+			{
+				if (length_count[bits])
+				{
+					--length_count[bits];
+					length_count[bits + 1] += 2;
+					break;
+				}
+			}
+			--total;
+		}
+
+		// the least frequent leaves take the longest codes
+		Uint current = 0;
+		for (Uint bits = maximum_bits; bits != 0; --bits)
+		{
+			for (Uint i = 0; i != length_count[bits]; ++i)
+			{
+				lengths[leaves[current++].second] = Uint8(bits);
+			}
+		}
+	}
+
+	//
+	// Static tables
+	//
+	struct EncoderTables
+	{
+		EncoderTables()
+		{
+			for (Uint code = 0; code != 29; ++code)
+			{
+				for (Uint length = length_base[code]; (length < length_base[code] + (1u << length_extra[code])) && (length <= maximum_match); ++length)
+				{
+					length_code[length] = Uint8(code);
+				}
+			}
+			// 258 has its own code
+			length_code[maximum_match] = 28;
+
+			for (Uint code = 0; code != 30; ++code)
+			{
+				for (Uint distance = distance_base[code]; distance < distance_base[code] + (1u << distance_extra[code]); ++distance)
+				{
+					if (distance <= 256)
+					{
+						distance_code_low[distance - 1] = Uint8(code);
+					}
+					else
+					{
+						distance_code_high[(distance - 1) >> 7] = Uint8(code);
+					}
+				}
+			}
+
+			for (Uint i = 0; i != 288; ++i)
+			{
+				literal_lengths[i] = Uint8((i < 144) ? 8 : ((i < 256) ? 9 : ((i < 280) ? 7 : 8)));
+			}
+			buildCodes(literal_lengths, 288, literal_codes);
+
+			for (Uint i = 0; i != 30; ++i)
+			{
+				distance_lengths[i] = 5;
+			}
+			buildCodes(distance_lengths, 30, distance_codes);
+		}
+
+		RENGINE_INLINE Uint distanceCode(Uint const distance) const
+		{
+			return (distance <= 256) ? distance_code_low[distance - 1] : distance_code_high[(distance - 1) >> 7];
+		}
+
+		Uint8 length_code[maximum_match + 1];
+		Uint8 distance_code_low[256];
+		Uint8 distance_code_high[256];
+
+		Uint8 literal_lengths[288];
+		Uint16 literal_codes[288];
+		Uint8 distance_lengths[30];
+		Uint16 distance_codes[30];
+	};
+	static EncoderTables const tables;
+
+	//
+	// Bit output, lsb first
+	//
+	struct BitOutput
+	{
+		BitOutput(Uint8* destination, Uint const size)
+			:out(destination), end(destination + size), buffer(0), count(0), overflow(false)
+		{
+		}
+
+		RENGINE_INLINE void put(Uint const bits, Uint const length)
+		{
+			buffer |= Uint64(bits) << count;
+			count += length;
+
+			if (count >= 32)
+			{
+				if (end - out >= 4)
+				{
+					out[0] = Uint8(buffer);
+					out[1] = Uint8(buffer >> 8);
+					out[2] = Uint8(buffer >> 16);
+					out[3] = Uint8(buffer >> 24);
+					out += 4;
+				}
+				else
+				{
+					out = end;
+					overflow = true;
+				}
+
+				buffer >>= 32;
+				count -= 32;
+			}
+		}
+
+		// pads to a byte boundary and writes the pending bits
+		void align()
+		{
+			while (count)
+			{
+				if (out != end)
+				{
+					*out++ = Uint8(buffer);
+				}
+				else
+				{
+					overflow = true;
+				}
+
+				buffer >>= 8;
+				count = (count > 8) ? (count - 8) : 0;
+			}
+		}
+
+		Uint8* out;
+		Uint8* end;
+		Uint64 buffer;
+		Uint count;
+		Bool overflow;
+	};
+
+	static void writeStored(BitOutput& output, Uint8 const* data, Uint const size, Bool const final)
+	{
+		output.put(final ? 1 : 0, 3);
+		output.align();
+
+		output.put(size, 16);
+		output.put(~size & 0xFFFF, 16);
+
+		if (Uint(output.end - output.out) >= size)
+		{
+			std::memcpy(output.out, data, size);
+			output.out += size;
+		}
+		else
+		{
+			output.out = output.end;
+			output.overflow = true;
+		}
+	}
+
+	static void writeSymbols(BitOutput& output, Symbols const& symbols,
+							 Uint8 const* literal_lengths, Uint16 const* literal_codes,
+							 Uint8 const* distance_lengths, Uint16 const* distance_codes)
+	{
+		for (Symbols::const_iterator i = symbols.begin(); i != symbols.end(); ++i)
+		{
+			if (i->distance == 0)
+			{
+				output.put(literal_codes[i->length], literal_lengths[i->length]);
+				continue;
+			}
+
+			Uint const length_code = tables.length_code[i->length];
+			output.put(literal_codes[257 + length_code], literal_lengths[257 + length_code]);
+			if (length_extra[length_code])
+			{
+				output.put(i->length - length_base[length_code], length_extra[length_code]);
+			}
+
+			Uint const distance_code = tables.distanceCode(i->distance);
+			output.put(distance_codes[distance_code], distance_lengths[distance_code]);
+			if (distance_extra[distance_code])
+			{
+				output.put(i->distance - distance_base[distance_code], distance_extra[distance_code]);
+			}
+		}
+
+		output.put(literal_codes[end_of_block], literal_lengths[end_of_block]);
+	}
+
+	// code length alphabet symbol, 16 to 18 repeat a length
+	struct CodeLengthRun
+	{
+		CodeLengthRun(Uint const code_length_symbol, Uint const repeat_count)
+			:symbol(Uint8(code_length_symbol)), repeat(Uint8(repeat_count))
+		{
+		}
+
+		Uint8 symbol;
+		Uint8 repeat;
+	};
+	typedef std::vector<CodeLengthRun> CodeLengthRuns;
+
+	//
+	// Writes the symbols of [data, data + size[ as a single block with the cheapest coding
+	//
+	static void writeBlock(BitOutput& output, Symbols const& symbols, Uint8 const* data, Uint const size, Bool const final)
+	{
+		Uint literal_frequencies[literal_count];
+		Uint distance_frequencies[distance_count];
+		std::memset(literal_frequencies, 0, sizeof(literal_frequencies));
+		std::memset(distance_frequencies, 0, sizeof(distance_frequencies));
+
+		// extra bits are the same for every coding
+		Uint64 extra_bits = 0;
+		for (Symbols::const_iterator i = symbols.begin(); i != symbols.end(); ++i)
+		{
+			if (i->distance == 0)
+			{
+				++literal_frequencies[i->length];
+			}
+			else
+			{
+				Uint const length_code = tables.length_code[i->length];
+				Uint const distance_code = tables.distanceCode(i->distance);
+
+				++literal_frequencies[257 + length_code];
+				++distance_frequencies[distance_code];
+				extra_bits += length_extra[length_code] + distance_extra[distance_code];
+			}
+		}
+		literal_frequencies[end_of_block] = 1;
+
+		Uint8 literal_lengths[literal_count];
+		Uint8 distance_lengths[distance_count];
+		buildLengths(literal_frequencies, literal_count, maximum_code_bits, literal_lengths);
+		buildLengths(distance_frequencies, distance_count, maximum_code_bits, distance_lengths);
+
+		Uint used_literals = literal_count;
+		while ((used_literals > 257) && !literal_lengths[used_literals - 1])
+		{
+			--used_literals;
+		}
+
+		Uint used_distances = distance_count;
+		while ((used_distances > 1) && !distance_lengths[used_distances - 1])
+		{
+			--used_distances;
+		}
+
+		//
+		// Code lengths run length encoded, 16 repeats the previous length, 17 and 18 repeat zeros
+		//
+		Uint8 lengths[literal_count + distance_count];
+		std::memcpy(lengths, literal_lengths, used_literals);
+		std::memcpy(lengths + used_literals, distance_lengths, used_distances);
+		Uint const length_count = used_literals + used_distances;
+
+		CodeLengthRuns runs;
+		runs.reserve(length_count);
+
+		for (Uint i = 0; i != length_count;)
+		{
+			Uint const value = lengths[i];
+			Uint run = 1;
+			while ((i + run != length_count) && (lengths[i + run] == value))
+			{
+				++run;
+			}
+			i += run;
+
+			if (value == 0)
+			{
+				for (; run >= 11; run -= runs.back().repeat)
+				{
+					runs.push_back(CodeLengthRun(18, std::min(run, Uint(138))));
+				}
+
+				if (run >= 3)
+				{
+					runs.push_back(CodeLengthRun(17, run));
+					run = 0;
+				}
+			}
+			else
+			{
+				// the first length is written once, the rest repeat it
+				runs.push_back(CodeLengthRun(value, 1));
+				--run;
+
+				for (; run >= 3; run -= runs.back().repeat)
+				{
+					runs.push_back(CodeLengthRun(16, std::min(run, Uint(6))));
+				}
+			}
+
+			for (; run; --run)
+			{
+				runs.push_back(CodeLengthRun(value, 1));
+			}
+		}
+
+		Uint code_length_frequencies[code_length_count];
+		std::memset(code_length_frequencies, 0, sizeof(code_length_frequencies));
+
+		for (CodeLengthRuns::const_iterator i = runs.begin(); i != runs.end(); ++i)
+		{
+			++code_length_frequencies[i->symbol];
+		}
+
+		Uint8 code_length_lengths[code_length_count];
+		buildLengths(code_length_frequencies, code_length_count, maximum_code_length_bits, code_length_lengths);
+
+		Uint used_code_lengths = code_length_count;
+		while ((used_code_lengths > 4) && !code_length_lengths[code_length_order[used_code_lengths - 1]])
+		{
+			--used_code_lengths;
+		}
+
+		//
+		// Sizes in bits
+		//
+		Uint64 dynamic_bits = 3 + 5 + 5 + 4 + 3 * used_code_lengths + extra_bits;
+		Uint64 fixed_bits = 3 + extra_bits;
+
+		for (Uint i = 0; i != literal_count; ++i)
+		{
+			dynamic_bits += Uint64(literal_frequencies[i]) * literal_lengths[i];
+			fixed_bits += Uint64(literal_frequencies[i]) * tables.literal_lengths[i];
+		}
+
+		for (Uint i = 0; i != distance_count; ++i)
+		{
+			dynamic_bits += Uint64(distance_frequencies[i]) * distance_lengths[i];
+			fixed_bits += Uint64(distance_frequencies[i]) * tables.distance_lengths[i];
+		}
+
+		for (Uint i = 0; i != code_length_count; ++i)
+		{
+			dynamic_bits += Uint64(code_length_frequencies[i]) * code_length_lengths[i];
+		}
+		dynamic_bits += 2 * code_length_frequencies[16] + 3 * code_length_frequencies[17] + 7 * code_length_frequencies[18];
+
+		Uint64 const stored_bits = 3 + ((8 - ((output.count + 3) & 7)) & 7) + 32 + Uint64(size) * 8;
+
+		//
+		// Output
+		//
+		if ((stored_bits <= fixed_bits) && (stored_bits <= dynamic_bits))
+		{
+			writeStored(output, data, size, final);
+		}
+		else if (fixed_bits <= dynamic_bits)
+		{
+			output.put((final ? 1 : 0) | (1 << 1), 3);
+			writeSymbols(output, symbols, tables.literal_lengths, tables.literal_codes, tables.distance_lengths, tables.distance_codes);
+		}
+		else
+		{
+			output.put((final ? 1 : 0) | (2 << 1), 3);
+			output.put(used_literals - 257, 5);
+			output.put(used_distances - 1, 5);
+			output.put(used_code_lengths - 4, 4);
+
+			for (Uint i = 0; i != used_code_lengths; ++i)
+			{
+				output.put(code_length_lengths[code_length_order[i]], 3);
+			}
+
+			Uint16 code_length_codes[code_length_count];
+			buildCodes(code_length_lengths, code_length_count, code_length_codes);
+
+			for (CodeLengthRuns::const_iterator i = runs.begin(); i != runs.end(); ++i)
+			{
+				output.put(code_length_codes[i->symbol], code_length_lengths[i->symbol]);
+
+				if (i->symbol == 16)
+				{
+					output.put(i->repeat - 3, 2);
+				}
+				else if (i->symbol == 17)
+				{
+					output.put(i->repeat - 3, 3);
+				}
+				else if (i->symbol == 18)
+				{
+					output.put(i->repeat - 11, 7);
+				}
+			}
+
+			Uint16 literal_codes[literal_count];
+			Uint16 distance_codes[distance_count];
+			buildCodes(literal_lengths, literal_count, literal_codes);
+			buildCodes(distance_lengths, distance_count, distance_codes);
+
+			writeSymbols(output, symbols, literal_lengths, literal_codes, distance_lengths, distance_codes);
+		}
+	}
+
+	//
+	// Match search
+	//
+	static RENGINE_INLINE Uint hash(Uint8 const* data)
+	{
+		Uint32 const value = Uint32(data[0]) | (Uint32(data[1]) << 8) | (Uint32(data[2]) << 16);
+		return (value * 2654435761u) >> (32 - hash_bits);
+	}
+
+	static RENGINE_INLINE Uint matchLength(Uint8 const* a, Uint8 const* b, Uint const limit)
+	{
+		Uint length = 0;
+
+#if (RENGINE_ENDIAN == RENGINE_LITTLE_ENDIAN) && (RENGINE_COMPILER == RENGINE_COMPILER_GNUC)
+		while (length + 8 <= limit)
+		{
+			Uint64 x, y;
+			std::memcpy(&x, a + length, 8);
+			std::memcpy(&y, b + length, 8);
+
+			if (x != y)
+			{
+				return length + (__builtin_ctzll(x ^ y) >> 3);
+			}
+			length += 8;
+		}
+#endif
+
+		while ((length != limit) && (a[length] == b[length]))
+		{
+			++length;
+		}
+		return length;
+	}
+
+	struct MatchParameters
+	{
+		Uint chain;		// candidates visited
+		Uint nice;		// stop searching at this length
+		Uint good;		// a previous match this long quarters the chain
+	};
+
+	//
+	// Encoder state of a single stream
+	//
+	class DeflateStream
+	{
+	public:
+		DeflateStream(BitOutput& output, Uint8 const* source, Uint const size, Int32* head, Int32* previous, Symbols& symbols)
+			:output_(output), source_(source), size_(size), head_(head), previous_(previous), symbols_(symbols), block_start_(0), block_end_(0)
+		{
+			symbols_.clear();
+		}
+
+		RENGINE_INLINE Int32 insert(Uint const position)
+		{
+			Uint const key = hash(source_ + position);
+			Int32 const candidate = head_[key];
+			previous_[position & window_mask] = candidate;
+			head_[key] = Int32(position);
+			return candidate;
+		}
+
+		// longest match longer than better, 0 when there is none
+		RENGINE_INLINE Uint findMatch(Uint const position, Int32 candidate, Uint const better, MatchParameters const& parameters, Uint& distance) const
+		{
+			Uint const limit = std::min(maximum_match, size_ - position);
+			if (limit < minimum_match)
+			{
+				return 0;
+			}
+
+			Uint8 const* current = source_ + position;
+			Uint best = std::max(better, minimum_match - 1);
+		if (best >= limit)
+		{
+			return 0;
+		}
+
+			Uint chain = (better >= parameters.good) ? (parameters.chain >> 2) : parameters.chain;
+
+			while ((candidate >= 0) && (position - Uint(candidate) <= window_size) && chain--)
+			{
+				Uint8 const* match = source_ + candidate;
+
+				if ((match[best] == current[best]) && (match[0] == current[0]) && (match[1] == current[1]))
+				{
+					Uint const length = matchLength(match, current, limit);
+					if (length > best)
+					{
+						best = length;
+						distance = position - Uint(candidate);
+
+						if (length >= std::min(parameters.nice, limit))
+						{
+							break;
+						}
+					}
+				}
+
+				candidate = previous_[candidate & window_mask];
+			}
+
+			return (best > better) && (best >= minimum_match) ? best : 0;
+		}
+
+		RENGINE_INLINE void literal(Uint const position)
+		{
+			Symbol symbol;
+			symbol.length = source_[position];
+			symbol.distance = 0;
+			symbols_.push_back(symbol);
+
+			block_end_ = position + 1;
+			flushIfFull();
+		}
+
+		RENGINE_INLINE void match(Uint const position, Uint const length, Uint const distance)
+		{
+			Symbol symbol;
+			symbol.length = Uint16(length);
+			symbol.distance = Uint16(distance);
+			symbols_.push_back(symbol);
+
+			block_end_ = position + length;
+			flushIfFull();
+		}
+
+		RENGINE_INLINE void flushIfFull()
+		{
+			// the stored fallback of a block must fit in a single stored block
+			if ((symbols_.size() >= maximum_symbols) || (block_end_ - block_start_ > maximum_stored - maximum_match))
+			{
+				flush(false);
+			}
+		}
+
+		void flush(Bool const final)
+		{
+			writeBlock(output_, symbols_, source_ + block_start_, block_end_ - block_start_, final);
+			symbols_.clear();
+			block_start_ = block_end_;
+		}
+
+		void greedy(MatchParameters const& parameters)
+		{
+			Uint position = 0;
+			while (position < size_)
+			{
+				Uint length = 0;
+				Uint distance = 0;
+
+				if (position + minimum_match <= size_)
+				{
+					length = findMatch(position, insert(position), 0, parameters, distance);
+				}
+
+				if (length)
+				{
+					match(position, length, distance);
+
+					// long matches are not indexed, short ones are
+					Uint const end = position + length;
+					if (length <= parameters.nice)
+					{
+						for (++position; (position != end) && (position + minimum_match <= size_); ++position)
+						{
+							insert(position);
+						}
+					}
+					position = end;
+				}
+				else
+				{
+					literal(position);
+					++position;
+				}
+			}
+		}
+
+		void lazy(MatchParameters const& parameters)
+		{
+			Uint position = 0;
+			Uint previous_length = 0;
+			Uint previous_distance = 0;
+			Bool pending = false;
+
+			while (position < size_)
+			{
+				Uint length = 0;
+				Uint distance = 0;
+
+				if (position + minimum_match <= size_)
+				{
+					Int32 const candidate = insert(position);
+					if (previous_length < parameters.nice)
+					{
+						length = findMatch(position, candidate, previous_length, parameters, distance);
+					}
+				}
+
+				// a short far match costs more than its literals
+				if ((length == minimum_match) && (distance > 4096))
+				{
+					length = 0;
+				}
+
+				if ((previous_length >= minimum_match) && (length <= previous_length))
+				{
+					Uint const start = position - 1;
+					match(start, previous_length, previous_distance);
+
+					Uint const end = start + previous_length;
+					for (++position; (position != end) && (position + minimum_match <= size_); ++position)
+					{
+						insert(position);
+					}
+
+					position = end;
+					previous_length = 0;
+					pending = false;
+				}
+				else
+				{
+					if (pending)
+					{
+						literal(position - 1);
+					}
+
+					previous_length = length;
+					previous_distance = distance;
+					pending = true;
+					++position;
+				}
+			}
+
+			if (pending)
+			{
+				literal(position - 1);
+			}
+		}
+
+	private:
+		DeflateStream& operator=(DeflateStream const& copy);
+
+		BitOutput& output_;
+		Uint8 const* source_;
+		Uint const size_;
+		Int32* head_;
+		Int32* previous_;
+		Symbols& symbols_;
+		Uint block_start_;
+		Uint block_end_;
+	};
+
+	//
+	// Deflater
+	//
+	Deflater::Deflater(Level const level)
+		:level_(level)
+	{
+	}
+
+	Deflater::~Deflater()
+	{
+	}
+
+	Uint Deflater::bound(Uint const source_size)
+	{
+		// every block falls back to a stored block: 5 header bytes, the flush rules keep blocks over 16k
+		return source_size + 5 * (source_size / maximum_symbols + source_size / maximum_stored + 2) + 8;
+	}
+
+	Deflater::Level Deflater::levelFromZlib(Int const level)
+	{
+		if (level == 0)
+		{
+			return StoreLevel;
+		}
+
+		return ((level > 0) && (level < 6)) ? FastLevel : BestLevel;
+	}
+
+	Deflater::Status Deflater::deflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint const source_size)
+	{
+		BitOutput output(destination, destination_size);
+
+		if (level_ == StoreLevel || (source_size < minimum_match))
+		{
+			Uint offset = 0;
+			do
+			{
+				Uint const size = std::min(maximum_stored, source_size - offset);
+				writeStored(output, source + offset, size, offset + size == source_size);
+				offset += size;
+			}
+			while (offset != source_size);
+		}
+		else
+		{
+			head_.assign(1u << hash_bits, -1);
+			previous_.resize(window_size);
+			symbols_.reserve(maximum_symbols + 1);
+
+			DeflateStream stream(output, source, source_size, &head_[0], &previous_[0], symbols_);
+
+			if (level_ == FastLevel)
+			{
+				MatchParameters const parameters = { 16, 64, 258 };
+				stream.greedy(parameters);
+			}
+			else
+			{
+				MatchParameters const parameters = { 512, 258, 32 };
+				stream.lazy(parameters);
+			}
+
+			stream.flush(true);
+		}
+
+		output.align();
+		destination_size = Uint(output.out - destination);
+
+		return output.overflow ? OutputOverflow : Success;
+	}
+
+	Deflater::Status deflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint const source_size, Deflater::Level const level)
+	{
+		Deflater deflater(level);
+		return deflater.deflate(destination, destination_size, source, source_size);
+	}
+
+} // namespace rengine
@@ -206,6 +206,23 @@ namespace rengine
 		return size;
 	}
 
+	Real64 fileModificationTime(std::string const& filename)
+	{
+		Real64 time = 0.0;
+
+		struct stat64 file_stat;
+		if (stat64(filename.c_str(), &file_stat) == 0)
+		{
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+			time = Real64(file_stat.st_mtim.tv_sec) + Real64(file_stat.st_mtim.tv_nsec) * 1e-9;
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_LINUX
+			time = Real64(file_stat.st_mtime);
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_LINUX
+		}
+
+		return time;
+	}
+
 	Bool fileExists(std::string const& filename)
 	{
 #if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
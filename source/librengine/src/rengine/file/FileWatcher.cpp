@@ -0,0 +1,313 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/FileWatcher.h>
+#include <rengine/file/File.h>
+#include <rengine/thread/Thread.h>
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif //RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+
+#include <set>
+#include <map>
+
+namespace rengine
+{
+	// time between two scans of the files when polling
+	static Uint const polling_interval_microseconds = 250000;
+	static Uint const sleep_microseconds = 10000;
+
+	class FileWatcher::Implementation : public Thread
+	{
+	public:
+		typedef std::set<std::string> FileSet;
+
+		Implementation()
+			:notifications_(false), notify_descriptor_(-1)
+		{
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+			notify_descriptor_ = inotify_init();
+			notifications_ = (notify_descriptor_ >= 0);
+#endif //RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+		}
+
+		~Implementation()
+		{
+			if (isRunning())
+			{
+				signalShouldStop();
+				Thread::stop();
+			}
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+			if (notify_descriptor_ >= 0)
+			{
+				close(notify_descriptor_);
+			}
+#endif //RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+		}
+
+		void setFiles(Filenames const& filenames)
+		{
+			ScopedLock lock(mutex_);
+
+			files_ = FileSet(filenames.begin(), filenames.end());
+
+			if (notifications_)
+			{
+				updateDirectories();
+			}
+			else
+			{
+				// files keep their state, the new ones are compared from now on
+				States states;
+				for (FileSet::const_iterator i = files_.begin(); i != files_.end(); ++i)
+				{
+					States::const_iterator found = states_.find(*i);
+					states[*i] = (found != states_.end()) ? found->second : state(*i);
+				}
+				states_.swap(states);
+			}
+
+			if (!files_.empty() && !isRunning())
+			{
+				start();
+			}
+		}
+
+		Filenames files() const
+		{
+			ScopedLock lock(mutex_);
+			return Filenames(files_.begin(), files_.end());
+		}
+
+		Filenames changes()
+		{
+			ScopedLock lock(mutex_);
+
+			Filenames changed(changed_.begin(), changed_.end());
+			changed_.clear();
+
+			return changed;
+		}
+
+		Bool usesNotifications() const
+		{
+			return notifications_;
+		}
+
+		virtual void run()
+		{
+			Uint elapsed = 0;
+
+			while (keepRunning())
+			{
+				if (notifications_)
+				{
+					readNotifications();
+				}
+				else
+				{
+					Thread::microSleep(sleep_microseconds);
+
+					elapsed += sleep_microseconds;
+					if (elapsed >= polling_interval_microseconds)
+					{
+						elapsed = 0;
+						pollFiles();
+					}
+				}
+			}
+		}
+	private:
+		struct FileState
+		{
+			FileState() :exists(false), modified(0.0), size(0) {}
+
+			Bool operator!=(FileState const& rhs) const
+			{
+				return (exists != rhs.exists) || (modified != rhs.modified) || (size != rhs.size);
+			}
+
+			Bool exists;
+			Real64 modified;
+			Uint64 size;
+		};
+		typedef std::map<std::string, FileState> States;
+
+		static FileState state(std::string const& filename)
+		{
+			FileState file_state;
+
+			// sub second times, saves within the same second keeping the size are still seen
+			file_state.modified = fileModificationTime(filename);
+			if (file_state.modified != 0.0)
+			{
+				file_state.exists = true;
+				file_state.size = fileSize(filename);
+			}
+
+			return file_state;
+		}
+
+		void pollFiles()
+		{
+			ScopedLock lock(mutex_);
+
+			for (States::iterator i = states_.begin(); i != states_.end(); ++i)
+			{
+				FileState const current = state(i->first);
+				if (current != i->second)
+				{
+					i->second = current;
+
+					if (current.exists)
+					{
+						changed_.insert(i->first);
+					}
+				}
+			}
+		}
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+		typedef std::map<int, std::string> Directories;	// watch descriptor to directory
+		typedef std::map<std::string, int> Watches;
+
+		// editors often save to another file and rename it over the original
+		static Uint32 const event_mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+		void updateDirectories()
+		{
+			FileSet needed;
+			for (FileSet::const_iterator i = files_.begin(); i != files_.end(); ++i)
+			{
+				needed.insert(getFilePath(*i));
+			}
+
+			for (Watches::iterator i = watches_.begin(); i != watches_.end();)
+			{
+				if (needed.find(i->first) == needed.end())
+				{
+					inotify_rm_watch(notify_descriptor_, i->second);
+					directories_.erase(i->second);
+					watches_.erase(i++);
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			for (FileSet::const_iterator i = needed.begin(); i != needed.end(); ++i)
+			{
+				if (watches_.find(*i) == watches_.end())
+				{
+					int const watch = inotify_add_watch(notify_descriptor_, i->empty() ? "." : i->c_str(), event_mask);
+					if (watch >= 0)
+					{
+						watches_[*i] = watch;
+						directories_[watch] = *i;
+					}
+				}
+			}
+		}
+
+		void readNotifications()
+		{
+			pollfd descriptor;
+			descriptor.fd = notify_descriptor_;
+			descriptor.events = POLLIN;
+			descriptor.revents = 0;
+
+			// short timeout, so stop is noticed
+			if (poll(&descriptor, 1, Int(sleep_microseconds / 1000)) <= 0)
+			{
+				return;
+			}
+
+			Char buffer[16 * 1024];
+			ssize_t const size = read(notify_descriptor_, buffer, sizeof(buffer));
+
+			ScopedLock lock(mutex_);
+
+			for (ssize_t offset = 0; offset + ssize_t(sizeof(inotify_event)) <= size;)
+			{
+				inotify_event const* event = (inotify_event const*) (buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				Directories::const_iterator directory = directories_.find(event->wd);
+				if ((directory == directories_.end()) || (event->len == 0) || !(event->mask & event_mask))
+				{
+					continue;
+				}
+
+				std::string const name(event->name);
+				std::string const filename = directory->second.empty() ? name : (directory->second + "/" + name);
+
+				if (files_.find(filename) != files_.end())
+				{
+					changed_.insert(filename);
+				}
+			}
+		}
+
+		Directories directories_;
+		Watches watches_;
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_LINUX
+		void updateDirectories()
+		{
+		}
+
+		void readNotifications()
+		{
+		}
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_LINUX
+
+		Bool notifications_;
+		int notify_descriptor_;
+
+		FileSet files_;
+		FileSet changed_;
+		States states_;
+		mutable Mutex mutex_;
+	};
+
+	FileWatcher::FileWatcher()
+		:implementation_(new Implementation())
+	{
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		delete(implementation_);
+	}
+
+	void FileWatcher::setFiles(Filenames const& filenames)
+	{
+		implementation_->setFiles(filenames);
+	}
+
+	FileWatcher::Filenames FileWatcher::files() const
+	{
+		return implementation_->files();
+	}
+
+	FileWatcher::Filenames FileWatcher::changes()
+	{
+		return implementation_->changes();
+	}
+
+	Bool FileWatcher::usesNotifications() const
+	{
+		return implementation_->usesNotifications();
+	}
+
+	void FileWatcher::stop()
+	{
+		delete(implementation_);
+		implementation_ = new Implementation();
+	}
+
+} // namespace rengine
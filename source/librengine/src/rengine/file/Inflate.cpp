@@ -0,0 +1,1048 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/Inflate.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rengine
+{
+	typedef Inflater::HuffmanEntry HuffmanEntry;
+	typedef Inflater::HuffmanTable HuffmanTable;
+
+	enum EntryKind
+	{
+		KindLiteral		= 0,
+		KindBase		= 1,	// length or distance base, low nibble has the extra bits
+		KindEnd			= 2,
+		KindSubtable	= 3,	// value is the sub table offset, low nibble has its index bits
+		KindInvalid		= 4
+	};
+
+	enum TableType
+	{
+		LiteralTable,
+		DistanceTable,
+		CodeLengthTable
+	};
+
+	static Uint const max_code_bits = 15;
+	static Uint const literal_root_bits = 10;
+	static Uint const distance_root_bits = 8;
+	static Uint const code_length_root_bits = 7;
+
+	static Uint16 const length_base[29] =
+	{
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+	};
+
+	static Uint8 const length_extra[29] =
+	{
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+	};
+
+	static Uint16 const distance_base[30] =
+	{
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+	};
+
+	static Uint8 const distance_extra[30] =
+	{
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+	};
+
+	static Uint8 const code_length_order[19] =
+	{
+		16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+	};
+
+	static RENGINE_INLINE HuffmanEntry makeEntry(Uint const kind, Uint const low, Uint const value, Uint const bits)
+	{
+		HuffmanEntry entry;
+		entry.value = Uint16(value);
+		entry.bits = Uint8(bits);
+		entry.op = Uint8((kind << 4) | low);
+		return entry;
+	}
+
+	static HuffmanEntry symbolEntry(TableType const type, Uint const symbol, Uint const bits)
+	{
+		if (type == LiteralTable)
+		{
+			if (symbol < 256)
+			{
+				return makeEntry(KindLiteral, 0, symbol, bits);
+			}
+			else if (symbol == 256)
+			{
+				return makeEntry(KindEnd, 0, 0, bits);
+			}
+			else if (symbol < 286)
+			{
+				return makeEntry(KindBase, length_extra[symbol - 257], length_base[symbol - 257], bits);
+			}
+		}
+		else if (type == DistanceTable)
+		{
+			if (symbol < 30)
+			{
+				return makeEntry(KindBase, distance_extra[symbol], distance_base[symbol], bits);
+			}
+		}
+		else
+		{
+			return makeEntry(KindLiteral, 0, symbol, bits);
+		}
+
+		return makeEntry(KindInvalid, 0, 0, bits);
+	}
+
+	static RENGINE_INLINE Uint reverseBits(Uint code, Uint const length)
+	{
+		Uint reversed = 0;
+		for (Uint i = 0; i != length; ++i)
+		{
+			reversed = (reversed << 1) | (code & 1);
+			code >>= 1;
+		}
+		return reversed;
+	}
+
+	//
+	// Builds the lookup table of a canonical Huffman code.
+	// Codes longer than root_bits continue in a sub table sized for the longest code sharing the prefix.
+	// Over subscribed sets are rejected, incomplete sets only when allowed and made of a single one bit code (as zlib).
+	//
+	static Bool buildTable(HuffmanTable& table, TableType const type, Uint8 const* lengths, Uint const count, Uint const root_bits, Bool const allow_incomplete)
+	{
+		Uint length_count[max_code_bits + 1];
+		memset(length_count, 0, sizeof(length_count));
+
+		for (Uint symbol = 0; symbol != count; ++symbol)
+		{
+			++length_count[lengths[symbol]];
+		}
+		length_count[0] = 0;
+
+		Int left = 1;
+		Uint used = 0;
+		for (Uint length = 1; length <= max_code_bits; ++length)
+		{
+			left <<= 1;
+			left -= Int(length_count[length]);
+			if (left < 0)
+			{
+				return false;
+			}
+			used += length_count[length];
+		}
+
+		if ((left > 0) && (!allow_incomplete || (used > 1) || (length_count[1] != used)))
+		{
+			return false;
+		}
+
+		Uint first_code[max_code_bits + 1];
+		Uint code = 0;
+		first_code[0] = 0;
+		for (Uint length = 1; length <= max_code_bits; ++length)
+		{
+			code = (code + length_count[length - 1]) << 1;
+			first_code[length] = code;
+		}
+
+		Uint const root_size = 1 << root_bits;
+		Uint const root_mask = root_size - 1;
+
+		// sub table sizes
+		Uint8 sub_bits[1 << literal_root_bits];
+		Uint sub_offset[1 << literal_root_bits];
+		memset(sub_bits, 0, root_size);
+
+		Uint next_code[max_code_bits + 1];
+		memcpy(next_code, first_code, sizeof(next_code));
+
+		for (Uint symbol = 0; symbol != count; ++symbol)
+		{
+			Uint const length = lengths[symbol];
+			if (length > root_bits)
+			{
+				Uint const prefix = reverseBits(next_code[length]++, length) & root_mask;
+				if (sub_bits[prefix] < length - root_bits)
+				{
+					sub_bits[prefix] = Uint8(length - root_bits);
+				}
+			}
+		}
+
+		Uint size = root_size;
+		for (Uint prefix = 0; prefix != root_size; ++prefix)
+		{
+			if (sub_bits[prefix])
+			{
+				sub_offset[prefix] = size;
+				size += 1 << sub_bits[prefix];
+			}
+		}
+
+		table.assign(size, makeEntry(KindInvalid, 0, 0, 0));
+
+		for (Uint prefix = 0; prefix != root_size; ++prefix)
+		{
+			if (sub_bits[prefix])
+			{
+				table[prefix] = makeEntry(KindSubtable, sub_bits[prefix], sub_offset[prefix], root_bits);
+			}
+		}
+
+		// fill every slot whose low bits match the reversed code
+		memcpy(next_code, first_code, sizeof(next_code));
+
+		for (Uint symbol = 0; symbol != count; ++symbol)
+		{
+			Uint const length = lengths[symbol];
+			if (length == 0)
+			{
+				continue;
+			}
+
+			Uint const reversed = reverseBits(next_code[length]++, length);
+			HuffmanEntry const entry = symbolEntry(type, symbol, length);
+
+			if (length <= root_bits)
+			{
+				for (Uint index = reversed; index < root_size; index += (1 << length))
+				{
+					table[index] = entry;
+				}
+			}
+			else
+			{
+				Uint const prefix = reversed & root_mask;
+				Uint const sub_size = 1 << sub_bits[prefix];
+				HuffmanEntry* sub_table = &table[sub_offset[prefix]];
+
+				for (Uint index = (reversed >> root_bits); index < sub_size; index += (1 << (length - root_bits)))
+				{
+					sub_table[index] = entry;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	//
+	// Fixed Huffman codes, built once before main
+	//
+	struct FixedTables
+	{
+		FixedTables()
+		{
+			Uint8 lengths[288];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 256 - 144);
+			memset(lengths + 256, 7, 280 - 256);
+			memset(lengths + 280, 8, 288 - 280);
+			buildTable(literals, LiteralTable, lengths, 288, literal_root_bits, false);
+
+			// 30 and 31 are invalid distances, they keep the code complete
+			memset(lengths, 5, 32);
+			buildTable(distances, DistanceTable, lengths, 32, distance_root_bits, false);
+		}
+
+		HuffmanTable literals;
+		HuffmanTable distances;
+	};
+
+	static FixedTables const fixed_tables;
+
+	struct BitInput;
+
+	// refills the input of a stream when [in, end[ is exhausted
+	struct InputChunks
+	{
+		InflateStream::Source* source;
+		std::vector<Uint8> buffer;
+
+		Bool next(BitInput& input);
+	};
+
+	//
+	// Bit input, least significant bit first.
+	// The buffer may hold uncounted bits above count, they always match the bytes at in.
+	//
+	struct BitInput
+	{
+		Uint8 const* in;
+		Uint8 const* end;
+		Uint64 bits;
+		Uint count;
+		InputChunks* chunks;	// 0 when [in, end[ is the whole input
+	};
+
+	Bool InputChunks::next(BitInput& input)
+	{
+		Uint const size = source->read(&buffer[0], Uint(buffer.size()));
+		if (size == 0)
+		{
+			return false;
+		}
+
+		// uncounted bits belong to the previous chunk
+		input.bits &= (Uint64(1) << input.count) - 1;
+		input.in = &buffer[0];
+		input.end = input.in + size;
+		return true;
+	}
+
+	static RENGINE_INLINE void refill(BitInput& input)
+	{
+#if RENGINE_ENDIAN == RENGINE_LITTLE_ENDIAN
+		if (input.end - input.in >= 8)
+		{
+			Uint64 word;
+			memcpy(&word, input.in, 8);
+			input.bits |= word << input.count;
+			input.in += (63 - input.count) >> 3;
+			input.count |= 56;
+			return;
+		}
+#endif
+		while (input.count <= 56)
+		{
+			if ((input.in == input.end) && (!input.chunks || !input.chunks->next(input)))
+			{
+				break;
+			}
+
+			input.bits |= Uint64(*input.in++) << input.count;
+			input.count += 8;
+		}
+	}
+
+	static RENGINE_INLINE Uint peek(BitInput const& input, Uint const bits)
+	{
+		return Uint(input.bits & ((Uint64(1) << bits) - 1));
+	}
+
+	static RENGINE_INLINE void consume(BitInput& input, Uint const bits)
+	{
+		input.bits >>= bits;
+		input.count -= bits;
+	}
+
+	static RENGINE_INLINE HuffmanEntry decode(BitInput const& input, HuffmanEntry const* table, Uint const root_bits)
+	{
+		HuffmanEntry entry = table[peek(input, root_bits)];
+
+		if ((entry.op >> 4) == KindSubtable)
+		{
+			entry = table[entry.value + (Uint(input.bits >> root_bits) & ((1u << (entry.op & 15)) - 1))];
+		}
+
+		return entry;
+	}
+
+	static RENGINE_INLINE void copyMatch(Uint8*& out, Uint8 const* out_end, Uint const distance, Uint const length)
+	{
+		Uint8 const* from = out - distance;
+		Uint8* const end = out + length;
+
+		if ((distance >= 8) && (Uint(out_end - end) >= 8))
+		{
+			// non overlapping words, may write up to 7 bytes past the match
+			do
+			{
+				memcpy(out, from, 8);
+				out += 8;
+				from += 8;
+			}
+			while (out < end);
+		}
+		else if (distance == 1)
+		{
+			memset(out, *from, length);
+		}
+		else
+		{
+			while (out != end)
+			{
+				*out++ = *from++;
+			}
+		}
+
+		out = end;
+	}
+
+	static Inflater::Status storedBlock(BitInput& input, Uint8*& out, Uint8* const out_end)
+	{
+		consume(input, input.count & 7);
+
+		refill(input);
+		if (input.count < 32)
+		{
+			return Inflater::InputUnderflow;
+		}
+
+		Uint length = peek(input, 16);
+		Uint const complement = Uint(input.bits >> 16) & 0xFFFF;
+		consume(input, 32);
+
+		if (length != (~complement & 0xFFFF))
+		{
+			return Inflater::InvalidData;
+		}
+
+		if (length > Uint(out_end - out))
+		{
+			return Inflater::OutputOverflow;
+		}
+
+		// bytes already in the bit buffer
+		while (length && input.count)
+		{
+			*out++ = Uint8(input.bits);
+			consume(input, 8);
+			--length;
+		}
+
+		if (length)
+		{
+			if (length > Uint(input.end - input.in))
+			{
+				return Inflater::InputUnderflow;
+			}
+
+			memcpy(out, input.in, length);
+			out += length;
+			input.in += length;
+			input.bits = 0;
+		}
+
+		return Inflater::Success;
+	}
+
+	static Inflater::Status compressedBlock(BitInput& input, Uint8* const out_begin, Uint8*& out, Uint8* const out_end,
+											HuffmanTable const& literal_table, HuffmanTable const& distance_table)
+	{
+		HuffmanEntry const* literals = &literal_table[0];
+		HuffmanEntry const* distances = &distance_table[0];
+
+		for (;;)
+		{
+			// a full refill holds a length code, its extra bits, a distance code and its extra bits (48 bits)
+			refill(input);
+
+			HuffmanEntry entry = decode(input, literals, literal_root_bits);
+			if (entry.bits > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			consume(input, entry.bits);
+
+			Uint kind = entry.op >> 4;
+			if (kind == KindLiteral)
+			{
+				if (out == out_end)
+				{
+					return Inflater::OutputOverflow;
+				}
+				*out++ = Uint8(entry.value);
+				continue;
+			}
+
+			if (kind == KindEnd)
+			{
+				return Inflater::Success;
+			}
+
+			if (kind != KindBase)
+			{
+				return Inflater::InvalidData;
+			}
+
+			Uint extra = entry.op & 15;
+			if (extra > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			Uint const length = entry.value + peek(input, extra);
+			consume(input, extra);
+
+			if (input.count < max_code_bits + 13)
+			{
+				refill(input);
+			}
+
+			entry = decode(input, distances, distance_root_bits);
+			if (entry.bits > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			consume(input, entry.bits);
+
+			kind = entry.op >> 4;
+			if (kind != KindBase)
+			{
+				return Inflater::InvalidData;
+			}
+
+			extra = entry.op & 15;
+			if (extra > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			Uint const distance = entry.value + peek(input, extra);
+			consume(input, extra);
+
+			if (distance > Uint(out - out_begin))
+			{
+				return Inflater::InvalidData;
+			}
+
+			if (length > Uint(out_end - out))
+			{
+				return Inflater::OutputOverflow;
+			}
+
+			copyMatch(out, out_end, distance, length);
+		}
+	}
+
+	static Inflater::Status dynamicTables(BitInput& input, HuffmanTable& code_length_table, HuffmanTable& literal_table, HuffmanTable& distance_table)
+	{
+		refill(input);
+		if (input.count < 14)
+		{
+			return Inflater::InputUnderflow;
+		}
+
+		Uint const literal_count = 257 + peek(input, 5);
+		Uint const distance_count = 1 + (Uint(input.bits >> 5) & 31);
+		Uint const code_count = 4 + (Uint(input.bits >> 10) & 15);
+		consume(input, 14);
+
+		if ((literal_count > 286) || (distance_count > 30))
+		{
+			return Inflater::InvalidData;
+		}
+
+		Uint8 lengths[286 + 30];
+		memset(lengths, 0, 19);
+
+		for (Uint code = 0; code != code_count; ++code)
+		{
+			if (input.count < 3)
+			{
+				refill(input);
+				if (input.count < 3)
+				{
+					return Inflater::InputUnderflow;
+				}
+			}
+
+			lengths[code_length_order[code]] = Uint8(peek(input, 3));
+			consume(input, 3);
+		}
+
+		if (!buildTable(code_length_table, CodeLengthTable, lengths, 19, code_length_root_bits, false))
+		{
+			return Inflater::InvalidData;
+		}
+
+		HuffmanEntry const* code_lengths = &code_length_table[0];
+		Uint const total = literal_count + distance_count;
+		Uint index = 0;
+
+		while (index < total)
+		{
+			if (input.count < 14)
+			{
+				refill(input);
+			}
+
+			HuffmanEntry const entry = code_lengths[peek(input, code_length_root_bits)];
+			if (entry.bits > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			consume(input, entry.bits);
+
+			Uint const symbol = entry.value;
+			if (symbol < 16)
+			{
+				lengths[index++] = Uint8(symbol);
+				continue;
+			}
+
+			Uint8 value = 0;
+			Uint repeat = 0;
+			Uint extra = 0;
+
+			if (symbol == 16)
+			{
+				if (index == 0)
+				{
+					return Inflater::InvalidData;
+				}
+				value = lengths[index - 1];
+				repeat = 3;
+				extra = 2;
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3;
+				extra = 3;
+			}
+			else
+			{
+				repeat = 11;
+				extra = 7;
+			}
+
+			if (extra > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			repeat += peek(input, extra);
+			consume(input, extra);
+
+			if (index + repeat > total)
+			{
+				return Inflater::InvalidData;
+			}
+
+			memset(lengths + index, value, repeat);
+			index += repeat;
+		}
+
+		// a block without end of block code can not terminate
+		if (lengths[256] == 0)
+		{
+			return Inflater::InvalidData;
+		}
+
+		if (!buildTable(literal_table, LiteralTable, lengths, literal_count, literal_root_bits, true) ||
+			!buildTable(distance_table, DistanceTable, lengths + literal_count, distance_count, distance_root_bits, true))
+		{
+			return Inflater::InvalidData;
+		}
+
+		return Inflater::Success;
+	}
+
+	//
+	// Inflater
+	//
+	Inflater::Inflater()
+	{
+	}
+
+	Inflater::~Inflater()
+	{
+	}
+
+	Inflater::Status Inflater::inflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint& source_size)
+	{
+		BitInput input;
+		input.in = source;
+		input.end = source + source_size;
+		input.bits = 0;
+		input.count = 0;
+		input.chunks = 0;
+
+		Uint8* out = destination;
+		Uint8* const out_end = destination + destination_size;
+
+		Status status = Success;
+		Bool last = false;
+
+		while (!last && (status == Success))
+		{
+			refill(input);
+			if (input.count < 3)
+			{
+				status = InputUnderflow;
+				break;
+			}
+
+			last = (peek(input, 1) == 1);
+			Uint const type = Uint(input.bits >> 1) & 3;
+			consume(input, 3);
+
+			if (type == 0)
+			{
+				status = storedBlock(input, out, out_end);
+			}
+			else if (type == 1)
+			{
+				status = compressedBlock(input, destination, out, out_end, fixed_tables.literals, fixed_tables.distances);
+			}
+			else if (type == 2)
+			{
+				status = dynamicTables(input, code_length_table_, literal_table_, distance_table_);
+				if (status == Success)
+				{
+					status = compressedBlock(input, destination, out, out_end, literal_table_, distance_table_);
+				}
+			}
+			else
+			{
+				status = InvalidData;
+			}
+		}
+
+		// whole bytes left in the bit buffer were not consumed
+		source_size = Uint(input.in - source) - (input.count >> 3);
+		destination_size = Uint(out - destination);
+
+		return status;
+	}
+
+	Inflater::Status inflate(Uint8* destination, Uint& destination_size, Uint8 const* source, Uint& source_size)
+	{
+		Inflater inflater;
+		return inflater.inflate(destination, destination_size, source, source_size);
+	}
+
+	//
+	// InflateStream
+	//
+	static Uint const stream_window_size = 1 << 16;
+	static Uint const stream_window_mask = stream_window_size - 1;
+	static Uint const stream_history = 1 << 15;
+	static Uint const stream_chunk_size = 1 << 16;
+
+	struct InflateStream::Implementation
+	{
+		enum State
+		{
+			BlockHeader,
+			StoredBlock,
+			CompressedBlock,
+			Finished
+		};
+
+		Implementation(Source& source)
+			:window(stream_window_size), read_position(0), write_position(0),
+			 state(BlockHeader), last(false), stored_left(0), literals(0), distances(0), status(Inflater::Success)
+		{
+			chunks.source = &source;
+			chunks.buffer.resize(stream_chunk_size);
+
+			input.in = 0;
+			input.end = 0;
+			input.bits = 0;
+			input.count = 0;
+			input.chunks = &chunks;
+		}
+
+		RENGINE_INLINE Uint64 pending() const
+		{
+			return write_position - read_position;
+		}
+
+		RENGINE_INLINE Uint64 space() const
+		{
+			return (stream_window_size - stream_history) - pending();
+		}
+
+		// appends bytes to the window, at most space bytes
+		void put(Uint8 const* data, Uint const size)
+		{
+			Uint const offset = Uint(write_position & stream_window_mask);
+			Uint const first = std::min(size, stream_window_size - offset);
+
+			memcpy(&window[offset], data, first);
+			memcpy(&window[0], data + first, size - first);
+			write_position += size;
+		}
+
+		// decodes a block header or a part of the current block
+		Inflater::Status step();
+		Inflater::Status blockHeader();
+		Inflater::Status storedBlock();
+		Inflater::Status compressedBlock();
+
+		InputChunks chunks;
+		BitInput input;
+
+		// decoded bytes, the history is kept behind write_position
+		std::vector<Uint8> window;
+		Uint64 read_position;
+		Uint64 write_position;
+
+		State state;
+		Bool last;
+		Uint stored_left;
+
+		HuffmanTable literal_table;
+		HuffmanTable distance_table;
+		HuffmanTable code_length_table;
+		HuffmanEntry const* literals;
+		HuffmanEntry const* distances;
+
+		Inflater::Status status;
+	};
+
+	Inflater::Status InflateStream::Implementation::blockHeader()
+	{
+		if (last)
+		{
+			state = Finished;
+			return Inflater::Success;
+		}
+
+		refill(input);
+		if (input.count < 3)
+		{
+			return Inflater::InputUnderflow;
+		}
+
+		last = (peek(input, 1) == 1);
+		Uint const type = Uint(input.bits >> 1) & 3;
+		consume(input, 3);
+
+		if (type == 0)
+		{
+			consume(input, input.count & 7);
+
+			refill(input);
+			if (input.count < 32)
+			{
+				return Inflater::InputUnderflow;
+			}
+
+			stored_left = peek(input, 16);
+			Uint const complement = Uint(input.bits >> 16) & 0xFFFF;
+			consume(input, 32);
+
+			if (stored_left != (~complement & 0xFFFF))
+			{
+				return Inflater::InvalidData;
+			}
+
+			state = StoredBlock;
+		}
+		else if (type == 1)
+		{
+			literals = &fixed_tables.literals[0];
+			distances = &fixed_tables.distances[0];
+			state = CompressedBlock;
+		}
+		else if (type == 2)
+		{
+			Inflater::Status const result = dynamicTables(input, code_length_table, literal_table, distance_table);
+			if (result != Inflater::Success)
+			{
+				return result;
+			}
+
+			literals = &literal_table[0];
+			distances = &distance_table[0];
+			state = CompressedBlock;
+		}
+		else
+		{
+			return Inflater::InvalidData;
+		}
+
+		return Inflater::Success;
+	}
+
+	Inflater::Status InflateStream::Implementation::storedBlock()
+	{
+		// bytes already in the bit buffer
+		while (stored_left && input.count && space())
+		{
+			Uint8 const byte = Uint8(input.bits);
+			put(&byte, 1);
+			consume(input, 8);
+			--stored_left;
+		}
+
+		if (input.count == 0)
+		{
+			// the stored bytes are copied from the chunk
+			input.bits = 0;
+		}
+
+		while (stored_left && space())
+		{
+			if ((input.in == input.end) && !chunks.next(input))
+			{
+				return Inflater::InputUnderflow;
+			}
+
+			Uint const size = std::min(Uint(input.end - input.in), Uint(std::min(Uint64(stored_left), space())));
+			put(input.in, size);
+			input.in += size;
+			stored_left -= size;
+		}
+
+		if (stored_left == 0)
+		{
+			state = BlockHeader;
+		}
+
+		return Inflater::Success;
+	}
+
+	Inflater::Status InflateStream::Implementation::compressedBlock()
+	{
+		Uint8* const out = &window[0];
+
+		// a match never overwrites the history or bytes not read yet
+		while (space() >= 258)
+		{
+			refill(input);
+
+			HuffmanEntry entry = decode(input, literals, literal_root_bits);
+			if (entry.bits > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			consume(input, entry.bits);
+
+			Uint kind = entry.op >> 4;
+			if (kind == KindLiteral)
+			{
+				out[write_position & stream_window_mask] = Uint8(entry.value);
+				++write_position;
+				continue;
+			}
+
+			if (kind == KindEnd)
+			{
+				state = BlockHeader;
+				return Inflater::Success;
+			}
+
+			if (kind != KindBase)
+			{
+				return Inflater::InvalidData;
+			}
+
+			Uint extra = entry.op & 15;
+			if (extra > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			Uint const length = entry.value + peek(input, extra);
+			consume(input, extra);
+
+			if (input.count < max_code_bits + 13)
+			{
+				refill(input);
+			}
+
+			entry = decode(input, distances, distance_root_bits);
+			if (entry.bits > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			consume(input, entry.bits);
+
+			kind = entry.op >> 4;
+			if (kind != KindBase)
+			{
+				return Inflater::InvalidData;
+			}
+
+			extra = entry.op & 15;
+			if (extra > input.count)
+			{
+				return Inflater::InputUnderflow;
+			}
+			Uint const distance = entry.value + peek(input, extra);
+			consume(input, extra);
+
+			if (distance > write_position)
+			{
+				return Inflater::InvalidData;
+			}
+
+			Uint64 from = write_position - distance;
+			for (Uint i = 0; i != length; ++i)
+			{
+				out[write_position++ & stream_window_mask] = out[from++ & stream_window_mask];
+			}
+		}
+
+		return Inflater::Success;
+	}
+
+	Inflater::Status InflateStream::Implementation::step()
+	{
+		if (state == BlockHeader)
+		{
+			return blockHeader();
+		}
+		else if (state == StoredBlock)
+		{
+			return storedBlock();
+		}
+		else if (state == CompressedBlock)
+		{
+			return compressedBlock();
+		}
+
+		return Inflater::Success;
+	}
+
+	InflateStream::InflateStream(Source& source)
+		:implementation_(new Implementation(source))
+	{
+	}
+
+	InflateStream::~InflateStream()
+	{
+		delete(implementation_);
+	}
+
+	Uint InflateStream::read(Uint8* destination, Uint const size)
+	{
+		Implementation& stream = *implementation_;
+		Uint copied = 0;
+
+		while (copied != size)
+		{
+			if (stream.pending())
+			{
+				Uint const offset = Uint(stream.read_position & stream_window_mask);
+				Uint const available = Uint(std::min(stream.pending(), Uint64(stream_window_size - offset)));
+				Uint const count = std::min(size - copied, available);
+
+				memcpy(destination + copied, &stream.window[offset], count);
+				stream.read_position += count;
+				copied += count;
+				continue;
+			}
+
+			if ((stream.state == Implementation::Finished) || (stream.status != Inflater::Success))
+			{
+				break;
+			}
+
+			stream.status = stream.step();
+		}
+
+		return copied;
+	}
+
+	Inflater::Status InflateStream::status() const
+	{
+		return implementation_->status;
+	}
+
+	Bool InflateStream::finished() const
+	{
+		return (implementation_->state == Implementation::Finished) && !implementation_->pending();
+	}
+
+} // namespace rengine
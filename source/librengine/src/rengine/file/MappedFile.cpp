@@ -0,0 +1,165 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/MappedFile.h>
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace rengine
+{
+	struct MappedFile::Implementation
+	{
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+		Implementation()
+			:file(INVALID_HANDLE_VALUE), mapping(0)
+		{}
+
+		HANDLE file;
+		HANDLE mapping;
+#else
+		Implementation()
+			:descriptor(-1)
+		{}
+
+		int descriptor;
+#endif
+	};
+
+	MappedFile::MappedFile()
+		:data_(0), size_(0), implementation_(new Implementation())
+	{
+	}
+
+	MappedFile::MappedFile(std::string const& filename)
+		:data_(0), size_(0), implementation_(new Implementation())
+	{
+		open(filename);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+		delete(implementation_);
+	}
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+
+	Bool MappedFile::open(std::string const& filename)
+	{
+		close();
+
+		implementation_->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, 0);
+		if (implementation_->file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(implementation_->file, &file_size) || (file_size.QuadPart == 0))
+		{
+			close();
+			return false;
+		}
+
+		implementation_->mapping = CreateFileMappingA(implementation_->file, 0, PAGE_READONLY, 0, 0, 0);
+		if (!implementation_->mapping)
+		{
+			close();
+			return false;
+		}
+
+		data_ = static_cast<Uint8 const*>(MapViewOfFile(implementation_->mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!data_)
+		{
+			close();
+			return false;
+		}
+
+		size_ = Uint64(file_size.QuadPart);
+		filename_ = filename;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (data_)
+		{
+			UnmapViewOfFile(data_);
+		}
+
+		if (implementation_->mapping)
+		{
+			CloseHandle(implementation_->mapping);
+		}
+
+		if (implementation_->file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(implementation_->file);
+		}
+
+		implementation_->mapping = 0;
+		implementation_->file = INVALID_HANDLE_VALUE;
+		data_ = 0;
+		size_ = 0;
+		filename_ = "";
+	}
+
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+	Bool MappedFile::open(std::string const& filename)
+	{
+		close();
+
+		implementation_->descriptor = ::open(filename.c_str(), O_RDONLY);
+		if (implementation_->descriptor < 0)
+		{
+			return false;
+		}
+
+		struct stat status;
+		if ((fstat(implementation_->descriptor, &status) != 0) || (status.st_size == 0))
+		{
+			close();
+			return false;
+		}
+
+		void* mapping = mmap(0, size_t(status.st_size), PROT_READ, MAP_SHARED, implementation_->descriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+
+		data_ = static_cast<Uint8 const*>(mapping);
+		size_ = Uint64(status.st_size);
+		filename_ = filename;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (data_)
+		{
+			munmap(const_cast<Uint8*>(data_), size_t(size_));
+		}
+
+		if (implementation_->descriptor >= 0)
+		{
+			::close(implementation_->descriptor);
+		}
+
+		implementation_->descriptor = -1;
+		data_ = 0;
+		size_ = 0;
+		filename_ = "";
+	}
+
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+} // namespace rengine
@@ -0,0 +1,195 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/RandomAccessFile.h>
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+	#include <windows.h>
+#else
+	#include <sys/stat.h>
+	#include <sys/types.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
+namespace rengine
+{
+	struct RandomAccessFile::Implementation
+	{
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+		Implementation()
+			:file(INVALID_HANDLE_VALUE)
+		{}
+
+		HANDLE file;
+#else
+		Implementation()
+			:descriptor(-1)
+		{}
+
+		int descriptor;
+#endif
+	};
+
+	RandomAccessFile::RandomAccessFile()
+		:size_(0), open_(false), implementation_(new Implementation())
+	{
+	}
+
+	RandomAccessFile::RandomAccessFile(std::string const& filename)
+		:size_(0), open_(false), implementation_(new Implementation())
+	{
+		open(filename);
+	}
+
+	RandomAccessFile::~RandomAccessFile()
+	{
+		close();
+		delete(implementation_);
+	}
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+
+	Bool RandomAccessFile::open(std::string const& filename)
+	{
+		close();
+
+		implementation_->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, 0);
+		if (implementation_->file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(implementation_->file, &file_size))
+		{
+			close();
+			return false;
+		}
+
+		size_ = Uint64(file_size.QuadPart);
+		filename_ = filename;
+		open_ = true;
+		return true;
+	}
+
+	void RandomAccessFile::close()
+	{
+		if (implementation_->file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(implementation_->file);
+		}
+
+		implementation_->file = INVALID_HANDLE_VALUE;
+		size_ = 0;
+		open_ = false;
+		filename_ = "";
+	}
+
+	Bool RandomAccessFile::read(Uint64 const offset, void* destination, Uint const size) const
+	{
+		if (!open_ || (offset + size > size_))
+		{
+			return false;
+		}
+
+		Uint8* output = static_cast<Uint8*>(destination);
+		Uint64 position = offset;
+		Uint remaining = size;
+
+		// an overlapped offset makes ReadFile positional on a synchronous handle
+		while (remaining)
+		{
+			OVERLAPPED overlapped;
+			ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+			overlapped.Offset = DWORD(position & 0xFFFFFFFF);
+			overlapped.OffsetHigh = DWORD(position >> 32);
+
+			DWORD read_size = 0;
+			if (!ReadFile(implementation_->file, output, DWORD(remaining), &read_size, &overlapped) || (read_size == 0))
+			{
+				return false;
+			}
+
+			output += read_size;
+			position += read_size;
+			remaining -= Uint(read_size);
+		}
+
+		return true;
+	}
+
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+	Bool RandomAccessFile::open(std::string const& filename)
+	{
+		close();
+
+		implementation_->descriptor = ::open(filename.c_str(), O_RDONLY);
+		if (implementation_->descriptor < 0)
+		{
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(implementation_->descriptor, &status) != 0)
+		{
+			close();
+			return false;
+		}
+
+		size_ = Uint64(status.st_size);
+		filename_ = filename;
+		open_ = true;
+		return true;
+	}
+
+	void RandomAccessFile::close()
+	{
+		if (implementation_->descriptor >= 0)
+		{
+			::close(implementation_->descriptor);
+		}
+
+		implementation_->descriptor = -1;
+		size_ = 0;
+		open_ = false;
+		filename_ = "";
+	}
+
+	Bool RandomAccessFile::read(Uint64 const offset, void* destination, Uint const size) const
+	{
+		if (!open_ || (offset + size > size_))
+		{
+			return false;
+		}
+
+		Uint8* output = static_cast<Uint8*>(destination);
+		Uint64 position = offset;
+		Uint remaining = size;
+
+		while (remaining)
+		{
+			ssize_t read_size = pread(implementation_->descriptor, output, size_t(remaining), off_t(position));
+
+			if ((read_size < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+
+			if (read_size <= 0)
+			{
+				return false;
+			}
+
+			output += read_size;
+			position += Uint64(read_size);
+			remaining -= Uint(read_size);
+		}
+
+		return true;
+	}
+
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+} // namespace rengine
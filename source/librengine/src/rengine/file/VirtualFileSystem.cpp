@@ -0,0 +1,614 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/file/RandomAccessFile.h>
+#include <rengine/string/String.h>
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace rengine
+{
+	//
+	// Streams
+	//
+	class DiskFileStream : public FileStream
+	{
+	public:
+		typedef SharedPointer<RandomAccessFile> SharedFile;
+
+		DiskFileStream(SharedFile const& file)
+			:file_(file), size_(Uint(file->size())), position_(0), good_(file->size() <= Uint64(Uint(-1)))
+		{
+		}
+
+		virtual Uint read(void* buffer, Uint const size)
+		{
+			Uint const count = std::min(size, size_ - position_);
+
+			if (!good_ || (count == 0))
+			{
+				return 0;
+			}
+
+			if (!file_->read(position_, buffer, count))
+			{
+				good_ = false;
+				return 0;
+			}
+
+			position_ += count;
+			return count;
+		}
+
+		virtual Uint size() const { return size_; }
+		virtual Uint position() const { return position_; }
+		virtual Bool eof() const { return (position_ == size_); }
+		virtual Bool good() const { return good_; }
+	private:
+		SharedFile file_;
+		Uint size_;
+		Uint position_;
+		Bool good_;
+	};
+
+	//
+	// DirectoryMount
+	//
+	VirtualFileSystem::DirectoryMount::DirectoryMount(std::string const& root)
+		:root_(VirtualFileSystem::normalize(root))
+	{
+	}
+
+	std::string VirtualFileSystem::DirectoryMount::path(std::string const& filename) const
+	{
+		std::string full_path;
+
+		if (root_.empty())
+		{
+			full_path = filename.empty() ? "." : filename;
+		}
+		else if (filename.empty())
+		{
+			full_path = root_;
+		}
+		else
+		{
+			full_path = (root_ == "/") ? (root_ + filename) : (root_ + "/" + filename);
+		}
+
+		return convertFileNameToNativeStyle(full_path);
+	}
+
+	FileType VirtualFileSystem::DirectoryMount::fileType(std::string const& filename) const
+	{
+		return rengine::fileType(path(filename));
+	}
+
+	DirectoryContents VirtualFileSystem::DirectoryMount::getDirectoryContents(std::string const& directory_name) const
+	{
+		return rengine::getDirectoryContents(path(directory_name));
+	}
+
+	Bool VirtualFileSystem::DirectoryMount::read(std::string const& filename, FileData& data) const
+	{
+		std::string const full_path = path(filename);
+
+		if (rengine::fileType(full_path) != FileRegular)
+		{
+			return false;
+		}
+
+		RandomAccessFile file;
+		if (!file.open(full_path) || (file.size() > Uint64(Uint(-1))))
+		{
+			return false;
+		}
+
+		FileData file_data;
+		file_data.size = Uint(file.size());
+
+		if (file_data.size)
+		{
+			file_data.data = new Uint8[file_data.size];
+			if (!file.read(0, file_data.data.get(), file_data.size))
+			{
+				return false;
+			}
+		}
+
+		data = file_data;
+		return true;
+	}
+
+	SharedFileStream VirtualFileSystem::DirectoryMount::openStream(std::string const& filename) const
+	{
+		std::string const full_path = path(filename);
+
+		SharedFileStream stream;
+		if (rengine::fileType(full_path) != FileRegular)
+		{
+			return stream;
+		}
+
+		DiskFileStream::SharedFile file = new RandomAccessFile();
+		if (file->open(full_path))
+		{
+			stream = new DiskFileStream(file);
+		}
+
+		return stream;
+	}
+
+	std::string VirtualFileSystem::DirectoryMount::nativeFilename(std::string const& filename) const
+	{
+		std::string const full_path = path(filename);
+		return (rengine::fileType(full_path) == FileRegular) ? convertFileNameToNativeStyle(full_path) : std::string();
+	}
+
+	//
+	// ZipMount
+	//
+	VirtualFileSystem::ZipMount::ZipMount(SharedZip const& zip)
+		:zip_(zip)
+	{
+	}
+
+	FileType VirtualFileSystem::ZipMount::fileType(std::string const& filename) const
+	{
+		return zip_->fileType(filename);
+	}
+
+	DirectoryContents VirtualFileSystem::ZipMount::getDirectoryContents(std::string const& directory_name) const
+	{
+		return zip_->getDirectoryContents(directory_name);
+	}
+
+	Bool VirtualFileSystem::ZipMount::read(std::string const& filename, FileData& data) const
+	{
+		if (zip_->fileType(filename) != FileRegular)
+		{
+			return false;
+		}
+
+		FileData file_data = zip_->read(filename);
+
+		// Zip::read returns no bytes for corrupted entries and for empty ones
+		if (!file_data.bytes())
+		{
+			Zip::SharedStream stream = zip_->openStream(filename);
+			if (!stream || stream->size())
+			{
+				return false;
+			}
+		}
+
+		data = file_data;
+		return true;
+	}
+
+	SharedFileStream VirtualFileSystem::ZipMount::openStream(std::string const& filename) const
+	{
+		Zip::SharedStream stream = zip_->openStream(filename);
+		return stream;
+	}
+
+	//
+	// MemoryMount
+	//
+	VirtualFileSystem::MemoryMount::MemoryMount()
+	{
+	}
+
+	void VirtualFileSystem::MemoryMount::add(std::string const& filename, void const* data, Uint const size)
+	{
+		FileData file_data;
+		file_data.size = size;
+
+		if (size)
+		{
+			file_data.data = new Uint8[size];
+			memcpy(file_data.data.get(), data, size);
+		}
+
+		ScopedLock lock(mutex_);
+		files_[VirtualFileSystem::normalize(filename)] = file_data;
+	}
+
+	void VirtualFileSystem::MemoryMount::add(std::string const& filename, std::string const& text)
+	{
+		add(filename, text.data(), Uint(text.size()));
+	}
+
+	Bool VirtualFileSystem::MemoryMount::remove(std::string const& filename)
+	{
+		ScopedLock lock(mutex_);
+		return (files_.erase(VirtualFileSystem::normalize(filename)) != 0);
+	}
+
+	void VirtualFileSystem::MemoryMount::clear()
+	{
+		ScopedLock lock(mutex_);
+		files_.clear();
+	}
+
+	Uint VirtualFileSystem::MemoryMount::numberOfFiles() const
+	{
+		ScopedLock lock(mutex_);
+		return Uint(files_.size());
+	}
+
+	FileType VirtualFileSystem::MemoryMount::fileType(std::string const& filename) const
+	{
+		std::string const name = VirtualFileSystem::normalize(filename);
+		if (name.empty())
+		{
+			return FileDirectory;
+		}
+
+		ScopedLock lock(mutex_);
+
+		if (files_.find(name) != files_.end())
+		{
+			return FileRegular;
+		}
+
+		// files are sorted, the first one after the prefix tells if the directory has files
+		std::string const prefix = name + "/";
+		Files::const_iterator next = files_.lower_bound(prefix);
+
+		return ((next != files_.end()) && startsWith(next->first, prefix)) ? FileDirectory : FileNotFound;
+	}
+
+	DirectoryContents VirtualFileSystem::MemoryMount::getDirectoryContents(std::string const& directory_name) const
+	{
+		std::string const name = VirtualFileSystem::normalize(directory_name);
+		std::string const prefix = name.empty() ? name : (name + "/");
+
+		DirectoryContents contents;
+		ScopedLock lock(mutex_);
+
+		for (Files::const_iterator i = files_.lower_bound(prefix); (i != files_.end()) && startsWith(i->first, prefix); ++i)
+		{
+			std::string const child = i->first.substr(prefix.size(), i->first.find('/', prefix.size()) - prefix.size());
+
+			if (contents.empty() || (contents.back() != child))
+			{
+				contents.push_back(child);
+			}
+		}
+
+		if (!contents.empty())
+		{
+			contents.push_back(".");
+			contents.push_back("..");
+		}
+
+		return contents;
+	}
+
+	Bool VirtualFileSystem::MemoryMount::read(std::string const& filename, FileData& data) const
+	{
+		ScopedLock lock(mutex_);
+
+		Files::const_iterator found = files_.find(VirtualFileSystem::normalize(filename));
+		if (found == files_.end())
+		{
+			return false;
+		}
+
+		data = found->second;
+		return true;
+	}
+
+	SharedFileStream VirtualFileSystem::MemoryMount::openStream(std::string const& filename) const
+	{
+		SharedFileStream stream;
+
+		FileData data;
+		if (read(filename, data))
+		{
+			stream = new MemoryFileStream(data);
+		}
+
+		return stream;
+	}
+
+	//
+	// VirtualFileSystem
+	//
+	VirtualFileSystem::VirtualFileSystem()
+	{
+	}
+
+	VirtualFileSystem::~VirtualFileSystem()
+	{
+	}
+
+	std::string VirtualFileSystem::normalize(std::string const& filename)
+	{
+		std::string const unix_filename = convertFileNameToUnixStyle(filename);
+		Bool const absolute = !unix_filename.empty() && (unix_filename[0] == '/');
+
+		std::vector<std::string> segments;
+		std::string::size_type begin = 0;
+
+		while (begin <= unix_filename.size())
+		{
+			std::string::size_type end = unix_filename.find('/', begin);
+			if (end == std::string::npos)
+			{
+				end = unix_filename.size();
+			}
+
+			std::string const segment = unix_filename.substr(begin, end - begin);
+			begin = end + 1;
+
+			if (segment.empty() || (segment == "."))
+			{
+				continue;
+			}
+
+			if (segment == "..")
+			{
+				if (!segments.empty() && (segments.back() != ".."))
+				{
+					segments.pop_back();
+				}
+				else if (!absolute)
+				{
+					segments.push_back(segment);
+				}
+			}
+			else
+			{
+				segments.push_back(segment);
+			}
+		}
+
+		std::string normalized = absolute ? "/" : "";
+		for (Uint i = 0; i != segments.size(); ++i)
+		{
+			if (i)
+			{
+				normalized += "/";
+			}
+			normalized += segments[i];
+		}
+
+		return normalized;
+	}
+
+	void VirtualFileSystem::mount(SharedMount const& mount, std::string const& mount_point, Int const priority)
+	{
+		MountPoint point;
+		point.mount = mount;
+		point.prefix = normalize(mount_point);
+		point.priority = priority;
+
+		WriteScopedLock lock(mutex_);
+
+		MountPoints::iterator position = mount_points_.begin();
+		while ((position != mount_points_.end()) && (position->priority > priority))
+		{
+			++position;
+		}
+
+		mount_points_.insert(position, point);
+	}
+
+	VirtualFileSystem::SharedMount VirtualFileSystem::mountDirectory(std::string const& directory, std::string const& mount_point, Int const priority)
+	{
+		SharedMount directory_mount = new DirectoryMount(directory);
+		mount(directory_mount, mount_point, priority);
+		return directory_mount;
+	}
+
+	VirtualFileSystem::SharedMount VirtualFileSystem::mountZip(std::string const& filename, std::string const& mount_point, Int const priority, Zip::AccessMode const mode)
+	{
+		SharedMount zip_mount;
+
+		ZipMount::SharedZip zip = new Zip();
+		if (zip->load(filename, mode))
+		{
+			zip_mount = new ZipMount(zip);
+			mount(zip_mount, mount_point, priority);
+		}
+
+		return zip_mount;
+	}
+
+	VirtualFileSystem::SharedMemoryMount VirtualFileSystem::mountMemory(std::string const& mount_point, Int const priority)
+	{
+		SharedMemoryMount memory_mount = new MemoryMount();
+		mount(memory_mount, mount_point, priority);
+		return memory_mount;
+	}
+
+	Bool VirtualFileSystem::unmount(SharedMount const& mount)
+	{
+		WriteScopedLock lock(mutex_);
+
+		for (MountPoints::iterator i = mount_points_.begin(); i != mount_points_.end(); ++i)
+		{
+			if (i->mount.get() == mount.get())
+			{
+				mount_points_.erase(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void VirtualFileSystem::unmountAll()
+	{
+		WriteScopedLock lock(mutex_);
+		mount_points_.clear();
+	}
+
+	Uint VirtualFileSystem::numberOfMounts() const
+	{
+		ReadScopedLock lock(mutex_);
+		return Uint(mount_points_.size());
+	}
+
+	VirtualFileSystem::Matches VirtualFileSystem::match(std::string const& filename) const
+	{
+		std::string const name = normalize(filename);
+		Matches matches;
+
+		ReadScopedLock lock(mutex_);
+
+		for (MountPoints::const_iterator i = mount_points_.begin(); i != mount_points_.end(); ++i)
+		{
+			Match current;
+			current.mount = i->mount;
+
+			if (i->prefix.empty())
+			{
+				current.filename = name;
+			}
+			else if (name == i->prefix)
+			{
+				current.filename = "";
+			}
+			else if (startsWith(name, i->prefix + "/"))
+			{
+				current.filename = name.substr(i->prefix.size() + 1);
+			}
+			else
+			{
+				continue;
+			}
+
+			matches.push_back(current);
+		}
+
+		return matches;
+	}
+
+	DirectoryContents VirtualFileSystem::getDirectoryContents(std::string const& directory_name) const
+	{
+		std::string const name = normalize(directory_name);
+
+		DirectoryContents contents;
+		std::set<std::string> added;
+
+		Matches const matches = match(name);
+		for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
+		{
+			DirectoryContents const mount_contents = i->mount->getDirectoryContents(i->filename);
+			for (DirectoryContents::const_iterator file = mount_contents.begin(); file != mount_contents.end(); ++file)
+			{
+				if (added.insert(*file).second)
+				{
+					contents.push_back(*file);
+				}
+			}
+		}
+
+		// mount points are directories of their parents
+		std::string const prefix = name.empty() ? name : (name + "/");
+
+		ReadScopedLock lock(mutex_);
+		for (MountPoints::const_iterator i = mount_points_.begin(); i != mount_points_.end(); ++i)
+		{
+			if ((i->prefix.size() > prefix.size()) && startsWith(i->prefix, prefix))
+			{
+				std::string const child = i->prefix.substr(prefix.size(), i->prefix.find('/', prefix.size()) - prefix.size());
+				if (added.insert(child).second)
+				{
+					contents.push_back(child);
+				}
+			}
+		}
+
+		return contents;
+	}
+
+	FileType VirtualFileSystem::fileType(std::string const& filename) const
+	{
+		std::string const name = normalize(filename);
+
+		Matches const matches = match(name);
+		for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
+		{
+			FileType const type = i->mount->fileType(i->filename);
+			if (type != FileNotFound)
+			{
+				return type;
+			}
+		}
+
+		std::string const prefix = name + "/";
+
+		ReadScopedLock lock(mutex_);
+		for (MountPoints::const_iterator i = mount_points_.begin(); i != mount_points_.end(); ++i)
+		{
+			if (!i->prefix.empty() && (name.empty() || (i->prefix == name) || startsWith(i->prefix, prefix)))
+			{
+				return FileDirectory;
+			}
+		}
+
+		return FileNotFound;
+	}
+
+	Bool VirtualFileSystem::read(std::string const& filename, FileData& data) const
+	{
+		Matches const matches = match(filename);
+		for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
+		{
+			if (i->mount->read(i->filename, data))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	Bool VirtualFileSystem::readText(std::string const& filename, std::string& text) const
+	{
+		FileData data;
+		if (!read(filename, data))
+		{
+			return false;
+		}
+
+		text.assign((Char const*) data.bytes(), data.size);
+		convertTextToNativeStyle(text);
+
+		return true;
+	}
+
+	SharedFileStream VirtualFileSystem::openStream(std::string const& filename) const
+	{
+		SharedFileStream stream;
+
+		Matches const matches = match(filename);
+		for (Matches::const_iterator i = matches.begin(); (i != matches.end()) && !stream; ++i)
+		{
+			stream = i->mount->openStream(i->filename);
+		}
+
+		return stream;
+	}
+
+	std::string VirtualFileSystem::nativeFilename(std::string const& filename) const
+	{
+		Matches const matches = match(filename);
+		for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
+		{
+			if (i->mount->fileType(i->filename) == FileRegular)
+			{
+				return i->mount->nativeFilename(i->filename);
+			}
+		}
+
+		return std::string();
+	}
+
+} // namespace rengine
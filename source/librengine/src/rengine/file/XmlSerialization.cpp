@@ -44,16 +44,7 @@ namespace rengine
 
 			if (data_->document.LoadFile(filename_))
 			{
-				TiXmlNode* node = data_->document.FirstChild("root");
-				if (node)
-				{
-					TiXmlElement* current_element = node->ToElement();
-					if (current_element)
-					{
-						data_->element_stack.push_back(XmlElementPair(current_element, 0));
-						state = true;
-					}
-				}
+				state = openRoot();
 			}
 
 		}
@@ -78,6 +69,31 @@ namespace rengine
 		return state;
 	}
 
+	Bool XmlArchive::parse(std::string const& text)
+	{
+		data_->document.Clear();
+		data_->element_stack.clear();
+
+		mode_ = Read;
+		filename_.clear();
+
+		data_->document.Parse(text.c_str());
+		return (!data_->document.Error() && openRoot());
+	}
+
+	Bool XmlArchive::openRoot()
+	{
+		TiXmlNode* node = data_->document.FirstChild("root");
+		TiXmlElement* current_element = node ? node->ToElement() : 0;
+
+		if (current_element)
+		{
+			data_->element_stack.push_back(XmlElementPair(current_element, 0));
+		}
+
+		return (current_element != 0);
+	}
+
 	void XmlArchive::beginNode(std::string const& node_name)
 	{
 		if (mode_ == Write)
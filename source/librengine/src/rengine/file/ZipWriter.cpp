@@ -0,0 +1,231 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/file/ZipWriter.h>
+#include <rengine/file/File.h>
+#include <rengine/util/Crc32.h>
+
+//
+// See Zip.cpp for the format, entries are written with the local header sizes and crc
+// so no extended local header is needed. Every entry gets the same date (1980-01-01)
+// so the same content always produces the same archive.
+//
+
+namespace rengine
+{
+	static Uint16 const version_needed = 20;
+	static Uint16 const dos_time = 0;
+	static Uint16 const dos_date = (1 << 5) | 1;
+	static Uint32 const directory_attribute = 0x10;
+
+	static void put16(std::vector<Uint8>& out, Uint const value)
+	{
+		out.push_back(Uint8(value));
+		out.push_back(Uint8(value >> 8));
+	}
+
+	static void put32(std::vector<Uint8>& out, Uint32 const value)
+	{
+		put16(out, value & 0xFFFF);
+		put16(out, value >> 16);
+	}
+
+	static void putName(std::vector<Uint8>& out, std::string const& name)
+	{
+		out.insert(out.end(), name.begin(), name.end());
+	}
+
+	ZipWriter::ZipWriter()
+		:m_good(false)
+	{
+	}
+
+	ZipWriter::ZipWriter(std::string const& filename)
+		:m_good(false)
+	{
+		open(filename);
+	}
+
+	ZipWriter::~ZipWriter()
+	{
+		close();
+	}
+
+	Bool ZipWriter::open(std::string const& filename)
+	{
+		close();
+
+		m_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		m_good = m_file.is_open();
+
+		return m_good;
+	}
+
+	Bool ZipWriter::close()
+	{
+		if (!m_file.is_open())
+		{
+			return false;
+		}
+
+		std::vector<Uint8> directory;
+		Uint64 const directory_offset = Uint64(m_file.tellp());
+
+		for (Entries::const_iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+		{
+			Bool const is_directory = (i->filename[i->filename.size() - 1] == '/');
+
+			put32(directory, 0x02014b50);
+			put16(directory, version_needed);
+			put16(directory, version_needed);
+			put16(directory, 0);
+			put16(directory, i->compression_method);
+			put16(directory, dos_time);
+			put16(directory, dos_date);
+			put32(directory, i->crc);
+			put32(directory, i->compressed_size);
+			put32(directory, i->uncompressed_size);
+			put16(directory, Uint(i->filename.size()));
+			put16(directory, 0);
+			put16(directory, 0);
+			put16(directory, 0);
+			put16(directory, 0);
+			put32(directory, is_directory ? directory_attribute : 0);
+			put32(directory, i->offset);
+			putName(directory, i->filename);
+		}
+
+		Uint32 const directory_size = Uint32(directory.size());
+
+		put32(directory, 0x06054b50);
+		put16(directory, 0);
+		put16(directory, 0);
+		put16(directory, Uint(m_entries.size()));
+		put16(directory, Uint(m_entries.size()));
+		put32(directory, directory_size);
+		put32(directory, Uint32(directory_offset));
+		put16(directory, 0);
+
+		m_good = m_good && (directory_offset <= 0xFFFFFFFF);
+		m_file.write((Char const*) &directory[0], directory.size());
+		m_good = m_good && m_file.good();
+		m_file.close();
+
+		Bool const good = m_good;
+
+		m_entries.clear();
+		m_names.clear();
+		m_buffer.clear();
+		m_good = false;
+
+		return good;
+	}
+
+	Bool ZipWriter::add(std::string const& filename, void const* data, Uint const size, Deflater::Level const level)
+	{
+		std::string const name = convertFileNameToUnixStyle(filename);
+
+		if (name.empty() || (name[name.size() - 1] == '/'))
+		{
+			return false;
+		}
+
+		addParentDirectories(name);
+		return addEntry(name, static_cast<Uint8 const*>(data), size, level);
+	}
+
+	Bool ZipWriter::addDirectory(std::string const& directory_name)
+	{
+		std::string name = convertFileNameToUnixStyle(directory_name);
+
+		if (name.empty())
+		{
+			return false;
+		}
+
+		if (name[name.size() - 1] != '/')
+		{
+			name += "/";
+		}
+
+		addParentDirectories(name.substr(0, name.size() - 1));
+		return addEntry(name, 0, 0, Deflater::StoreLevel);
+	}
+
+	void ZipWriter::addParentDirectories(std::string const& filename)
+	{
+		for (std::string::size_type slash = filename.find('/'); slash != std::string::npos; slash = filename.find('/', slash + 1))
+		{
+			std::string const directory = filename.substr(0, slash + 1);
+			if (m_names.find(directory) == m_names.end())
+			{
+				addEntry(directory, 0, 0, Deflater::StoreLevel);
+			}
+		}
+	}
+
+	Bool ZipWriter::addEntry(std::string const& filename, Uint8 const* data, Uint const size, Deflater::Level const level)
+	{
+		Uint64 const offset = m_file.is_open() ? Uint64(m_file.tellp()) : 0;
+
+		if (!m_good || (offset > 0xFFFFFFFF) || (m_entries.size() >= 0xFFFF) || (m_names.find(filename) != m_names.end()))
+		{
+			return false;
+		}
+
+		Entry entry;
+		entry.filename = filename;
+		entry.compression_method = 0;
+		entry.crc = crc32(0, data, size);
+		entry.compressed_size = size;
+		entry.uncompressed_size = size;
+		entry.offset = Uint32(offset);
+
+		Uint8 const* payload = data;
+
+		if (size && (level != Deflater::StoreLevel))
+		{
+			m_buffer.resize(Deflater::bound(size));
+			Uint compressed_size = Uint(m_buffer.size());
+
+			m_deflater.setLevel(level);
+			if ((m_deflater.deflate(&m_buffer[0], compressed_size, data, size) == Deflater::Success) && (compressed_size < size))
+			{
+				entry.compression_method = 8;
+				entry.compressed_size = compressed_size;
+				payload = &m_buffer[0];
+			}
+		}
+
+		std::vector<Uint8> header;
+		put32(header, 0x04034b50);
+		put16(header, version_needed);
+		put16(header, 0);
+		put16(header, entry.compression_method);
+		put16(header, dos_time);
+		put16(header, dos_date);
+		put32(header, entry.crc);
+		put32(header, entry.compressed_size);
+		put32(header, entry.uncompressed_size);
+		put16(header, Uint(filename.size()));
+		put16(header, 0);
+		putName(header, filename);
+
+		m_file.write((Char const*) &header[0], header.size());
+		if (entry.compressed_size)
+		{
+			m_file.write((Char const*) payload, entry.compressed_size);
+		}
+
+		if (!m_file.good())
+		{
+			m_good = false;
+			return false;
+		}
+
+		m_entries.push_back(entry);
+		m_names.insert(filename);
+
+		return true;
+	}
+
+} // namespace rengine
@@ -58,17 +58,25 @@ namespace rengine
         if (c & (~255)) { if (c < 0) c = 0; else c = 255; }
 
 	void convertYUYV_RGB8(Uchar* in, Uchar* out, Uint const& width, Uint const& height)
+	{
+		convertYUYV_RGB8(ImageView(in, width, height, 2), ImageView(out, width, height, 3));
+	}
+
+	void convertYUYV_RGB8(ImageView const& in, ImageView const& out)
 	{
 		Uchar *s;
 		Uchar *d;
-		int l, c;
+		int c;
 		int r, g, b, cr, cg, cb, y1, y2;
 
-		l = height;
-		s = in;
-		d = out;
-		while (l--) 
+		Uint const width = minimum(in.getWidth(), out.getWidth());
+		Uint const height = minimum(in.getHeight(), out.getHeight());
+
+		for (Uint l = 0; l != height; ++l)
 		{
+			s = in.row(l);
+			d = out.row(l);
+
 			c = width >> 1;
 			while (c--) 
 			{
@@ -107,26 +115,34 @@ namespace rengine
 
 	void convertBGR8_RGB8(Uchar* in, Uchar* out, Uint const& width, Uint const& height)
 	{
-		Uint const size = width * height * 3;
-		for (Uint i = 0; i != size; i += 3)
-		{
-			out[i + 0] = in[i + 2];
-			out[i + 1] = in[i + 1];
-			out[i + 2] = in[i + 0];
-		}
+		convertBGR8_RGB8(ImageView(in, width, height, 3), ImageView(out, width, height, 3));
 	}
 
 
 	void convertBGR8_RGB8(Uchar* in_out, Uint const& width, Uint const& height)
 	{
-		Uchar swapper = 0;
+		ImageView const view(in_out, width, height, 3);
+		convertBGR8_RGB8(view, view);
+	}
+
+	void convertBGR8_RGB8(ImageView const& in, ImageView const& out)
+	{
+		Uint const width = minimum(in.getWidth(), out.getWidth());
+		Uint const height = minimum(in.getHeight(), out.getHeight());
 
-		Uint const size = width * height * 3;
-		for (Uint i = 0; i != size; i += 3)
+		for (Uint y = 0; y != height; ++y)
 		{
-			swapper = in_out[i + 0];
-			in_out[i + 0] = in_out[i + 2];
-			in_out[i + 2] = swapper;
+			Uchar const* source = in.row(y);
+			Uchar* destination = out.row(y);
+
+			for (Uint i = 0; i != width * 3; i += 3)
+			{
+				// same view is swapped in place
+				Uchar const blue = source[i + 0];
+				destination[i + 0] = source[i + 2];
+				destination[i + 1] = source[i + 1];
+				destination[i + 2] = blue;
+			}
 		}
 	}
 }
@@ -1,6 +1,7 @@
 // __!!rengine_copyright!!__ //
 
 #include <rengine/image/Image.h>
+#include <rengine/image/ImageResampler.h>
 
 #include <sstream>
 #include <cmath>
@@ -74,6 +75,31 @@ namespace rengine
 		this->color_channels = color_channels;
 	}
 
+	Image::Image(Uint const width, Uint const height, Uint const color_channels, Uchar* data, SharedImageStorage const& storage)
+	{
+		// freeImage only releases the storage
+		delete_on_destructor = true;
+
+		this->data = data;
+		this->width = width;
+		this->height = height;
+		this->color_channels = color_channels;
+		this->storage = storage;
+	}
+
+	Image::Image(ImageView const& view)
+	{
+		delete_on_destructor = true;
+		data = 0;
+		freeImage();
+
+		if (view.isValid())
+		{
+			createImage(view.getWidth(), view.getHeight(), view.getColorChannels());
+			view.copyTo(this->view());
+		}
+	}
+
 	Image::~Image()
 	{
 		if (getDeleteDataOnDestructor())
@@ -87,13 +113,24 @@ namespace rengine
 		return (data != 0);
 	}
 
+	ImageView Image::view() const
+	{
+		return ImageView(data, width, height, color_channels);
+	}
+
+	ImageView Image::view(Uint const x, Uint const y, Uint const view_width, Uint const view_height) const
+	{
+		return view().subView(x, y, view_width, view_height);
+	}
+
 	void Image::freeImage()
 	{
-		if (data)
+		if (data && !storage)
 		{
 			delete[](data);
 		}
 		data = 0;
+		storage = 0;
 
 		width = 0;
 		height = 0;
@@ -131,8 +168,7 @@ namespace rengine
 
 			if ((new_width != width) || (new_height != height))
 			{
-				downscale(new_width, new_height);
-				//crop(0, 0, new_width, new_height);
+				resize(new_width, new_height);
 			}
 		}
 
@@ -144,18 +180,7 @@ namespace rengine
 
 	void Image::applyColorKey(const Color &color)
 	{
-		if (color_channels == 4)
-		{
-			for(Uint i = 0; i < width * height; ++i)
-			{
-				if ( (pixel(i)->r() == color.r()) && 
-					 (pixel(i)->g() == color.g()) && 
-					 (pixel(i)->b() == color.b()))
-				{
-					pixel(i)->a() = color.a();
-				}
-			}
-		}
+		view().applyColorKey(color);
 	}
 
 	void Image::downscale(Uint new_width, Uint new_height)
@@ -165,113 +190,54 @@ namespace rengine
 			return;
 		}
 
-		Uchar* scaled = new Uchar[new_width * new_height * color_channels];
-		if (scaled)
-		{
-			for (Uint iterator_x = 0; iterator_x != new_width; ++iterator_x)
-			{
-				Int x = (Int) (iterator_x * (Real(width) / Real(new_width)) + 0.5f);
+		resize(new_width, new_height);
+	}
 
-				for (Uint iterator_y = 0; iterator_y != new_height; ++iterator_y)
-				{
-					Int y = (Int) (iterator_y * (Real(height) / Real(new_height)) + 0.5f);
+	void Image::resize(Uint const new_width, Uint const new_height)
+	{
+		MitchellFilter filter;
+		resize(new_width, new_height, filter);
+	}
 
-					memcpy(&scaled[(iterator_y * new_width + iterator_x) * color_channels],
-						   &data[(y * width + x) * color_channels],
-						   color_channels);
-				}
+	void Image::resize(Uint const new_width, Uint const new_height, Filter const& filter)
+	{
+		if (!isLoaded() || ((new_width == width) && (new_height == height)))
+		{
+			return;
+		}
 
-			}
+		Uchar* scaled = new Uchar[new_width * new_height * color_channels];
 
-			delete[](data);
-			data = scaled;
+		ImageResampler resampler(filter);
+		resampler.resample(data, width, height, scaled, new_width, new_height, color_channels);
 
-			width = new_width;
-			height = new_height;
-		}
+		delete[](data);
+		data = scaled;
+
+		width = new_width;
+		height = new_height;
 	}
 
 	void Image::crop(Uint const x, Uint const y, Uint const crop_width, Uint const crop_height)
 	{
-		Uchar* croped = new Uchar[crop_height * crop_width * color_channels];
-
-		for (Uint iterator_x = 0; iterator_x != crop_width; ++iterator_x)
+		ImageView const region = view(x, y, crop_width, crop_height);
+		if (!region.isValid())
 		{
-			for (Uint iterator_y = 0; iterator_y != crop_height; ++iterator_y)
-			{
-				memcpy( &croped[ (iterator_y * crop_width + iterator_x) * color_channels ] ,
-						&data[ (iterator_y * width + iterator_x) * color_channels],
-						color_channels);
-			}
+			return;
 		}
 
+		Uchar* croped = new Uchar[region.getWidth() * region.getHeight() * color_channels];
+		region.copyTo(ImageView(croped, region.getWidth(), region.getHeight(), color_channels));
+
 		delete[] data;
 		data = croped;
 
-		width = crop_width;
-		height = crop_height;
+		width = region.getWidth();
+		height = region.getHeight();
 	}
 
 	void Image::flip(FlipMode mode)
 	{
-		if (isLoaded())
-		{
-			if (mode == FlipVertical)
-			{
-				Uint half_height = Uint( floor( Real(height) / 2.0f ) );
-
-				Uint line_size = width * color_channels;
-				Uchar *line = new Uchar[width * color_channels];
-				Uchar *origin = 0;
-				Uchar *destination = 0;
-
-				for (Uint iterator_y = 0; iterator_y != half_height; ++iterator_y)
-				{
-					destination = line;
-					origin = &data[iterator_y * width * color_channels];
-					memcpy(destination, origin, line_size);
-
-					destination = &data[iterator_y * width * color_channels];
-					origin = &data[(height - iterator_y - 1) * width * color_channels];
-					memcpy(destination, origin, line_size);
-
-					destination = &data[(height - iterator_y - 1) * width * color_channels];
-					origin = line;
-					memcpy(destination, origin, line_size);
-
-				}
-
-				delete[](line);
-			}
-			else
-			{
-				Uchar *pixel_color = new Uchar[color_channels];
-				Uint half_width = Uint( floor( Real(width) / 2.0f ) );
-
-				//			Uint line_size = width * color_channels;
-				Uchar *origin = 0;
-				Uchar *destination = 0;
-
-				for (Uint iterator_y = 0; iterator_y != height; ++iterator_y)
-				{
-					for (Uint iterator_x = 0; iterator_x != half_width; ++iterator_x)
-					{
-						destination = pixel_color;
-						origin = &data[(iterator_y * width + iterator_x) * color_channels];
-						memcpy(destination, origin, color_channels);
-
-						destination = &data[(iterator_y * width + iterator_x) * color_channels];
-						origin = &data[(iterator_y * width + (width - iterator_x - 1)) * color_channels];
-						memcpy(destination, origin, color_channels);
-
-						destination = &data[(iterator_y * width + (width - iterator_x - 1)) * color_channels];
-						origin = pixel_color;
-						memcpy(destination, origin, color_channels);
-					}
-				}
-
-				delete[](pixel_color);
-			}
-		}
+		view().flip(ImageView::FlipMode(mode));
 	}
 } //namespace rengine
@@ -0,0 +1,388 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/image/ImageResampler.h>
+#include <rengine/thread/ParallelFor.h>
+#include <rengine/math/Math.h>
+
+#include <cmath>
+#include <cstring>
+
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+	#include <emmintrin.h>
+#endif
+
+namespace rengine
+{
+	//
+	// Pixels are held as 4 float lanes, unused channels are kept at zero
+	//
+	static Uint const lanes = 4;
+
+	static RENGINE_INLINE void expandRow(Uchar const* source, Uint const width, Uint const color_channels, Real* destination)
+	{
+		if (color_channels == lanes)
+		{
+			for (Uint i = 0; i != width * lanes; ++i)
+			{
+				destination[i] = Real(source[i]);
+			}
+		}
+		else
+		{
+			for (Uint x = 0; x != width; ++x)
+			{
+				Real* pixel = destination + x * lanes;
+				pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0.0f;
+
+				for (Uint channel = 0; channel != color_channels; ++channel)
+				{
+					pixel[channel] = Real(source[x * color_channels + channel]);
+				}
+			}
+		}
+	}
+
+	static RENGINE_INLINE void packRow(Real const* source, Uint const width, Uint const color_channels, Uchar* destination)
+	{
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+		__m128i const zero = _mm_setzero_si128();
+
+		for (Uint x = 0; x != width; ++x)
+		{
+			__m128i value = _mm_cvtps_epi32(_mm_loadu_ps(source + x * lanes));
+			value = _mm_packs_epi32(value, zero);
+			value = _mm_packus_epi16(value, zero);
+
+			Uint32 packed = Uint32(_mm_cvtsi128_si32(value));
+
+			if (color_channels == lanes)
+			{
+				memcpy(destination + x * lanes, &packed, lanes);
+			}
+			else
+			{
+				Uchar const* bytes = (Uchar const*) &packed;
+				for (Uint channel = 0; channel != color_channels; ++channel)
+				{
+					destination[x * color_channels + channel] = bytes[channel];
+				}
+			}
+		}
+#else
+		for (Uint x = 0; x != width; ++x)
+		{
+			for (Uint channel = 0; channel != color_channels; ++channel)
+			{
+				Real const value = clampTo(source[x * lanes + channel] + 0.5f, 0.0f, 255.0f);
+				destination[x * color_channels + channel] = Uchar(value);
+			}
+		}
+#endif
+	}
+
+	static RENGINE_INLINE void zeroRow(Real* row, Uint const width)
+	{
+		memset(row, 0, sizeof(Real) * width * lanes);
+	}
+
+	// destination[x] = sum(source[first(x) + tap] * weight(x, tap))
+	static RENGINE_INLINE void filterRow(Real const* source, ImageResampler::Contributions const& contributions, Real* destination)
+	{
+		for (Uint x = 0; x != contributions.size(); ++x)
+		{
+			Real const* weights = contributions.weights(x);
+			Real const* pixel = source + contributions.first(x) * lanes;
+			Uint const count = contributions.count(x);
+
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+			__m128 accumulator = _mm_setzero_ps();
+			for (Uint tap = 0; tap != count; ++tap)
+			{
+				accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(pixel + tap * lanes), _mm_set1_ps(weights[tap])));
+			}
+			_mm_storeu_ps(destination + x * lanes, accumulator);
+#else
+			Real accumulator[lanes] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (Uint tap = 0; tap != count; ++tap)
+			{
+				for (Uint lane = 0; lane != lanes; ++lane)
+				{
+					accumulator[lane] += pixel[tap * lanes + lane] * weights[tap];
+				}
+			}
+			memcpy(destination + x * lanes, accumulator, sizeof(accumulator));
+#endif
+		}
+	}
+
+	// destination += source * weight
+	static RENGINE_INLINE void accumulateRow(Real const* source, Real const weight, Uint const width, Real* destination)
+	{
+		Uint const elements = width * lanes;
+
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+		__m128 const scale = _mm_set1_ps(weight);
+		for (Uint i = 0; i != elements; i += lanes)
+		{
+			_mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), scale)));
+		}
+#else
+		for (Uint i = 0; i != elements; ++i)
+		{
+			destination[i] += source[i] * weight;
+		}
+#endif
+	}
+
+	//
+	// Horizontal pass, source rows into the intermediate buffer
+	// the source is either 8 bit pixels or 4 float lanes per pixel
+	//
+	class HorizontalResamplePass : public ParallelRange
+	{
+	public:
+		HorizontalResamplePass(Uchar const* source, Uint const source_stride, Real const* source_lanes, Uint const source_width, Uint const color_channels,
+							   ImageResampler::Contributions const& contributions, Real* intermediate)
+			:source_(source), source_stride_(source_stride), source_lanes_(source_lanes), source_width_(source_width), color_channels_(color_channels),
+			 contributions_(contributions), intermediate_(intermediate)
+		{}
+
+		virtual void operator()(Uint const begin, Uint const end)
+		{
+			std::vector<Real> row;
+			if (!source_lanes_)
+			{
+				row.resize(source_width_ * lanes);
+			}
+
+			Uint const destination_width = contributions_.size();
+
+			for (Uint y = begin; y != end; ++y)
+			{
+				Real const* source_row = 0;
+
+				if (source_lanes_)
+				{
+					source_row = source_lanes_ + y * source_width_ * lanes;
+				}
+				else
+				{
+					expandRow(source_ + y * source_stride_, source_width_, color_channels_, &row[0]);
+					source_row = &row[0];
+				}
+
+				filterRow(source_row, contributions_, intermediate_ + y * destination_width * lanes);
+			}
+		}
+
+	private:
+		Uchar const* source_;
+		Uint source_stride_;
+		Real const* source_lanes_;
+		Uint source_width_;
+		Uint color_channels_;
+		ImageResampler::Contributions const& contributions_;
+		Real* intermediate_;
+	};
+
+	//
+	// Vertical pass, intermediate rows into the destination
+	// the destination is either 8 bit pixels or 4 float lanes per pixel
+	//
+	class VerticalResamplePass : public ParallelRange
+	{
+	public:
+		VerticalResamplePass(Real const* intermediate, Uint const width, Uint const color_channels,
+							 ImageResampler::Contributions const& contributions, Uchar* destination, Uint const destination_stride, Real* destination_lanes)
+			:intermediate_(intermediate), width_(width), color_channels_(color_channels),
+			 contributions_(contributions), destination_(destination), destination_stride_(destination_stride), destination_lanes_(destination_lanes)
+		{}
+
+		virtual void operator()(Uint const begin, Uint const end)
+		{
+			std::vector<Real> row;
+			if (!destination_lanes_)
+			{
+				row.resize(width_ * lanes);
+			}
+
+			for (Uint y = begin; y != end; ++y)
+			{
+				Real* destination_row = destination_lanes_ ? (destination_lanes_ + y * width_ * lanes) : &row[0];
+				zeroRow(destination_row, width_);
+
+				Real const* weights = contributions_.weights(y);
+				Uint const first = contributions_.first(y);
+				Uint const count = contributions_.count(y);
+
+				for (Uint tap = 0; tap != count; ++tap)
+				{
+					accumulateRow(intermediate_ + (first + tap) * width_ * lanes, weights[tap], width_, destination_row);
+				}
+
+				if (!destination_lanes_)
+				{
+					packRow(destination_row, width_, color_channels_, destination_ + y * destination_stride_);
+				}
+			}
+		}
+
+	private:
+		Real const* intermediate_;
+		Uint width_;
+		Uint color_channels_;
+		ImageResampler::Contributions const& contributions_;
+		Uchar* destination_;
+		Uint destination_stride_;
+		Real* destination_lanes_;
+	};
+
+	//
+	// Contributions
+	//
+	ImageResampler::Contributions::Contributions()
+		:taps_(0)
+	{}
+
+	void ImageResampler::Contributions::build(Filter const& filter, Uint const source_size, Uint const destination_size, Uint const samples)
+	{
+		Real const scale = Real(destination_size) / Real(source_size);
+		Real const filter_scale = (scale < 1.0f) ? (1.0f / scale) : 1.0f;
+		Real const support = filter.width() * filter_scale;
+
+		taps_ = Uint(std::ceil(support * 2.0f)) + 2;
+
+		first_.assign(destination_size, 0);
+		count_.assign(destination_size, 0);
+		weights_.assign(destination_size * taps_, 0.0f);
+
+		Int const last_source = Int(source_size) - 1;
+
+		for (Uint i = 0; i != destination_size; ++i)
+		{
+			// pixel centers sit at half integers on both grids
+			Real const center = (Real(i) + 0.5f) / scale;
+
+			Int const left = Int(std::floor(center - support));
+			Int const right = Int(std::ceil(center + support));
+
+			Int const first = clampTo(left, 0, last_source);
+			Int const last = clampTo(right - 1, 0, last_source);
+			Uint const count = minimum(Uint(last - first + 1), taps_);
+
+			Real* weights = &weights_[i * taps_];
+			Real sum = 0.0f;
+
+			for (Int j = left; j != right; ++j)
+			{
+				Real const x0 = (Real(j) - center) / filter_scale;
+				Real const x1 = (Real(j + 1) - center) / filter_scale;
+				Real const weight = filter.sampleBox(x0, x1, samples);
+
+				// edge pixels are repeated outside the image
+				Uint const tap = Uint(clampTo(j, first, first + Int(count) - 1) - first);
+				weights[tap] += weight;
+				sum += weight;
+			}
+
+			if (absolute(sum) > 1e-6f)
+			{
+				for (Uint tap = 0; tap != count; ++tap)
+				{
+					weights[tap] /= sum;
+				}
+
+				first_[i] = Uint(first);
+				count_[i] = count;
+			}
+			else
+			{
+				// filter has no support at this phase, fall back to the nearest pixel
+				memset(weights, 0, sizeof(Real) * taps_);
+				weights[0] = 1.0f;
+
+				first_[i] = Uint(clampTo(Int(center), 0, last_source));
+				count_[i] = 1;
+			}
+		}
+	}
+
+	//
+	// ImageResampler
+	//
+	ImageResampler::ImageResampler(Filter const& filter, Uint const samples)
+		:filter_(filter), samples_(maximum(samples, Uint(2))), threads_(0)
+	{}
+
+	ImageResampler::~ImageResampler()
+	{}
+
+	void ImageResampler::resample(Uchar const* source, Uint const source_width, Uint const source_height,
+								  Uchar* destination, Uint const destination_width, Uint const destination_height,
+								  Uint const color_channels) const
+	{
+		resample(ImageView((Uchar*) source, source_width, source_height, color_channels),
+				 ImageView(destination, destination_width, destination_height, color_channels));
+	}
+
+	void ImageResampler::resample(ImageView const& source, ImageView const& destination) const
+	{
+		Uint const color_channels = source.getColorChannels();
+
+		if (!source.isValid() || !destination.isValid() || (color_channels > lanes) || (destination.getColorChannels() != color_channels))
+		{
+			return;
+		}
+
+		run(source.getData(), source.getRowStride(), 0, source.getWidth(), source.getHeight(),
+			destination.getData(), destination.getRowStride(), 0, destination.getWidth(), destination.getHeight(),
+			color_channels);
+	}
+
+	void ImageResampler::resample(Real const* source, Uint const source_width, Uint const source_height,
+								  Real* destination, Uint const destination_width, Uint const destination_height) const
+	{
+		run(0, 0, source, source_width, source_height, 0, 0, destination, destination_width, destination_height, lanes);
+	}
+
+	void ImageResampler::run(Uchar const* source, Uint const source_stride, Real const* source_lanes, Uint const source_width, Uint const source_height,
+							 Uchar* destination, Uint const destination_stride, Real* destination_lanes, Uint const destination_width, Uint const destination_height,
+							 Uint const color_channels) const
+	{
+		if ((source_width == 0) || (source_height == 0) || (destination_width == 0) || (destination_height == 0))
+		{
+			return;
+		}
+
+		Contributions horizontal;
+		horizontal.build(filter_, source_width, destination_width, samples_);
+
+		Contributions vertical;
+		vertical.build(filter_, source_height, destination_height, samples_);
+
+		std::vector<Real> intermediate(destination_width * source_height * lanes);
+
+		// keep blocks large enough to pay for the thread start
+		Uint const minimum_block = maximum(Uint(1), Uint(16384 / maximum(destination_width, Uint(1))));
+
+		HorizontalResamplePass horizontal_pass(source, source_stride, source_lanes, source_width, color_channels, horizontal, &intermediate[0]);
+		parallelFor(horizontal_pass, source_height, threads_, minimum_block);
+
+		VerticalResamplePass vertical_pass(&intermediate[0], destination_width, color_channels, vertical, destination, destination_stride, destination_lanes);
+		parallelFor(vertical_pass, destination_height, threads_, minimum_block);
+	}
+
+	SharedPointer<Image> ImageResampler::resample(Image const& image, Uint const width, Uint const height) const
+	{
+		SharedPointer<Image> resampled;
+
+		if (image.isLoaded())
+		{
+			resampled = new Image(width, height, image.getColorChannels());
+			resample(image.view(), resampled->view());
+		}
+
+		return resampled;
+	}
+
+} // namespace rengine
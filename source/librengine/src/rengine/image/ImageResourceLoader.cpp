@@ -5,6 +5,8 @@
 
 #include <rengine/image/ImageResourceLoader.h>
 #include <rengine/image/stb_image.h>
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/resource/AssetPack.h>
 
 #include <cstring>
 
@@ -23,14 +25,63 @@ namespace rengine
 		return can_load;
 	}
 
+	Bool ImageResourceLoader::supportsConcurrentLoads() const
+	{
+		return true;
+	}
+
+	Uint64 ImageResourceLoader::resourceSize(Image const& image) const
+	{
+		return Uint64(image.getWidth()) * Uint64(image.getHeight()) * Uint64(image.getColorChannels());
+	}
+
+	Bool ImageResourceLoader::assign(Image& image, Image& reloaded)
+	{
+		image.createImage(reloaded.getWidth(), reloaded.getHeight(), reloaded.getColorChannels());
+		memcpy(image.getData(), reloaded.getData(), resourceSize(reloaded));
+		return true;
+	}
+
 	SharedPointer<Image> ImageResourceLoader::loadImplementation(std::string const& location, OpaqueProperties const& options)
 	{
 		SharedPointer<Image> image;
 
+		FileData file_data;
+		if (fileSystem().read(location, file_data) && file_data.size)
+		{
+			image = decode(file_data);
+		}
+
+		return image;
+	}
+
+	SharedPointer<Image> ImageResourceLoader::decode(FileData const& file_data)
+	{
+		SharedPointer<Image> image;
+
+		AssetPack::CookedImage cooked;
+		if (AssetPack::decodeImage(file_data, cooked))
+		{
+			image = cooked.image;
+
+			// cooked images are stored the way OpenGL wants them
+			if (cooked.flags & AssetPack::ImageFlipped)
+			{
+				image->flip(Image::FlipVertical);
+			}
+
+			return image;
+		}
+
 		Int width = 0;
 		Int height = 0;
 		Int color_channels = 0;
-		Uchar* data = stbi_load(location.c_str(), &width, &height, &color_channels, 0);
+		Uchar* data = 0;
+
+		if (file_data.size)
+		{
+			data = stbi_load_from_memory(file_data.bytes(), Int(file_data.size), &width, &height, &color_channels, 0);
+		}
 
 //		if (data)
 //		{
@@ -63,17 +114,82 @@ namespace rengine
 		return image_loader.suportsFormat(extension);
 	}
 
+	Bool Texture2DResourceLoader::supportsConcurrentLoads() const
+	{
+		return true;
+	}
+
+	Uint64 Texture2DResourceLoader::resourceSize(Texture2D const& texture) const
+	{
+		return texture.memorySize();
+	}
+
+	Bool Texture2DResourceLoader::assign(Texture2D& texture, Texture2D& reloaded)
+	{
+		// uploaded again by finalize
+		texture.setFlags(reloaded.getFlags());
+		texture.setFilter(reloaded.getMinFilter(), reloaded.getMagFilter());
+		texture.setWrap(reloaded.getWrapS(), reloaded.getWrapT());
+		texture.setImage(reloaded.getImage());
+
+		if (reloaded.getMipmaps())
+		{
+			texture.setMipmaps(reloaded.getMipmaps());
+		}
+
+		return true;
+	}
+
+	void Texture2DResourceLoader::finalize(Texture2D& texture)
+	{
+		CoreEngine::instance()->renderEngine().prepare(texture);
+	}
+
 	SharedPointer<Texture2D> Texture2DResourceLoader::loadImplementation(std::string const& location, OpaqueProperties const& options)
 	{
 		SharedPointer<Texture2D> texture;
 
-		ImageResourceLoader image_loader;
-		SharedPointer<Image> image = image_loader.load(location, options);
+		FileData file_data;
+		if (!fileSystem().read(location, file_data) || !file_data.size)
+		{
+			return texture;
+		}
 
+		Bool const rescale = !CoreEngine::instance()->renderEngine().supportsNonPowerOfTwoTextures();
+
+		SharedPointer<Image> image;
+		SharedPointer<MipmapChain> mipmaps;
+
+		// cooked pixels are uploaded straight from the pack, only copied when they need changes
+		AssetPack::CookedImage cooked;
+		if (AssetPack::decodeImage(file_data, cooked, true))
+		{
+			image = cooked.image;
+			mipmaps = cooked.mipmaps;
+
+			Bool const flip = !(cooked.flags & AssetPack::ImageFlipped);
+			// the cooked chain only fits the cooked size
+			Bool const resize = rescale && !(cooked.flags & AssetPack::ImagePowerOfTwo);
+
+			if (flip || resize)
+			{
+				image = new Image(cooked.image->view());
+				image->makeOpenGlCompliant(flip, resize);
+				mipmaps = 0;
+			}
+		}
+		else
+		{
+			image = ImageResourceLoader::decode(file_data);
+
+			if (image)
+			{
+				image->makeOpenGlCompliant(true, rescale);
+			}
+		}
 
 		if (image)
 		{
-			image->makeOpenGlCompliant(true, !CoreEngine::instance()->renderEngine().supportsNonPowerOfTwoTextures());
 
 			texture = new Texture2D();
 
@@ -96,6 +212,23 @@ namespace rengine
 			}
 
 			texture->setImage(image);
+
+			// build the mipmap chain at load time, off the render thread
+			if (options.hasProperty("generate_mipmap") && any_cast<Bool>(options["generate_mipmap"].value))
+			{
+				Bool const asynchronous = options.hasProperty("async_mipmap") && any_cast<Bool>(options["async_mipmap"].value);
+
+				texture->setFlags(texture->getFlags() | Texture2D::GenerateMipmap | (asynchronous ? Texture2D::GenerateMipmapAsync : Texture2D::None));
+
+				if (mipmaps)
+				{
+					texture->setMipmaps(mipmaps);
+				}
+				else
+				{
+					texture->buildMipmaps(asynchronous);
+				}
+			}
 		}
 
 		return texture;
@@ -0,0 +1,159 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/image/ImageView.h>
+#include <rengine/math/Math.h>
+
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+namespace rengine
+{
+	ImageView ImageView::subView(Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		if ((x >= width_) || (y >= height_))
+		{
+			return ImageView();
+		}
+
+		Uint const clipped_width = minimum(width, width_ - x);
+		Uint const clipped_height = minimum(height, height_ - y);
+
+		return ImageView(rawPixel(x, y), clipped_width, clipped_height, color_channels_, row_stride_);
+	}
+
+	void ImageView::flip(FlipMode const mode) const
+	{
+		if (!isValid())
+		{
+			return;
+		}
+
+		Uint const line_size = width_ * color_channels_;
+
+		if (mode == FlipVertical)
+		{
+			std::vector<Uchar> line(line_size);
+
+			for (Uint top = 0, bottom = height_ - 1; top < bottom; ++top, --bottom)
+			{
+				memcpy(&line[0], row(top), line_size);
+				memcpy(row(top), row(bottom), line_size);
+				memcpy(row(bottom), &line[0], line_size);
+			}
+		}
+		else
+		{
+			for (Uint y = 0; y != height_; ++y)
+			{
+				Uchar* left = row(y);
+				Uchar* right = row(y) + line_size - color_channels_;
+
+				for (; left < right; left += color_channels_, right -= color_channels_)
+				{
+					std::swap_ranges(left, left + color_channels_, right);
+				}
+			}
+		}
+	}
+
+	void ImageView::applyColorKey(Color const& color) const
+	{
+		if (!isValid() || (color_channels_ != 4))
+		{
+			return;
+		}
+
+		for (Uint y = 0; y != height_; ++y)
+		{
+			Uchar* pixel = row(y);
+			Uchar* const end = pixel + width_ * 4;
+
+			for (; pixel != end; pixel += 4)
+			{
+				if ((pixel[0] == color.r()) && (pixel[1] == color.g()) && (pixel[2] == color.b()))
+				{
+					pixel[3] = color.a();
+				}
+			}
+		}
+	}
+
+	void ImageView::fill(Uchar const value) const
+	{
+		if (!isValid())
+		{
+			return;
+		}
+
+		if (isContiguous())
+		{
+			memset(data_, value, row_stride_ * height_);
+		}
+		else
+		{
+			for (Uint y = 0; y != height_; ++y)
+			{
+				memset(row(y), value, width_ * color_channels_);
+			}
+		}
+	}
+
+	void ImageView::copyTo(ImageView const& destination) const
+	{
+		if (!isValid() || !destination.isValid())
+		{
+			return;
+		}
+
+		Uint const width = minimum(width_, destination.width_);
+		Uint const height = minimum(height_, destination.height_);
+
+		Uint const source_channels = color_channels_;
+		Uint const destination_channels = destination.color_channels_;
+
+		if (source_channels == destination_channels)
+		{
+			Uint const line_size = width * source_channels;
+
+			if (isContiguous() && destination.isContiguous() && (width == width_) && (width == destination.width_))
+			{
+				memcpy(destination.data_, data_, line_size * height);
+			}
+			else
+			{
+				for (Uint y = 0; y != height; ++y)
+				{
+					memcpy(destination.row(y), row(y), line_size);
+				}
+			}
+			return;
+		}
+
+		// gray and gray alpha sources have their alpha in the second channel
+		Bool const source_gray = (source_channels <= 2);
+		Bool const source_alpha = (source_channels == 2) || (source_channels == 4);
+		Bool const destination_alpha = (destination_channels == 2) || (destination_channels == 4);
+		Uint const destination_colors = destination_alpha ? (destination_channels - 1) : destination_channels;
+
+		for (Uint y = 0; y != height; ++y)
+		{
+			Uchar const* in = row(y);
+			Uchar* out = destination.row(y);
+
+			for (Uint x = 0; x != width; ++x, in += source_channels, out += destination_channels)
+			{
+				for (Uint channel = 0; channel != destination_colors; ++channel)
+				{
+					out[channel] = source_gray ? in[0] : in[minimum(channel, Uint(2))];
+				}
+
+				if (destination_alpha)
+				{
+					out[destination_colors] = source_alpha ? in[source_channels - 1] : 255;
+				}
+			}
+		}
+	}
+
+} // namespace rengine
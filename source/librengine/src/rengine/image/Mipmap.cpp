@@ -0,0 +1,183 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/image/Mipmap.h>
+#include <rengine/image/ImageResampler.h>
+#include <rengine/math/Math.h>
+
+#include <cmath>
+
+namespace rengine
+{
+	//
+	// sRGB transfer tables
+	//
+	class SrgbTables
+	{
+	public:
+		static Uint const encode_size = 4096;
+
+		SrgbTables()
+		{
+			for (Uint i = 0; i != 256; ++i)
+			{
+				Real const value = Real(i) / 255.0f;
+				decode[i] = (value <= 0.04045f) ? (value / 12.92f) : Real(std::pow((value + 0.055f) / 1.055f, 2.4f));
+			}
+
+			for (Uint i = 0; i != encode_size; ++i)
+			{
+				Real const value = Real(i) / Real(encode_size - 1);
+				Real const srgb = (value <= 0.0031308f) ? (value * 12.92f) : Real(1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f);
+				encode[i] = Uchar(clampTo(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+			}
+		}
+
+		Real decode[256];
+		Uchar encode[encode_size];
+	};
+
+	static SrgbTables const srgb_tables;
+
+	static Uint const lanes = 4;
+
+	static RENGINE_INLINE Bool isGammaChannel(Uint const channel, Uint const color_channels, Bool const gamma_correct)
+	{
+		// only color channels of rgb and rgba images
+		return gamma_correct && (color_channels >= 3) && (channel < 3);
+	}
+
+	static void decodeLevel(Image const& image, Bool const gamma_correct, std::vector<Real>& pixels)
+	{
+		Uint const color_channels = image.getColorChannels();
+		Uint const size = image.getWidth() * image.getHeight();
+		Uchar const* data = image.getData();
+
+		pixels.assign(size * lanes, 0.0f);
+
+		for (Uint i = 0; i != size; ++i)
+		{
+			for (Uint channel = 0; channel != color_channels; ++channel)
+			{
+				Uchar const value = data[i * color_channels + channel];
+				pixels[i * lanes + channel] = isGammaChannel(channel, color_channels, gamma_correct) ? srgb_tables.decode[value] : (Real(value) / 255.0f);
+			}
+		}
+	}
+
+	static void encodeLevel(std::vector<Real> const& pixels, Bool const gamma_correct, Image& image)
+	{
+		Uint const color_channels = image.getColorChannels();
+		Uint const size = image.getWidth() * image.getHeight();
+		Uchar* data = image.getData();
+
+		for (Uint i = 0; i != size; ++i)
+		{
+			for (Uint channel = 0; channel != color_channels; ++channel)
+			{
+				Real const value = clampTo(pixels[i * lanes + channel], 0.0f, 1.0f);
+
+				if (isGammaChannel(channel, color_channels, gamma_correct))
+				{
+					data[i * color_channels + channel] = srgb_tables.encode[Uint(value * Real(SrgbTables::encode_size - 1) + 0.5f)];
+				}
+				else
+				{
+					data[i * color_channels + channel] = Uchar(value * 255.0f + 0.5f);
+				}
+			}
+		}
+	}
+
+	//
+	// MipmapChain
+	//
+	MipmapChain::MipmapChain()
+	{}
+
+	MipmapChain::~MipmapChain()
+	{}
+
+	Uint MipmapChain::numberOfLevels(Uint const width, Uint const height)
+	{
+		Uint levels = 1;
+		Uint size = maximum(width, height);
+
+		while (size > 1)
+		{
+			size /= 2;
+			++levels;
+		}
+
+		return levels;
+	}
+
+	void MipmapChain::build(SharedPointer<Image> const& base, Filter const& filter, Bool const gamma_correct)
+	{
+		levels_.clear();
+
+		if (!base || !base->isLoaded() || (base->getColorChannels() > lanes))
+		{
+			return;
+		}
+
+		levels_.push_back(base);
+
+		Uint const color_channels = base->getColorChannels();
+		Uint width = base->getWidth();
+		Uint height = base->getHeight();
+
+		ImageResampler resampler(filter);
+
+		std::vector<Real> current;
+		std::vector<Real> next;
+		decodeLevel(*base, gamma_correct, current);
+
+		Uint const levels = numberOfLevels(width, height);
+		for (Uint level = 1; level != levels; ++level)
+		{
+			Uint const next_width = maximum(width / 2, Uint(1));
+			Uint const next_height = maximum(height / 2, Uint(1));
+
+			next.resize(next_width * next_height * lanes);
+			resampler.resample(&current[0], width, height, &next[0], next_width, next_height);
+
+			SharedPointer<Image> image = new Image(next_width, next_height, color_channels);
+			encodeLevel(next, gamma_correct, *image);
+			levels_.push_back(image);
+
+			current.swap(next);
+			width = next_width;
+			height = next_height;
+		}
+	}
+
+	//
+	// MipmapBuilder
+	//
+	MipmapBuilder::MipmapBuilder(SharedPointer<Image> const& base, SharedPointer<Filter> const& filter, Bool const gamma_correct)
+		:base_(base), filter_(filter), gamma_correct_(gamma_correct), chain_(new MipmapChain()), finished_(0)
+	{
+		if (!filter_)
+		{
+			filter_ = new BoxFilter();
+		}
+	}
+
+	MipmapBuilder::~MipmapBuilder()
+	{
+		stop();
+	}
+
+	void MipmapBuilder::run()
+	{
+		chain_->build(base_, *filter_, gamma_correct_);
+		base_ = 0;
+		finished_ = 1;
+	}
+
+	Bool MipmapBuilder::finished() const
+	{
+		return (Int64(finished_) != 0);
+	}
+
+} // namespace rengine
@@ -7,6 +7,7 @@
 #include <rengine/resource/ResourceManager.h>
 #include <rengine/util/StringTable.h>
 #include <rengine/state/Program.h>
+#include <rengine/state/RenderTargetPool.h>
 #include <rengine/string/String.h>
 
 namespace rengine
@@ -68,10 +69,60 @@ namespace rengine
 		return initialized_;
 	}
 
+	// glsl type of a uniform
+	static std::string glslType(Uniform::Type const type)
+	{
+		switch (type)
+		{
+			case Uniform::FloatVec2Uniform: return "vec2";
+			case Uniform::FloatVec3Uniform: return "vec3";
+			case Uniform::FloatVec4Uniform: return "vec4";
+			case Uniform::IntUniform: return "int";
+			case Uniform::IntVec2Uniform: return "ivec2";
+			case Uniform::IntVec3Uniform: return "ivec3";
+			case Uniform::IntVec4Uniform: return "ivec4";
+			case Uniform::Mat4x4Uniform: return "mat4";
+			default: return "float";
+		}
+	}
+
+	static void setUniform(Uniform& target, Uniform& source)
+	{
+		switch (source.type())
+		{
+			case Uniform::FloatUniform: target.set(*((Real*) source.data())); break;
+			case Uniform::FloatVec2Uniform: target.set(*((Vector2D*) source.data())); break;
+			case Uniform::FloatVec3Uniform: target.set(*((Vector3D*) source.data())); break;
+			case Uniform::FloatVec4Uniform: target.set(*((Vector4D*) source.data())); break;
+			case Uniform::IntUniform: target.set(*((Int*) source.data())); break;
+			case Uniform::IntVec2Uniform: target.set(*((Vector2Di*) source.data())); break;
+			case Uniform::IntVec3Uniform: target.set(*((Vector3Di*) source.data())); break;
+			case Uniform::IntVec4Uniform: target.set(*((Vector4Di*) source.data())); break;
+			case Uniform::Mat4x4Uniform: target.set(*((Matrix44*) source.data())); break;
+		}
+	}
+
 	void ImageProcessor::operator()(RenderEngine& render_engine)
 	{
 		if (initialized_)
 		{
+			// parameters may change after the program is built
+			Program::Uniforms uniforms;
+			pointOperationUniforms(uniforms);
+
+			if (!uniforms.empty() && quadrilateral_->states()->hasProgram())
+			{
+				Program& program = *quadrilateral_->states()->getProgram();
+				for (Program::Uniforms::iterator i = uniforms.begin(); i != uniforms.end(); ++i)
+				{
+					// unused uniforms are dropped by the glsl compiler
+					if (program.hasUniform((*i)->name()) && (program.uniform((*i)->name()).type() == (*i)->type()))
+					{
+						setUniform(program.uniform((*i)->name()), **i);
+					}
+				}
+			}
+
 			render_engine.draw(*quadrilateral_);
 		}
 	}
@@ -86,27 +137,50 @@ namespace rengine
 	}
 
 	ProcessingChain::ProcessingChain()
+		:backend_(GpuBackend), threads_(0), fusion_(true)
 	{
 
 	}
 
-	static Bool usePing(Bool const& as_input, Int const& stage, Int const& total_stages)
+	void ProcessingChain::buildPasses()
 	{
-		Bool use_ping = true;
+		passes_.clear();
 
-		Bool size_even = ( (total_stages % 2) == 0 );
-		Bool stage_even = ( (stage % 2) == 0 );
-
-		if (as_input)
+		ProcessingStages::size_type stage = 0;
+		while (stage != stages_.size())
 		{
-			use_ping = (size_even != stage_even);
+			ProcessingStages::size_type last = stage + 1;
+
+			if (fusion_ && stages_[stage]->isPointOperation())
+			{
+				while ((last != stages_.size()) && stages_[last]->isPointOperation())
+				{
+					++last;
+				}
+			}
+
+			if ((last - stage) > 1)
+			{
+				passes_.push_back(new FusedImageProcessor(ProcessingStages(stages_.begin() + stage, stages_.begin() + last)));
+			}
+			else
+			{
+				passes_.push_back(stages_[stage]);
+			}
+
+			stage = last;
 		}
-		else
+	}
+
+	static void connect(ImageProcessor& processor, SharedPointer<Texture2D> const& texture)
+	{
+		processor.inputs().clear();
+		processor.addInput(texture);
+
+		if (processor.quadrilateral())
 		{
-			use_ping = (size_even == stage_even);
+			processor.quadrilateral()->states()->setTexture(0, texture);
 		}
-
-		return use_ping;
 	}
 
 	bool ProcessingChain::initialize()
@@ -116,7 +190,7 @@ namespace rengine
 			return initialized_;
 		}
 
-		if (inputs_.size() == 0 || outputs_.size() == 0)
+		if (inputs_.size() == 0 || outputs_.size() == 0 || stages_.size() == 0)
 		{
 			return initialized_;
 		}
@@ -135,86 +209,46 @@ namespace rengine
 		float x = 0.0f;
 		float y = 0.0f;
 
-		ping_ = new FrameBuffer(width, height);
+		output_buffer_ = new FrameBuffer(width, height);
+		output_buffer_->attach(outputs_[0]);
+
+		buildPasses();
 
-		if (stages_.size() == 1)
+		Bool no_error = true;
+		for (ProcessingStages::size_type pass = 0; (pass != passes_.size()) && no_error; ++pass)
 		{
 			SharedPointer<Quadrilateral> quad_ = new Quadrilateral();
 			quad_->setCornersVertex(Vector3D(x, y, 0.0f), Vector3D(width, height, 0.0f));
 			quad_->setCornersTextureCoordinates(Vector2D(0.0f, 0.0f), Vector2D(1.0f, 1.0f));
+			passes_[pass]->setQuadrilateral(quad_);
 
-			for (Connections::size_type i = 0; i != inputs_.size(); ++i)
-			{
-				stages_[0]->addInput(inputs_[i]);
-				quad_->states()->setTexture(inputs_[i]);
-			}
+			//
+			// Intermediate textures are only known when drawing,
+			// the chain input has the same size and is used to set up the pass
+			//
+			connect(*passes_[pass], inputs_[0]);
 
-			for (Connections::size_type i = 0; i != outputs_.size(); ++i)
+			if (pass == (passes_.size() - 1))
 			{
-				stages_[0]->addOutput(outputs_[i]);
-				ping_->attach(outputs_[i]);
+				passes_[pass]->addOutput(outputs_[0]);
 			}
 
-			stages_[0]->setQuadrilateral(quad_);
-			initialized_ = stages_[0]->initialize();
+			no_error &= passes_[pass]->initialize();
 		}
-		else
-		{
-			pong_ = new FrameBuffer(width, height);
-
-			SharedPointer<Texture2D> pong_texture_ = outputs_[0];
-			pong_->attach(pong_texture_);
 
-			ping_texture_ = new Texture2D(outputs_[0]->getInternalFormat());
-			ping_->attach(ping_texture_);
-
-			Bool no_error = true;
-			for (ProcessingStages::size_type stage = 0; (stage != stages_.size()) && no_error; ++ stage)
-			{
-				SharedPointer<Quadrilateral> quad_ = new Quadrilateral();
-				quad_->setCornersVertex(Vector3D(x, y, 0.0f), Vector3D(width, height, 0.0f));
-				quad_->setCornersTextureCoordinates(Vector2D(0.0f, 0.0f), Vector2D(1.0f, 1.0f));
-
-				//
-				// Connect inputs
-				//
-				if (stage == 0)
-				{
-					for (Connections::size_type i = 0; i != inputs_.size(); ++i)
-					{
-						stages_[stage]->addInput(inputs_[i]);
-						quad_->states()->setTexture(inputs_[i]);
-					}
-				}
-				else
-				{
-					SharedPointer<Texture2D> texture = usePing(true, stage, stages_.size()) ? ping_texture_ : pong_texture_;
-					quad_->states()->setTexture(texture);
-					stages_[stage]->addInput(texture);
-				}
-
-
-				//
-				// Connect Outputs
-				//
-				if (stage == (stages_.size() - 1))
-				{
-					stages_[stage]->addOutput(pong_texture_);
-				}
-
-
-				stages_[stage]->setQuadrilateral(quad_);
-				no_error &= stages_[stage]->initialize();
-			}
-
-			initialized_ = no_error;
-		}
+		initialized_ = no_error;
 
 		return initialized_;
 	}
 
 	void ProcessingChain::operator()(RenderEngine& render_engine)
 	{
+		if (backend_ == CpuBackend)
+		{
+			processOnCpu(render_engine);
+			return;
+		}
+
 		if (initialize())
 		{
 			Uint viewport_x = render_engine.getViewportX();
@@ -225,33 +259,40 @@ namespace rengine
 			render_engine.pushDrawStates();
 			render_engine.apply(states);
 
-			render_engine.setViewport(0, 0, ping_->width(), ping_->height());
+			render_engine.setViewport(0, 0, output_buffer_->width(), output_buffer_->height());
 
-			if (stages_.size() == 1)
+			//
+			// Intermediate passes ping pong between two pooled targets
+			//
+			RenderTargetPool& pool = CoreEngine::instance()->renderTargetPool();
+			RenderTargetPool::RenderTarget targets[2];
+
+			for (ProcessingStages::size_type target = 0; (target != 2) && (target + 1 < passes_.size()); ++target)
 			{
-				render_engine.bind(*ping_);
-				render_engine.clearBuffers();
+				targets[target] = pool.acquire(output_buffer_->width(), output_buffer_->height(), outputs_[0]->getInternalFormat());
+			}
 
-				(*stages_[0])(render_engine);
+			SharedPointer<Texture2D> source = inputs_[0];
+			for (ProcessingStages::size_type pass = 0; pass != passes_.size(); ++pass)
+			{
+				FrameBuffer& frame_buffer = (pass == (passes_.size() - 1)) ? *output_buffer_ : *targets[pass % 2].frame_buffer;
 
-				render_engine.unbind(*ping_);
+				connect(*passes_[pass], source);
 
-			}
-			else
-			{
-				for (ProcessingStages::size_type stage = 0; stage != stages_.size(); ++ stage)
-				{
-					Bool use_ping = usePing(false, stage, stages_.size());
+				render_engine.bind(frame_buffer);
+				render_engine.clearBuffers();
 
-					render_engine.bind(use_ping ? *ping_ : *pong_);
-					render_engine.clearBuffers();
+				(*passes_[pass])(render_engine);
 
-					(*stages_[stage])(render_engine);
+				render_engine.unbind(frame_buffer);
 
-					render_engine.unbind(use_ping ? *ping_ : *pong_);
-				}
+				source = targets[pass % 2].texture;
 			}
 
+			for (Uint target = 0; target != 2; ++target)
+			{
+				pool.release(targets[target]);
+			}
 
 			render_engine.popDrawStates();
 
@@ -260,69 +301,165 @@ namespace rengine
 	}
 
 	//
-	// ThresholdImageProcessor
+	// FusedImageProcessor
 	//
 
-	ThresholdImageProcessor::ThresholdImageProcessor()
-	: threshold_(0.5), value_(0.0f, 0.0f, 0.0f, 1.0f)
-	{}
-
-	ThresholdImageProcessor::ThresholdImageProcessor(Real const& threshold)
-	: threshold_(threshold), value_(0.0f, 0.0f, 0.0f, 1.0f)
+	FusedImageProcessor::FusedImageProcessor(ProcessingChain::ProcessingStages const& stages)
+	:stages_(stages)
 	{
 	}
 
-	bool ThresholdImageProcessor::initialize()
+	bool FusedImageProcessor::initialize()
 	{
 		if (initialized_)
 		{
 			return initialized_;
 		}
 
+		StringElement element;
+		shader_symbols_.clear();
 
-		if (ImageProcessor::initialize())
+		element.text = "\n" + pointOperation() + "\n";
+		shader_symbols_["point_operations"] = element;
+
+		Program::Uniforms uniforms;
+		pointOperationUniforms(uniforms);
+
+		element.text = "\n";
+		for (Program::Uniforms::const_iterator i = uniforms.begin(); i != uniforms.end(); ++i)
 		{
-			if (quadrilateral_->states()->hasProgram())
-			{
-				quadrilateral_->states()->getProgram()->uniform("threshold_value").set(value_);
-				quadrilateral_->states()->getProgram()->uniform("threshold").set(threshold_);
-			}
+			element.text += "uniform " + glslType((*i)->type()) + " " + (*i)->name() + ";\n";
 		}
+		shader_symbols_["point_uniforms"] = element;
 
-		return initialized_;
+		return ImageProcessor::initialize();
 	}
 
-	//
-	// BinarizationImageProcessor
-	//
-
-	BinarizationImageProcessor::BinarizationImageProcessor()
-	: threshold_(0.5)
-	{}
+	Bool FusedImageProcessor::isPointOperation() const
+	{
+		return true;
+	}
 
-	BinarizationImageProcessor::BinarizationImageProcessor(Real const& threshold)
-	: threshold_(threshold)
-	{}
+	// uniforms of each stage are prefixed by its position
+	static std::string stagePrefix(std::string const& prefix, Uint const stage)
+	{
+		return prefix + "stage" + lexical_cast<std::string>(stage) + "_";
+	}
 
-	bool BinarizationImageProcessor::initialize()
+	std::string FusedImageProcessor::pointOperation(std::string const& prefix) const
 	{
-		if (initialized_)
+		std::string operations;
+
+		for (ProcessingChain::ProcessingStages::size_type i = 0; i != stages_.size(); ++i)
 		{
-			return initialized_;
+			operations += "\t{\n\t\t" + stages_[i]->pointOperation(stagePrefix(prefix, Uint(i))) + "\n\t}\n";
 		}
 
+		return operations;
+	}
 
-		if (ImageProcessor::initialize())
+	void FusedImageProcessor::pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix) const
+	{
+		for (ProcessingChain::ProcessingStages::size_type i = 0; i != stages_.size(); ++i)
 		{
-			if (quadrilateral_->states()->hasProgram())
-			{
-				quadrilateral_->states()->getProgram()->uniform("threshold").set(threshold_);
-			}
+			stages_[i]->pointOperationUniforms(uniforms, stagePrefix(prefix, Uint(i)));
 		}
+	}
 
-		return initialized_;
+	//
+	// Point operations
+	//
+
+	Bool ImageProcessor::isPointOperation() const
+	{
+		return false;
+	}
+
+	std::string ImageProcessor::pointOperation(std::string const& prefix) const
+	{
+		return "";
+	}
+
+	void ImageProcessor::pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix) const
+	{
+	}
+
+	Bool CopyImageProcessor::isPointOperation() const
+	{
+		return true;
+	}
+
+	std::string CopyImageProcessor::pointOperation(std::string const& prefix) const
+	{
+		return "// copy";
+	}
+
+	Bool GrayscaleImageProcessor::isPointOperation() const
+	{
+		return true;
+	}
+
+	std::string GrayscaleImageProcessor::pointOperation(std::string const& prefix) const
+	{
+		return "color = vec4(vec3(luminance(color.rgb)), 1.0);";
+	}
+
+	Bool ThresholdImageProcessor::isPointOperation() const
+	{
+		return true;
+	}
+
+	std::string ThresholdImageProcessor::pointOperation(std::string const& prefix) const
+	{
+		return "if (color.r < " + prefix + "threshold) { color = " + prefix + "threshold_value; }";
+	}
+
+	void ThresholdImageProcessor::pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix) const
+	{
+		uniforms.push_back(new Uniform(prefix + "threshold", threshold_));
+		uniforms.push_back(new Uniform(prefix + "threshold_value", value_));
+	}
+
+	Bool BinarizationImageProcessor::isPointOperation() const
+	{
+		return true;
+	}
+
+	std::string BinarizationImageProcessor::pointOperation(std::string const& prefix) const
+	{
+		return "color.rgb = (color.r < " + prefix + "threshold) ? vec3(0.0) : vec3(1.0);";
+	}
+
+	void BinarizationImageProcessor::pointOperationUniforms(Program::Uniforms& uniforms, std::string const& prefix) const
+	{
+		uniforms.push_back(new Uniform(prefix + "threshold", threshold_));
 	}
 
+	//
+	// ThresholdImageProcessor
+	//
+
+	ThresholdImageProcessor::ThresholdImageProcessor()
+	: threshold_(0.5), value_(0.0f, 0.0f, 0.0f, 1.0f)
+	{}
+
+	ThresholdImageProcessor::ThresholdImageProcessor(Real const& threshold)
+	: threshold_(threshold), value_(0.0f, 0.0f, 0.0f, 1.0f)
+	{
+	}
+
+	//
+	// BinarizationImageProcessor
+	//
+
+	BinarizationImageProcessor::BinarizationImageProcessor()
+	: threshold_(0.5)
+	{}
+
+	BinarizationImageProcessor::BinarizationImageProcessor(Real const& threshold)
+	: threshold_(threshold)
+	{}
+
 	//
 	// KernelImageProcessor
 	//
@@ -438,6 +575,11 @@ namespace rengine
 	}
 
 
+	std::string FusedImageProcessor::effectFile() const
+	{
+		return CoreEngine::instance()->locationTable().lookUp("image_processing_fused");
+	}
+
 	std::string CopyImageProcessor::effectFile() const
 	{
 		return CoreEngine::instance()->locationTable().lookUp("image_processing_copy");
@@ -0,0 +1,574 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/image/processing/ImageProcessor.h>
+#include <rengine/image/Image.h>
+#include <rengine/thread/ParallelFor.h>
+#include <rengine/math/Math.h>
+#include <rengine/RenderEngine.h>
+
+#include <vector>
+
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+	#include <emmintrin.h>
+#endif
+
+//
+// Cpu backend of the image processors.
+// Results match the glsl effects in data/shaders/image_processing, pixels outside the image are clamped to the edge.
+//
+
+namespace rengine
+{
+	static Uint const tile_width = 128;
+	static Uint const tile_height = 64;
+	static Uint const lanes = 4;
+
+	//
+	// Tiles of the destination processed by parallelFor
+	//
+	class ImageProcessorTiles : public ParallelRange
+	{
+	public:
+		ImageProcessorTiles(ImageProcessor const& processor, ImageView const& source, ImageView const& destination)
+			:processor_(processor), source_(source), destination_(destination)
+		{
+			tiles_x_ = (destination.getWidth() + tile_width - 1) / tile_width;
+			tiles_y_ = (destination.getHeight() + tile_height - 1) / tile_height;
+		}
+
+		Uint numberOfTiles() const
+		{
+			return tiles_x_ * tiles_y_;
+		}
+
+		virtual void operator()(Uint const begin, Uint const end)
+		{
+			for (Uint tile = begin; tile != end; ++tile)
+			{
+				Uint const x = (tile % tiles_x_) * tile_width;
+				Uint const y = (tile / tiles_x_) * tile_height;
+
+				processor_.processRegion(source_, destination_, x, y,
+										 minimum(tile_width, destination_.getWidth() - x),
+										 minimum(tile_height, destination_.getHeight() - y));
+			}
+		}
+
+	private:
+		ImageProcessor const& processor_;
+		ImageView source_;
+		ImageView destination_;
+		Uint tiles_x_;
+		Uint tiles_y_;
+	};
+
+	static RENGINE_INLINE Bool hasAlpha(Uint const color_channels)
+	{
+		return (color_channels == 2) || (color_channels == 4);
+	}
+
+	static RENGINE_INLINE Uint colorChannels(Uint const color_channels)
+	{
+		return hasAlpha(color_channels) ? (color_channels - 1) : color_channels;
+	}
+
+	static RENGINE_INLINE Uchar toByte(Real const value)
+	{
+		return Uchar(clampTo(value, 0.0f, 255.0f) + 0.5f);
+	}
+
+	//
+	// Convolution taps, offsets are relative to the output pixel
+	//
+	struct ConvolutionTap
+	{
+		Int x;
+		Int y;
+		Real weight;
+	};
+
+	typedef std::vector<ConvolutionTap> ConvolutionTaps;
+
+	//
+	// 1D kernels follow their orientation, axis forces a direction (0 none, 1 horizontal, 2 vertical)
+	//
+	static Real buildTaps(Kernel& kernel, Uint const axis, ConvolutionTaps& taps, Int& halo)
+	{
+		taps.clear();
+
+		Int const size = Int(kernel.size());
+		Int const half = size / 2;
+		Real const* data = kernel.data();
+		Real sum = 0.0f;
+
+		if (kernel.dimensions() == 1)
+		{
+			Bool const horizontal = (axis == 1) || ((axis == 0) && (kernel.orientation() != Kernel::Vertical));
+			Bool const vertical = (axis == 2) || ((axis == 0) && (kernel.orientation() != Kernel::Horizontal));
+
+			for (Int i = -half; i <= half; ++i)
+			{
+				ConvolutionTap tap;
+				tap.x = horizontal ? i : 0;
+				tap.y = vertical ? i : 0;
+				tap.weight = data[i + half];
+
+				sum += tap.weight;
+				if (tap.weight != 0.0f)
+				{
+					taps.push_back(tap);
+				}
+			}
+		}
+		else if (kernel.dimensions() == 2)
+		{
+			for (Int y = -half; y <= half; ++y)
+			{
+				for (Int x = -half; x <= half; ++x)
+				{
+					ConvolutionTap tap;
+					tap.x = x;
+					tap.y = y;
+					tap.weight = data[(y + half) * size + (x + half)];
+
+					sum += tap.weight;
+					if (tap.weight != 0.0f)
+					{
+						taps.push_back(tap);
+					}
+				}
+			}
+		}
+
+		halo = maximum(halo, half);
+		return (sum <= 0.0f) ? 1.0f : sum;
+	}
+
+	//
+	// Source region with halo, expanded to 4 float lanes per pixel
+	//
+	class ConvolutionRegion
+	{
+	public:
+		ConvolutionRegion(ImageView const& source, Uint const x, Uint const y, Uint const width, Uint const height, Int const halo)
+			:width_(width + 2 * halo), height_(height + 2 * halo), halo_(halo), pixels_(width_ * height_ * lanes, 0.0f)
+		{
+			Int const last_x = Int(source.getWidth()) - 1;
+			Int const last_y = Int(source.getHeight()) - 1;
+			Uint const color_channels = source.getColorChannels();
+
+			for (Uint row = 0; row != height_; ++row)
+			{
+				Uchar const* source_row = source.row(Uint(clampTo(Int(y + row) - halo, 0, last_y)));
+				Real* pixel = &pixels_[row * width_ * lanes];
+
+				for (Uint column = 0; column != width_; ++column, pixel += lanes)
+				{
+					Uchar const* source_pixel = source_row + Uint(clampTo(Int(x + column) - halo, 0, last_x)) * color_channels;
+					for (Uint channel = 0; channel != color_channels; ++channel)
+					{
+						pixel[channel] = Real(source_pixel[channel]);
+					}
+				}
+			}
+		}
+
+		// linear offsets of the taps inside the region
+		void offsets(ConvolutionTaps const& taps, std::vector<Int>& offsets, std::vector<Real>& weights, Real const normalization) const
+		{
+			offsets.clear();
+			weights.clear();
+
+			for (ConvolutionTaps::const_iterator i = taps.begin(); i != taps.end(); ++i)
+			{
+				offsets.push_back((i->y * Int(width_) + i->x) * Int(lanes));
+				weights.push_back(i->weight / normalization);
+			}
+		}
+
+		// pixel of the output coordinates relative to the region origin
+		Real const* center(Uint const x, Uint const y) const
+		{
+			return &pixels_[((y + halo_) * width_ + (x + halo_)) * lanes];
+		}
+
+	private:
+		Uint width_;
+		Uint height_;
+		Int halo_;
+		std::vector<Real> pixels_;
+	};
+
+	static RENGINE_INLINE void convolve(Real const* center, std::vector<Int> const& offsets, std::vector<Real> const& weights, Real* result)
+	{
+		Uint const taps = Uint(offsets.size());
+
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+		__m128 accumulator = _mm_setzero_ps();
+		for (Uint tap = 0; tap != taps; ++tap)
+		{
+			accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(center + offsets[tap]), _mm_set1_ps(weights[tap])));
+		}
+		_mm_storeu_ps(result, accumulator);
+#else
+		result[0] = result[1] = result[2] = result[3] = 0.0f;
+		for (Uint tap = 0; tap != taps; ++tap)
+		{
+			Real const* pixel = center + offsets[tap];
+			for (Uint lane = 0; lane != lanes; ++lane)
+			{
+				result[lane] += pixel[lane] * weights[tap];
+			}
+		}
+#endif
+	}
+
+	static RENGINE_INLINE void absoluteSum(Real const* left, Real const* right, Real* result)
+	{
+#if RENGINE_SIMD_SSE2 == RENGINE_ON
+		__m128 const sign = _mm_set1_ps(-0.0f);
+		_mm_storeu_ps(result, _mm_add_ps(_mm_andnot_ps(sign, _mm_loadu_ps(left)), _mm_andnot_ps(sign, _mm_loadu_ps(right))));
+#else
+		for (Uint lane = 0; lane != lanes; ++lane)
+		{
+			result[lane] = absolute(left[lane]) + absolute(right[lane]);
+		}
+#endif
+	}
+
+	// kernel results have an opaque alpha
+	static RENGINE_INLINE void storeConvolution(Real const* value, Uint const color_channels, Uchar* destination)
+	{
+		Uint const colors = colorChannels(color_channels);
+		for (Uint channel = 0; channel != colors; ++channel)
+		{
+			destination[channel] = toByte(value[channel]);
+		}
+
+		if (hasAlpha(color_channels))
+		{
+			destination[colors] = 255;
+		}
+	}
+
+	//
+	// ImageProcessor
+	//
+	void ImageProcessor::process(ImageView const& source, ImageView const& destination, Uint const threads) const
+	{
+		if (!source.isValid() || !destination.isValid() ||
+			(source.getWidth() != destination.getWidth()) || (source.getHeight() != destination.getHeight()) ||
+			(source.getColorChannels() != destination.getColorChannels()))
+		{
+			return;
+		}
+
+		ImageProcessorTiles tiles(*this, source, destination);
+		parallelFor(tiles, tiles.numberOfTiles(), threads);
+	}
+
+	void ImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+									   Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		source.subView(x, y, width, height).copyTo(destination.subView(x, y, width, height));
+	}
+
+	//
+	// ProcessingChain
+	//
+	void ProcessingChain::process(ImageView const& source, ImageView const& destination, Uint const threads) const
+	{
+		if (!source.isValid() || !destination.isValid() ||
+			(source.getWidth() != destination.getWidth()) || (source.getHeight() != destination.getHeight()))
+		{
+			return;
+		}
+
+		Uint const width = destination.getWidth();
+		Uint const height = destination.getHeight();
+		Uint const color_channels = destination.getColorChannels();
+
+		if (stages_.empty())
+		{
+			source.copyTo(destination);
+			return;
+		}
+
+		ImageView input = source;
+
+		Image converted;
+		if (source.getColorChannels() != color_channels)
+		{
+			converted.createImage(width, height, color_channels);
+			source.copyTo(converted.view());
+			input = converted.view();
+		}
+
+		Image ping;
+		Image pong;
+		if (stages_.size() > 1)
+		{
+			ping.createImage(width, height, color_channels);
+		}
+		if (stages_.size() > 2)
+		{
+			pong.createImage(width, height, color_channels);
+		}
+
+		for (ProcessingStages::size_type stage = 0; stage != stages_.size(); ++stage)
+		{
+			ImageView output = destination;
+			if (stage != (stages_.size() - 1))
+			{
+				output = ((stage % 2) == 0) ? ping.view() : pong.view();
+			}
+
+			stages_[stage]->process(input, output, threads);
+			input = output;
+		}
+	}
+
+	SharedPointer<Image> ProcessingChain::process(Image const& image) const
+	{
+		SharedPointer<Image> processed;
+
+		if (image.isLoaded())
+		{
+			processed = new Image(image.getWidth(), image.getHeight(), image.getColorChannels());
+			process(image.view(), processed->view(), threads_);
+		}
+
+		return processed;
+	}
+
+	void ProcessingChain::processOnCpu(RenderEngine& render_engine)
+	{
+		if (inputs_.empty() || outputs_.empty())
+		{
+			return;
+		}
+
+		Texture2D& input = *inputs_[0];
+		if (!input.drawResourceLoaded(&render_engine))
+		{
+			render_engine.apply(input);
+		}
+
+		Int input_channels = input.getColorChannels();
+		if (input_channels == 0)
+		{
+			input_channels = 4;
+		}
+
+		Int width = 0;
+		Int height = 0;
+		Uchar* pixels = render_engine.downloadTexture2DData(input_channels, &width, &height, input.getId(&render_engine));
+		Image source(width, height, input_channels, pixels);
+
+		Uint output_channels = 4;
+		switch (outputs_[0]->getFormat())
+		{
+			case DrawResource::Red:
+			output_channels = 1;
+				break;
+			case DrawResource::RedGreen:
+			output_channels = 2;
+				break;
+			case DrawResource::Rgb:
+			output_channels = 3;
+				break;
+			default:
+				break;
+		}
+
+		SharedPointer<Image> destination = new Image(width, height, output_channels);
+		process(source.view(), destination->view(), threads_);
+
+		outputs_[0]->setImage(destination);
+	}
+
+	//
+	// FusedImageProcessor
+	//
+	void FusedImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+											Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		// point operations can run in place on the destination
+		ImageView input = source;
+		for (ProcessingChain::ProcessingStages::const_iterator i = stages_.begin(); i != stages_.end(); ++i)
+		{
+			(*i)->processRegion(input, destination, x, y, width, height);
+			input = destination;
+		}
+	}
+
+	//
+	// GrayscaleImageProcessor
+	//
+	void GrayscaleImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+												Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		Uint const color_channels = source.getColorChannels();
+		Uint const colors = colorChannels(color_channels);
+
+		for (Uint row = y; row != y + height; ++row)
+		{
+			Uchar const* in = source.rawPixel(x, row);
+			Uchar* out = destination.rawPixel(x, row);
+
+			for (Uint column = 0; column != width; ++column, in += color_channels, out += color_channels)
+			{
+				Uchar const luminance = (colors >= 3) ? toByte(0.3f * Real(in[0]) + 0.59f * Real(in[1]) + 0.11f * Real(in[2])) : in[0];
+
+				for (Uint channel = 0; channel != colors; ++channel)
+				{
+					out[channel] = luminance;
+				}
+
+				if (hasAlpha(color_channels))
+				{
+					out[colors] = 255;
+				}
+			}
+		}
+	}
+
+	//
+	// ThresholdImageProcessor
+	//
+	void ThresholdImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+												Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		Uint const color_channels = source.getColorChannels();
+		Real const threshold = threshold_ * 255.0f;
+
+		Uchar value[lanes];
+		for (Uint channel = 0; channel != lanes; ++channel)
+		{
+			value[channel] = toByte(value_[channel] * 255.0f);
+		}
+
+		for (Uint row = y; row != y + height; ++row)
+		{
+			Uchar const* in = source.rawPixel(x, row);
+			Uchar* out = destination.rawPixel(x, row);
+
+			for (Uint column = 0; column != width; ++column, in += color_channels, out += color_channels)
+			{
+				Uchar const* color = (Real(in[0]) < threshold) ? value : in;
+
+				for (Uint channel = 0; channel != color_channels; ++channel)
+				{
+					out[channel] = color[channel];
+				}
+			}
+		}
+	}
+
+	//
+	// BinarizationImageProcessor
+	//
+	void BinarizationImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+												   Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		Uint const color_channels = source.getColorChannels();
+		Uint const colors = colorChannels(color_channels);
+		Real const threshold = threshold_ * 255.0f;
+
+		for (Uint row = y; row != y + height; ++row)
+		{
+			Uchar const* in = source.rawPixel(x, row);
+			Uchar* out = destination.rawPixel(x, row);
+
+			for (Uint column = 0; column != width; ++column, in += color_channels, out += color_channels)
+			{
+				Uchar const binary = (Real(in[0]) < threshold) ? 0 : 255;
+
+				for (Uint channel = 0; channel != colors; ++channel)
+				{
+					out[channel] = binary;
+				}
+
+				if (hasAlpha(color_channels))
+				{
+					out[colors] = in[colors];
+				}
+			}
+		}
+	}
+
+	//
+	// KernelImageProcessor
+	//
+	void KernelImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+											 Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		ConvolutionTaps taps;
+		Int halo = 0;
+		Real const sum = buildTaps(*kernel_, 0, taps, halo);
+
+		ConvolutionRegion region(source, x, y, width, height, halo);
+
+		std::vector<Int> offsets;
+		std::vector<Real> weights;
+		region.offsets(taps, offsets, weights, sum);
+
+		Uint const color_channels = source.getColorChannels();
+		Real result[lanes];
+
+		for (Uint row = 0; row != height; ++row)
+		{
+			Uchar* out = destination.rawPixel(x, y + row);
+
+			for (Uint column = 0; column != width; ++column, out += color_channels)
+			{
+				convolve(region.center(column, row), offsets, weights, result);
+				storeConvolution(result, color_channels, out);
+			}
+		}
+	}
+
+	//
+	// SeparableKernelImageProcessor
+	//
+	void SeparableKernelImageProcessor::processRegion(ImageView const& source, ImageView const& destination,
+													  Uint const x, Uint const y, Uint const width, Uint const height) const
+	{
+		// 1D kernels run horizontally and vertically, 2D kernels are used as they are
+		ConvolutionTaps taps0;
+		ConvolutionTaps taps1;
+		Int halo = 0;
+		Real const sum0 = buildTaps(*kernel0_, 1, taps0, halo);
+		Real const sum1 = buildTaps(*kernel1_, 2, taps1, halo);
+
+		ConvolutionRegion region(source, x, y, width, height, halo);
+
+		std::vector<Int> offsets0;
+		std::vector<Real> weights0;
+		region.offsets(taps0, offsets0, weights0, sum0);
+
+		std::vector<Int> offsets1;
+		std::vector<Real> weights1;
+		region.offsets(taps1, offsets1, weights1, sum1);
+
+		Uint const color_channels = source.getColorChannels();
+		Real result0[lanes];
+		Real result1[lanes];
+		Real result[lanes];
+
+		for (Uint row = 0; row != height; ++row)
+		{
+			Uchar* out = destination.rawPixel(x, y + row);
+
+			for (Uint column = 0; column != width; ++column, out += color_channels)
+			{
+				Real const* center = region.center(column, row);
+				convolve(center, offsets0, weights0, result0);
+				convolve(center, offsets1, weights1, result1);
+				absoluteSum(result0, result1, result);
+				storeConvolution(result, color_channels, out);
+			}
+		}
+	}
+
+} //namespace rengine
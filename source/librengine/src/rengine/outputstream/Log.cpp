@@ -4,6 +4,7 @@
 #include <rengine/file/File.h>
 #include <rengine/time/Timestamp.h>
 #include <rengine/time/Timer.h>
+#include <rengine/time/Profiler.h>
 #include <iomanip>
 
 static int const header_line_size = 100;
@@ -308,12 +309,15 @@ namespace rengine
 
 	void LogSystem::Worker::run()
 	{
+		RENGINE_PROFILE_THREAD("log worker");
+
 		while(keepRunning())
 		{
 			Uint flushed = 0;
 			SharedLog logger = m_log_system->getNextLogger();
 			if (logger)
 			{
+				RENGINE_PROFILE_SCOPE("log flush");
 				flushed = logger->flushMessages(m_log_system->getConfig().flush_size);
 			}
 
@@ -0,0 +1,473 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/resource/AssetPack.h>
+#include <rengine/string/String.h>
+#include <rengine/math/Math.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rengine
+{
+	Uint32 const AssetPack::magic;
+	Uint32 const AssetPack::image_magic;
+	Uint32 const AssetPack::version;
+	Uint const AssetPack::header_size;
+	Uint const AssetPack::alignment;
+
+	static Uint const image_header_size = 6 * 4;
+
+	static void put32(std::vector<Uint8>& out, Uint32 const value)
+	{
+		out.push_back(Uint8(value));
+		out.push_back(Uint8(value >> 8));
+		out.push_back(Uint8(value >> 16));
+		out.push_back(Uint8(value >> 24));
+	}
+
+	static void put64(std::vector<Uint8>& out, Uint64 const value)
+	{
+		put32(out, Uint32(value));
+		put32(out, Uint32(value >> 32));
+	}
+
+	static Uint32 get32(Uint8 const* in)
+	{
+		return Uint32(in[0]) | (Uint32(in[1]) << 8) | (Uint32(in[2]) << 16) | (Uint32(in[3]) << 24);
+	}
+
+	static Uint64 get64(Uint8 const* in)
+	{
+		return Uint64(get32(in)) | (Uint64(get32(in + 4)) << 32);
+	}
+
+	// 64 bit, sizes read from a damaged file would wrap a Uint
+	static Uint64 imageLevelSize(Uint const width, Uint const height, Uint const channels, Uint const level)
+	{
+		return Uint64(maximum(width >> level, Uint(1))) * Uint64(maximum(height >> level, Uint(1))) * Uint64(channels);
+	}
+
+	//
+	// Keeps the payload of referenced cooked images alive
+	//
+	struct CookedImageStorage : public ImageStorage
+	{
+		CookedImageStorage(FileData const& file_data)
+			:data(file_data)
+		{
+		}
+
+		FileData data;
+	};
+
+	//
+	// AssetPack
+	//
+	AssetPack::AssetPack()
+	{
+	}
+
+	AssetPack::AssetPack(std::string const& filename)
+	{
+		open(filename);
+	}
+
+	AssetPack::~AssetPack()
+	{
+		close();
+	}
+
+	Bool AssetPack::open(std::string const& filename)
+	{
+		close();
+
+		FileData::SharedMapping mapping = new MappedFile(filename);
+		if (!mapping->isOpen() || (mapping->size() < header_size))
+		{
+			return false;
+		}
+
+		Uint8 const* data = mapping->data();
+		Uint64 const size = mapping->size();
+
+		Uint32 const number_of_entries = get32(data + 8);
+		Uint64 const index_offset = get64(data + 16);
+		Uint64 const index_size = get64(data + 24);
+
+		Uint const entry_header_size = 4 + 4 + 8 + 8;
+
+		// the count is checked against the index before allocating the entries
+		if ((get32(data) != magic) || (get32(data + 4) != version) ||
+			(index_offset > size) || (index_size > size - index_offset) ||
+			(Uint64(number_of_entries) * entry_header_size > index_size))
+		{
+			return false;
+		}
+
+		Entries entries(number_of_entries);
+		Uint8 const* current = data + index_offset;
+		Uint8 const* const end = current + index_size;
+
+		for (Uint i = 0; i != number_of_entries; ++i)
+		{
+			if (Uint64(end - current) < entry_header_size)
+			{
+				return false;
+			}
+
+			Entry& entry = entries[i];
+			entry.type = EntryType(get32(current));
+			Uint32 const name_length = get32(current + 4);
+			entry.offset = get64(current + 8);
+			entry.size = get64(current + 16);
+			current += entry_header_size;
+
+			if ((Uint64(end - current) < name_length) || (entry.offset > size) || (entry.size > size - entry.offset) || (entry.size > Uint64(Uint(-1))))
+			{
+				return false;
+			}
+
+			entry.name.assign((Char const*) current, name_length);
+			current += name_length;
+		}
+
+		// the writer sorts the index, this only protects the lookups from a damaged pack
+		std::sort(entries.begin(), entries.end());
+
+		filename_ = filename;
+		mapping_ = mapping;
+		entries_.swap(entries);
+
+		return true;
+	}
+
+	void AssetPack::close()
+	{
+		filename_.clear();
+		mapping_ = 0;
+		entries_.clear();
+	}
+
+	AssetPack::Entries::const_iterator AssetPack::lowerBound(std::string const& name) const
+	{
+		Entry key;
+		key.name = name;
+		return std::lower_bound(entries_.begin(), entries_.end(), key);
+	}
+
+	AssetPack::Entry const* AssetPack::find(std::string const& filename) const
+	{
+		std::string const name = VirtualFileSystem::normalize(filename);
+
+		Entries::const_iterator found = lowerBound(name);
+		return ((found != entries_.end()) && (found->name == name)) ? &(*found) : 0;
+	}
+
+	Bool AssetPack::entryType(std::string const& filename, EntryType& type) const
+	{
+		Entry const* entry = find(filename);
+		if (entry)
+		{
+			type = entry->type;
+		}
+
+		return (entry != 0);
+	}
+
+	FileType AssetPack::fileType(std::string const& filename) const
+	{
+		std::string const name = VirtualFileSystem::normalize(filename);
+		if (name.empty())
+		{
+			return FileDirectory;
+		}
+
+		Entries::const_iterator found = lowerBound(name);
+		if ((found != entries_.end()) && (found->name == name))
+		{
+			return FileRegular;
+		}
+
+		std::string const prefix = name + "/";
+		found = lowerBound(prefix);
+
+		return ((found != entries_.end()) && startsWith(found->name, prefix)) ? FileDirectory : FileNotFound;
+	}
+
+	DirectoryContents AssetPack::getDirectoryContents(std::string const& directory_name) const
+	{
+		std::string const name = VirtualFileSystem::normalize(directory_name);
+		std::string const prefix = name.empty() ? name : (name + "/");
+
+		DirectoryContents contents;
+
+		for (Entries::const_iterator i = lowerBound(prefix); (i != entries_.end()) && startsWith(i->name, prefix); ++i)
+		{
+			std::string const child = i->name.substr(prefix.size(), i->name.find('/', prefix.size()) - prefix.size());
+
+			if (contents.empty() || (contents.back() != child))
+			{
+				contents.push_back(child);
+			}
+		}
+
+		if (!contents.empty())
+		{
+			contents.push_back(".");
+			contents.push_back("..");
+		}
+
+		return contents;
+	}
+
+	Bool AssetPack::read(std::string const& filename, FileData& data) const
+	{
+		Entry const* entry = find(filename);
+		if (!entry)
+		{
+			return false;
+		}
+
+		FileData file_data;
+		file_data.mapping = mapping_;
+		file_data.view = mapping_->data() + entry->offset;
+		file_data.size = Uint(entry->size);
+
+		data = file_data;
+		return true;
+	}
+
+	SharedFileStream AssetPack::openStream(std::string const& filename) const
+	{
+		SharedFileStream stream;
+
+		FileData data;
+		if (read(filename, data))
+		{
+			stream = new MemoryFileStream(data);
+		}
+
+		return stream;
+	}
+
+	void AssetPack::encodeImage(Image const& image, MipmapChain const* mipmaps, Uint const flags, std::vector<Uint8>& out)
+	{
+		Uint const levels = mipmaps ? mipmaps->numberOfLevels() : 1;
+
+		out.clear();
+		put32(out, image_magic);
+		put32(out, image.getWidth());
+		put32(out, image.getHeight());
+		put32(out, image.getColorChannels());
+		put32(out, levels);
+		put32(out, flags);
+
+		for (Uint level = 0; level != levels; ++level)
+		{
+			Image const& current = (level == 0) ? image : *mipmaps->level(level);
+			Uint8 const* pixels = current.getData();
+			out.insert(out.end(), pixels, pixels + current.getWidth() * current.getHeight() * current.getColorChannels());
+		}
+	}
+
+	Bool AssetPack::isCookedImage(FileData const& data)
+	{
+		return (data.size >= image_header_size) && (get32(data.bytes()) == image_magic);
+	}
+
+	Bool AssetPack::decodeImage(FileData const& data, CookedImage& cooked, Bool const reference_pixels)
+	{
+		if (!isCookedImage(data))
+		{
+			return false;
+		}
+
+		Uint8 const* bytes = data.bytes();
+		Uint const width = get32(bytes + 4);
+		Uint const height = get32(bytes + 8);
+		Uint const channels = get32(bytes + 12);
+		Uint const levels = get32(bytes + 16);
+		Uint const flags = get32(bytes + 20);
+
+		// the area bound keeps the level sizes far from wrapping 64 bits
+		if ((width == 0) || (height == 0) || (channels == 0) || (channels > 4) ||
+			(levels == 0) || (levels > MipmapChain::numberOfLevels(width, height)) ||
+			(Uint64(width) * Uint64(height) > data.size))
+		{
+			return false;
+		}
+
+		Uint64 needed = image_header_size;
+		for (Uint level = 0; level != levels; ++level)
+		{
+			needed += imageLevelSize(width, height, channels, level);
+		}
+
+		if (needed > data.size)
+		{
+			return false;
+		}
+
+		MipmapChain::Levels images(levels);
+		Uint8 const* pixels = bytes + image_header_size;
+
+		SharedImageStorage storage;
+		if (reference_pixels)
+		{
+			storage = new CookedImageStorage(data);
+		}
+
+		for (Uint level = 0; level != levels; ++level)
+		{
+			Uint const level_size = Uint(imageLevelSize(width, height, channels, level));
+			Uint const level_width = maximum(width >> level, Uint(1));
+			Uint const level_height = maximum(height >> level, Uint(1));
+
+			if (reference_pixels)
+			{
+				// mappings are read only, so are the referenced pixels
+				images[level] = new Image(level_width, level_height, channels, const_cast<Uint8*>(pixels), storage);
+			}
+			else
+			{
+				images[level] = new Image(level_width, level_height, channels);
+				memcpy(images[level]->getData(), pixels, level_size);
+			}
+			pixels += level_size;
+		}
+
+		cooked.image = images[0];
+		cooked.flags = flags;
+		cooked.mipmaps = 0;
+
+		if (levels > 1)
+		{
+			cooked.mipmaps = new MipmapChain();
+			cooked.mipmaps->setLevels(images);
+		}
+
+		return true;
+	}
+
+	//
+	// AssetPackWriter
+	//
+	AssetPackWriter::AssetPackWriter()
+		:offset_(0), good_(false)
+	{
+	}
+
+	AssetPackWriter::AssetPackWriter(std::string const& filename)
+		:offset_(0), good_(false)
+	{
+		open(filename);
+	}
+
+	AssetPackWriter::~AssetPackWriter()
+	{
+		close();
+	}
+
+	Bool AssetPackWriter::open(std::string const& filename)
+	{
+		close();
+
+		file_.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+		// the header is written again by close, once the index offset is known
+		std::vector<Uint8> header(AssetPack::header_size, 0);
+		file_.write((Char const*) &header[0], header.size());
+
+		offset_ = header.size();
+		good_ = file_.good();
+
+		return good_;
+	}
+
+	Bool AssetPackWriter::close()
+	{
+		if (!file_.is_open())
+		{
+			return false;
+		}
+
+		std::sort(entries_.begin(), entries_.end());
+
+		std::vector<Uint8> index;
+		for (Entries::const_iterator i = entries_.begin(); i != entries_.end(); ++i)
+		{
+			put32(index, i->type);
+			put32(index, Uint32(i->name.size()));
+			put64(index, i->offset);
+			put64(index, i->size);
+			index.insert(index.end(), i->name.begin(), i->name.end());
+		}
+
+		std::vector<Uint8> header;
+		put32(header, AssetPack::magic);
+		put32(header, AssetPack::version);
+		put32(header, Uint32(entries_.size()));
+		put32(header, 0);
+		put64(header, offset_);
+		put64(header, index.size());
+
+		if (!index.empty())
+		{
+			file_.write((Char const*) &index[0], index.size());
+		}
+		file_.seekp(0, std::ios::beg);
+		file_.write((Char const*) &header[0], header.size());
+
+		Bool const good = good_ && file_.good();
+		file_.close();
+
+		entries_.clear();
+		names_.clear();
+		offset_ = 0;
+		good_ = false;
+
+		return good;
+	}
+
+	Bool AssetPackWriter::add(std::string const& filename, AssetPack::EntryType const type, void const* data, Uint const size)
+	{
+		std::string const name = VirtualFileSystem::normalize(filename);
+
+		if (!good_ || name.empty() || (names_.find(name) != names_.end()))
+		{
+			return false;
+		}
+
+		Uint const padding = Uint((AssetPack::alignment - (offset_ % AssetPack::alignment)) % AssetPack::alignment);
+		if (padding)
+		{
+			Char const zeros[AssetPack::alignment] = { 0 };
+			file_.write(zeros, padding);
+			offset_ += padding;
+		}
+
+		if (size)
+		{
+			file_.write((Char const*) data, size);
+		}
+
+		if (!file_.good())
+		{
+			good_ = false;
+			return false;
+		}
+
+		Entry entry;
+		entry.name = name;
+		entry.type = type;
+		entry.offset = offset_;
+		entry.size = size;
+
+		entries_.push_back(entry);
+		names_.insert(name);
+		offset_ += size;
+
+		return true;
+	}
+
+} // namespace rengine
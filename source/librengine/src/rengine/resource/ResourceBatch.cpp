@@ -0,0 +1,271 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/resource/ResourceBatch.h>
+
+#include <rengine/image/Image.h>
+#include <rengine/state/Texture.h>
+#include <rengine/state/Program.h>
+#include <rengine/text/Font.h>
+#include <rengine/math/Math.h>
+
+#include <algorithm>
+
+namespace rengine
+{
+	ResourceBatch::ResourceBatch(ResourceManager& manager)
+		:manager_(manager), started_(false), loaded_(0), failed_(0)
+	{
+		registerType<Image>("image");
+		registerType<Texture2D>("texture");
+		registerType<Font>("font");
+		registerType<Program>("program");
+	}
+
+	ResourceBatch::~ResourceBatch()
+	{
+		// cancelled requests never call their handler
+		for (NodeList::iterator i = nodes_.begin(); i != nodes_.end(); ++i)
+		{
+			if (i->request)
+			{
+				i->request->cancel();
+			}
+		}
+	}
+
+	std::string ResourceBatch::key(std::string const& type, std::string const& location)
+	{
+		return type + " " + location;
+	}
+
+	Bool ResourceBatch::add(std::string const& type, std::string const& location, Int const priority, Dependencies const& dependencies)
+	{
+		if (started_ || (types_.find(type) == types_.end()))
+		{
+			return false;
+		}
+
+		std::string const node_key = key(type, location);
+		NodeIndex::const_iterator found = node_index_.find(node_key);
+
+		if (found == node_index_.end())
+		{
+			Node node;
+			node.type = type;
+			node.location = location;
+			node.priority = priority;
+			node.dependencies = dependencies;
+			node.state = Pending;
+			node.pending_dependencies = 0;
+
+			node_index_[node_key] = Uint(nodes_.size());
+			nodes_.push_back(node);
+		}
+		else
+		{
+			Node& node = nodes_[found->second];
+			node.priority = maximum(node.priority, priority);
+
+			for (Dependencies::const_iterator i = dependencies.begin(); i != dependencies.end(); ++i)
+			{
+				if (std::find(node.dependencies.begin(), node.dependencies.end(), *i) == node.dependencies.end())
+				{
+					node.dependencies.push_back(*i);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	Bool ResourceBatch::add(ResourceManifest const& manifest)
+	{
+		Bool added = true;
+
+		for (ResourceManifest::Entries::const_iterator i = manifest.entries().begin(); i != manifest.entries().end(); ++i)
+		{
+			added = add(i->type, i->location, i->priority, i->dependencies) && added;
+		}
+
+		return added;
+	}
+
+	Bool ResourceBatch::start()
+	{
+		if (started_)
+		{
+			return false;
+		}
+		started_ = true;
+
+		typedef std::multimap<std::string, Uint> Locations;
+		Locations locations;
+		for (Uint i = 0; i != nodes_.size(); ++i)
+		{
+			locations.insert(Locations::value_type(nodes_[i].location, i));
+		}
+
+		Nodes missing;
+		for (Uint i = 0; i != nodes_.size(); ++i)
+		{
+			Dependencies const& dependencies = nodes_[i].dependencies;
+
+			for (Dependencies::const_iterator dependency = dependencies.begin(); dependency != dependencies.end(); ++dependency)
+			{
+				std::pair<Locations::const_iterator, Locations::const_iterator> range = locations.equal_range(*dependency);
+				if (range.first == range.second)
+				{
+					missing.push_back(i);
+				}
+
+				for (Locations::const_iterator found = range.first; found != range.second; ++found)
+				{
+					nodes_[found->second].dependents.push_back(i);
+					nodes_[i].pending_dependencies++;
+				}
+			}
+		}
+
+		// resources that would wait on each other forever, the ones left out of a topological order
+		Nodes pending(nodes_.size());
+		Nodes ready;
+		for (Uint i = 0; i != nodes_.size(); ++i)
+		{
+			pending[i] = nodes_[i].pending_dependencies;
+			if (pending[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		Uint ordered = 0;
+		while (!ready.empty())
+		{
+			Uint const node = ready.back();
+			ready.pop_back();
+			++ordered;
+
+			for (Nodes::const_iterator i = nodes_[node].dependents.begin(); i != nodes_[node].dependents.end(); ++i)
+			{
+				if (--pending[*i] == 0)
+				{
+					ready.push_back(*i);
+				}
+			}
+		}
+
+		Bool const valid = missing.empty() && (ordered == nodes_.size());
+
+		for (Nodes::const_iterator i = missing.begin(); i != missing.end(); ++i)
+		{
+			fail(*i);
+		}
+
+		for (Uint i = 0; i != nodes_.size(); ++i)
+		{
+			if (pending[i] != 0)
+			{
+				fail(i);
+			}
+		}
+
+		for (Uint i = 0; i != nodes_.size(); ++i)
+		{
+			if ((nodes_[i].state == Pending) && (nodes_[i].pending_dependencies == 0))
+			{
+				schedule(i);
+			}
+		}
+
+		return valid;
+	}
+
+	void ResourceBatch::wait()
+	{
+		while (started_ && !done())
+		{
+			manager_.loadQueue().flush();
+
+			// cancelled requests never call their handler, with the queue idle nothing else will finish
+			if (!done() && (manager_.loadQueue().numberOfPendingRequests() == 0))
+			{
+				for (Uint i = 0; i != nodes_.size(); ++i)
+				{
+					fail(i);
+				}
+			}
+		}
+	}
+
+	ResourceBatch::State ResourceBatch::state(std::string const& type, std::string const& location) const
+	{
+		NodeIndex::const_iterator found = node_index_.find(key(type, location));
+		return (found != node_index_.end()) ? nodes_[found->second].state : Pending;
+	}
+
+	std::vector<std::string> ResourceBatch::failures() const
+	{
+		std::vector<std::string> failed;
+
+		for (NodeList::const_iterator i = nodes_.begin(); i != nodes_.end(); ++i)
+		{
+			if (i->state == Failed)
+			{
+				failed.push_back(key(i->type, i->location));
+			}
+		}
+
+		return failed;
+	}
+
+	void ResourceBatch::schedule(Uint const node)
+	{
+		nodes_[node].state = Loading;
+		nodes_[node].request = types_[nodes_[node].type]->request(*this, node);
+	}
+
+	void ResourceBatch::finished(Uint const node, Bool const loaded)
+	{
+		if (!loaded)
+		{
+			fail(node);
+			return;
+		}
+
+		nodes_[node].state = Loaded;
+		++loaded_;
+
+		Nodes const dependents = nodes_[node].dependents;
+		for (Nodes::const_iterator i = dependents.begin(); i != dependents.end(); ++i)
+		{
+			Node& dependent = nodes_[*i];
+			dependent.pending_dependencies--;
+
+			if ((dependent.state == Pending) && (dependent.pending_dependencies == 0))
+			{
+				schedule(*i);
+			}
+		}
+	}
+
+	void ResourceBatch::fail(Uint const node)
+	{
+		if ((nodes_[node].state == Loaded) || (nodes_[node].state == Failed))
+		{
+			return;
+		}
+
+		nodes_[node].state = Failed;
+		++failed_;
+
+		Nodes const dependents = nodes_[node].dependents;
+		for (Nodes::const_iterator i = dependents.begin(); i != dependents.end(); ++i)
+		{
+			if (nodes_[*i].state == Pending)
+			{
+				fail(*i);
+			}
+		}
+	}
+
+} // namespace rengine
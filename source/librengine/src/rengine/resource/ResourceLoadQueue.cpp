@@ -0,0 +1,287 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/resource/ResourceLoadQueue.h>
+#include <rengine/thread/Thread.h>
+#include <rengine/time/Timer.h>
+#include <rengine/time/Profiler.h>
+#include <rengine/math/Math.h>
+
+#include <algorithm>
+
+namespace rengine
+{
+	//
+	// ResourceRequest
+	//
+	ResourceRequest::ResourceRequest(std::string const& location, Int const priority)
+		:location_(location), priority_(priority), sequence_(0), state_(Queued), cancelled_(0)
+	{
+	}
+
+	ResourceRequest::~ResourceRequest()
+	{
+	}
+
+	void ResourceRequest::cancel()
+	{
+		cancelled_ = 1;
+	}
+
+	// heap order, the top is the highest priority pushed first
+	struct ResourceRequestOrder
+	{
+		Bool operator()(SharedResourceRequest const& lhs, SharedResourceRequest const& rhs) const
+		{
+			if (lhs->priority_ != rhs->priority_)
+			{
+				return (lhs->priority_ < rhs->priority_);
+			}
+
+			return (lhs->sequence_ > rhs->sequence_);
+		}
+	};
+
+	//
+	// ResourceLoadQueue
+	//
+	class ResourceLoadQueue::Worker : public Thread
+	{
+	public:
+		Worker(ResourceLoadQueue& queue)
+			:queue_(queue)
+		{
+		}
+
+		virtual void run()
+		{
+			RENGINE_PROFILE_THREAD("resource load");
+
+			for (SharedResourceRequest request = queue_.take(); request; request = queue_.take())
+			{
+				Bool succeeded = false;
+
+				if (request->state() != ResourceRequest::Cancelled)
+				{
+					RENGINE_PROFILE_SCOPE("resource load");
+					request->state_ = ResourceRequest::Loading;
+					succeeded = request->load();
+				}
+
+				queue_.loaded(request, succeeded);
+			}
+		}
+	private:
+		ResourceLoadQueue& queue_;
+	};
+
+	ResourceLoadQueue::ResourceLoadQueue()
+		:loading_(0), sequence_(0), stopping_(false), number_of_workers_(0)
+	{
+	}
+
+	ResourceLoadQueue::~ResourceLoadQueue()
+	{
+		shutdown();
+	}
+
+	void ResourceLoadQueue::setNumberOfWorkers(Uint const workers)
+	{
+		ScopedLock lock(mutex_);
+		number_of_workers_ = workers;
+	}
+
+	void ResourceLoadQueue::push(SharedResourceRequest const& request)
+	{
+		ScopedLock lock(mutex_);
+
+		if (workers_.empty())
+		{
+			startWorkers();
+		}
+
+		request->sequence_ = sequence_++;
+		request->state_ = ResourceRequest::Queued;
+
+		queued_.push_back(request);
+		std::push_heap(queued_.begin(), queued_.end(), ResourceRequestOrder());
+
+		work_condition_.signal();
+	}
+
+	Uint ResourceLoadQueue::finalize(Real64 const budget_seconds)
+	{
+		Timer timer;
+		Uint finalized = 0;
+
+		for (;;)
+		{
+			SharedResourceRequest request;
+			{
+				ScopedLock lock(mutex_);
+				if (finalizing_.empty())
+				{
+					break;
+				}
+
+				std::pop_heap(finalizing_.begin(), finalizing_.end(), ResourceRequestOrder());
+				request = finalizing_.back();
+				finalizing_.pop_back();
+			}
+
+			// failed requests are already done, they still notify
+			if (request->state() == ResourceRequest::Cancelled)
+			{
+				request->state_ = ResourceRequest::Cancelled;
+				continue;
+			}
+
+			if (ResourceRequest::State(Int64(request->state_)) == ResourceRequest::Finalizing)
+			{
+				request->finalize();
+				request->state_ = ResourceRequest::Loaded;
+			}
+
+			request->notify();
+			++finalized;
+
+			if (timer.elapsedTime() >= budget_seconds)
+			{
+				break;
+			}
+		}
+
+		return finalized;
+	}
+
+	void ResourceLoadQueue::flush()
+	{
+		for (;;)
+		{
+			finalize(1.0e30);
+
+			ScopedLock lock(mutex_);
+
+			if (finalizing_.empty())
+			{
+				if (queued_.empty() && (loading_ == 0))
+				{
+					break;
+				}
+
+				loaded_condition_.wait(&mutex_);
+			}
+		}
+	}
+
+	Uint ResourceLoadQueue::numberOfPendingRequests() const
+	{
+		ScopedLock lock(mutex_);
+		return Uint(queued_.size() + finalizing_.size()) + loading_;
+	}
+
+	void ResourceLoadQueue::shutdown()
+	{
+		{
+			ScopedLock lock(mutex_);
+
+			for (Requests::iterator i = queued_.begin(); i != queued_.end(); ++i)
+			{
+				(*i)->cancel();
+				(*i)->state_ = ResourceRequest::Cancelled;
+			}
+			queued_.clear();
+
+			stopping_ = true;
+			work_condition_.broadcast();
+		}
+
+		stopWorkers();
+
+		ScopedLock lock(mutex_);
+
+		// requests finished by the workers while stopping
+		for (Requests::iterator i = finalizing_.begin(); i != finalizing_.end(); ++i)
+		{
+			(*i)->cancel();
+			(*i)->state_ = ResourceRequest::Cancelled;
+		}
+		finalizing_.clear();
+
+		stopping_ = false;
+	}
+
+	void ResourceLoadQueue::startWorkers()
+	{
+		Uint workers = number_of_workers_;
+		if (workers == 0)
+		{
+			workers = Uint(maximum(Thread::numberOfProcessors() - 1, 1));
+		}
+
+		for (Uint i = 0; i != workers; ++i)
+		{
+			Worker* worker = new Worker(*this);
+			worker->start();
+			workers_.push_back(worker);
+		}
+	}
+
+	void ResourceLoadQueue::stopWorkers()
+	{
+		Workers workers;
+		{
+			ScopedLock lock(mutex_);
+			workers.swap(workers_);
+		}
+
+		for (Workers::iterator i = workers.begin(); i != workers.end(); ++i)
+		{
+			(*i)->stop();
+			delete(*i);
+		}
+	}
+
+	SharedResourceRequest ResourceLoadQueue::take()
+	{
+		ScopedLock lock(mutex_);
+
+		while (queued_.empty() && !stopping_)
+		{
+			work_condition_.wait(&mutex_);
+		}
+
+		SharedResourceRequest request;
+
+		if (!stopping_)
+		{
+			std::pop_heap(queued_.begin(), queued_.end(), ResourceRequestOrder());
+			request = queued_.back();
+			queued_.pop_back();
+			++loading_;
+		}
+
+		return request;
+	}
+
+	void ResourceLoadQueue::loaded(SharedResourceRequest const& request, Bool const succeeded)
+	{
+		ScopedLock lock(mutex_);
+
+		--loading_;
+
+		if (request->state() == ResourceRequest::Cancelled)
+		{
+			request->state_ = ResourceRequest::Cancelled;
+		}
+		else
+		{
+			request->state_ = succeeded ? ResourceRequest::Finalizing : ResourceRequest::Failed;
+
+			finalizing_.push_back(request);
+			std::push_heap(finalizing_.begin(), finalizing_.end(), ResourceRequestOrder());
+		}
+
+		loaded_condition_.broadcast();
+	}
+
+} // namespace rengine
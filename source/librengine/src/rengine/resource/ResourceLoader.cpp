@@ -1,18 +1,47 @@
 // __!!rengine_copyright!!__ //
 
 #include <rengine/resource/ResourceLoader.h>
-#include <rengine/file/File.h>
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/CoreEngine.h>
 
 namespace rengine
 {
+	// used by loaders running without an engine, tools and tests
+	struct DiskFileSystem : public VirtualFileSystem
+	{
+		DiskFileSystem()
+		{
+			mountDirectory("");
+		}
+	};
+	static DiskFileSystem disk_file_system;
+
+	static Atomic use_stamp;
+
+	VirtualFileSystem const& BaseResourceLoader::fileSystem()
+	{
+		CoreEngine const* engine = CoreEngine::instance();
+		return engine ? engine->fileSystem() : disk_file_system;
+	}
+
+	Uint64 BaseResourceLoader::nextUse()
+	{
+		return Uint64(++use_stamp);
+	}
+
 	Bool BaseResourceLoader::suportsFormat(std::string const& extension) const
 	{
 		return false;
 	}
 
+	void BaseResourceLoader::sourceFiles(std::string const& location, Locations& files) const
+	{
+		files.push_back(location);
+	}
+
 	Bool BaseResourceLoader::canLoadResourceFromLocation(std::string const& resource_location) const
 	{
-		return (suportsFormat( getFileExtension(resource_location) ) && fileExists(resource_location));
+		return (suportsFormat( getFileExtension(resource_location) ) && fileSystem().fileExists(resource_location));
 	}
 } // end of namespace
 
@@ -4,18 +4,53 @@
 #include <rengine/outputstream/OutputStream.h>
 #include <rengine/CoreEngine.h>
 #include <rengine/util/Demangle.h>
+#include <rengine/string/String.h>
+#include <rengine/math/Math.h>
+
+#include <rengine/file/VirtualFileSystem.h>
+
+#include <algorithm>
+#include <set>
 
 namespace rengine
 {
+	static Real64 const bytes_per_megabyte = 1024.0 * 1024.0;
+
+	static Uint64 budgetBytes(SystemVariable& budget)
+	{
+		Real const megabytes = budget.asFloat();
+		return (megabytes > 0.0f) ? Uint64(Real64(megabytes) * bytes_per_megabyte) : 0;
+	}
+
+	// oldest use first
+	struct EvictionOrder
+	{
+		Bool operator()(BaseResourceLoader::EvictionCandidate const& lhs, BaseResourceLoader::EvictionCandidate const& rhs) const
+		{
+			return (lhs.last_use < rhs.last_use);
+		}
+	};
+
 	ResourceManager::ResourceManager()
+		:configured(false), watched_generation(0), watching(false)
 	{
 		caching_option = new SystemVariable("resource_caching_option", "default");
 		caching_option->setHandler(this);
 		caching_option->setDescription("resource caching state [cache, nocache]");
+
+		finalize_budget = new SystemVariable("resource_finalize_budget", 4.0f);
+		finalize_budget->setDescription("milliseconds per frame spent finalizing asynchronous loads, at least one load is finalized");
+
+		memory_budget = new SystemVariable("resource_memory_budget", 0.0f);
+		memory_budget->setDescription("megabytes of cached resources, least recently used resources are evicted, 0 disables it");
+
+		hot_reload = new SystemVariable("resource_hot_reload", false);
+		hot_reload->setDescription("reload cached resources when their files change");
 	}
 
 	ResourceManager::~ResourceManager()
 	{
+		load_queue.shutdown();
 		clearCachedResources();
 		clearLoaders();
 	}
@@ -26,6 +61,12 @@ namespace rengine
 		{
 			loaders[i]->clearCachedResources();
 		}
+
+		ScopedLock lock(index_mutex);
+		for (LoaderIndices::iterator i = loader_indices.begin(); i != loader_indices.end(); ++i)
+		{
+			i->second.locations.clear();
+		}
 	}
 
 	void ResourceManager::setCacheOption(BaseResourceLoader::CacheOption const& option)
@@ -38,7 +79,201 @@ namespace rengine
 
 	void ResourceManager::addLoader(SharedPointer<BaseResourceLoader> const& loader)
 	{
+		ScopedLock lock(index_mutex);
+
 		loaders.push_back(loader);
+
+		LoaderIndex& index = loader_indices[&loader->resourceTypeinfo()];
+		index.loaders.push_back(loader.get());
+		index.formats.clear();
+
+		if (!index.budget)
+		{
+			// rengine::Texture2D is resource_budget_texture2d
+			std::string type = demangleType(loader->resourceTypeinfo().name());
+			std::string::size_type const scope = type.rfind("::");
+			if (scope != std::string::npos)
+			{
+				type = type.substr(scope + 2);
+			}
+			lowercase(type);
+
+			index.budget = new SystemVariable("resource_budget_" + type, 0.0f);
+			index.budget->setDescription("megabytes of cached " + type + " resources, 0 disables it");
+
+			if (configured)
+			{
+				CoreEngine::instance()->system().registerVariable(index.budget);
+			}
+		}
+	}
+
+	void ResourceManager::setMemoryBudget(Real const megabytes)
+	{
+		memory_budget->set(megabytes);
+	}
+
+	Uint64 ResourceManager::cachedBytes() const
+	{
+		Uint64 bytes = 0;
+		for (ResourceLoaders::size_type i = 0; i != loaders.size(); ++i)
+		{
+			bytes += loaders[i]->cachedBytes();
+		}
+
+		return bytes;
+	}
+
+	Uint64 ResourceManager::evictLeastRecentlyUsed(LoaderIndex::Loaders const& loaders, Uint64 const budget)
+	{
+		Uint64 used = 0;
+		for (LoaderIndex::Loaders::size_type i = 0; i != loaders.size(); ++i)
+		{
+			used += loaders[i]->cachedBytes();
+		}
+
+		if (used <= budget)
+		{
+			return 0;
+		}
+
+		BaseResourceLoader::EvictionCandidates candidates;
+		for (LoaderIndex::Loaders::size_type i = 0; i != loaders.size(); ++i)
+		{
+			loaders[i]->evictionCandidates(candidates);
+		}
+		std::sort(candidates.begin(), candidates.end(), EvictionOrder());
+
+		Uint64 evicted = 0;
+		for (BaseResourceLoader::EvictionCandidates::const_iterator i = candidates.begin(); (i != candidates.end()) && (used > budget); ++i)
+		{
+			Uint64 const released = i->loader->evict(i->location);
+			used -= minimum(released, used);
+			evicted += released;
+		}
+
+		return evicted;
+	}
+
+	Uint64 ResourceManager::enforceMemoryBudget()
+	{
+		ScopedLock lock(index_mutex);
+		Uint64 evicted = 0;
+
+		for (LoaderIndices::iterator i = loader_indices.begin(); i != loader_indices.end(); ++i)
+		{
+			Uint64 const budget = budgetBytes(*i->second.budget);
+			if (budget)
+			{
+				evicted += evictLeastRecentlyUsed(i->second.loaders, budget);
+			}
+		}
+
+		Uint64 const budget = budgetBytes(*memory_budget);
+		if (budget)
+		{
+			LoaderIndex::Loaders all;
+			for (ResourceLoaders::size_type i = 0; i != loaders.size(); ++i)
+			{
+				all.push_back(loaders[i].get());
+			}
+
+			evicted += evictLeastRecentlyUsed(all, budget);
+		}
+
+		return evicted;
+	}
+
+	void ResourceManager::setHotReload(Bool const enabled)
+	{
+		hot_reload->set(enabled);
+	}
+
+	void ResourceManager::stopHotReload()
+	{
+		file_watcher.stop();
+		watched_files.clear();
+		watched_generation = 0;
+		watching = false;
+	}
+
+	Uint ResourceManager::updateHotReload()
+	{
+		if (!hot_reload->asBool())
+		{
+			if (watching)
+			{
+				stopHotReload();
+			}
+			return 0;
+		}
+
+		Uint64 generation = 0;
+		for (ResourceLoaders::size_type i = 0; i != loaders.size(); ++i)
+		{
+			generation += loaders[i]->cacheGeneration();
+		}
+
+		// the cache changed, watch the files of the resources cached now
+		if (!watching || (generation != watched_generation))
+		{
+			VirtualFileSystem const& file_system = BaseResourceLoader::fileSystem();
+
+			WatchedFiles watched;
+			FileWatcher::Filenames filenames;
+
+			for (ResourceLoaders::size_type i = 0; i != loaders.size(); ++i)
+			{
+				BaseResourceLoader::ResourceLoaderInfo const info = loaders[i]->loaderInfo();
+				for (BaseResourceLoader::ResourceLoaderInfo::const_iterator item = info.begin(); item != info.end(); ++item)
+				{
+					BaseResourceLoader::Locations files;
+					loaders[i]->sourceFiles(item->name, files);
+
+					for (BaseResourceLoader::Locations::const_iterator file = files.begin(); file != files.end(); ++file)
+					{
+						std::string const native = file_system.nativeFilename(*file);
+						if (!native.empty())
+						{
+							watched.insert(WatchedFiles::value_type(native, WatchedResource(loaders[i].get(), item->name)));
+							filenames.push_back(native);
+						}
+					}
+				}
+			}
+
+			file_watcher.setFiles(filenames);
+			watched_files.swap(watched);
+			watched_generation = generation;
+			watching = true;
+		}
+
+		// a resource made of several changed files is reloaded once
+		typedef std::set<WatchedResource> Reloads;
+		Reloads reloads;
+
+		FileWatcher::Filenames const changes = file_watcher.changes();
+		for (FileWatcher::Filenames::const_iterator i = changes.begin(); i != changes.end(); ++i)
+		{
+			std::pair<WatchedFiles::const_iterator, WatchedFiles::const_iterator> range = watched_files.equal_range(*i);
+			for (WatchedFiles::const_iterator watched = range.first; watched != range.second; ++watched)
+			{
+				reloads.insert(watched->second);
+			}
+		}
+
+		Uint queued = 0;
+		for (Reloads::const_iterator i = reloads.begin(); i != reloads.end(); ++i)
+		{
+			SharedResourceRequest request = i->first->reload(i->second);
+			if (request)
+			{
+				load_queue.push(request);
+				++queued;
+			}
+		}
+
+		return queued;
 	}
 
 	void ResourceManager::configure()
@@ -52,22 +287,36 @@ namespace rengine
 				);
 
 		CoreEngine::instance()->system().registerVariable(caching_option);
+		CoreEngine::instance()->system().registerVariable(finalize_budget);
+		CoreEngine::instance()->system().registerVariable(memory_budget);
+		CoreEngine::instance()->system().registerVariable(hot_reload);
+
+		configured = true;
+		for (LoaderIndices::iterator i = loader_indices.begin(); i != loader_indices.end(); ++i)
+		{
+			CoreEngine::instance()->system().registerVariable(i->second.budget);
+		}
 
 		registerDefaultLoaders();
 	}
 
+	Uint ResourceManager::finalizeAsyncLoads()
+	{
+		return load_queue.finalize(Real64(finalize_budget->asFloat()) / 1000.0);
+	}
+
 	void ResourceManager::reportLoadersInfo() const
 	{
 		CoreEngine::instance()->log() << "Resource Info report:" << std::endl;
-		CoreEngine::instance()->log() << "[request count] location" << std::endl;
+		CoreEngine::instance()->log() << "[request count] [bytes] location" << std::endl;
 		for (ResourceLoaders::size_type i = 0; i != loaders.size(); ++i)
 		{
-			CoreEngine::instance()->log() << demangleType(loaders[i]->resourceTypeinfo().name()) <<  std::endl;
+			CoreEngine::instance()->log() << demangleType(loaders[i]->resourceTypeinfo().name()) << " " << loaders[i]->cachedBytes() << " bytes" << std::endl;
 
 			BaseResourceLoader::ResourceLoaderInfo info = loaders[i]->loaderInfo();
 			for (BaseResourceLoader::ResourceLoaderInfo::const_iterator i = info.begin(); i != info.end(); ++i)
 			{
-				CoreEngine::instance()->log() << "[" << i->request_count << "] " << i->name << std::endl;
+				CoreEngine::instance()->log() << "[" << i->request_count << "] [" << i->size << "] " << i->name << std::endl;
 
 			}
 		}
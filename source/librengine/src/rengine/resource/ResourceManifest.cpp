@@ -0,0 +1,87 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/resource/ResourceManifest.h>
+#include <rengine/resource/ResourceLoader.h>
+#include <rengine/file/VirtualFileSystem.h>
+
+namespace rengine
+{
+	ResourceManifest::Entry::Entry()
+		:priority(0)
+	{
+	}
+
+	ResourceManifest::Entry::Entry(std::string const& type, std::string const& location, Int const priority)
+		:type(type), location(location), priority(priority)
+	{
+	}
+
+	void ResourceManifest::Entry::serialize(XmlArchive& archive)
+	{
+		XML_SERIALIZE(archive, type);
+		XML_SERIALIZE(archive, location);
+		XML_SERIALIZE(archive, priority);
+		XML_SERIALIZE(archive, dependencies);
+	}
+
+	ResourceManifest::ResourceManifest()
+	{
+	}
+
+	ResourceManifest::~ResourceManifest()
+	{
+	}
+
+	Bool ResourceManifest::load(std::string const& location)
+	{
+		FileData data;
+		if (!BaseResourceLoader::fileSystem().read(location, data))
+		{
+			return false;
+		}
+
+		XmlArchive archive;
+		if (!archive.parse(std::string((Char const*) data.bytes(), data.size)))
+		{
+			return false;
+		}
+
+		Entries entries;
+		try
+		{
+			rengine::serialize(archive, "resources", entries);
+		}
+		catch (XmlArchiveException const& caught)
+		{
+			return false;
+		}
+
+		entries_.insert(entries_.end(), entries.begin(), entries.end());
+		return true;
+	}
+
+	Bool ResourceManifest::save(std::string const& filename) const
+	{
+		XmlArchive archive;
+		if (!archive.open(filename, XmlArchive::Write))
+		{
+			return false;
+		}
+
+		Entries entries = entries_;
+		rengine::serialize(archive, "resources", entries);
+
+		return archive.save();
+	}
+
+	void ResourceManifest::add(Entry const& entry)
+	{
+		entries_.push_back(entry);
+	}
+
+	void ResourceManifest::clear()
+	{
+		entries_.clear();
+	}
+
+} // namespace rengine
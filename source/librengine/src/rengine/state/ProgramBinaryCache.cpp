@@ -0,0 +1,200 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/state/ProgramBinaryCache.h>
+#include <rengine/file/File.h>
+#include <rengine/util/Crc32.h>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+namespace rengine
+{
+	// the binaries are local to the machine, values are stored in its byte order
+	static Uint32 const binary_magic = 0x43425052; // "RPBC"
+	static Uint32 const binary_version = 2;
+
+	// a driver string longer than this is a corrupted file
+	static Uint32 const maximum_driver_size = 4096;
+
+	static Uint32 checksum(std::string const& text)
+	{
+		return crc32(0, text.data(), Uint(text.size()));
+	}
+
+	static void write(std::ostream& out, Uint32 const value)
+	{
+		out.write((char const*) &value, sizeof(value));
+	}
+
+	static Bool read(std::istream& in, Uint32& value)
+	{
+		in.read((char*) &value, sizeof(value));
+		return in.good();
+	}
+
+	// bytes of the file after the read position
+	static Uint64 remaining(std::istream& in, Uint64 const file_size)
+	{
+		std::streamoff const position = in.tellg();
+		return ((position < 0) || (Uint64(position) > file_size)) ? 0 : file_size - Uint64(position);
+	}
+
+	// a size larger than the rest of the file is a corrupted file
+	static Bool read(std::istream& in, Uint64 const file_size, Uint32 const size, std::string& text)
+	{
+		if (!in.good() || (size > remaining(in, file_size)))
+		{
+			return false;
+		}
+
+		text.assign(size, ' ');
+		if (size)
+		{
+			in.read(&text[0], size);
+		}
+		return in.good();
+	}
+
+	ProgramBinaryCache::ProgramBinaryCache()
+	{
+	}
+
+	void ProgramBinaryCache::setDirectory(std::string const& directory)
+	{
+		directory_ = directory;
+	}
+
+	void ProgramBinaryCache::setDriver(std::string const& driver)
+	{
+		driver_ = driver;
+	}
+
+	std::string ProgramBinaryCache::filename(std::string const& vertex_source, std::string const& fragment_source) const
+	{
+		std::stringstream name;
+		name << std::hex << std::setfill('0');
+		name << std::setw(8) << checksum(vertex_source);
+		name << std::setw(8) << checksum(fragment_source);
+		name << std::setw(8) << checksum(driver_);
+		name << ".bin";
+
+		return convertFileNameToNativeStyle(directory_ + "/" + name.str());
+	}
+
+	Bool ProgramBinaryCache::load(std::string const& vertex_source, std::string const& fragment_source, Uint& format, Binary& binary) const
+	{
+		if (!enabled())
+		{
+			return false;
+		}
+
+		std::ifstream in(filename(vertex_source, fragment_source).c_str(), std::ios::in | std::ios::binary);
+		if (!in.is_open())
+		{
+			return false;
+		}
+
+		in.seekg(0, std::ios::end);
+		Uint64 const file_size = Uint64(in.tellg());
+		in.seekg(0, std::ios::beg);
+
+		Uint32 magic = 0;
+		Uint32 version = 0;
+		Uint32 driver_size = 0;
+		std::string driver;
+		if (!read(in, magic) || !read(in, version) || !read(in, driver_size) ||
+			(magic != binary_magic) || (version != binary_version) || (driver_size > maximum_driver_size) ||
+			!read(in, file_size, driver_size, driver) || (driver != driver_))
+		{
+			return false;
+		}
+
+		// the checksums in the filename could collide, the whole sources are compared
+		Uint32 vertex_size = 0;
+		Uint32 fragment_size = 0;
+		std::string vertex;
+		std::string fragment;
+		if (!read(in, vertex_size) || (vertex_size != vertex_source.size()) || !read(in, file_size, vertex_size, vertex) || (vertex != vertex_source) ||
+			!read(in, fragment_size) || (fragment_size != fragment_source.size()) || !read(in, file_size, fragment_size, fragment) || (fragment != fragment_source))
+		{
+			return false;
+		}
+
+		Uint32 binary_format = 0;
+		Uint32 binary_size = 0;
+		if (!read(in, binary_format) || !read(in, binary_size) || (binary_size == 0) || (binary_size > remaining(in, file_size)))
+		{
+			return false;
+		}
+
+		Binary data(binary_size);
+		in.read((char*) &data[0], binary_size);
+		if (in.gcount() != std::streamsize(binary_size))
+		{
+			return false;
+		}
+
+		format = binary_format;
+		binary.swap(data);
+		return true;
+	}
+
+	Bool ProgramBinaryCache::save(std::string const& vertex_source, std::string const& fragment_source, Uint const format, Binary const& binary) const
+	{
+		if (!enabled() || binary.empty() || !makeDirectory(directory_))
+		{
+			return false;
+		}
+
+		std::string const destination = filename(vertex_source, fragment_source);
+
+		// written aside and renamed, another process never reads half a file
+		std::string const temporary = destination + ".tmp";
+		{
+			std::ofstream out(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out.is_open())
+			{
+				return false;
+			}
+
+			write(out, binary_magic);
+			write(out, binary_version);
+			write(out, Uint32(driver_.size()));
+			out.write(driver_.data(), driver_.size());
+			write(out, Uint32(vertex_source.size()));
+			out.write(vertex_source.data(), vertex_source.size());
+			write(out, Uint32(fragment_source.size()));
+			out.write(fragment_source.data(), fragment_source.size());
+			write(out, Uint32(format));
+			write(out, Uint32(binary.size()));
+			out.write((char const*) &binary[0], binary.size());
+
+			if (!out.good())
+			{
+				out.close();
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+
+		std::remove(destination.c_str());
+		if (std::rename(temporary.c_str(), destination.c_str()) != 0)
+		{
+			std::remove(temporary.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	void ProgramBinaryCache::remove(std::string const& vertex_source, std::string const& fragment_source) const
+	{
+		if (enabled())
+		{
+			std::remove(filename(vertex_source, fragment_source).c_str());
+		}
+	}
+
+} // namespace rengine
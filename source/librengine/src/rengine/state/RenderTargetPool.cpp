@@ -0,0 +1,62 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/state/RenderTargetPool.h>
+
+namespace rengine
+{
+	RenderTargetPool::RenderTargetPool()
+		:targets_(0)
+	{
+	}
+
+	RenderTargetPool::~RenderTargetPool()
+	{
+		clear();
+	}
+
+	RenderTargetPool::RenderTarget RenderTargetPool::acquire(Uint const width, Uint const height, DrawResource::DataFormat const internal_format)
+	{
+		Key key;
+		key.width = width;
+		key.height = height;
+		key.internal_format = internal_format;
+
+		Targets::iterator found = idle_.find(key);
+		if (found != idle_.end())
+		{
+			RenderTarget target = found->second;
+			idle_.erase(found);
+			return target;
+		}
+
+		RenderTarget target;
+		target.frame_buffer = new FrameBuffer(width, height);
+		target.texture = new Texture2D(internal_format);
+		target.frame_buffer->attach(target.texture);
+
+		++targets_;
+		return target;
+	}
+
+	void RenderTargetPool::release(RenderTarget const& target)
+	{
+		if (!target.frame_buffer || !target.texture)
+		{
+			return;
+		}
+
+		Key key;
+		key.width = target.frame_buffer->width();
+		key.height = target.frame_buffer->height();
+		key.internal_format = target.texture->getInternalFormat();
+
+		idle_.insert(Targets::value_type(key, target));
+	}
+
+	void RenderTargetPool::clear()
+	{
+		targets_ -= Uint(idle_.size());
+		idle_.clear();
+	}
+
+} // namespace rengine
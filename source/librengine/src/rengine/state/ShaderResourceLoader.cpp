@@ -2,7 +2,9 @@
 
 #include <rengine/state/ShaderResourceLoader.h>
 #include <rengine/file/File.h>
+#include <rengine/file/VirtualFileSystem.h>
 #include <rengine/string/String.h>
+#include <rengine/util/Crc32.h>
 #include <rengine/math/Vector.h>
 #include <rengine/CoreEngine.h>
 #include <rengine/outputstream/OutputStream.h>
@@ -112,7 +114,7 @@ namespace rengine
 
 		std::string source;
 
-		if (readRawText(location, source))
+		if (fileSystem().readText(location, source))
 		{
 			Shader::Type type = Shader::Fragment;
 
@@ -153,6 +155,7 @@ namespace rengine
 		default_values.clear();
 		semantics.clear();
 		symbols.clear();
+		includes.clear();
 
 		if (options.hasProperty("symbols"))
 		{
@@ -161,10 +164,25 @@ namespace rengine
 
 		SharedPointer<Program> program = new Program();
 
+		std::string const key = preprocessedKey(location);
 		std::string source;
-		readRawText(location, source);
-		std::string base_path = getFilePath(location);
-		source = preprocess(program, source, base_path);
+
+		if (!replayPreprocessed(key, program, source))
+		{
+			Bool const read = fileSystem().readText(location, source);
+			std::string base_path = getFilePath(location);
+			source = preprocess(program, source, base_path);
+
+			if (read && errors.empty())
+			{
+				storePreprocessed(key, location, program, source);
+			}
+		}
+
+		{
+			ScopedLock lock(includes_mutex);
+			program_includes[location] = includes;
+		}
 
 		std::string common_section = getSection(source, "common");
 		std::string input_vertex_section = getSection(source, "vertex");
@@ -248,17 +266,194 @@ namespace rengine
 		return program;
 	}
 
-	std::string ProgramResourceLoader::preprocess(SharedPointer<Program> program, std::string src, std::string const& base_location)
+	void ProgramResourceLoader::finalize(Program& program)
 	{
-		//
-		// Expand symbols
-		//
-		src = expandSymbols(src);
+		// the status is queried on first use, the programs finalized in a frame compile together
+		CoreEngine::instance()->renderEngine().submit(program);
+	}
+
+	void ProgramResourceLoader::sourceFiles(std::string const& location, Locations& files) const
+	{
+		files.push_back(location);
+
+		ScopedLock lock(includes_mutex);
+
+		ProgramIncludes::const_iterator found = program_includes.find(location);
+		if (found != program_includes.end())
+		{
+			files.insert(files.end(), found->second.begin(), found->second.end());
+		}
+	}
+
+	Bool ProgramResourceLoader::assign(Program& program, Program& reloaded)
+	{
+		// linked again by finalize
+		program.release();
+		program.setShader(reloaded.getShader(Shader::Vertex));
+		program.setShader(reloaded.getShader(Shader::Fragment));
+		program.inputs() = reloaded.inputs();
+		program.outputs() = reloaded.outputs();
+
+		// uniforms that still exist keep their objects and values
+		Program::Uniforms uniforms;
+		for (Program::Uniforms::iterator i = reloaded.uniforms().begin(); i != reloaded.uniforms().end(); ++i)
+		{
+			SharedPointer<Uniform> uniform = *i;
+
+			for (Program::Uniforms::iterator old = program.uniforms().begin(); old != program.uniforms().end(); ++old)
+			{
+				if (((*old)->name() == uniform->name()) && ((*old)->type() == uniform->type()) && ((*old)->size() == uniform->size()))
+				{
+					uniform = *old;
+					break;
+				}
+			}
+
+			uniform->setProgram(&program);
+			uniforms.push_back(uniform);
+		}
+		program.uniforms() = uniforms;
+
+		return true;
+	}
+
+	void ProgramResourceLoader::clearPreprocessed()
+	{
+		ScopedLock lock(preprocessed_mutex);
+		preprocessed.clear();
+	}
+
+	Uint ProgramResourceLoader::numberOfPreprocessed() const
+	{
+		ScopedLock lock(preprocessed_mutex);
+		return Uint(preprocessed.size());
+	}
+
+	ProgramResourceLoader::FileStamp ProgramResourceLoader::fileStamp(std::string const& location)
+	{
+		FileStamp stamp;
+
+		std::string const native = fileSystem().nativeFilename(location);
+		if (!native.empty())
+		{
+			stamp.time = fileModificationTime(native);
+			return stamp;
+		}
+
+		// packs and memory mounts have no times, and may be remounted with other contents
+		FileData data;
+		if (fileSystem().read(location, data))
+		{
+			stamp.checksum = crc32(0, data.bytes(), data.size);
+		}
+
+		return stamp;
+	}
+
+	std::string ProgramResourceLoader::preprocessedKey(std::string const& location) const
+	{
+		std::string key = location;
+		key += m_limitedToOpenGL21 ? "|gl21" : "|";
+
+		for (StringTable::const_iterator i = symbols.begin(); i != symbols.end(); ++i)
+		{
+			key += "|" + i->first + "=" + i->second.text;
+		}
+
+		return key;
+	}
+
+	Bool ProgramResourceLoader::replayPreprocessed(std::string const& key, SharedPointer<Program> program, std::string& source)
+	{
+		ScopedLock lock(preprocessed_mutex);
+
+		PreprocessedEffects::iterator found = preprocessed.find(key);
+		if (found == preprocessed.end())
+		{
+			return false;
+		}
+
+		PreprocessedEffect const& effect = found->second;
+
+		for (FileStamps::const_iterator i = effect.file_stamps.begin(); i != effect.file_stamps.end(); ++i)
+		{
+			if (fileStamp(i->first) != i->second)
+			{
+				preprocessed.erase(found);
+				return false;
+			}
+		}
+
+		for (UniformDeclarations::const_iterator i = effect.uniforms.begin(); i != effect.uniforms.end(); ++i)
+		{
+			program->addUniform( new Uniform(i->name, i->type, i->size) );
+		}
+
+		default_values = effect.default_values;
+		semantics = effect.semantics;
+		includes = effect.includes;
+		source = effect.source;
+
+		applyDefaultValues(program);
+
+		return true;
+	}
+
+	void ProgramResourceLoader::storePreprocessed(std::string const& key, std::string const& location, SharedPointer<Program> program, std::string const& source)
+	{
+		ScopedLock lock(preprocessed_mutex);
+
+		PreprocessedEffect& effect = preprocessed[key];
+
+		effect.source = source;
+		effect.default_values = default_values;
+		effect.semantics = semantics;
+		effect.includes = includes;
+
+		effect.uniforms.clear();
+		for (Program::Uniforms::const_iterator i = program->uniforms().begin(); i != program->uniforms().end(); ++i)
+		{
+			UniformDeclaration declaration;
+			declaration.name = (*i)->name();
+			declaration.type = (*i)->type();
+			declaration.size = (*i)->size();
+			effect.uniforms.push_back(declaration);
+		}
+
+		effect.file_stamps.clear();
+		effect.file_stamps[location] = fileStamp(location);
+		for (Locations::const_iterator i = includes.begin(); i != includes.end(); ++i)
+		{
+			effect.file_stamps[*i] = fileStamp(*i);
+		}
+	}
+
+	Bool ProgramResourceLoader::expandIncludes(std::string const& location, std::string& source)
+	{
+		errors.clear();
 
+		std::string src;
+		if (!fileSystem().readText(location, src))
+		{
+			return false;
+		}
+
+		if (!expandIncludePragmas(src, getFilePath(location)) || !errors.empty())
+		{
+			return false;
+		}
+
+		source = src;
+		return true;
+	}
+
+	Bool ProgramResourceLoader::expandIncludePragmas(std::string& src, std::string const& base_location)
+	{
 		Bool needs_next_pass = true;
 		Uint const maximum_passes = 50;
 		Uint pass = 0;
 
+		// included files may include others, expanded a level per pass
 		while (needs_next_pass && (pass < maximum_passes))
 		{
 			needs_next_pass = false;
@@ -268,90 +463,115 @@ namespace rengine
 			string_stream << src;
 			std::string line;
 
-			Action statement_action = LineCopy;
-			Action current_action = LineCopy;
-
 			while (std::getline(string_stream, line))
 			{
 				std::string clean_line = line;
 				trim(clean_line);
 
-				bool add_to_output = true;
-
-				if (current_action != AssembleStatement)
+				if (startsWith(clean_line, include_marker))
 				{
-					if (startsWith(clean_line, include_marker)) // check for include pragmas
-					{
-						output_stream << pragmaInclude(clean_line, base_location) << std::endl;
-						needs_next_pass = true;
-						add_to_output = false;
-					}
-					else if (startsWith(clean_line, default_marker)) // check for default pragmas
-					{
-						pragmaDefault(clean_line);
-					}
-					else if (startsWith(clean_line, semantic_marker)) // check for semantic pragmas
-					{
-						pragmaSemantic(clean_line);
-					}
-					else if (startsWith(clean_line, uniform_marker + " "))
-					{
-						current_action = AssembleStatement;
-						statement_action = UniformStatement;
-					}
-					else if (startsWith(clean_line, glsl_version_marker))
-					{
-						line = glslVersion(clean_line);
-					}
-					else if (startsWith(clean_line, "//"))
-					{
-
-					}
+					output_stream << pragmaInclude(clean_line, base_location) << std::endl;
+					needs_next_pass = true;
 				}
+				else
+				{
+					output_stream << line << std::endl;
+				}
+			}
 
+			src = output_stream.str();
+			++pass;
+		}
 
-				//
-				// Assemble Current Statement
-				//
-				if (current_action == AssembleStatement)
-				{
-					addToStatement(clean_line);
+		return !needs_next_pass;
+	}
 
-					if (statementEnded())
-					{
-						current_action = LineCopy;
-					}
-				}
+	std::string ProgramResourceLoader::preprocess(SharedPointer<Program> program, std::string src, std::string const& base_location)
+	{
+		//
+		// Expand symbols
+		//
+		src = expandSymbols(src);
+
+		//
+		// Expand includes, then handle the other pragmas
+		//
+		if (!expandIncludePragmas(src, base_location))
+		{
+			errors += "Processing passes exhausted\n";
+		}
+
+		std::stringstream output_stream;
+		std::stringstream string_stream;
+		string_stream << src;
+		std::string line;
+
+		Action statement_action = LineCopy;
+		Action current_action = LineCopy;
 
-				//
-				// Handle Statement
-				//
-				if ( (current_action == LineCopy) && (statement.size() != 0) )
+		while (std::getline(string_stream, line))
+		{
+			std::string clean_line = line;
+			trim(clean_line);
+
+			if (current_action != AssembleStatement)
+			{
+				if (startsWith(clean_line, default_marker)) // check for default pragmas
+				{
+					pragmaDefault(clean_line);
+				}
+				else if (startsWith(clean_line, semantic_marker)) // check for semantic pragmas
+				{
+					pragmaSemantic(clean_line);
+				}
+				else if (startsWith(clean_line, uniform_marker + " "))
+				{
+					current_action = AssembleStatement;
+					statement_action = UniformStatement;
+				}
+				else if (startsWith(clean_line, glsl_version_marker))
+				{
+					line = glslVersion(clean_line);
+				}
+				else if (startsWith(clean_line, "//"))
 				{
-					if (statement_action == UniformStatement)
-					{
-						declarationUniform(program, statement);
-					}
 
-					statement.clear();
 				}
+			}
+
+
+			//
+			// Assemble Current Statement
+			//
+			if (current_action == AssembleStatement)
+			{
+				addToStatement(clean_line);
 
+				if (statementEnded())
+				{
+					current_action = LineCopy;
+				}
+			}
 
-				if (add_to_output)
+			//
+			// Handle Statement
+			//
+			if ( (current_action == LineCopy) && (statement.size() != 0) )
+			{
+				if (statement_action == UniformStatement)
 				{
-					output_stream << line << std::endl;
+					declarationUniform(program, statement);
 				}
+
+				statement.clear();
 			}
 
-			src = output_stream.str();
-			++pass;
-		}
 
-		if (pass >= maximum_passes)
-		{
-			errors += "Processing passes exhausted\n";
+			output_stream << line << std::endl;
 		}
 
+		src = output_stream.str();
+
 
 		if (errors.empty())
 		{
@@ -655,7 +875,9 @@ namespace rengine
 
 		std::string file_contents;
 		std::string filename = convertFileNameToNativeStyle(base_location + "/" + file);
-		if (readRawText(filename, file_contents))
+		includes.push_back(filename);
+
+		if (fileSystem().readText(filename, file_contents))
 		{
 			std::string current_base_location = getFilePath(file);
 			trim(current_base_location);
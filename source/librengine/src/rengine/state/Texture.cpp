@@ -3,6 +3,7 @@
 #include <rengine/CoreEngine.h>
 #include <rengine/RenderEngine.h>
 #include <rengine/state/Texture.h>
+#include <rengine/image/Mipmap.h>
 #include <rengine/state/Streams.h>
 #include <rengine/lang/debug/Debug.h>
 
@@ -40,6 +41,8 @@ namespace rengine
 	void Texture2D::initialize()
 	{
 		image = 0;
+		mipmaps_ = 0;
+		mipmap_builder_ = 0;
 
 		flags = Texture2D::None;
 		flags |= ReleaseImage;
@@ -64,7 +67,12 @@ namespace rengine
 	void Texture2D::release()
 	{
 		// TODO : this should be implemented with an observer
-		CoreEngine::instance()->renderEngine().unloadTexture(*this);
+		// textures built by tools without an engine were never uploaded
+		CoreEngine* engine = CoreEngine::instance();
+		if (engine)
+		{
+			engine->renderEngine().unloadTexture(*this);
+		}
 
 		initialize();
 	}
@@ -75,6 +83,9 @@ namespace rengine
 
 		if (this->image.get())
 		{
+			// chain of the previous image is stale
+			releaseMipmaps();
+
 			width = image->getWidth();
 			height = image->getHeight();
 			color_channels = image->getColorChannels();
@@ -118,6 +129,79 @@ namespace rengine
 
 	}
 
+	void Texture2D::buildMipmaps(Bool const asynchronous)
+	{
+		releaseMipmaps();
+
+		if (!image)
+		{
+			return;
+		}
+
+		if (asynchronous)
+		{
+			mipmap_builder_ = new MipmapBuilder(image);
+			mipmap_builder_->start();
+		}
+		else
+		{
+			mipmaps_ = new MipmapChain();
+			mipmaps_->build(image, BoxFilter());
+			changeFlags() |= MipmapDataChanged;
+		}
+	}
+
+	void Texture2D::setMipmaps(SharedPointer<MipmapChain> const& mipmaps)
+	{
+		releaseMipmaps();
+
+		mipmaps_ = mipmaps;
+		changeFlags() |= MipmapDataChanged;
+	}
+
+	void Texture2D::releaseMipmaps()
+	{
+		mipmap_builder_ = 0;
+		mipmaps_ = 0;
+	}
+
+	Bool Texture2D::collectMipmaps()
+	{
+		if (mipmap_builder_ && mipmap_builder_->finished())
+		{
+			mipmap_builder_->stop();
+			mipmaps_ = mipmap_builder_->chain();
+			mipmap_builder_ = 0;
+
+			changeFlags() |= MipmapDataChanged;
+			return true;
+		}
+
+		return false;
+	}
+
+	Uint64 Texture2D::memorySize() const
+	{
+		Uint64 const level_size = Uint64(width) * Uint64(height) * Uint64(color_channels);
+
+		// a full chain adds a third of the base level
+		Bool const mipmapped = (min_filter >= NearestMipmapNearest) || isFlagSet(GenerateMipmap) || mipmaps_;
+		Uint64 size = mipmapped ? (level_size + level_size / 3) : level_size;
+
+		if (image)
+		{
+			size += Uint64(image->getWidth()) * Uint64(image->getHeight()) * Uint64(image->getColorChannels());
+		}
+
+		for (Uint level = 1; mipmaps_ && (level < mipmaps_->numberOfLevels()); ++level)
+		{
+			Image const& current = *mipmaps_->level(level);
+			size += Uint64(current.getWidth()) * Uint64(current.getHeight()) * Uint64(current.getColorChannels());
+		}
+
+		return size;
+	}
+
 	void Texture2D::setInternalFormat(DataFormat const& internal_format)
 	{
 		changeFlags() |= ImageDataChanged;
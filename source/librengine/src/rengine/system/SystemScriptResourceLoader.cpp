@@ -1,7 +1,7 @@
 // __!!rengine_copyright!!__ //
 
 #include <rengine/system/SystemScriptResourceLoader.h>
-#include <rengine/file/File.h>
+#include <rengine/file/VirtualFileSystem.h>
 
 namespace rengine
 {
@@ -23,7 +23,7 @@ namespace rengine
 
 		std::string script_text;
 
-		if (readRawText(location, script_text))
+		if (fileSystem().readText(location, script_text))
 		{
 			script = new SystemScript();
 
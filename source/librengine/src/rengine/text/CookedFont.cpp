@@ -0,0 +1,238 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/text/Fonts.h>
+
+#include <cstring>
+
+//
+// Cooked font payload, little endian:
+//	"RFNT", source size, source bytes, name length, name,
+//	resolution (x, y), margin (x, y), number of glyphs,
+//	per glyph: code, dimension (x, y), texture coords (u, v), advance, bearing x, bearing y
+//	atlas width, height, channels, pixels
+// Reals are stored as their 32 bit pattern.
+//
+
+namespace rengine
+{
+	Uint32 const CookedFont::magic;
+
+	static void put32(std::vector<Uint8>& out, Uint32 const value)
+	{
+		out.push_back(Uint8(value));
+		out.push_back(Uint8(value >> 8));
+		out.push_back(Uint8(value >> 16));
+		out.push_back(Uint8(value >> 24));
+	}
+
+	static void putReal(std::vector<Uint8>& out, Real32 const value)
+	{
+		Uint32 bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		put32(out, bits);
+	}
+
+	//
+	// bounds checked reader of a payload
+	//
+	class CookedFontReader
+	{
+	public:
+		CookedFontReader(Uint8 const* data, Uint const size)
+			:current_(data), end_(data + size), good_(true)
+		{
+		}
+
+		Uint32 get32()
+		{
+			Uint8 const* bytes = skip(4);
+			return bytes ? (Uint32(bytes[0]) | (Uint32(bytes[1]) << 8) | (Uint32(bytes[2]) << 16) | (Uint32(bytes[3]) << 24)) : 0;
+		}
+
+		Real32 getReal()
+		{
+			Uint32 const bits = get32();
+			Real32 value = 0.0f;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// returns 0 when the payload is shorter
+		Uint8 const* skip(Uint const size)
+		{
+			if (!good_ || (Uint(end_ - current_) < size))
+			{
+				good_ = false;
+				return 0;
+			}
+
+			Uint8 const* bytes = current_;
+			current_ += size;
+			return bytes;
+		}
+
+		Bool good() const
+		{
+			return good_;
+		}
+
+		Uint remaining() const
+		{
+			return Uint(end_ - current_);
+		}
+	private:
+		Uint8 const* current_;
+		Uint8 const* end_;
+		Bool good_;
+	};
+
+	CookedFont::CookedFont()
+	{
+	}
+
+	CookedFont::~CookedFont()
+	{
+	}
+
+	Bool CookedFont::isCooked(Uint8 const* data, Uint const size)
+	{
+		CookedFontReader reader(data, size);
+		return (reader.get32() == magic) && reader.good();
+	}
+
+	Bool CookedFont::source(Uint8 const* data, Uint const size, Uint8 const*& source, Uint& source_size)
+	{
+		CookedFontReader reader(data, size);
+		if (reader.get32() != magic)
+		{
+			return false;
+		}
+
+		source_size = reader.get32();
+		source = reader.skip(source_size);
+
+		return reader.good();
+	}
+
+	Bool CookedFont::cook(Font const& font, Uint8 const* source, Uint const source_size, std::vector<Uint8>& out)
+	{
+		SharedPointer<Image> image = font.texture() ? font.texture()->getImage() : SharedPointer<Image>();
+		if (!image)
+		{
+			return false;
+		}
+
+		out.clear();
+		put32(out, magic);
+		put32(out, source_size);
+		out.insert(out.end(), source, source + source_size);
+
+		put32(out, Uint32(font.name().size()));
+		out.insert(out.end(), font.name().begin(), font.name().end());
+
+		put32(out, font.resolution().x());
+		put32(out, font.resolution().y());
+		putReal(out, font.margin().x());
+		putReal(out, font.margin().y());
+
+		put32(out, Uint32(font.glyphMap().size()));
+		for (GlyphMap::const_iterator i = font.glyphMap().begin(); i != font.glyphMap().end(); ++i)
+		{
+			Glyph const& glyph = *i->second;
+			put32(out, glyph.code());
+			put32(out, glyph.dimension().x());
+			put32(out, glyph.dimension().y());
+			putReal(out, glyph.textureCoords().x());
+			putReal(out, glyph.textureCoords().y());
+			putReal(out, glyph.advance());
+			putReal(out, glyph.bearingX());
+			putReal(out, glyph.bearingY());
+		}
+
+		put32(out, image->getWidth());
+		put32(out, image->getHeight());
+		put32(out, image->getColorChannels());
+		out.insert(out.end(), image->getData(), image->getData() + image->getWidth() * image->getHeight() * image->getColorChannels());
+
+		return true;
+	}
+
+	Bool CookedFont::load(Uint8 const* data, Uint const size)
+	{
+		CookedFontReader reader(data, size);
+
+		if (reader.get32() != magic)
+		{
+			return false;
+		}
+
+		reader.skip(reader.get32());
+
+		Uint32 const name_length = reader.get32();
+		Char const* name = (Char const*) reader.skip(name_length);
+
+		Uint32 const resolution_x = reader.get32();
+		Uint32 const resolution_y = reader.get32();
+		Real32 const margin_x = reader.getReal();
+		Real32 const margin_y = reader.getReal();
+
+		GlyphMap glyphs;
+		Uint32 const number_of_glyphs = reader.get32();
+
+		for (Uint32 i = 0; (i != number_of_glyphs) && reader.good(); ++i)
+		{
+			SharedPointer<Glyph> glyph = new Glyph();
+			glyph->setCode(reader.get32());
+
+			Uint32 const width = reader.get32();
+			Uint32 const height = reader.get32();
+			glyph->setDimension(Glyph::Dimension(width, height));
+
+			Real32 const u = reader.getReal();
+			Real32 const v = reader.getReal();
+			glyph->setTextureCoords(Glyph::TextureCoords(u, v));
+
+			glyph->setAdvance(reader.getReal());
+			glyph->setBearingX(reader.getReal());
+			glyph->setBearingY(reader.getReal());
+
+			glyphs[glyph->code()] = glyph;
+		}
+
+		Uint32 const width = reader.get32();
+		Uint32 const height = reader.get32();
+		Uint32 const channels = reader.get32();
+
+		// 64 bit, the area bound keeps a damaged size from wrapping
+		if (!reader.good() || (width == 0) || (height == 0) || (channels == 0) || (channels > 4) ||
+			(Uint64(width) * Uint64(height) > reader.remaining()) ||
+			(Uint64(width) * Uint64(height) * Uint64(channels) > reader.remaining()))
+		{
+			return false;
+		}
+
+		Uint const pixels_size = width * height * channels;
+		Uint8 const* pixels = reader.skip(pixels_size);
+		if (!pixels)
+		{
+			return false;
+		}
+
+		SharedPointer<Image> image = new Image(width, height, channels);
+		memcpy(image->getData(), pixels, pixels_size);
+
+		name_.assign(name, name_length);
+		setResolution(Resolution(resolution_x, resolution_y));
+		setMarging(Margin(margin_x, margin_y));
+
+		for (GlyphMap::const_iterator i = glyphs.begin(); i != glyphs.end(); ++i)
+		{
+			addGlyph(i->first, i->second);
+		}
+
+		texture_ = new Texture2D(image);
+
+		return true;
+	}
+
+} // namespace rengine
@@ -2,11 +2,63 @@
 
 #include <rengine/text/FontResourceLoader.h>
 #include <rengine/text/Fonts.h>
-#include <rengine/file/File.h>
+#include <rengine/file/VirtualFileSystem.h>
 #include <rengine/string/String.h>
+#include <rengine/CoreEngine.h>
+#include <rengine/RenderEngine.h>
 
 namespace rengine
 {
+	//
+	// Fonts cooked by rengineAssetCooker hold the baked atlas, it is used when the default options are requested.
+	// Other options rasterize the source font kept in the payload, bytes and size are set to it.
+	//
+	static Bool fontData(FileData const& data, OpaqueProperties const& options, SharedPointer<Font>& cooked, Uint8 const*& bytes, Uint& size)
+	{
+		bytes = data.bytes();
+		size = data.size;
+
+		if (!CookedFont::isCooked(bytes, size))
+		{
+			return true;
+		}
+
+		if (options.empty())
+		{
+			SharedPointer<CookedFont> font = new CookedFont();
+			if (!font->load(bytes, size))
+			{
+				return false;
+			}
+
+			cooked = font;
+			return true;
+		}
+
+		return CookedFont::source(data.bytes(), data.size, bytes, size);
+	}
+
+	// uploads the glyph atlas of an asynchronous load
+	static void finalizeFont(Font& font)
+	{
+		if (font.texture())
+		{
+			CoreEngine::instance()->renderEngine().prepare(*font.texture());
+		}
+	}
+
+	// the glyph atlas and the glyphs
+	static Uint64 fontSize(Font const& font)
+	{
+		Uint64 size = sizeof(Font) + font.glyphMap().size() * sizeof(Font::Glyph);
+		if (font.texture())
+		{
+			size += font.texture()->memorySize();
+		}
+
+		return size;
+	}
+
 	Bool DefaultFontsResourceLoader::suportsFormat(std::string const& extension) const
 	{
 		Bool can_load = false;
@@ -24,6 +76,11 @@ namespace rengine
 		return suportsFormat(resource_location);
 	}
 
+	Uint64 DefaultFontsResourceLoader::resourceSize(Font const& font) const
+	{
+		return fontSize(font);
+	}
+
 	SharedPointer<Font> DefaultFontsResourceLoader::loadImplementation(std::string const& location, OpaqueProperties const& options)
 	{
 		SharedPointer<Font> font;
@@ -55,6 +112,21 @@ namespace rengine
 		return equalCaseInsensitive(extension, "fon");
 	}
 
+	Bool WinfontResourceLoader::supportsConcurrentLoads() const
+	{
+		return true;
+	}
+
+	void WinfontResourceLoader::finalize(Font& font)
+	{
+		finalizeFont(font);
+	}
+
+	Uint64 WinfontResourceLoader::resourceSize(Font const& font) const
+	{
+		return fontSize(font);
+	}
+
 	SharedPointer<Font> WinfontResourceLoader::loadImplementation(std::string const& location, OpaqueProperties const& options)
 	{
 		SharedPointer<Winfont> font = new Winfont();
@@ -77,7 +149,22 @@ namespace rengine
 			font->setLastGlyphCode(code);
 		}
 
-		if (!font->load(location))
+		FileData data;
+		SharedPointer<Font> cooked;
+		Uint8 const* bytes = 0;
+		Uint size = 0;
+
+		if (!fileSystem().read(location, data) || !fontData(data, options, cooked, bytes, size))
+		{
+			return SharedPointer<Font>();
+		}
+
+		if (cooked)
+		{
+			return cooked;
+		}
+
+		if (!font->load(bytes, size))
 		{
 			font = 0;
 		}
@@ -92,6 +179,21 @@ namespace rengine
 		return equalCaseInsensitive(extension, "ttf");
 	}
 
+	Bool TruetypeFontResourceLoader::supportsConcurrentLoads() const
+	{
+		return true;
+	}
+
+	void TruetypeFontResourceLoader::finalize(Font& font)
+	{
+		finalizeFont(font);
+	}
+
+	Uint64 TruetypeFontResourceLoader::resourceSize(Font const& font) const
+	{
+		return fontSize(font);
+	}
+
 	SharedPointer<Font> TruetypeFontResourceLoader::loadImplementation(std::string const& location, OpaqueProperties const& options)
 	{
 
@@ -114,7 +216,22 @@ namespace rengine
 			font->setPixelHeight(pixel_height);
 		}
 
-		if (!font->load(location))
+		FileData data;
+		SharedPointer<Font> cooked;
+		Uint8 const* bytes = 0;
+		Uint size = 0;
+
+		if (!fileSystem().read(location, data) || !fontData(data, options, cooked, bytes, size))
+		{
+			return SharedPointer<Font>();
+		}
+
+		if (cooked)
+		{
+			return cooked;
+		}
+
+		if (!font->load(bytes, size))
 		{
 			font = 0;
 		}
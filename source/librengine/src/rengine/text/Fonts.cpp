@@ -323,7 +323,9 @@ namespace rengine
 		}
 
 		SharedPointer<Texture2D> texture = new Texture2D();
-		image->makeOpenGlCompliant(true, !CoreEngine::instance()->renderEngine().supportsNonPowerOfTwoTextures());
+		// fonts may be built without an engine, by rengineAssetCooker
+		CoreEngine const* engine = CoreEngine::instance();
+		image->makeOpenGlCompliant(true, engine && !engine->renderEngine().supportsNonPowerOfTwoTextures());
 		texture->setImage(image);
 
 		return texture;
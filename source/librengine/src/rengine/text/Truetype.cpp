@@ -2,7 +2,7 @@
 
 #include <rengine/text/Fonts.h>
 #include <rengine/lang/Lang.h>
-#include <fstream>
+#include <rengine/file/VirtualFileSystem.h>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #define STBTT_malloc(x,u)  rg_malloc(x)
@@ -24,26 +24,24 @@ namespace rengine
 
 	Bool Truetypefont::load(std::string const& filename)
 	{
-		SharedArray<Uchar> ttf;
+		FileData data;
+		if (!VirtualFileSystem::DirectoryMount().read(filename, data))
+		{
+			return false;
+		}
 
-		Bool is_good = true;
-		std::ifstream in(filename.c_str(), std::ios::in | std::ios::ate | std::ios::binary);
-		is_good = in.good();
+		return load(data.bytes(), data.size);
+	}
 
-		if (is_good)
+	Bool Truetypefont::load(Uint8 const* data, Uint const size)
+	{
+		if (!data || !size)
 		{
-			Ulong end_position = Ulong(in.tellg());
-			ttf = new Uchar[end_position];
-
-			in.seekg(0, std::ios::beg);
-			in.read((char*)ttf.get(), end_position);
-			is_good = in.good();
-			in.close();
+			return false;
 		}
 
 		SharedArray<stbtt_bakedchar> baked_data = new stbtt_bakedchar[last_glyph - first_glyph];
 		Int const texture_width = 256;
-		Uchar* data = ttf.get();
 		Int const offset = 0; 
 		SharedPointer<Image> pixels = new Image(texture_width, texture_width, 1);
 
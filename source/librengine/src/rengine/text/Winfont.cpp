@@ -2,11 +2,11 @@
 
 #include <rengine/text/Fonts.h>
 #include <rengine/lang/Lang.h>
+#include <rengine/file/VirtualFileSystem.h>
 
 #include <cstdlib>
 #include <cstring>
 #include <climits>
-#include <fstream>
 #include <sstream>
 
 //fntheader.type
@@ -235,7 +235,7 @@ namespace rengine
 
 	Bool Winfont::load(std::istream& in)
 	{
-		typedef std::ifstream::pos_type Position;
+		typedef std::istream::pos_type Position;
 
 		Position initial_position = in.tellg();
 
@@ -414,14 +414,21 @@ namespace rengine
 
 	Bool Winfont::load(std::string const& filename)
 	{
-		Bool state = false;
-
-		std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
-		if (!in.is_open())
+		FileData data;
+		if (!VirtualFileSystem::DirectoryMount().read(filename, data))
 		{
-			return state;
+			return false;
 		}
 
+		return load(data.bytes(), data.size);
+	}
+
+	Bool Winfont::load(Uint8 const* data, Uint const size)
+	{
+		Bool state = false;
+
+		std::istringstream in(std::string((Char const*) data, size), std::ios::in | std::ios::binary);
+
 		Uint16 magic = 0;
 		read16(in, (Char*) &magic);
 		if ((magic == 0x200) || (magic == 0x300))
@@ -506,7 +513,7 @@ namespace rengine
 
 					for (Uint i = 0; i != max_loaded_fonts; ++i)
 					{
-						std::ifstream::pos_type position = in.tellg();
+						std::istream::pos_type position = in.tellg();
 						offset = 0;
 						read16(in, (Char*) &offset);
 						offset = offset << shift_size;
@@ -520,8 +527,6 @@ namespace rengine
 			}
 		}
 
-		in.close();
-
 		return state;
 	}
 
@@ -0,0 +1,80 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/thread/ParallelFor.h>
+#include <rengine/thread/Thread.h>
+#include <rengine/math/Math.h>
+
+#include <vector>
+
+namespace rengine
+{
+	class ParallelForWorker : public Thread
+	{
+	public:
+		ParallelForWorker(ParallelRange& range, Uint const begin, Uint const end)
+			:m_range(range), m_begin(begin), m_end(end)
+		{}
+
+		virtual void run()
+		{
+			m_range(m_begin, m_end);
+		}
+
+	private:
+		ParallelRange& m_range;
+		Uint m_begin;
+		Uint m_end;
+	};
+
+	void parallelFor(ParallelRange& range, Uint const count, Uint const threads, Uint const minimum_block)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		Uint workers = threads;
+		if (workers == 0)
+		{
+			workers = Uint( maximum(Thread::numberOfProcessors(), 1) );
+		}
+
+		Uint const block = maximum(minimum_block, Uint(1));
+		workers = minimum(workers, (count + block - 1) / block);
+
+		if (workers <= 1)
+		{
+			range(0, count);
+			return;
+		}
+
+		Uint const items_per_worker = count / workers;
+		Uint const remainder = count % workers;
+
+		std::vector<ParallelForWorker*> running;
+		running.reserve(workers - 1);
+
+		Uint begin = 0;
+		Uint end = items_per_worker + ((remainder > 0) ? 1 : 0);
+		Uint const first_end = end;
+
+		for (Uint worker = 1; worker != workers; ++worker)
+		{
+			begin = end;
+			end = begin + items_per_worker + ((worker < remainder) ? 1 : 0);
+
+			ParallelForWorker* thread = new ParallelForWorker(range, begin, end);
+			thread->start();
+			running.push_back(thread);
+		}
+
+		range(0, first_end);
+
+		for (std::vector<ParallelForWorker*>::iterator i = running.begin(); i != running.end(); ++i)
+		{
+			(*i)->stop();
+			delete(*i);
+		}
+	}
+
+} // namespace rengine
@@ -0,0 +1,211 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/time/FrameProfiler.h>
+#include <rengine/lang/debug/Debug.h>
+
+#include <algorithm>
+
+namespace rengine
+{
+	FrameProfiler::Statistics::Statistics()
+		:samples(0), minimum(0.0), average(0.0), percentile_95(0.0), percentile_99(0.0), maximum(0.0)
+	{
+	}
+
+	FrameProfiler::FrameProfiler(Uint const window)
+		:window_((window > 0) ? window : 1)
+	{
+		section("frame");
+	}
+
+	void FrameProfiler::setWindow(Uint const frames)
+	{
+		window_ = (frames > 0) ? frames : 1;
+		clear();
+	}
+
+	FrameProfiler::SectionId FrameProfiler::section(std::string const& name)
+	{
+		SectionIds::const_iterator found = section_ids_.find(name);
+		if (found != section_ids_.end())
+		{
+			return found->second;
+		}
+
+		Section section;
+		section.name = name;
+		section.scope = Profiler::instance().intern(name.c_str());
+		section.depth = 0;
+		section.frame_time = 0.0;
+		section.ran = false;
+		section.next = 0;
+
+		SectionId const id = SectionId(sections_.size());
+		sections_.push_back(section);
+		section_ids_[name] = id;
+
+		return id;
+	}
+
+	void FrameProfiler::beginFrame()
+	{
+		open_.clear();
+		begin(FrameSection);
+	}
+
+	void FrameProfiler::endFrame()
+	{
+		while (!open_.empty())
+		{
+			end(open_.back().section);
+		}
+
+		for (Sections::iterator i = sections_.begin(); i != sections_.end(); ++i)
+		{
+			if (i->ran)
+			{
+				addSample(*i, i->frame_time);
+				i->frame_time = 0.0;
+				i->ran = false;
+			}
+		}
+	}
+
+	void FrameProfiler::begin(SectionId const section)
+	{
+		RENGINE_ASSERT(section < sections_.size());
+
+		sections_[section].depth = Uint(open_.size());
+
+		OpenSection open;
+		open.section = section;
+		open.traced = Profiler::instance().enabled();
+		if (open.traced)
+		{
+			Profiler::instance().begin(sections_[section].scope);
+		}
+		open.start = Profiler::now();
+
+		open_.push_back(open);
+	}
+
+	void FrameProfiler::end(SectionId const section)
+	{
+		Profiler::Nanoseconds const end_time = Profiler::now();
+
+		Bool opened = false;
+		for (OpenSections::const_iterator i = open_.begin(); i != open_.end(); ++i)
+		{
+			opened = opened || (i->section == section);
+		}
+
+		if (!opened)
+		{
+			return;
+		}
+
+		// sections closed out of order close the ones opened after them
+		while (!open_.empty())
+		{
+			OpenSection const open = open_.back();
+			open_.pop_back();
+
+			if (open.traced)
+			{
+				Profiler::instance().end(sections_[open.section].scope);
+			}
+
+			record(open.section, Real64(end_time - open.start) / 1000000.0);
+
+			if (open.section == section)
+			{
+				break;
+			}
+		}
+	}
+
+	void FrameProfiler::record(SectionId const section, Real64 const milliseconds)
+	{
+		RENGINE_ASSERT(section < sections_.size());
+
+		// nested in the sections open around it, as a timed section would be
+		sections_[section].depth = Uint(open_.size());
+		sections_[section].frame_time += milliseconds;
+		sections_[section].ran = true;
+	}
+
+	void FrameProfiler::addSample(Section& section, Real64 const milliseconds)
+	{
+		if (section.samples.size() < window_)
+		{
+			section.samples.push_back(milliseconds);
+		}
+		else
+		{
+			section.samples[section.next] = milliseconds;
+		}
+
+		section.next = (section.next + 1) % window_;
+	}
+
+	FrameProfiler::Samples FrameProfiler::samples(SectionId const section) const
+	{
+		RENGINE_ASSERT(section < sections_.size());
+
+		Section const& source = sections_[section];
+		if (source.samples.size() < window_)
+		{
+			return source.samples;
+		}
+
+		Samples ordered(source.samples.begin() + source.next, source.samples.end());
+		ordered.insert(ordered.end(), source.samples.begin(), source.samples.begin() + source.next);
+		return ordered;
+	}
+
+	FrameProfiler::Statistics FrameProfiler::statistics(SectionId const section) const
+	{
+		RENGINE_ASSERT(section < sections_.size());
+
+		Statistics statistics;
+
+		Samples sorted = sections_[section].samples;
+		if (sorted.empty())
+		{
+			return statistics;
+		}
+		std::sort(sorted.begin(), sorted.end());
+
+		Real64 total = 0.0;
+		for (Samples::const_iterator i = sorted.begin(); i != sorted.end(); ++i)
+		{
+			total += *i;
+		}
+
+		Uint const count = Uint(sorted.size());
+		// ceil(count * percent / 100), at least 1
+		Uint const rank_95 = (95 * count + 99) / 100;
+		Uint const rank_99 = (99 * count + 99) / 100;
+
+		statistics.samples = count;
+		statistics.minimum = sorted.front();
+		statistics.maximum = sorted.back();
+		statistics.average = total / Real64(count);
+		statistics.percentile_95 = sorted[rank_95 - 1];
+		statistics.percentile_99 = sorted[rank_99 - 1];
+
+		return statistics;
+	}
+
+	void FrameProfiler::clear()
+	{
+		for (Sections::iterator i = sections_.begin(); i != sections_.end(); ++i)
+		{
+			i->samples.clear();
+			i->next = 0;
+			i->frame_time = 0.0;
+			i->ran = false;
+		}
+	}
+
+} // namespace rengine
@@ -1,17 +0,0 @@
-// __!!rengine_copyright!!__ //
-
-#include <rengine/time/PerformanceAnalyzer.h>
-
-namespace rengine
-{
-
-Timer PerformanceAnalyzer::timer_;
-PerformanceAnalyzer::QueryResultSetMap PerformanceAnalyzer::queries_;
-PerformanceAnalyzer::MarkerQuery::ToggleQueryMap PerformanceAnalyzer::MarkerQuery::toggle_queries_;
-
-
-} //namespace rengine
-
-
-
-
@@ -0,0 +1,436 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/time/Profiler.h>
+#include <rengine/string/String.h>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+#include <windows.h>
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+#include <pthread.h>
+#include <sys/time.h>
+#include <time.h>
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+namespace rengine
+{
+	static Uint const default_buffer_size = 16 * 1024;
+	static Uint const default_trace_size = 1024 * 1024;
+
+	//
+	// Ring of events written by a single thread
+	//
+	struct Profiler::ThreadBuffer
+	{
+		ThreadBuffer(Uint const thread, Uint const size)
+			:id(thread), events(size), mask(size - 1), write_position(0), read_position(0), finished(0)
+		{
+		}
+
+		Uint const id;
+		std::string name;
+		Events events;
+		Uint64 const mask;
+
+		// events written, only the owner thread increments it
+		Atomic write_position;
+		// events already collected, only touched by collect
+		Uint64 read_position;
+		// set when the owner thread exits
+		Atomic finished;
+	};
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+	// Win32 tls has no exit callback, buffers of finished threads are kept
+	struct ProfilerThreadKey
+	{
+		ProfilerThreadKey()
+		{
+			key = TlsAlloc();
+		}
+
+		~ProfilerThreadKey()
+		{
+			TlsFree(key);
+		}
+
+		Profiler::ThreadBuffer* get() const
+		{
+			return (Profiler::ThreadBuffer*) TlsGetValue(key);
+		}
+
+		void set(Profiler::ThreadBuffer* buffer)
+		{
+			TlsSetValue(key, buffer);
+		}
+
+		DWORD key;
+	};
+#else //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+	struct ProfilerThreadKey
+	{
+		ProfilerThreadKey()
+		{
+			pthread_key_create(&key, threadFinished);
+		}
+
+		~ProfilerThreadKey()
+		{
+			pthread_key_delete(key);
+		}
+
+		Profiler::ThreadBuffer* get() const
+		{
+			return (Profiler::ThreadBuffer*) pthread_getspecific(key);
+		}
+
+		void set(Profiler::ThreadBuffer* buffer)
+		{
+			pthread_setspecific(key, buffer);
+		}
+
+		// the buffer is released by the next collect
+		static void threadFinished(void* buffer)
+		{
+			((Profiler::ThreadBuffer*) buffer)->finished = 1;
+		}
+
+		pthread_key_t key;
+	};
+#endif //RENGINE_PLATFORM != RENGINE_PLATFORM_WIN32
+
+	static ProfilerThreadKey& threadKey()
+	{
+		// threads may record while statics are destroyed, never released
+		static ProfilerThreadKey* key = new ProfilerThreadKey();
+		return *key;
+	}
+
+	static std::string escapeJson(std::string const& text)
+	{
+		std::stringstream escaped;
+
+		for (std::string::const_iterator i = text.begin(); i != text.end(); ++i)
+		{
+			Uchar const character = Uchar(*i);
+
+			if ((character == '"') || (character == '\\'))
+			{
+				escaped << '\\' << *i;
+			}
+			else if (character < 0x20)
+			{
+				escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << Uint(character) << std::dec;
+			}
+			else
+			{
+				escaped << *i;
+			}
+		}
+
+		return escaped.str();
+	}
+
+	Profiler& Profiler::instance()
+	{
+		// threads may record while statics are destroyed, never released
+		static Profiler* profiler = new Profiler();
+		return *profiler;
+	}
+
+	Profiler::Profiler()
+		:enabled_(false), buffer_size_(default_buffer_size), trace_size_(default_trace_size), start_time_(now()), registered_threads_(0)
+	{
+		threadKey();
+	}
+
+	Profiler::~Profiler()
+	{
+		for (ThreadBuffers::iterator i = buffers_.begin(); i != buffers_.end(); ++i)
+		{
+			delete(*i);
+		}
+	}
+
+#if RENGINE_PLATFORM == RENGINE_PLATFORM_WIN32
+	Profiler::Nanoseconds Profiler::now()
+	{
+		static LARGE_INTEGER frequency = { 0 };
+		if (frequency.QuadPart == 0)
+		{
+			QueryPerformanceFrequency(&frequency);
+		}
+
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+
+		// split, the product overflows after a few hours of uptime
+		Uint64 const ticks = Uint64(counter.QuadPart);
+		Uint64 const ticks_per_second = Uint64(frequency.QuadPart);
+		return (ticks / ticks_per_second) * 1000000000ULL + ((ticks % ticks_per_second) * 1000000000ULL) / ticks_per_second;
+	}
+#elif RENGINE_PLATFORM == RENGINE_PLATFORM_LINUX
+	Profiler::Nanoseconds Profiler::now()
+	{
+		struct timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		return Nanoseconds(time.tv_sec) * 1000000000ULL + Nanoseconds(time.tv_nsec);
+	}
+#else
+	Profiler::Nanoseconds Profiler::now()
+	{
+		struct timeval time;
+		gettimeofday(&time, 0);
+		return Nanoseconds(time.tv_sec) * 1000000000ULL + Nanoseconds(time.tv_usec) * 1000ULL;
+	}
+#endif
+
+	void Profiler::setBufferSize(Uint const events)
+	{
+		Uint size = 2;
+		while (size < events)
+		{
+			size <<= 1;
+		}
+
+		ScopedLock lock(buffers_mutex_);
+		buffer_size_ = size;
+	}
+
+	Uint Profiler::bufferSize() const
+	{
+		ScopedLock lock(buffers_mutex_);
+		return buffer_size_;
+	}
+
+	void Profiler::setTraceSize(Uint const events)
+	{
+		ScopedLock lock(buffers_mutex_);
+		trace_size_ = events;
+	}
+
+	Uint Profiler::traceSize() const
+	{
+		ScopedLock lock(buffers_mutex_);
+		return trace_size_;
+	}
+
+	Profiler::ScopeId Profiler::intern(Char const* name)
+	{
+		ScopedLock lock(scopes_mutex_);
+
+		std::string const scope_name(name);
+		ScopeIds::const_iterator found = scope_ids_.find(scope_name);
+		if (found != scope_ids_.end())
+		{
+			return found->second;
+		}
+
+		ScopeId const id = ScopeId(scope_names_.size());
+		scope_ids_[scope_name] = id;
+		scope_names_.push_back(scope_name);
+
+		return id;
+	}
+
+	std::string Profiler::scopeName(ScopeId const scope) const
+	{
+		ScopedLock lock(scopes_mutex_);
+		return (scope < scope_names_.size()) ? scope_names_[scope] : std::string();
+	}
+
+	Profiler::ThreadBuffer* Profiler::threadBuffer()
+	{
+		ThreadBuffer* buffer = threadKey().get();
+
+		if (!buffer)
+		{
+			ScopedLock lock(buffers_mutex_);
+
+			buffer = new ThreadBuffer(registered_threads_++, buffer_size_);
+			buffer->name = "thread " + lexical_cast<std::string>(buffer->id);
+			buffers_.push_back(buffer);
+
+			threadKey().set(buffer);
+		}
+
+		return buffer;
+	}
+
+	void Profiler::record(ScopeId const scope, EventType const type)
+	{
+		ThreadBuffer* buffer = threadBuffer();
+
+		// the owner is the only writer of the position
+		Uint64 const position = Uint64(Int64(buffer->write_position));
+
+		Event& event = buffer->events[position & buffer->mask];
+		event.time = now();
+		event.scope = scope;
+		event.type = type;
+
+		// full barrier, the event is visible before the position
+		++buffer->write_position;
+	}
+
+	void Profiler::setThreadName(std::string const& name)
+	{
+		ThreadBuffer* buffer = threadBuffer();
+
+		ScopedLock lock(buffers_mutex_);
+		buffer->name = name;
+	}
+
+	void Profiler::drain(ThreadBuffer& buffer)
+	{
+		Uint64 const capacity = buffer.mask + 1;
+		Bool const finished = (Int64(buffer.finished) != 0);
+		Uint64 const written = Uint64(buffer.write_position += 0);
+
+		Uint64 first = buffer.read_position;
+		if (written - first > capacity)
+		{
+			first = written - capacity;
+		}
+
+		Events events;
+		events.reserve(Events::size_type(written - first));
+		for (Uint64 i = first; i != written; ++i)
+		{
+			events.push_back(buffer.events[i & buffer.mask]);
+		}
+
+		// the owner kept writing while copying, the slots it reused, and the one it may be writing, are lost
+		Uint64 const rewritten = Uint64(buffer.write_position += 0) + (finished ? 0 : 1);
+		Uint64 valid = first;
+		if ((rewritten > capacity) && (rewritten - capacity > valid))
+		{
+			valid = (rewritten - capacity < written) ? (rewritten - capacity) : written;
+		}
+
+		ThreadTrace& trace = traces_[buffer.id];
+		trace.name = buffer.name;
+		trace.dropped += valid - buffer.read_position;
+		trace.events.insert(trace.events.end(), events.begin() + Events::difference_type(valid - first), events.end());
+
+		if (trace.events.size() > trace_size_)
+		{
+			TraceEvents::size_type const excess = trace.events.size() - trace_size_;
+			trace.events.erase(trace.events.begin(), trace.events.begin() + TraceEvents::difference_type(excess));
+			trace.dropped += excess;
+		}
+
+		buffer.read_position = written;
+	}
+
+	void Profiler::collect()
+	{
+		ScopedLock lock(buffers_mutex_);
+
+		for (ThreadBuffers::iterator i = buffers_.begin(); i != buffers_.end();)
+		{
+			// read before draining, a finished thread wrote its last event
+			Bool const finished = (Int64((*i)->finished) != 0);
+
+			drain(**i);
+
+			if (finished)
+			{
+				delete(*i);
+				i = buffers_.erase(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	Profiler::ThreadTraces Profiler::traces() const
+	{
+		ScopedLock lock(buffers_mutex_);
+		return traces_;
+	}
+
+	void Profiler::clear()
+	{
+		ScopedLock lock(buffers_mutex_);
+
+		traces_.clear();
+
+		for (ThreadBuffers::iterator i = buffers_.begin(); i != buffers_.end(); ++i)
+		{
+			(*i)->read_position = Uint64((*i)->write_position += 0);
+		}
+	}
+
+	void Profiler::exportChromeTrace(std::ostream& out) const
+	{
+		ThreadTraces const thread_traces = traces();
+
+		ScopeNames names;
+		{
+			ScopedLock lock(scopes_mutex_);
+			for (ScopeNames::const_iterator i = scope_names_.begin(); i != scope_names_.end(); ++i)
+			{
+				names.push_back(escapeJson(*i));
+			}
+		}
+
+		out << "{\"traceEvents\":[";
+
+		Bool first = true;
+		for (ThreadTraces::const_iterator thread = thread_traces.begin(); thread != thread_traces.end(); ++thread)
+		{
+			out << (first ? "\n" : ",\n");
+			first = false;
+
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->first
+				<< ",\"args\":{\"name\":\"" << escapeJson(thread->second.name) << "\"}}";
+
+			// ends of scopes whose begin was dropped are left out
+			Uint open = 0;
+			for (TraceEvents::const_iterator event = thread->second.events.begin(); event != thread->second.events.end(); ++event)
+			{
+				if (event->type == End)
+				{
+					if (open == 0)
+					{
+						continue;
+					}
+					--open;
+				}
+				else
+				{
+					++open;
+				}
+
+				Nanoseconds const time = (event->time > start_time_) ? (event->time - start_time_) : 0;
+
+				out << ",\n{\"name\":\"" << ((event->scope < names.size()) ? names[event->scope] : std::string())
+					<< "\",\"ph\":\"" << ((event->type == Begin) ? "B" : "E")
+					<< "\",\"pid\":1,\"tid\":" << thread->first
+					<< ",\"ts\":" << (time / 1000) << "." << std::setw(3) << std::setfill('0') << (time % 1000) << std::setfill(' ')
+					<< "}";
+			}
+		}
+
+		out << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+	}
+
+	Bool Profiler::exportChromeTrace(std::string const& filename) const
+	{
+		std::ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
+		if (!out.is_open())
+		{
+			return false;
+		}
+
+		exportChromeTrace(out);
+		return out.good();
+	}
+
+} // namespace rengine
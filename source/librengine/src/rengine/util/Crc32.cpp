@@ -0,0 +1,233 @@
+// __!!rengine_copyright!!__ //
+
+#include <rengine/util/Crc32.h>
+
+#include <cstring>
+
+#if (RENGINE_SIMD_SSE2 == RENGINE_ON) && ((RENGINE_COMPILER == RENGINE_COMPILER_GNUC) || (RENGINE_COMPILER == RENGINE_COMPILER_MSVC))
+	#define RENGINE_CRC32_PCLMUL RENGINE_ON
+#else
+	#define RENGINE_CRC32_PCLMUL RENGINE_OFF
+#endif
+
+#if RENGINE_CRC32_PCLMUL == RENGINE_ON
+	#include <emmintrin.h>
+	#include <wmmintrin.h>
+
+	#if RENGINE_COMPILER == RENGINE_COMPILER_MSVC
+		#include <intrin.h>
+		#define RENGINE_CRC32_TARGET
+	#else
+		#include <cpuid.h>
+		#define RENGINE_CRC32_TARGET __attribute__((target("sse2,pclmul")))
+	#endif
+#endif
+
+namespace rengine
+{
+	//
+	// Slicing by 8 tables, table[0] is the classic byte table and
+	// table[k][n] is the crc of byte n followed by k zero bytes
+	//
+	struct Crc32Tables
+	{
+		Crc32Tables()
+		{
+			for (Uint32 n = 0; n != 256; ++n)
+			{
+				Uint32 crc = n;
+				for (Uint bit = 0; bit != 8; ++bit)
+				{
+					crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+				}
+				table[0][n] = crc;
+			}
+
+			for (Uint32 n = 0; n != 256; ++n)
+			{
+				for (Uint k = 1; k != 8; ++k)
+				{
+					table[k][n] = (table[k - 1][n] >> 8) ^ table[0][table[k - 1][n] & 0xFF];
+				}
+			}
+		}
+
+		Uint32 table[8][256];
+	};
+
+	static Crc32Tables const crc32_tables;
+
+	// works on the inverted crc register
+	static Uint32 crc32Slicing(Uint32 crc, Uint8 const* data, Uint size)
+	{
+		Uint32 const (*table)[256] = crc32_tables.table;
+
+#if RENGINE_ENDIAN == RENGINE_LITTLE_ENDIAN
+		while (size >= 8)
+		{
+			Uint32 low;
+			Uint32 high;
+			memcpy(&low, data, 4);
+			memcpy(&high, data + 4, 4);
+			low ^= crc;
+
+			crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+				  table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+				  table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+				  table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+
+			data += 8;
+			size -= 8;
+		}
+#endif
+
+		while (size--)
+		{
+			crc = table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+		}
+
+		return crc;
+	}
+
+#if RENGINE_CRC32_PCLMUL == RENGINE_ON
+
+	static Bool hasPclmul()
+	{
+#if RENGINE_COMPILER == RENGINE_COMPILER_MSVC
+		int registers[4];
+		__cpuid(registers, 1);
+		return (registers[2] & (1 << 1)) != 0;
+#else
+		unsigned int eax = 0;
+		unsigned int ebx = 0;
+		unsigned int ecx = 0;
+		unsigned int edx = 0;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 1));
+#endif
+	}
+
+	static Bool const pclmul_available = hasPclmul();
+
+	//
+	// Folds 64 byte blocks with carry-less multiplications and reduces with Barrett (Intel, "Fast CRC Computation
+	// for Generic Polynomials Using PCLMULQDQ Instruction"). Works on the inverted crc register,
+	// size is at least 64 and a multiple of 16.
+	//
+	RENGINE_CRC32_TARGET static Uint32 crc32Folding(Uint32 crc, Uint8 const* data, Uint size)
+	{
+		__m128i const k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+		__m128i const k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+		__m128i const k5k0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+		__m128i const poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+		__m128i const mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+		__m128i x1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x00));
+		__m128i x2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x10));
+		__m128i x3 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x20));
+		__m128i x4 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x30));
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(Int(crc)));
+
+		data += 64;
+		size -= 64;
+
+		// four 128 bit lanes in parallel
+		while (size >= 64)
+		{
+			__m128i const x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+			__m128i const x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+			__m128i const x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+			__m128i const x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+			x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x00)));
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x10)));
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x20)));
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 0x30)));
+
+			data += 64;
+			size -= 64;
+		}
+
+		// fold the lanes into one
+		__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+		while (size >= 16)
+		{
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<__m128i const*>(data))), x5);
+
+			data += 16;
+			size -= 16;
+		}
+
+		// 128 to 64 bits
+		x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, mask);
+		x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		// Barrett reduction to 32 bits
+		x2 = _mm_and_si128(x1, mask);
+		x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+		x2 = _mm_and_si128(x2, mask);
+		x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		return Uint32(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+	}
+
+#endif // RENGINE_CRC32_PCLMUL
+
+	Uint32 crc32(Uint32 crc, void const* data, Uint const size)
+	{
+		Uint8 const* bytes = static_cast<Uint8 const*>(data);
+		Uint remaining = size;
+
+		if (bytes == 0)
+		{
+			return 0;
+		}
+
+		crc = ~crc;
+
+#if RENGINE_CRC32_PCLMUL == RENGINE_ON
+		if (pclmul_available && (remaining >= 64))
+		{
+			Uint const folded = remaining & ~Uint(15);
+			crc = crc32Folding(crc, bytes, folded);
+			bytes += folded;
+			remaining -= folded;
+		}
+#endif
+
+		return ~crc32Slicing(crc, bytes, remaining);
+	}
+
+	Bool crc32Accelerated()
+	{
+#if RENGINE_CRC32_PCLMUL == RENGINE_ON
+		return pclmul_available;
+#else
+		return false;
+#endif
+	}
+
+} // namespace rengine
@@ -0,0 +1,247 @@
+#include <rengine/util/Bootstrap.h>
+
+#include <rengine/image/ImageResourceLoader.h>
+#include <rengine/image/Mipmap.h>
+#include <rengine/image/Filter.h>
+#include <rengine/resource/AssetPack.h>
+#include <rengine/state/ShaderResourceLoader.h>
+#include <rengine/text/FontResourceLoader.h>
+#include <rengine/file/VirtualFileSystem.h>
+
+typedef std::vector<std::string> Filenames;
+
+struct CookerOptions
+{
+	CookerOptions()
+		:power_of_two(false), mipmaps(true)
+	{
+	}
+
+	Bool power_of_two;
+	Bool mipmaps;
+};
+
+//
+// files of a directory and its subdirectories, relative to the directory
+//
+static void collectFiles(std::string const& root, std::string const& relative, Filenames& filenames)
+{
+	std::string const directory = relative.empty() ? root : (root + "/" + relative);
+	DirectoryContents contents = getDirectoryContents(convertFileNameToNativeStyle(directory));
+	std::sort(contents.begin(), contents.end());
+
+	for (DirectoryContents::const_iterator i = contents.begin(); i != contents.end(); ++i)
+	{
+		if ((*i == ".") || (*i == ".."))
+		{
+			continue;
+		}
+
+		std::string const name = relative.empty() ? *i : (relative + "/" + *i);
+		FileType const type = fileType(convertFileNameToNativeStyle(root + "/" + name));
+
+		if (type == FileDirectory)
+		{
+			collectFiles(root, name, filenames);
+		}
+		else if (type == FileRegular)
+		{
+			filenames.push_back(name);
+		}
+	}
+}
+
+static Bool cookImage(AssetPackWriter& writer, std::string const& name, std::string const& path, CookerOptions const& options)
+{
+	ImageResourceLoader loader;
+	SharedPointer<Image> image = loader.loadImplementation(path);
+	if (!image)
+	{
+		return false;
+	}
+
+	Uint flags = AssetPack::ImageFlipped;
+	image->makeOpenGlCompliant(true, options.power_of_two);
+	if (options.power_of_two)
+	{
+		flags |= AssetPack::ImagePowerOfTwo;
+	}
+
+	MipmapChain mipmaps;
+	if (options.mipmaps)
+	{
+		mipmaps.build(image, BoxFilter());
+	}
+
+	std::vector<Uint8> payload;
+	AssetPack::encodeImage(*image, options.mipmaps ? &mipmaps : 0, flags, payload);
+
+	return writer.add(name, AssetPack::ImageEntry, &payload[0], Uint(payload.size()));
+}
+
+static Bool cookFont(AssetPackWriter& writer, std::string const& name, std::string const& path)
+{
+	SharedPointer<Font> font;
+	if (equalCaseInsensitive(getFileExtension(path), "ttf"))
+	{
+		TruetypeFontResourceLoader loader;
+		font = loader.loadImplementation(path);
+	}
+	else
+	{
+		WinfontResourceLoader loader;
+		font = loader.loadImplementation(path);
+	}
+
+	FileData source;
+	if (!font || !VirtualFileSystem::DirectoryMount().read(path, source))
+	{
+		return false;
+	}
+
+	std::vector<Uint8> payload;
+	if (!CookedFont::cook(*font, source.bytes(), source.size, payload))
+	{
+		return false;
+	}
+
+	return writer.add(name, AssetPack::FontEntry, &payload[0], Uint(payload.size()));
+}
+
+static Bool cookEffect(AssetPackWriter& writer, std::string const& name, std::string const& path)
+{
+	ProgramResourceLoader loader;
+
+	std::string source;
+	if (!loader.expandIncludes(path, source))
+	{
+		return false;
+	}
+
+	return writer.add(name, AssetPack::RawEntry, source.data(), Uint(source.size()));
+}
+
+static Bool cookRaw(AssetPackWriter& writer, std::string const& name, std::string const& path)
+{
+	FileData data;
+	if (!VirtualFileSystem::DirectoryMount().read(path, data))
+	{
+		return false;
+	}
+
+	return writer.add(name, AssetPack::RawEntry, data.bytes(), data.size);
+}
+
+//
+// usage: rengineAssetCooker <data directory> <output pack> [--power-of-two] [--no-mipmaps]
+//
+// Images are decoded, flipped for OpenGL and stored with their mipmap chain.
+// Fonts are rasterized with the default loader options, effects are stored with their includes expanded.
+// Every other file is stored as is. Mount the pack over the data directory to use it.
+//
+int main(int argc, char *argv[])
+{
+	rengine::enableApplicationDebugger();
+	std::cout << "Asset cooker" << std::endl;
+
+	if (argc < 3)
+	{
+		std::cout << "usage: rengineAssetCooker <data directory> <output pack> [--power-of-two] [--no-mipmaps]" << std::endl;
+		return 1;
+	}
+
+	std::string const data_directory = convertFileNameToUnixStyle(argv[1]);
+	std::string const output = argv[2];
+
+	CookerOptions options;
+	for (Int i = 3; i < argc; ++i)
+	{
+		std::string const argument = argv[i];
+
+		if (argument == "--power-of-two")
+		{
+			options.power_of_two = true;
+		}
+		else if (argument == "--no-mipmaps")
+		{
+			options.mipmaps = false;
+		}
+		else
+		{
+			std::cout << "Unknown option " << argument << std::endl;
+			return 1;
+		}
+	}
+
+	Filenames filenames;
+	collectFiles(data_directory, "", filenames);
+
+	AssetPackWriter writer;
+	if (!writer.open(output))
+	{
+		std::cout << "Unable to create " << output << std::endl;
+		return 1;
+	}
+
+	ImageResourceLoader image_loader;
+	Uint failures = 0;
+
+	for (Filenames::const_iterator i = filenames.begin(); i != filenames.end(); ++i)
+	{
+		std::string const name = VirtualFileSystem::normalize(*i);
+		std::string const path = convertFileNameToNativeStyle(data_directory + "/" + *i);
+		std::string const extension = getLowerCaseFileExtension(*i);
+
+		Bool cooked = false;
+		std::string kind = "raw";
+
+		if (image_loader.suportsFormat(extension))
+		{
+			kind = "image";
+			cooked = cookImage(writer, name, path, options);
+		}
+		else if ((extension == "ttf") || (extension == "fon"))
+		{
+			kind = "font";
+			cooked = cookFont(writer, name, path);
+		}
+		else if (extension == "eff")
+		{
+			kind = "effect";
+			cooked = cookEffect(writer, name, path);
+		}
+
+		// files the cookers can not handle are kept as they are
+		if (!cooked && (kind != "raw"))
+		{
+			std::cout << "Unable to cook " << kind << " " << name << ", storing it raw" << std::endl;
+			kind = "raw";
+		}
+
+		if (!cooked)
+		{
+			cooked = cookRaw(writer, name, path);
+		}
+
+		if (cooked)
+		{
+			std::cout << "[" << kind << "] " << name << std::endl;
+		}
+		else
+		{
+			std::cout << "Unable to store " << name << std::endl;
+			++failures;
+		}
+	}
+
+	Uint const entries = writer.numberOfEntries();
+	if (!writer.close())
+	{
+		std::cout << "Unable to write " << output << std::endl;
+		return 1;
+	}
+
+	std::cout << entries << " entries written to " << output << ", " << failures << " failures." << std::endl;
+
+	return (failures == 0) ? 0 : 1;
+}
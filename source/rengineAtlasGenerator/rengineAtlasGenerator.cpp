@@ -1,6 +1,7 @@
 #include <rengine/util/Bootstrap.h>
 
 #include <rengine/image/ImageResourceLoader.h>
+#include <rengine/image/ImageResampler.h>
 #include <rengine/algorithm/RectanglePacking.h>
 #include <rengine/image/stb_image.h>
 
@@ -10,18 +11,32 @@ Int const margin = 0;
 
 //todo implement margin
 typedef std::vector<std::string> Filenames;
+typedef std::vector< SharedPointer<Image> > Images;
 
+//
+// usage: rengineAtlasGenerator [scale]
+// source images are resampled by scale before packing
+//
 int main(int argc, char *argv[])
 {
 	rengine::enableApplicationDebugger();
 	std::cout << "Atlas generator" << std::endl;
 
+	Real scale = 1.0f;
+	if (argc > 1)
+	{
+		scale = lexical_cast<Real>(std::string(argv[1]), 1.0f);
+	}
+
+	LanczosFilter filter;
+	ImageResampler resampler(filter);
 
 	ImageResourceLoader loader;
 
 	DirectoryContents directory_contents = getDirectoryContents(image_dir);
 
 	Filenames filenames;
+	Images images;
 	MetaBinPack::MetaRectangles rectangles;
 
 	for (DirectoryContents::iterator i = directory_contents.begin(); i != directory_contents.end(); ++i)
@@ -33,12 +48,20 @@ int main(int argc, char *argv[])
 		{
 			SharedPointer<Image> image =  loader.loadImplementation(path);
 
+			if (image && (scale != 1.0f))
+			{
+				Uint width = maximum(Uint(Real(image->getWidth()) * scale + 0.5f), Uint(1));
+				Uint height = maximum(Uint(Real(image->getHeight()) * scale + 0.5f), Uint(1));
+				image = resampler.resample(*image, width, height);
+			}
+
 			if (image)
 			{
 				MetaBinPack::MetaRectangle rectangle;
 				rectangle.originalWidth = image->getWidth() + 2 * margin;
 				rectangle.originalHeight = image->getHeight() + 2 * margin;
 				filenames.push_back(path);
+				images.push_back(image);
 				rectangles.push_back(rectangle);
 			}
 			else
@@ -71,64 +94,35 @@ int main(int argc, char *argv[])
 		// build image
 		//
 		Int channels = 4;
-		Int total_size = width * height * channels;
-		SharedArray<unsigned char> image = new unsigned char[total_size];
-		memset(image.get(), 0, total_size);
+		Image atlas(width, height, channels);
+		atlas.zeroImage();
 
 
 		for (Int i = 0; i != (Int)rectangles.size(); ++i)
 		{
-			SharedPointer<Image> sourceImage =  loader.loadImplementation(filenames[i]);
-			if (sourceImage.get() == 0)
-			{	
-				std::cout << "Unable to load " << filenames[i] << std::endl;
+			SharedPointer<Image> sourceImage = images[i];
+
+			Int const rectangle_width = rectangles[i].width - 2 * margin;
+			Int const rectangle_height = rectangles[i].height - 2 * margin;
+			ImageView destination = atlas.view(rectangles[i].x + margin, rectangles[i].y + margin, rectangle_width, rectangle_height);
+
+			if (!rectangles[i].rotated)
+			{
+				sourceImage->view().copyTo(destination);
 				continue;
 			}
 
-			for (Int x = 0; x != rectangles[i].width - 2 * margin; ++x)
+			// rotated images are copied one pixel at a time
+			for (Int y = 0; y != rectangle_height; ++y)
 			{
-				for (Int y = 0; y != rectangles[i].height - 2 * margin; ++y)
+				for (Int x = 0; x != rectangle_width; ++x)
 				{
-					Image::Color* color = 0;
-					if (rectangles[i].rotated)
-					{
-						color = sourceImage->pixel(y, x);	 
-					}
-					else
-					{
-						color = sourceImage->pixel(x, y);	
-					}
-
-					Int x_pos = rectangles[i].x + x;
-					Int y_pos = rectangles[i].y + y;
-					
-
-					image[(x_pos + margin + (y_pos + margin) * width) * 4 + 0] = color->r();
-					
-					if (sourceImage->getColorChannels() >= 3)
-					{
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 1] = color->g();
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 2] = color->b();
-					}
-					else
-					{
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 1] = color->r();
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 2] = color->r();
-					}
-
-					if (sourceImage->getColorChannels() >= 4)
-					{
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 3] = color->a();
-					}
-					else
-					{
-						image[(x_pos + margin + (y_pos + margin) * width) * 4 + 3] = 255;
-					}
+					sourceImage->view(y, x, 1, 1).copyTo(destination.subView(x, y, 1, 1));
 				}
 			}
 		}
 
-		int result = stbi_write_tga((output_image + ".tga").c_str(), width, height, channels, image.get());
+		int result = stbi_write_tga((output_image + ".tga").c_str(), width, height, channels, atlas.getData());
 	}
 	else
 	{
@@ -1,10 +1,11 @@
 #include <rengine/util/Bootstrap.h>
+#include <rengine/time/Timer.h>
 
 class MainScene : public Scene, public InterfaceEventHandler
 {
 public:
 	typedef std::vector< SharedPointer<Mesh> > MeshVector;
-	MainScene() {}
+	MainScene() :frames_uploaded(0), last_report_frames(0), last_report_time(0.0) {}
 	virtual ~MainScene() {}
 
 	virtual void init()
@@ -14,7 +15,14 @@ public:
 		CoreEngine::instance()->renderEngine().setViewport(0, 0, width, height);
 
 
-		video_capture = VideoCapture::create();
+		// "capture_source" on the location table replays a recorded file or image directory
+		video_capture = VideoCapture::create(CoreEngine::instance()->locationTable().lookUp("capture_source"));
+
+		if (!video_capture)
+		{
+			CoreEngine::instance()->log() << "No video capture backend available" << std::endl;
+			return;
+		}
 
 		if (true)
 		{
@@ -98,11 +106,19 @@ public:
 
 	virtual void shutdown()
 	{
-		video_capture->close();
+		if (video_capture)
+		{
+			video_capture->close();
+		}
 	}
 
 	virtual void update()
 	{
+		if (!video_capture)
+		{
+			return;
+		}
+
 		try
 		{
 			VideoCapture::FrameOptions options;
@@ -115,6 +131,7 @@ public:
 					video_capture->captureOptions().height, 3, frame->data);
 				image->flip(Image::FlipVertical);
 				texture->setImage(image);
+				++frames_uploaded;
 			}
 		}
 		catch (VideoCaptureException caught)
@@ -136,13 +153,32 @@ public:
 		Matrix projection = Matrix::ortho2D(0, width, 0, height);
 		CoreEngine::instance()->renderEngine().pushDrawStates();
 
-		if (video_capture->ready())
+		if (video_capture && video_capture->ready())
 		{
 			quadrilateral->states()->getProgram()->uniform("mvp").set( Matrix::ortho2D(0, width, 0, height) );
 			CoreEngine::instance()->renderEngine().draw( *quadrilateral );
 		}
 
 		CoreEngine::instance()->renderEngine().popDrawStates();
+
+		reportThroughput();
+	}
+
+	// capture -> convert -> upload throughput, once per second
+	void reportThroughput()
+	{
+		Real64 const now = CoreEngine::instance()->timer().elapsedTime();
+		Real64 const elapsed = now - last_report_time;
+
+		if (elapsed >= 1.0)
+		{
+			CoreEngine::instance()->log() << "Capture throughput : "
+				<< Real64(frames_uploaded - last_report_frames) / elapsed << " frames/s ("
+				<< frames_uploaded << " frames)" << std::endl;
+
+			last_report_time = now;
+			last_report_frames = frames_uploaded;
+		}
 	}
 
 	virtual void operator()(InterfaceEvent const& interface_event, GraphicsWindow* window)
@@ -162,6 +198,10 @@ private:
 
 	SharedPointer<Quadrilateral> quadrilateral;
 	SharedPointer<Texture2D> texture;
+
+	Uint64 frames_uploaded;
+	Uint64 last_report_frames;
+	Real64 last_report_time;
 };
 
 RENGINE_BOOT();
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include <rengine/lang/debug/Debug.h>
-#include <rengine/file/Zip.h>
+#include <rengine/file/VirtualFileSystem.h>
 #include <rengine/CoreEngine.h>
 #include <rengine/RenderEngine.h>
 #include <rengine/system/System.h>
@@ -57,44 +57,28 @@ extern "C"
 
 	uint8* FCEUD_LoadFromDatabase(const char *fn, int* size)
 	{
-		*size = 0;
-		uint8* data = 0;
-
-		rengine::Zip zip;
-
-		if (!zip.fileExists(fn))
+		// rom database, mounted on the first read
+		static rengine::VirtualFileSystem roms;
+		if (roms.numberOfMounts() == 0)
 		{
-			zip.close();
-			zip.load(NES_DATABASE);
+			roms.mountZip(NES_DATABASE);
 		}
 
-		//if (!zip.fileExists(fn))
-		//{
-		//	zip.close();
-		//	zip.load(MASTERSYSTEM_DATABASE);
-		//}
+		*size = 0;
+		uint8* data = 0;
 
-		if (zip.fileExists(fn))
+		FileData file_data;
+		if (roms.read(fn, file_data) && file_data.size)
 		{
-			Zip::FileData file_data = zip.read(fn);
-			*size = file_data.size;
-
-			if (file_data.size && file_data.data)
+			// the emulator core frees the rom
+			data = (uint8*)malloc(file_data.size);
+			if (data)
 			{
-				data = (uint8*)malloc(file_data.size);
-				if (data)
-				{
-					memcpy(data, file_data.data.get(), file_data.size);
-				}
-				else
-				{
-					*size = 0;
-				}
+				memcpy(data, file_data.bytes(), file_data.size);
+				*size = int(file_data.size);
 			}
 		}
 
-		zip.close();
-
 		return data;
 	}
 }
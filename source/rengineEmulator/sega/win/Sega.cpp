@@ -1,5 +1,7 @@
 #include <rengine/lang/debug/Debug.h>
-#include <rengine/file/Zip.h>
+#include <rengine/file/VirtualFileSystem.h>
+#include <rengine/file/Deflate.h>
+#include <rengine/util/Crc32.h>
 #include <rengine/CoreEngine.h>
 #include <rengine/RenderEngine.h>
 #include <rengine/system/System.h>
@@ -12,6 +14,7 @@
 
 #include <sstream>
 #include <cstdio>
+#include <algorithm>
 
 #include <AL/al.h>
 #include <AL/alc.h>
@@ -31,29 +34,72 @@ int log_error   = 1;
 
 extern "C"
 {
-	unsigned long computeCrc(unsigned long crc, unsigned char* data, unsigned int size);
 	unsigned long crc32(unsigned long crc, unsigned char* data, unsigned int size)
 	{
-		crc = 0xffffffffL;
-		return computeCrc(crc, data, size);
+		return rengine::crc32(0, data, size);
 	}
 
+	// compressed states start with a tag, untagged states are raw ones saved before compression was available
+	static rengine::Uint8 const state_tag[4] = { 'R', 'G', 'Z', '1' };
+	static rengine::Uint const state_tag_size = sizeof(state_tag);
+
 	void uncompress(Bytef* out, unsigned long* outbytes, Bytef* in, unsigned long inbytes)
 	{
-		if (inbytes >= (STATE_SIZE - 4))
+		rengine::Uint out_size = rengine::Uint(*outbytes);
+
+		if ((inbytes >= state_tag_size) && (memcmp(in, state_tag, state_tag_size) == 0))
 		{
-			error("uncompress/compress2 using a buffer too big");
+			rengine::Uint in_size = rengine::Uint(inbytes - state_tag_size);
+
+			if (rengine::inflate(out, out_size, in + state_tag_size, in_size) == rengine::Inflater::Success)
+			{
+				*outbytes = out_size;
+			}
+			else
+			{
+				error("uncompress of a corrupted state");
+				*outbytes = 0;
+			}
+			return;
 		}
-		else
+
+		// raw bytes can also be valid deflate data, untagged states are never inflated
+		if (inbytes <= *outbytes)
 		{
 			*outbytes = inbytes;
 			memcpy(out, in, inbytes);
 		}
+		else
+		{
+			error("uncompress using a buffer too big");
+			*outbytes = 0;
+		}
 	}
 
 	void compress2(Bytef *out, unsigned long* outbytes, Bytef* in, unsigned long inbytes, int level)
 	{
-		uncompress(out, outbytes, in, inbytes);
+		// the state buffer holds the size before the tag and the compressed data
+		unsigned long const available = std::min(*outbytes, (unsigned long)(STATE_SIZE - 4));
+		if (available < state_tag_size)
+		{
+			error("compress2 using a buffer too small");
+			*outbytes = 0;
+			return;
+		}
+
+		rengine::Uint out_size = rengine::Uint(available - state_tag_size);
+
+		memcpy(out, state_tag, state_tag_size);
+
+		if (rengine::deflate(out + state_tag_size, out_size, in, rengine::Uint(inbytes), rengine::Deflater::levelFromZlib(level)) == rengine::Deflater::Success)
+		{
+			*outbytes = out_size + state_tag_size;
+		}
+		else
+		{
+			error("compress2 using a buffer too big");
+			*outbytes = 0;
+		}
 	}
 
 	void osd_input_Update(void)
@@ -63,16 +109,16 @@ extern "C"
 
 	int load_archive(char* const filename)
 	{
-		char* buffer = 0;
-		int data_size = 0;
-		SharedArray<Uint8> data = Sega::instance->readFile(filename, data_size);
-
-		if (data && data_size)
+		FileData data;
+		if (!Sega::instance->readFile(filename, data) || (data.size > MAXROMSIZE))
 		{
-			memcpy(cart.rom, data.get(), data_size);
+			return 0;
 		}
 
-		return data_size;
+		// the emulator core owns the cartridge memory
+		memcpy(cart.rom, data.bytes(), data.size);
+
+		return int(data.size);
 	}
 
 	void error(char *format, ...)
@@ -330,46 +376,18 @@ Sega::~Sega()
 	Sega::instance = 0;
 }
 
-rengine::SharedArray<Uint8> Sega::readFile(std::string const& filename, int& size)
+Bool Sega::readFile(std::string const& filename, FileData& data)
 {
-	SharedArray<Uint8> data;
-
-	rengine::Zip zip;
-
-	if (!zip.fileExists(filename))
-	{
-		zip.close();
-		zip.load(GENESIS_DATABASE);
-	}
-
-	if (!zip.fileExists(filename))
-	{
-		zip.close();
-		zip.load(MASTERSYSTEM_DATABASE);
-	}
-
-	if (!zip.fileExists(filename))
-	{
-		zip.close();
-		zip.load(GAMEGEAR_DATABASE);
-	}
-
-	if (!zip.fileExists(filename))
+	if (m_roms.numberOfMounts() == 0)
 	{
-		zip.close();
-		zip.load(SG1000_DATABASE);
+		// looked up in this order
+		m_roms.mountZip(GENESIS_DATABASE, "", 3);
+		m_roms.mountZip(MASTERSYSTEM_DATABASE, "", 2);
+		m_roms.mountZip(GAMEGEAR_DATABASE, "", 1);
+		m_roms.mountZip(SG1000_DATABASE, "", 0);
 	}
 
-	if (zip.fileExists(filename))
-	{
-		Zip::FileData file_data = zip.read(filename);
-		data = file_data.data;
-		size = file_data.size;
-	}
-
-	zip.close();
-
-	return data;
+	return m_roms.read(filename, data);
 }
 
 void Sega::shutdown()
@@ -434,14 +452,12 @@ void Sega::loadBios()
 	config.tmss &= ~2;
 
 	/* open BIOS file */
-	int size = 0;
-	SharedArray<Uint8> data = Sega::instance->readFile(OS_ROM, size);
-
-	if (!data.get()) return;
+	FileData data;
+	if (!Sega::instance->readFile(OS_ROM, data)) return;
 
 	/* read file */
-	if (size <= (int)sizeof(bios_rom))
-		memcpy(bios_rom, data.get(), size);
+	if (data.size <= sizeof(bios_rom))
+		memcpy(bios_rom, data.bytes(), data.size);
 
 	/* check ROM file */
 	if (!strncmp((char *)(bios_rom + 0x120),"GENESIS OS", 10))
@@ -2,7 +2,7 @@
 #define __RENGINE_SEGA_H__
 
 #include <rengine/lang/debug/Debug.h>
-#include <rengine/file/Zip.h>
+#include <rengine/file/VirtualFileSystem.h>
 #include <rengine/Scene.h>
 #include <rengine/state/Texture.h>
 #include <rengine/geometry/BaseShapes.h>
@@ -37,7 +37,8 @@ public:
 
 	virtual void operator()(rengine::SystemCommand::CommandId const command, rengine::SystemCommand::Arguments const& arguments);
 
-	rengine::SharedArray<rengine::Uint8> readFile(std::string const& filename, int& size);
+	// reads a rom or bios from the mounted rom databases
+	rengine::Bool readFile(std::string const& filename, rengine::FileData& data);
 	void loadRom(std::string const& rom);
 
 	void saveGame(int slot);
@@ -54,6 +55,9 @@ private:
 	void loadBios();
 	std::string filename;
 
+	// rom databases, mounted on the first read
+	rengine::VirtualFileSystem m_roms;
+
 	rengine::Real m_framerate;
 	rengine::Real64 m_start_time;
 	rengine::Uint64 m_rendered_frames;